@@ -0,0 +1,73 @@
+#include "archive.hh"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
+
+#include "logger.hh"
+#include "codeplugarchive.hh"
+
+
+int archive(QCommandLineParser &parser, QCoreApplication &app) {
+  Q_UNUSED(app)
+
+  QStringList args = parser.positionalArguments();
+  if (3 > args.size())
+    parser.showHelp(-1);
+
+  QString action = args.at(1);
+  CodeplugArchive store(args.at(2));
+  QTextStream out(stdout);
+
+  if ("add" == action) {
+    // dmrconf archive add DIR FILE [NAME]
+    if (4 > args.size())
+      parser.showHelp(-1);
+    if (! store.add(args.at(3), args.value(4))) {
+      logError() << "Cannot archive '" << args.at(3) << "': " << store.errorMessage();
+      return -1;
+    }
+    return 0;
+  } else if ("list" == action) {
+    // dmrconf archive list DIR
+    QList<CodeplugArchive::Entry> entries;
+    if (! store.list(entries)) {
+      logError() << "Cannot list archive '" << args.at(2) << "': " << store.errorMessage();
+      return -1;
+    }
+    foreach (const CodeplugArchive::Entry &entry, entries) {
+      out << entry.name << "\t" << entry.added.toString(Qt::ISODate) << "\t" << entry.size
+          << "b\t" << entry.blocks << " blocks\t" << entry.source << "\n";
+    }
+    return 0;
+  } else if ("extract" == action) {
+    // dmrconf archive extract DIR NAME FILE
+    if (5 > args.size())
+      parser.showHelp(-1);
+    if (! store.extract(args.at(3), args.at(4))) {
+      logError() << "Cannot extract '" << args.at(3) << "': " << store.errorMessage();
+      return -1;
+    }
+    return 0;
+  } else if ("diff" == action) {
+    // dmrconf archive diff DIR NAME1 NAME2
+    if (5 > args.size())
+      parser.showHelp(-1);
+    QList<CodeplugArchive::Difference> differences;
+    if (! store.diff(args.at(3), args.at(4), differences)) {
+      logError() << "Cannot compare '" << args.at(3) << "' and '" << args.at(4) << "': "
+                 << store.errorMessage();
+      return -1;
+    }
+    foreach (const CodeplugArchive::Difference &diff, differences) {
+      out << "image " << diff.image << ": " << QString("%1").arg(diff.address, 8, 16, QChar('0'))
+          << " +" << diff.size << "b\n";
+    }
+    // Like diff(1), signal differences by the exit code
+    return differences.isEmpty() ? 0 : 1;
+  }
+
+  logError() << "Unknown archive action '" << action << "'.";
+  parser.showHelp(-1);
+  return -1;
+}
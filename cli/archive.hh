@@ -0,0 +1,9 @@
+#ifndef ARCHIVE_HH
+#define ARCHIVE_HH
+
+class QCoreApplication;
+class QCommandLineParser;
+
+int archive(QCommandLineParser &parser, QCoreApplication &app);
+
+#endif // ARCHIVE_HH
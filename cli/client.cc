@@ -0,0 +1,57 @@
+#include "client.hh"
+
+#include <QLocalSocket>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QDir>
+
+#include "logger.hh"
+#include "server.hh"
+#include "progressbar.hh"
+
+/** Timeout in ms to connect to the daemon. */
+#define CONNECT_TIMEOUT 100
+
+
+bool forwardCommand(const QStringList &arguments, int &result) {
+  QLocalSocket socket;
+  socket.connectToServer(Server::socketPath());
+  if (! socket.waitForConnected(CONNECT_TIMEOUT))
+    return false;
+
+  logDebug() << "Forward command to daemon at '" << Server::socketPath() << "'.";
+  QJsonObject request;
+  request.insert("cwd", QDir::currentPath());
+  request.insert("args", QJsonArray::fromStringList(arguments));
+  socket.write(QJsonDocument(request).toJson(QJsonDocument::Compact));
+  socket.write("\n");
+
+  bool progress = false;
+  while (true) {
+    while (! socket.canReadLine()) {
+      if (! socket.waitForReadyRead(-1)) {
+        logError() << "Lost connection to daemon: " << socket.errorString();
+        result = -1;
+        return true;
+      }
+    }
+
+    QJsonObject reply = QJsonDocument::fromJson(socket.readLine()).object();
+    if (reply.contains("progress")) {
+      uint percent = reply.value("progress").toInt();
+      if (progress)
+        updateProgress(percent);
+      else
+        showProgress(percent);
+      progress = true;
+    } else if (reply.contains("log")) {
+      // Gets logged on destruction
+      LogMessage msg(LogMessage::Level(reply.value("level").toInt()), reply.value("file").toString(),
+                     reply.value("line").toInt(), reply.value("log").toString());
+    } else if (reply.contains("exit")) {
+      result = reply.value("exit").toInt();
+      return true;
+    }
+  }
+}
@@ -0,0 +1,12 @@
+#ifndef CLIENT_HH
+#define CLIENT_HH
+
+class QStringList;
+
+/** Runs the command given by the command line arguments (without the program name) within a
+ * running dmrconf daemon. Log messages and progress of the daemon are shown as if the command
+ * was run locally. Returns @c false if there is no daemon running, @c true otherwise. The exit
+ * code of the command is stored in @c result. */
+bool forwardCommand(const QStringList &arguments, int &result);
+
+#endif // CLIENT_HH
@@ -0,0 +1,161 @@
+#include "commands.hh"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <limits>
+
+#include "detect.hh"
+#include "verify.hh"
+#include "readcodeplug.hh"
+#include "writecodeplug.hh"
+#include "writecallsigndb.hh"
+#include "encodecodeplug.hh"
+#include "encodecallsigndb.hh"
+#include "decodecodeplug.hh"
+#include "infofile.hh"
+#include "fleet.hh"
+#include "archive.hh"
+#include "usbserial.hh"
+#include "logger.hh"
+
+
+void setupCommandLine(QCommandLineParser &parser) {
+  parser.setApplicationDescription(
+        QCoreApplication::translate(
+          "main", "Up- and download codeplugs for cheap Chineese DMR radios."));
+
+  parser.addHelpOption();
+  parser.addVersionOption();
+  parser.addOption({
+                     {"V","verbose"},
+                     QCoreApplication::translate("main", "Verbose output.")
+                   });
+  parser.addOption({
+                     {"c", "csv"},
+                     QCoreApplication::translate("main", "Up- and download codeplugs in CSV format.")
+                   });
+  parser.addOption({
+                     {"b", "bin"},
+                     QCoreApplication::translate("main", "Up- and download codeplugs in binary format.")
+                   });
+  parser.addOption({
+                     {"R", "radio"},
+                     QCoreApplication::translate("main", "Specifies the radio. This option can also "
+                     "be used to override the auto-detection of radios. Be careful using this "
+                     "option when writing to the device. A incompatible code-plug might be written."),
+                     QCoreApplication::translate("main", "RADIO")
+                   });
+  parser.addOption({
+                     {"i", "id"},
+                     QCoreApplication::translate("main", "Specifes the DMR id."),
+                     QCoreApplication::translate("main", "ID")
+                   });
+  parser.addOption(QCommandLineOption(
+                     "init-codeplug",
+                     QCoreApplication::translate(
+                       "main", "Initializes the code-plug in the radio. If not present (default) "
+                               "the code-plug gets updated, maintining all settings made earlier.")));
+  parser.addOption(QCommandLineOption(
+                     "init-db",
+                     QCoreApplication::translate(
+                       "main", "Writes the complete call-sign DB to the radio. If not present "
+                               "(default) only those entries are written, that changed since the "
+                               "last write.")));
+  parser.addOption(QCommandLineOption(
+                     "timeout",
+                     QCoreApplication::translate(
+                       "main", "Cancels the transfer to or from the radio, if it makes no "
+                               "progress for the given number of seconds."),
+                     QCoreApplication::translate("main", "SECONDS")));
+  parser.addOption(QCommandLineOption(
+                     "auto-enable-gps",
+                     QCoreApplication::translate("main", "Automatically enables GPS if there is a "
+                                                         "GPS/APRS system used by any channel.")));
+  parser.addOption(QCommandLineOption(
+                     "auto-enable-roaming",
+                     QCoreApplication::translate("main", "Automatically enables roaming if there is a "
+                                                         "roaming zone used by any channel.")));
+  parser.addOption(QCommandLineOption(
+                     "serial",
+                     QCoreApplication::translate(
+                       "main", "Selects the I/O backend for radios connected as serial devices. "
+                               "Either 'qt' (default) or 'native', the latter uses termios "
+                               "directly and is only available on POSIX systems."),
+                     QCoreApplication::translate("main", "BACKEND")));
+  parser.addOption(QCommandLineOption(
+                     "no-daemon",
+                     QCoreApplication::translate("main", "Runs the command within this process, even "
+                                                         "if a dmrconf daemon is running.")));
+
+  parser.addPositionalArgument(
+        "command", QCoreApplication::translate(
+          "main", "Specifies the command to perform. Either detect, verify, read, write, "
+          "write-db, encode, encode-db, decode, fleet, info, archive or serve. Consult the "
+          "man-page of dmrconf for a detailed descriptoin of these commands."),
+        QCoreApplication::translate("main", "[command]"));
+
+  parser.addPositionalArgument(
+        "file", QCoreApplication::translate(
+          "main", "The code-plug file. Either binary (extension .dfu), text/csv (extension .conf "
+          "or .csv) or a binary config snapshot (extension .dmrb). The format can be forced using the --csc or --binary options."),
+        QCoreApplication::translate("main", "[filename]"));
+}
+
+bool timeoutOption(QCommandLineParser &parser, int &ms) {
+  if (! parser.isSet("timeout"))
+    return true;
+  bool ok;
+  uint seconds = parser.value("timeout").toUInt(&ok);
+  if ((! ok) || (0 == seconds) || (seconds > uint(std::numeric_limits<int>::max()/1000))) {
+    logError() << "Please specify a valid number of seconds for --timeout option.";
+    return false;
+  }
+  ms = 1000*seconds;
+  return true;
+}
+
+bool isServedCommand(const QString &command) {
+  return ("detect" == command) || ("verify" == command) || ("read" == command)
+      || ("write" == command) || ("write-db" == command) || ("encode" == command)
+      || ("decode" == command) || ("fleet" == command);
+}
+
+int runCommand(QCommandLineParser &parser, QCoreApplication &app) {
+  QString backend = parser.isSet("serial") ? parser.value("serial").toLower() : "qt";
+  if ("native" == backend) {
+    USBSerial::setDefaultBackend(USBSerial::NativeBackend);
+  } else if ("qt" == backend) {
+    USBSerial::setDefaultBackend(USBSerial::QtBackend);
+  } else {
+    logError() << "Unknown serial backend '" << parser.value("serial")
+               << "'. Expected 'qt' or 'native'.";
+    return -1;
+  }
+
+  QString command = parser.positionalArguments().at(0);
+  if ("detect" == command)
+    return detect(parser, app);
+  if ("verify" == command)
+    return verify(parser, app);
+  if ("read" == command)
+    return readCodeplug(parser, app);
+  if ("write" == command)
+    return writeCodeplug(parser, app);
+  if ("write-db" == command)
+    return writeCallsignDB(parser, app);
+  if ("encode" == command)
+    return encodeCodeplug(parser, app);
+  if ("encode-db" == command)
+    return encodeCallsignDB(parser, app);
+  if ("decode" == command)
+    return decodeCodeplug(parser, app);
+  if ("info" == command)
+    return infoFile(parser, app);
+  if ("archive" == command)
+    return archive(parser, app);
+  if ("fleet" == command)
+    return encodeFleet(parser, app);
+
+  parser.showHelp(-1);
+  return -1;
+}
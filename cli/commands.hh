@@ -0,0 +1,19 @@
+#ifndef COMMANDS_HH
+#define COMMANDS_HH
+
+class QString;
+class QCommandLineParser;
+class QCoreApplication;
+
+/** Adds all options and positional arguments of dmrconf to the given parser. */
+void setupCommandLine(QCommandLineParser &parser);
+/** Reads the stall timeout in ms from the @c timeout option into @c ms, if set. Returns @c false
+ * and logs an error if the value is not a positive number of seconds. */
+bool timeoutOption(QCommandLineParser &parser, int &ms);
+/** Returns @c true if the given command can be run by the daemon. */
+bool isServedCommand(const QString &command);
+/** Runs the command given by the first positional argument. Shows the help on unknown
+ * commands. */
+int runCommand(QCommandLineParser &parser, QCoreApplication &app);
+
+#endif // COMMANDS_HH
@@ -5,6 +5,7 @@
 #include "logger.hh"
 #include "radio.hh"
 #include "radiointerface.hh"
+#include "session.hh"
 
 
 int detect(QCommandLineParser &parser, QCoreApplication &app) {
@@ -12,14 +13,13 @@ int detect(QCommandLineParser &parser, QCoreApplication &app) {
   Q_UNUSED(app);
 
   QString errorMessage;
-  Radio *radio = Radio::detect(errorMessage);
+  Radio *radio = Session::get().redetect(errorMessage);
   if (nullptr == radio) {
     logError() << "No compatible radio found: " << errorMessage;
     return -1;
   }
 
   logInfo() << "Found: '" << radio->name() << "'.";
-  delete  radio;
 
   return 0;
 }
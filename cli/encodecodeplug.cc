@@ -3,15 +3,18 @@
 #include <QCoreApplication>
 #include <QCommandLineParser>
 #include <QFile>
+#include <QScopedPointer>
 
 #include "logger.hh"
 #include "config.hh"
-#include "uv390_codeplug.hh"
-#include "rd5r_codeplug.hh"
-#include "gd77_codeplug.hh"
-#include "opengd77_codeplug.hh"
-#include "d878uv_codeplug.hh"
+#include "configsnapshot.hh"
+#include "uv390.hh"
+#include "rd5r.hh"
+#include "gd77.hh"
+#include "opengd77.hh"
+#include "d878uv.hh"
 #include "crc32.hh"
+#include "session.hh"
 
 
 int encodeCodeplug(QCommandLineParser &parser, QCoreApplication &app) {
@@ -39,90 +42,84 @@ int encodeCodeplug(QCommandLineParser &parser, QCoreApplication &app) {
   if (parser.isSet("auto-enable-roaming"))
     flags.autoEnableRoaming = true;
 
-  if (("uv390"==parser.value("radio").toLower()) || ("rt3s"==parser.value("radio").toLower())) {
-    Config config;
-    QString errorMessage;
-    QTextStream stream(&infile);
-    if (! config.readCSV(stream, errorMessage)) {
-      logError() << "Cannot parse CSV codeplug '" << infile.fileName() << "': " << errorMessage;
+  // Reuse the codeplug encoded before from the same input, radio and flags
+  QString outname = parser.positionalArguments().at(2);
+  QString key = Session::imageKey(infile.fileName(), parser.value("radio"),
+                                  QString("%1%2%3").arg(flags.updateCodePlug)
+                                  .arg(flags.autoEnableGPS).arg(flags.autoEnableRoaming));
+  QByteArray image;
+  if (Session::get().cachedImage(key, image)) {
+    logDebug() << "Use cached codeplug encoded from '" << infile.fileName() << "'.";
+    QFile outfile(outname);
+    if ((! outfile.open(QIODevice::WriteOnly)) || (image.size() != outfile.write(image))) {
+      logError() << "Cannot write output codeplug file '" << outname << "': "
+                 << outfile.errorString();
       return -1;
     }
+    return 0;
+  }
 
-    UV390Codeplug codeplug;
-    codeplug.encode(&config, flags);
-    if (! codeplug.write(parser.positionalArguments().at(2))) {
-      logError() << "Cannot write output codeplug file '" << parser.positionalArguments().at(1)
-                 << "': " << codeplug.errorMessage();
-      return -1;
-    }
-  } else if ("rd5r"==parser.value("radio").toLower()) {
-    Config config;
-    QString errorMessage;
-    QTextStream stream(&infile);
-    if (! config.readCSV(stream, errorMessage)) {
-      logError() << "Cannot parse CSV codeplug '" << infile.fileName() << "': " << errorMessage;
-      return -1;
-    }
-    RD5RCodeplug codeplug;
-    codeplug.encode(&config, flags);
-    if (! codeplug.write(parser.positionalArguments().at(2))) {
-      logError() << "Cannot write output codeplug file '" << parser.positionalArguments().at(1)
-                 << "': " << codeplug.errorMessage();
-      return -1;
-    }
-  } else if ("gd77"==parser.value("radio").toLower()) {
-    Config config;
-    QString errorMessage;
-    QTextStream stream(&infile);
-    if (! config.readCSV(stream, errorMessage)) {
-      logError() << "Cannot parse CSV codeplug '" << infile.fileName() << "': " << errorMessage;
-      return -1;
-    }
-    GD77Codeplug codeplug;
-    codeplug.encode(&config, flags);
-    if (! codeplug.write(parser.positionalArguments().at(2))) {
-      logError() << "Cannot write output codeplug file '" << parser.positionalArguments().at(1)
-                 << "': " << codeplug.errorMessage();
-      return -1;
-    }
-  } else if ("opengd77"==parser.value("radio").toLower()) {
-    Config config;
-    QString errorMessage;
-    QTextStream stream(&infile);
-    if (! config.readCSV(stream, errorMessage)) {
-      logError() << "Cannot parse CSV codeplug '" << infile.fileName() << "': " << errorMessage;
-      return -1;
-    }
-    OpenGD77Codeplug codeplug;
-    codeplug.encode(&config, flags);
-    if (! codeplug.write(parser.positionalArguments().at(2))) {
-      logError() << "Cannot write output codeplug file '" << parser.positionalArguments().at(1)
-                 << "': " << codeplug.errorMessage();
-      return -1;
-    }
-  } else if ("d878uv"==parser.value("radio").toLower()) {
-    Config config;
-    QString errorMessage;
-    QTextStream stream(&infile);
-    if (! config.readCSV(stream, errorMessage)) {
+  QString errorMessage;
+  Config *config = Session::get().config(infile.fileName(), errorMessage);
+  if (nullptr == config) {
+    if (ConfigSnapshot::isSnapshotFile(infile.fileName()))
+      logError() << "Cannot read snapshot '" << infile.fileName() << "': " << errorMessage;
+    else
       logError() << "Cannot parse CSV codeplug '" << infile.fileName() << "': " << errorMessage;
-      return -1;
-    }
-    D878UVCodeplug codeplug;
-    codeplug.setBitmaps(&config);
-    codeplug.allocateUntouched();
-    codeplug.allocateForEncoding();
-    codeplug.encode(&config, flags);
-    codeplug.image(0).sort();
-    if (! codeplug.write(parser.positionalArguments().at(2))) {
-      logError() << "Cannot write output codeplug file '" << parser.positionalArguments().at(1)
-                 << "': " << codeplug.errorMessage();
-      return -1;
-    }
-  } else {
+    return -1;
+  }
+
+  QScopedPointer<Radio> radio(createRadio(parser.value("radio").toLower()));
+  if (radio.isNull()) {
     logError() << "Cannot encode codeplug: Unknown radio '" << parser.value("radio") << "'.";
     return -1;
   }
+  if (! encodeForRadio(radio.data(), config, flags))
+    return -1;
+  if (! radio->codeplug().write(outname)) {
+    logError() << "Cannot write output codeplug file '" << outname << "': "
+               << radio->codeplug().errorMessage();
+    return -1;
+  }
+
+  QFile outfile(outname);
+  if (outfile.open(QIODevice::ReadOnly))
+    Session::get().cacheImage(key, outfile.readAll());
 
   return 0;
 }
+
+Radio *
+createRadio(const QString &name) {
+  if (("uv390"==name) || ("rt3s"==name))
+    return new UV390();
+  else if ("rd5r"==name)
+    return new RD5R();
+  else if ("gd77"==name)
+    return new GD77();
+  else if ("opengd77"==name)
+    return new OpenGD77();
+  else if ("d878uv"==name)
+    return new D878UV();
+  return nullptr;
+}
+
+bool
+encodeForRadio(Radio *radio, Config *config, const CodePlug::Flags &flags) {
+  CodePlug &codeplug = radio->codeplug();
+  // The D878UV codeplug only holds the memory allocated explicitly
+  if (D878UVCodeplug *d878uv = qobject_cast<D878UVCodeplug *>(&codeplug)) {
+    d878uv->setBitmaps(config);
+    if ((! d878uv->allocateUntouched()) || (! d878uv->allocateForEncoding())) {
+      logError() << "Cannot encode codeplug for " << radio->name() << ": "
+                 << codeplug.errorMessage();
+      return false;
+    }
+  }
+  if (! codeplug.encode(config, flags)) {
+    logError() << "Cannot encode codeplug for " << radio->name() << ": "
+               << codeplug.errorMessage();
+    return false;
+  }
+  return true;
+}
@@ -1,9 +1,18 @@
 #ifndef ENCODECODEPLUG_HH
 #define ENCODECODEPLUG_HH
 
+#include "codeplug.hh"
+
 class QCoreApplication;
 class QCommandLineParser;
+class Radio;
 
 int encodeCodeplug(QCommandLineParser &parser, QCoreApplication &app);
 
+/** Creates the radio with the given name (e.g., "uv390") without connecting to a device. Returns
+ * @c nullptr if the radio is unknown. */
+Radio *createRadio(const QString &name);
+/** Encodes the given configuration as the codeplug of the given radio. */
+bool encodeForRadio(Radio *radio, Config *config, const CodePlug::Flags &flags);
+
 #endif // ENCODECODEPLUG_HH
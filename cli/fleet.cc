@@ -0,0 +1,166 @@
+#include "fleet.hh"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QDir>
+#include <QTextStream>
+#include <QScopedPointer>
+#include <QSet>
+
+#include "logger.hh"
+#include "config.hh"
+#include "configsnapshot.hh"
+#include "radio.hh"
+#include "encodecodeplug.hh"
+#include "session.hh"
+
+
+/** Returns the given CSV field without surrounding white spaces and quotes. */
+static QString
+field(const QStringList &fields, int idx) {
+  QString value = fields.value(idx).trimmed();
+  if ((2 <= value.size()) && value.startsWith('"') && value.endsWith('"'))
+    value = value.mid(1, value.size()-2);
+  return value;
+}
+
+/** Reads the fleet file. Each line holds the DMR ID, the name and optionally the intro lines of
+ * a radio, separated by commas. Missing intro lines are taken from the template. Empty lines,
+ * comments (starting with #) and a header line are skipped. Invalid and duplicate IDs are
+ * rejected, as well as empty names and names or intro lines exceeding the limits of the radio. */
+static bool
+readFleet(const QString &filename, const CodePlug::Identity &defaults,
+          const Radio::Features &features, QList<CodePlug::Identity> &fleet,
+          QString &errorMessage)
+{
+  QFile file(filename);
+  if (! file.open(QIODevice::ReadOnly)) {
+    errorMessage = file.errorString();
+    return false;
+  }
+
+  QSet<uint32_t> ids;
+  QTextStream stream(&file);
+  for (int line=1; ! stream.atEnd(); line++) {
+    QString text = stream.readLine().trimmed();
+    if (text.isEmpty() || text.startsWith('#'))
+      continue;
+
+    QStringList fields = text.split(',');
+    bool ok;
+    CodePlug::Identity identity = defaults;
+    identity.id = field(fields, 0).toUInt(&ok);
+    if ((! ok) && fleet.isEmpty() && (1 == line))
+      continue;
+    // DMR IDs are 24 bit
+    if ((! ok) || (0 == identity.id) || (16777215 < identity.id)) {
+      errorMessage = QString("Invalid DMR ID '%1' in line %2.").arg(field(fields, 0)).arg(line);
+      return false;
+    }
+    if (ids.contains(identity.id)) {
+      errorMessage = QString("Duplicate DMR ID %1 in line %2.").arg(identity.id).arg(line);
+      return false;
+    }
+    identity.name = field(fields, 1);
+    if (identity.name.isEmpty()) {
+      errorMessage = QString("Empty radio name in line %1.").arg(line);
+      return false;
+    }
+    if (2 < fields.size())
+      identity.introLine1 = field(fields, 2);
+    if (3 < fields.size())
+      identity.introLine2 = field(fields, 3);
+    // The codeplug would truncate these silently
+    if (identity.name.size() > features.maxNameLength) {
+      errorMessage = QString("Name '%1' in line %2 exceeds limit of %3 characters.")
+          .arg(identity.name).arg(line).arg(features.maxNameLength);
+      return false;
+    }
+    if (((2 < fields.size()) && (identity.introLine1.size() > features.maxIntroLineLength))
+        || ((3 < fields.size()) && (identity.introLine2.size() > features.maxIntroLineLength))) {
+      errorMessage = QString("Intro line in line %1 exceeds limit of %2 characters.")
+          .arg(line).arg(features.maxIntroLineLength);
+      return false;
+    }
+    ids.insert(identity.id);
+    fleet.append(identity);
+  }
+
+  return true;
+}
+
+int encodeFleet(QCommandLineParser &parser, QCoreApplication &app) {
+  Q_UNUSED(app);
+
+  if (3 > parser.positionalArguments().size())
+    parser.showHelp(-1);
+
+  if (! parser.isSet("radio")) {
+    logError() << "You have to specify the radio using the --radio option.";
+    parser.showHelp(-1);
+  }
+
+  CodePlug::Flags flags;
+  if (parser.isSet("init-codeplug"))
+    flags.updateCodePlug = false;
+  if (parser.isSet("auto-enable-gps"))
+    flags.autoEnableGPS = true;
+  if (parser.isSet("auto-enable-roaming"))
+    flags.autoEnableRoaming = true;
+
+  QString filename = parser.positionalArguments().at(1);
+  QString errorMessage;
+  Config *config = Session::get().config(filename, errorMessage);
+  if (nullptr == config) {
+    logError() << "Cannot read template codeplug '" << filename << "': " << errorMessage;
+    return -1;
+  }
+
+  QScopedPointer<Radio> radio(createRadio(parser.value("radio").toLower()));
+  if (radio.isNull()) {
+    logError() << "Cannot encode codeplug: Unknown radio '" << parser.value("radio") << "'.";
+    return -1;
+  }
+
+  QList<CodePlug::Identity> fleet;
+  CodePlug::Identity defaults(config);
+  if (! readFleet(parser.positionalArguments().at(2), defaults, radio->features(), fleet,
+                  errorMessage)) {
+    logError() << "Cannot read fleet '" << parser.positionalArguments().at(2) << "': "
+               << errorMessage;
+    return -1;
+  }
+
+  QDir directory(QDir::current());
+  if (3 < parser.positionalArguments().size())
+    directory.setPath(parser.positionalArguments().at(3));
+  if ((! directory.exists()) && (! directory.mkpath("."))) {
+    logError() << "Cannot create output directory '" << directory.path() << "'.";
+    return -1;
+  }
+
+  // Encode the template once, then patch the identity of each radio
+  logDebug() << "Encode template '" << filename << "' for " << fleet.size() << " radios.";
+  if (! encodeForRadio(radio.data(), config, flags))
+    return -1;
+  CodePlug *codeplug = &radio->codeplug();
+
+  foreach (const CodePlug::Identity &identity, fleet) {
+    QString outname = directory.filePath(QString("%1.dfu").arg(identity.id));
+    if (! codeplug->patchIdentity(identity)) {
+      logError() << "Cannot encode codeplug for " << identity.id << ": "
+                 << codeplug->errorMessage();
+      return -1;
+    }
+    if (! codeplug->write(outname)) {
+      logError() << "Cannot write output codeplug file '" << outname << "': "
+                 << codeplug->errorMessage();
+      return -1;
+    }
+    logInfo() << "Written codeplug of '" << identity.name << "' (" << identity.id << ") to '"
+              << outname << "'.";
+  }
+
+  return 0;
+}
@@ -0,0 +1,9 @@
+#ifndef FLEET_HH
+#define FLEET_HH
+
+class QCoreApplication;
+class QCommandLineParser;
+
+int encodeFleet(QCommandLineParser &parser, QCoreApplication &app);
+
+#endif // FLEET_HH
@@ -1,6 +1,15 @@
 #include "progressbar.hh"
 
+static std::function<void(uint)> _progressHandler;
+/** The progress shown last. */
+static uint _lastPercent = 0;
+
 void showProgress(uint percent) {
+  _lastPercent = percent;
+  if (_progressHandler) {
+    _progressHandler(percent);
+    return;
+  }
   std::cerr << "[";
   for (uint i=0; i<50; i++) {
     if (percent/2 > i)
@@ -12,6 +21,18 @@ void showProgress(uint percent) {
 }
 
 void updateProgress(uint percent) {
+  // Redraw only if the progress changed
+  if (percent == _lastPercent)
+    return;
+  _lastPercent = percent;
+  if (_progressHandler) {
+    _progressHandler(percent);
+    return;
+  }
   std::cerr << "\033[1A\033[K";
   showProgress(percent);
 }
+
+void setProgressHandler(const std::function<void(uint)> &handler) {
+  _progressHandler = handler;
+}
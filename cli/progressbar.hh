@@ -3,8 +3,13 @@
 
 #include <iostream>
 #include <cinttypes>
+#include <functional>
 
 void showProgress(uint percent=0);
 void updateProgress(uint percent);
 
+/** Redirects the progress to the given handler instead of drawing the progress bar, e.g., to
+ * stream it to a client of the daemon. An empty handler restores the progress bar. */
+void setProgressHandler(const std::function<void(uint)> &handler);
+
 #endif // PROGRESSBAR_HH
@@ -3,15 +3,20 @@
 #include <QCoreApplication>
 #include <QCommandLineParser>
 #include <QFile>
+#include <QScopedPointer>
 
 #include <QApplication>
 
 #include "logger.hh"
 #include "radio.hh"
+#include "radiojob.hh"
 #include "printprogress.hh"
 #include "config.hh"
+#include "configsnapshot.hh"
 #include "codeplug.hh"
 #include "progressbar.hh"
+#include "session.hh"
+#include "commands.hh"
 
 
 int readCodeplug(QCommandLineParser &parser, QCoreApplication &app)
@@ -21,6 +26,10 @@ int readCodeplug(QCommandLineParser &parser, QCoreApplication &app)
   if (2 > parser.positionalArguments().size())
     parser.showHelp(-1);
 
+  int timeout = 0;
+  if (! timeoutOption(parser, timeout))
+    return -1;
+
   QString forceRadio="";
   if (parser.isSet("radio")) {
     logWarn() << "You force the radio type to be '" << parser.value("radio").toUpper()
@@ -29,7 +38,7 @@ int readCodeplug(QCommandLineParser &parser, QCoreApplication &app)
   }
 
   QString errorMessage;
-  Radio *radio = Radio::detect(errorMessage, forceRadio);
+  Radio *radio = Session::get().radio(errorMessage, forceRadio);
   if (nullptr == radio) {
     logError() << "Cannot detect radio: " << errorMessage;
     return -1;
@@ -38,22 +47,20 @@ int readCodeplug(QCommandLineParser &parser, QCoreApplication &app)
   QString filename = parser.positionalArguments().at(1);
 
   if (!parser.isSet("csv") && !filename.endsWith(".conf") && !filename.endsWith(".csv") &&
+      !ConfigSnapshot::isSnapshotFile(filename) &&
       !parser.isSet("cpl") && !filename.endsWith(".bin") && !filename.endsWith(".dfu")) {
     logError() << "Cannot determine output filetype, consider using --csv or --bin options.";
     return -1;
   }
 
-  showProgress();
-  QObject::connect(radio, &Radio::downloadProgress, updateProgress);
-
   Config config;
-  if (! radio->startDownload(true)) {
-    logError() << "Codeplug download error: " << radio->errorMessage();
-    return -1;
-  }
-
-  if (Radio::StatusError == radio->status()) {
-    logError() << "Codeplug download error: " << radio->errorMessage();
+  QScopedPointer<RadioJob> job(RadioJob::download(radio));
+  showProgress();
+  QObject::connect(job.data(), &RadioJob::progressChanged, updateProgress);
+  job->setTimeout(timeout);
+  job->start();
+  if (! job->wait()) {
+    logError() << "Codeplug download error: " << job->errorMessage();
     return -1;
   }
 
@@ -75,6 +82,21 @@ int readCodeplug(QCommandLineParser &parser, QCoreApplication &app)
     return 0;
   }
 
+  // If output is a snapshot -> decode code-plug
+  if (ConfigSnapshot::isSnapshotFile(filename)) {
+    if (! radio->codeplug().decode(&config)) {
+      logError() << "Cannot decode codeplug: " << radio->errorMessage();
+      return -1;
+    }
+
+    if (! config.writeSnapshot(filename, errorMessage)) {
+      logError() << "Cannot write snapshot '" << filename << "': " << errorMessage;
+      return -1;
+    }
+
+    return 0;
+  }
+
   // otherwise write binary code-plug
   radio->codeplug().write(filename);
 
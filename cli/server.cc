@@ -0,0 +1,239 @@
+#include "server.hh"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QLocalSocket>
+#include <QStandardPaths>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QDir>
+
+#include "logger.hh"
+#include "commands.hh"
+#include "session.hh"
+#include "progressbar.hh"
+
+/** Timeout in ms to check for a running daemon. */
+#define CONNECT_TIMEOUT 100
+
+
+/** Sends the given reply to the client. */
+static void
+send(QLocalSocket *client, const QJsonObject &reply) {
+  if (nullptr == client)
+    return;
+  client->write(QJsonDocument(reply).toJson(QJsonDocument::Compact));
+  client->write("\n");
+  client->flush();
+}
+
+/** Returns the minimum number of positional arguments of the given command. */
+static int
+minArguments(const QString &command) {
+  if (("encode" == command) || ("fleet" == command))
+    return 3;
+  if (("detect" == command) || ("write-db" == command))
+    return 1;
+  return 2;
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of ClientLogHandler
+ * ********************************************************************************************* */
+ClientLogHandler::ClientLogHandler(QLocalSocket *client, LogMessage::Level minLevel,
+                                   QObject *parent)
+  : LogHandler(parent), _client(client), _minLevel(minLevel)
+{
+  // pass...
+}
+
+void
+ClientLogHandler::handle(const LogMessage &message) {
+  if (message.level() < _minLevel)
+    return;
+  QJsonObject reply;
+  reply.insert("log", message.message());
+  reply.insert("level", int(message.level()));
+  reply.insert("file", message.file());
+  reply.insert("line", message.line());
+  this->reply(reply);
+}
+
+void
+ClientLogHandler::reply(const QJsonObject &reply) {
+  // Queued even within the thread of the handler, to keep the order of the replies
+  QByteArray line = QJsonDocument(reply).toJson(QJsonDocument::Compact);
+  QMetaObject::invokeMethod(this, "onReply", Qt::QueuedConnection, Q_ARG(QByteArray, line));
+}
+
+void
+ClientLogHandler::flush() {
+  QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+}
+
+void
+ClientLogHandler::onReply(const QByteArray &line) {
+  if (_client.isNull())
+    return;
+  _client->write(line);
+  _client->write("\n");
+  _client->flush();
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of Server
+ * ********************************************************************************************* */
+Server::Server(QCoreApplication &app, QObject *parent)
+  : QObject(parent), _app(app), _server(), _queue(), _busy(false)
+{
+  _server.setSocketOptions(QLocalServer::UserAccessOption);
+  connect(&_server, SIGNAL(newConnection()), this, SLOT(onNewConnection()));
+}
+
+Server::~Server() {
+  _server.close();
+}
+
+QString
+Server::socketPath() {
+  QString path = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+  if (path.isEmpty())
+    return "dmrconf";
+  return path + "/dmrconf.socket";
+}
+
+bool
+Server::listen(QString &errorMessage) {
+  // Check if there is a daemon running already
+  QLocalSocket socket;
+  socket.connectToServer(socketPath());
+  if (socket.waitForConnected(CONNECT_TIMEOUT)) {
+    errorMessage = tr("There is already a daemon listening at '%1'.").arg(socketPath());
+    return false;
+  }
+
+  // Remove stale socket of a daemon that was killed
+  QLocalServer::removeServer(socketPath());
+  if (! _server.listen(socketPath())) {
+    errorMessage = tr("Cannot listen at '%1': %2").arg(socketPath(), _server.errorString());
+    return false;
+  }
+
+  return true;
+}
+
+void
+Server::onNewConnection() {
+  while (QLocalSocket *client = _server.nextPendingConnection()) {
+    connect(client, SIGNAL(readyRead()), this, SLOT(onReadyRead()));
+    connect(client, SIGNAL(disconnected()), client, SLOT(deleteLater()));
+  }
+}
+
+void
+Server::onReadyRead() {
+  QLocalSocket *client = qobject_cast<QLocalSocket *>(sender());
+  if ((nullptr == client) || (! client->canReadLine()))
+    return;
+
+  // Only a single request per connection
+  disconnect(client, SIGNAL(readyRead()), this, SLOT(onReadyRead()));
+  QJsonParseError err;
+  QJsonDocument doc = QJsonDocument::fromJson(client->readLine(), &err);
+  if (QJsonParseError::NoError != err.error) {
+    logWarn() << "Invalid request: " << err.errorString();
+    send(client, {{"log", tr("Invalid request: %1").arg(err.errorString())},
+                  {"level", int(LogMessage::ERROR)}});
+    send(client, {{"exit", -1}});
+    client->disconnectFromServer();
+    return;
+  }
+
+  _queue.append(qMakePair(QPointer<QLocalSocket>(client), doc.object()));
+  // Requests arriving while a command waits for the radio get processed once it is done
+  if (! _busy)
+    processQueue();
+}
+
+void
+Server::processQueue() {
+  _busy = true;
+  while (! _queue.isEmpty()) {
+    QPair<QPointer<QLocalSocket>, QJsonObject> request = _queue.takeFirst();
+    if (request.first.isNull())
+      continue;
+    int result = process(request.first, request.second);
+    if (request.first.isNull())
+      continue;
+    send(request.first, {{"exit", result}});
+    request.first->disconnectFromServer();
+  }
+  _busy = false;
+}
+
+int
+Server::process(QLocalSocket *client, const QJsonObject &request) {
+  QStringList arguments("dmrconf");
+  foreach (const QJsonValue &arg, request.value("args").toArray())
+    arguments.append(arg.toString());
+
+  QCommandLineParser parser;
+  setupCommandLine(parser);
+  if (! parser.parse(arguments)) {
+    send(client, {{"log", parser.errorText()}, {"level", int(LogMessage::ERROR)}});
+    return -1;
+  }
+
+  QString command = parser.positionalArguments().value(0);
+  if ((! isServedCommand(command)) || (minArguments(command) > parser.positionalArguments().size())
+      || ((("encode" == command) || ("fleet" == command)) && (! parser.isSet("radio")))) {
+    send(client, {{"log", tr("Invalid arguments for command '%1'.").arg(command)},
+                  {"level", int(LogMessage::ERROR)}});
+    return -1;
+  }
+
+  logDebug() << "Run '" << arguments.join(' ') << "'.";
+
+  // Forward log messages and progress to the client
+  ClientLogHandler *handler = new ClientLogHandler(
+        client, parser.isSet("verbose") ? LogMessage::DEBUG : LogMessage::WARNING);
+  Logger::get().addHandler(handler);
+  setProgressHandler([handler](uint percent) {
+    handler->reply({{"progress", int(percent)}});
+  });
+
+  // Relative paths refer to the working directory of the client
+  QString cwd = QDir::currentPath();
+  QDir::setCurrent(request.value("cwd").toString(cwd));
+  int result = runCommand(parser, _app);
+  QDir::setCurrent(cwd);
+
+  setProgressHandler(std::function<void(uint)>());
+  Logger::get().remHandler(handler);
+  // Write pending replies before the exit code
+  handler->flush();
+  delete handler;
+
+  // The radio may have been disconnected or replaced, detect it again next time
+  if ((0 != result) && (("read" == command) || ("write" == command) || ("write-db" == command)))
+    Session::get().releaseRadio();
+
+  return result;
+}
+
+
+int serve(QCommandLineParser &parser, QCoreApplication &app) {
+  Q_UNUSED(parser);
+
+  Server server(app);
+  QString errorMessage;
+  if (! server.listen(errorMessage)) {
+    logError() << "Cannot start daemon: " << errorMessage;
+    return -1;
+  }
+
+  logInfo() << "Listening at '" << Server::socketPath() << "'.";
+  return app.exec();
+}
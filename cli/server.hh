@@ -0,0 +1,102 @@
+#ifndef SERVER_HH
+#define SERVER_HH
+
+#include <QObject>
+#include <QLocalServer>
+#include <QJsonObject>
+#include <QPointer>
+#include <QList>
+#include <QPair>
+#include "logger.hh"
+
+class QLocalSocket;
+class QCommandLineParser;
+class QCoreApplication;
+
+/** Forwards log messages and progress to the client of the current request.
+ *
+ * Log messages are also emitted within the radio threads, while the client socket must only be
+ * accessed within the thread it lives in. Hence, all replies get queued and are written to the
+ * socket within the thread of the handler. Call @c flush to write the queued replies. */
+class ClientLogHandler: public LogHandler
+{
+  Q_OBJECT
+
+public:
+  /** Constructor. */
+  ClientLogHandler(QLocalSocket *client, LogMessage::Level minLevel, QObject *parent=nullptr);
+
+  void handle(const LogMessage &message);
+  /** Queues the given reply to the client. This method is thread-safe. */
+  void reply(const QJsonObject &reply);
+  /** Writes all queued replies. Must be called within the thread of the handler. */
+  void flush();
+
+protected slots:
+  /** Writes the given line to the client. */
+  void onReply(const QByteArray &line);
+
+protected:
+  /** The client, gets reset if the client disconnects. */
+  QPointer<QLocalSocket> _client;
+  /** The minimum log level. */
+  LogMessage::Level _minLevel;
+};
+
+
+/** Implements the dmrconf daemon.
+ *
+ * The daemon listens on a local (Unix domain) socket and runs the commands detect, verify, read,
+ * write, write-db, encode, decode and fleet on behalf of the dmrconf command line tool. Radio,
+ * call-sign DB, parsed configurations and encoded codeplugs are kept resident within the
+ * @c Session between the requests.
+ *
+ * The protocol is line based, each line holds a single JSON object. The client sends a single
+ * request of the form <tt>{"cwd": DIRECTORY, "args": [ARGUMENTS...]}</tt>, where the arguments
+ * are the command line arguments of dmrconf (without the program name). The daemon replies with
+ * any number of <tt>{"log": MESSAGE, "level": LEVEL, "file": FILE, "line": LINE}</tt> and
+ * <tt>{"progress": PERCENT}</tt> objects followed by <tt>{"exit": CODE}</tt>. Requests are
+ * processed one at a time in the order of their arrival. */
+class Server: public QObject
+{
+  Q_OBJECT
+
+public:
+  /** Constructs a daemon running the commands within the given application. */
+  explicit Server(QCoreApplication &app, QObject *parent=nullptr);
+  /** Destructor, closes the socket. */
+  virtual ~Server();
+
+  /** Returns the path of the socket of the daemon. */
+  static QString socketPath();
+
+  /** Starts listening. Fails if there is already a daemon running. */
+  bool listen(QString &errorMessage);
+
+protected slots:
+  /** Gets called on new connections. */
+  void onNewConnection();
+  /** Gets called once a client sent (a part of) its request. */
+  void onReadyRead();
+
+protected:
+  /** Processes the queued requests. */
+  void processQueue();
+  /** Processes the given request and returns the exit code. */
+  int process(QLocalSocket *client, const QJsonObject &request);
+
+protected:
+  /** The application. */
+  QCoreApplication &_app;
+  /** The local server. */
+  QLocalServer _server;
+  /** Queued requests. */
+  QList<QPair<QPointer<QLocalSocket>, QJsonObject>> _queue;
+  /** If @c true, a request is being processed. */
+  bool _busy;
+};
+
+/** Runs the daemon. */
+int serve(QCommandLineParser &parser, QCoreApplication &app);
+
+#endif // SERVER_HH
@@ -0,0 +1,140 @@
+#include "session.hh"
+
+#include <QFileInfo>
+#include <QEventLoop>
+
+#include "logger.hh"
+#include "radio.hh"
+#include "config.hh"
+#include "configsnapshot.hh"
+#include "userdatabase.hh"
+
+/** Maximum number of encoded codeplugs kept. */
+#define MAX_CACHED_IMAGES 16
+
+
+/* ********************************************************************************************* *
+ * Implementation of Session
+ * ********************************************************************************************* */
+Session *Session::_instance = nullptr;
+
+Session::Session()
+  : QObject(nullptr), _radio(nullptr), _userDB(nullptr), _configs(), _images()
+{
+  // pass...
+}
+
+Session::~Session() {
+  foreach (const CachedConfig &cached, _configs)
+    delete cached.config;
+  _configs.clear();
+}
+
+Session &
+Session::get() {
+  if (nullptr == _instance)
+    _instance = new Session();
+  return *_instance;
+}
+
+Radio *
+Session::radio(QString &errorMessage, const QString &force) {
+  // A forced radio type may differ from the detected one
+  if (_radio && force.isEmpty())
+    return _radio;
+  return redetect(errorMessage, force);
+}
+
+Radio *
+Session::redetect(QString &errorMessage, const QString &force) {
+  releaseRadio();
+  if (nullptr == (_radio = Radio::detect(errorMessage, force)))
+    return nullptr;
+  _radio->setParent(this);
+  return _radio;
+}
+
+void
+Session::releaseRadio() {
+  if (nullptr == _radio)
+    return;
+  _radio->deleteLater();
+  _radio = nullptr;
+}
+
+Config *
+Session::config(const QString &filename, QString &errorMessage) {
+  QFileInfo info(filename);
+  QString path = info.absoluteFilePath();
+  if (_configs.contains(path)) {
+    const CachedConfig &cached = _configs[path];
+    if ((cached.modified == info.lastModified()) && (cached.size == info.size())) {
+      logDebug() << "Use cached config of '" << path << "'.";
+      return cached.config;
+    }
+    delete cached.config;
+    _configs.remove(path);
+  }
+
+  Config *config = new Config();
+  if (ConfigSnapshot::isSnapshotFile(filename)) {
+    if (! config->readSnapshot(filename, errorMessage)) {
+      delete config;
+      return nullptr;
+    }
+  } else if (! config->readCSV(filename, errorMessage)) {
+    delete config;
+    return nullptr;
+  }
+
+  _configs.insert(path, {config, info.lastModified(), info.size()});
+  return config;
+}
+
+UserDatabase *
+Session::userDB(QString &errorMessage) {
+  if (nullptr == _userDB)
+    _userDB = new UserDatabase(30, this);
+
+  if (0 == _userDB->count()) {
+    logInfo() << "Downloading call-sign DB...";
+    // Wait for download to finish
+    QEventLoop loop;
+    QObject::connect(_userDB, SIGNAL(loaded()), &loop, SLOT(quit()));
+    QObject::connect(_userDB, SIGNAL(error(QString)), &loop, SLOT(quit()));
+    loop.exec();
+    // Check if call-sign DB has been loaded
+    if (0 == _userDB->count()) {
+      errorMessage = tr("Could not download/load call-sign DB.");
+      _userDB->deleteLater();
+      _userDB = nullptr;
+      return nullptr;
+    }
+  }
+
+  // A previous request may have sorted the users w.r.t. its DMR ID
+  _userDB->resetOrder();
+  return _userDB;
+}
+
+QString
+Session::imageKey(const QString &filename, const QString &radio, const QString &options) {
+  QFileInfo info(filename);
+  return QString("%1:%2:%3:%4:%5").arg(radio.toLower(), options, info.absoluteFilePath())
+      .arg(info.lastModified().toMSecsSinceEpoch()).arg(info.size());
+}
+
+bool
+Session::cachedImage(const QString &key, QByteArray &data) const {
+  if (! _images.contains(key))
+    return false;
+  data = _images.value(key);
+  return true;
+}
+
+void
+Session::cacheImage(const QString &key, const QByteArray &data) {
+  if (MAX_CACHED_IMAGES <= _images.size())
+    _images.clear();
+  _images.insert(key, data);
+}
@@ -0,0 +1,85 @@
+#ifndef SESSION_HH
+#define SESSION_HH
+
+#include <QObject>
+#include <QHash>
+#include <QDateTime>
+#include <QByteArray>
+
+class Radio;
+class Config;
+class UserDatabase;
+
+/** Holds the resources used by the dmrconf commands.
+ *
+ * A single command obtains the radio, the parsed configuration and the call-sign DB from the
+ * session. Within the daemon (see @c Server), the session is kept resident between requests.
+ * That is, the radio stays detected, the call-sign DB stays loaded and parsed configurations and
+ * encoded codeplugs are cached until their source files change. */
+class Session: public QObject
+{
+  Q_OBJECT
+
+protected:
+  /** Hidden constructor, use @c get. */
+  Session();
+
+public:
+  /** Destructor. */
+  virtual ~Session();
+
+  /** Returns the singleton instance. */
+  static Session &get();
+
+  /** Returns the radio, detects it if there is no radio yet or if the radio type is forced to
+   * another one. The radio is owned by the session. Returns @c nullptr on error. */
+  Radio *radio(QString &errorMessage, const QString &force="");
+  /** Detects the radio again, e.g., for the detect command. */
+  Radio *redetect(QString &errorMessage, const QString &force="");
+  /** Releases the radio, e.g., after a failed transfer. The next call to @c radio will detect
+   * the radio again. */
+  void releaseRadio();
+
+  /** Returns the configuration read from the given CSV or snapshot file. The configuration is
+   * owned by the session and is kept until the file changes. Returns @c nullptr on error. */
+  Config *config(const QString &filename, QString &errorMessage);
+
+  /** Returns the call-sign DB, waits until the DB is loaded. Returns @c nullptr on error. */
+  UserDatabase *userDB(QString &errorMessage);
+
+  /** Returns a key for an encoded codeplug. The key identifies the given input file (including
+   * its modification time) together with the given radio and encoding options. */
+  static QString imageKey(const QString &filename, const QString &radio, const QString &options);
+  /** Looks up the encoded codeplug with the given key. */
+  bool cachedImage(const QString &key, QByteArray &data) const;
+  /** Caches the encoded codeplug with the given key. */
+  void cacheImage(const QString &key, const QByteArray &data);
+
+protected:
+  /** A cached configuration. */
+  class CachedConfig {
+  public:
+    /** The configuration. */
+    Config *config;
+    /** The modification time of the file. */
+    QDateTime modified;
+    /** The size of the file. */
+    qint64 size;
+  };
+
+protected:
+  /** The detected radio or @c nullptr. */
+  Radio *_radio;
+  /** The call-sign DB or @c nullptr. */
+  UserDatabase *_userDB;
+  /** Parsed configurations by absolute path. */
+  QHash<QString, CachedConfig> _configs;
+  /** Encoded codeplugs by key. */
+  QHash<QString, QByteArray> _images;
+
+protected:
+  /** The singleton instance. */
+  static Session *_instance;
+};
+
+#endif // SESSION_HH
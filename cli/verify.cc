@@ -7,12 +7,13 @@
 
 #include "logger.hh"
 #include "config.hh"
-#include "csvreader.hh"
+#include "configsnapshot.hh"
 #include "dfufile.hh"
 #include "rd5r.hh"
 #include "uv390.hh"
 #include "gd77.hh"
 #include "opengd77.hh"
+#include "session.hh"
 
 
 int verify(QCommandLineParser &parser, QCoreApplication &app)
@@ -29,17 +30,22 @@ int verify(QCommandLineParser &parser, QCoreApplication &app)
     return -1;
   }
 
-  Config config;
+  Config *config = nullptr;
 
   // Determin type by ending or flag
   if (parser.isSet("csv") || (filename.endsWith(".conf") || filename.endsWith(".csv"))) {
-    QTextStream stream(&file);
     QString errorMessage;
-    if (! CSVReader::read(&config, stream, errorMessage)) {
+    if (nullptr == (config = Session::get().config(filename, errorMessage))) {
       logError() << "Cannot read config file '" << filename << "': " << errorMessage;
       return -1;
     }
     logInfo() << "Verify '" << filename << "': No syntax issues found.";
+  } else if (ConfigSnapshot::isSnapshotFile(filename)) {
+    QString errorMessage;
+    if (nullptr == (config = Session::get().config(filename, errorMessage))) {
+      logError() << "Cannot read snapshot '" << filename << "': " << errorMessage;
+      return -1;
+    }
   } else if (parser.isSet("bin") || (filename.endsWith(".bin") || filename.endsWith(".dfu"))) {
     logError() << "Verification of binary code-plugs makes no sense.";
     return -1;
@@ -57,13 +63,13 @@ int verify(QCommandLineParser &parser, QCoreApplication &app)
   QList<VerifyIssue> issues;
   QString radio = parser.value("radio").toLower();
   if ("rd5r" == radio) {
-    RD5R radio; radio.verifyConfig(&config, issues);
+    RD5R radio; radio.verifyConfig(config, issues);
   } else if (("uv390" == radio) && ("rt3s" == radio)) {
-    UV390 radio; radio.verifyConfig(&config, issues);
+    UV390 radio; radio.verifyConfig(config, issues);
   } else if ("gd77" == radio) {
-    GD77 radio; radio.verifyConfig(&config, issues);
+    GD77 radio; radio.verifyConfig(config, issues);
   } else if ("opengd77" == radio) {
-    OpenGD77 radio; radio.verifyConfig(&config, issues);
+    OpenGD77 radio; radio.verifyConfig(config, issues);
   } else {
     logError() << "Cannot verify code-plug against unknown radio '" << radio << "'.";
     return -1;
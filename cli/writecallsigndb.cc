@@ -2,27 +2,27 @@
 
 #include <QCoreApplication>
 #include <QCommandLineParser>
+#include <QScopedPointer>
 
 #include "logger.hh"
 #include "radio.hh"
+#include "radiojob.hh"
 #include "userdatabase.hh"
 #include "progressbar.hh"
+#include "session.hh"
+#include "commands.hh"
 
 
 int writeCallsignDB(QCommandLineParser &parser, QCoreApplication &app) {
-  UserDatabase userdb;
-  if (0 == userdb.count()) {
-    logInfo() << "Downloading call-sign DB...";
-    // Wait for download to finish
-    QEventLoop loop;
-    QObject::connect(&userdb, SIGNAL(loaded()), &loop, SLOT(quit()));
-    QObject::connect(&userdb, SIGNAL(error(QString)), &loop, SLOT(quit()));
-    loop.exec();
-    // Check if call-sign DB has been loaded
-    if (0 == userdb.count()) {
-      logError() << "Could not download/load call-sign DB.";
-      return -1;
-    }
+  int timeout = 0;
+  if (! timeoutOption(parser, timeout))
+    return -1;
+
+  QString msg;
+  UserDatabase *userdb = Session::get().userDB(msg);
+  if (nullptr == userdb) {
+    logError() << msg;
+    return -1;
   }
 
   if (parser.isSet("id")) {
@@ -33,26 +33,30 @@ int writeCallsignDB(QCommandLineParser &parser, QCoreApplication &app) {
       return -1;
     }
     logDebug() << "Sort call-sign DB w.r.t. DMR ID " << id << ".";
-    userdb.sortUsers(id);
+    userdb->sortUsers(id);
   } else {
     logWarn() << "No ID is specified, a more or less random set of call-signs will be used "
-              << "if the radio cannot hold the entire call-sign DB of " << userdb.count()
+              << "if the radio cannot hold the entire call-sign DB of " << userdb->count()
               << " entries. Specify your DMR ID with --id=YOUR_DMR_ID. dmrconf will then "
               << "select those entries 'closest' to you. I.e., DMR IDs with the same prefix.";
   }
 
-  QString msg;
-  Radio *radio = Radio::detect(msg);
+  Radio *radio = Session::get().radio(msg);
   if (nullptr == radio) {
     logError() << "Could not detect a known radio. Check connection?";
     return -1;
   }
 
-  showProgress();
-  QObject::connect(radio, &Radio::uploadProgress, updateProgress);
+  if (parser.isSet("init-db"))
+    userdb->clearLastWritten(radio->name());
 
-  if (! radio->startUploadCallsignDB(&userdb, true)) {
-    logError() << "Could not upload call-sign DB to radio: " << radio->errorMessage();
+  QScopedPointer<RadioJob> job(RadioJob::uploadCallsignDB(radio, userdb));
+  showProgress();
+  QObject::connect(job.data(), &RadioJob::progressChanged, updateProgress);
+  job->setTimeout(timeout);
+  job->start();
+  if (! job->wait()) {
+    logError() << "Could not upload call-sign DB to radio: " << job->errorMessage();
     return -1;
   }
 
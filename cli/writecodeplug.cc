@@ -2,11 +2,16 @@
 
 #include <QCoreApplication>
 #include <QCommandLineParser>
+#include <QScopedPointer>
 
 #include "logger.hh"
 #include "radio.hh"
+#include "radiojob.hh"
 #include "config.hh"
+#include "configsnapshot.hh"
 #include "progressbar.hh"
+#include "session.hh"
+#include "commands.hh"
 
 
 int writeCodeplug(QCommandLineParser &parser, QCoreApplication &app) {
@@ -15,12 +20,19 @@ int writeCodeplug(QCommandLineParser &parser, QCoreApplication &app) {
   if (2 > parser.positionalArguments().size())
     parser.showHelp(-1);
 
+  int timeout = 0;
+  if (! timeoutOption(parser, timeout))
+    return -1;
+
   QString filename = parser.positionalArguments().at(1);
 
   QString errorMessage;
-  Config config;
-  if (! config.readCSV(filename, errorMessage)) {
-    logError() << "Cannot read CSV file '" << filename << "': " << errorMessage;
+  Config *config = Session::get().config(filename, errorMessage);
+  if (nullptr == config) {
+    if (ConfigSnapshot::isSnapshotFile(filename))
+      logError() << "Cannot read snapshot '" << filename << "': " << errorMessage;
+    else
+      logError() << "Cannot read CSV file '" << filename << "': " << errorMessage;
     return -1;
   }
   logDebug() << "Read codeplug from '" << filename << "'.";
@@ -32,7 +44,7 @@ int writeCodeplug(QCommandLineParser &parser, QCoreApplication &app) {
     forceRadio = parser.value("radio");
   }
 
-  Radio *radio = Radio::detect(errorMessage, forceRadio);
+  Radio *radio = Session::get().radio(errorMessage, forceRadio);
   if (nullptr == radio) {
     logError() << "Cannot detect radio: " << errorMessage;
     return -1;
@@ -40,7 +52,7 @@ int writeCodeplug(QCommandLineParser &parser, QCoreApplication &app) {
 
   bool verified = true;
   QList<VerifyIssue> issues;
-  if (VerifyIssue::WARNING <= radio->verifyConfig(&config, issues)) {
+  if (VerifyIssue::WARNING <= radio->verifyConfig(config, issues)) {
     foreach(const VerifyIssue &issue, issues) {
       if (VerifyIssue::WARNING == issue.type()) {
         logWarn() << "Verification Issue: " << issue.message();
@@ -55,9 +67,6 @@ int writeCodeplug(QCommandLineParser &parser, QCoreApplication &app) {
     return -1;
   }
 
-  showProgress();
-  QObject::connect(radio, &Radio::uploadProgress, updateProgress);
-
   CodePlug::Flags flags;
   if (parser.isSet("init-codeplug"))
     flags.updateCodePlug = false;
@@ -67,13 +76,13 @@ int writeCodeplug(QCommandLineParser &parser, QCoreApplication &app) {
     flags.autoEnableRoaming = true;
 
   logDebug() << "Start upload to " << radio->name() << ".";
-  if (! radio->startUpload(&config, true, flags)) {
-    logError() << "Codeplug upload error: " << radio->errorMessage();
-    return -1;
-  }
-
-  if (Radio::StatusError == radio->status()) {
-    logError() << "Codeplug upload error: " << radio->errorMessage();
+  QScopedPointer<RadioJob> job(RadioJob::upload(radio, config, flags));
+  showProgress();
+  QObject::connect(job.data(), &RadioJob::progressChanged, updateProgress);
+  job->setTimeout(timeout);
+  job->start();
+  if (! job->wait()) {
+    logError() << "Codeplug upload error: " << job->errorMessage();
     return -1;
   }
 
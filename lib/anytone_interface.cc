@@ -1,6 +1,9 @@
 #include "anytone_interface.hh"
 #include "logger.hh"
 #include <QtEndian>
+#include <new>
+
+#define WRITE_WINDOW 8  // Number of write requests sent before waiting for their acks.
 
 /* ********************************************************************************************* *
  * Implementation of AnytoneInterface::ReadRequest
@@ -145,19 +148,26 @@ AnytoneInterface::write(uint32_t bank, uint32_t addr, uint8_t *data, int nbytes)
 
   logDebug() << "Anytone: Write " << nbytes << "b to addr 0x" << QString::number(addr, 16) << "...";
 
-  for (int i=0; i<nbytes; i+=16) {
-    uint8_t ack;
-    WriteRequest req(addr+i, (const char *)(data+i));
-    if (! send_receive((const char *)&req, sizeof(WriteRequest),(char *)&ack, 1)) {
+  // Write requests are sent in windows of up to WRITE_WINDOW requests before collecting their
+  // acknowledgements. This avoids a full round-trip per 16 bytes.
+  char reqs[WRITE_WINDOW*sizeof(WriteRequest)];
+  uint8_t acks[WRITE_WINDOW];
+  for (int i=0; i<nbytes; i+=16*WRITE_WINDOW) {
+    int n = std::min(WRITE_WINDOW, (nbytes-i+15)/16);
+    for (int j=0; j<n; j++)
+      new (reqs+j*sizeof(WriteRequest)) WriteRequest(addr+i+16*j, (const char *)(data+i+16*j));
+    if (! send_receive(reqs, n*sizeof(WriteRequest), (char *)acks, n)) {
       _errorMessage = tr("Anytone: Cannot write data to device: %1").arg(_errorMessage);
       logError() << _errorMessage;
       return false;
     }
-    if (0x06 != ack) {
-      _errorMessage = tr("Anytone: Cannot write data to device: Unexpected response %1, expected 06.")
-          .arg(ack, 2, 16, QChar('0'));
-      logError() << _errorMessage;
-      return false;
+    for (int j=0; j<n; j++) {
+      if (0x06 != acks[j]) {
+        _errorMessage = tr("Anytone: Cannot write data to device at 0x%1: Unexpected response %2, expected 06.")
+            .arg(addr+i+16*j, 8, 16, QChar('0')).arg(acks[j], 2, 16, QChar('0'));
+        logError() << _errorMessage;
+        return false;
+      }
     }
   }
 
@@ -328,8 +338,8 @@ AnytoneInterface::leave_program_mode() {
 bool
 AnytoneInterface::send_receive(const char *cmd, int clen, char *resp, int rlen) {
   // Try to write command to device
-  if (clen != QSerialPort::write(cmd, clen)) {
-    _errorMessage = "Cannot send command to device: " + QSerialPort::errorString();
+  if (clen != transmit(cmd, clen)) {
+    _errorMessage = "Cannot send command to device: " + _errorMessage;
     logError() << _errorMessage;
     close();
     _state = STATE_ERROR;
@@ -337,27 +347,12 @@ AnytoneInterface::send_receive(const char *cmd, int clen, char *resp, int rlen)
   }
 
   // Read from device until complete response has been read
-  char *p = resp;
-  int len = rlen;
-  while (len > 0) {
-    if (! waitForReadyRead(1000)) {
-      _errorMessage = "No response from device: Timeout.";
-      logError() << _errorMessage;
-      close();
-      _state = STATE_ERROR;
-      return false;
-    }
-
-    int r = QSerialPort::read(p, len);
-    if (r < 0) {
-      _errorMessage = "Cannot read response from device: " + QSerialPort::errorString();
-      logError() << _errorMessage;
-      close();
-      _state = STATE_ERROR;
-      return false;
-    }
-    p += r;
-    len-=r;
+  if (! receiveExact(resp, rlen, 1000)) {
+    _errorMessage = "Cannot read response from device: " + _errorMessage;
+    logError() << _errorMessage;
+    close();
+    _state = STATE_ERROR;
+    return false;
   }
 
   // done
@@ -24,7 +24,7 @@
  * ********************************************************************************************* */
 Channel::Channel(const QString &name, double rx, double tx, Power power, uint txTimeout, bool rxOnly, ScanList *scanlist,
                  QObject *parent)
-  : QObject(parent), _name(name), _rxFreq(rx), _txFreq(tx), _power(power), _txTimeOut(txTimeout),
+  : QObject(parent), _name(name), _rxFreq(mhz2hz(rx)), _txFreq(mhz2hz(tx)), _power(power), _txTimeOut(txTimeout),
     _rxOnly(rxOnly), _scanlist(scanlist)
 {
   // pass..
@@ -44,21 +44,39 @@ Channel::setName(const QString &name) {
 }
 
 double Channel::rxFrequency() const {
-  return _rxFreq;
+  return hz2mhz(_rxFreq);
 }
 bool
 Channel::setRXFrequency(double freq) {
+  return setRXFrequencyHz(mhz2hz(freq));
+}
+
+double
+Channel::txFrequency() const {
+  return hz2mhz(_txFreq);
+}
+bool
+Channel::setTXFrequency(double freq) {
+  return setTXFrequencyHz(mhz2hz(freq));
+}
+
+Frequency
+Channel::rxFrequencyHz() const {
+  return _rxFreq;
+}
+bool
+Channel::setRXFrequencyHz(Frequency freq) {
   _rxFreq = freq;
   emit modified();
   return true;
 }
 
-double
-Channel::txFrequency() const {
+Frequency
+Channel::txFrequencyHz() const {
   return _txFreq;
 }
 bool
-Channel::setTXFrequency(double freq) {
+Channel::setTXFrequencyHz(Frequency freq) {
   _txFreq = freq;
   emit modified();
   return true;
@@ -105,17 +123,16 @@ Channel::setScanList(ScanList *list) {
   if (nullptr == list)
     return false;
   _scanlist = list;
-  if (_scanlist)
-    connect(_scanlist, SIGNAL(destroyed(QObject *)), this, SLOT(onScanListDeleted(QObject *)));
   emit modified();
   return true;
 }
 
 void
-Channel::onScanListDeleted(QObject *obj) {
-  ScanList *scanlist = reinterpret_cast<ScanList *>(obj);
-  if (_scanlist == scanlist)
-    _scanlist = nullptr;
+Channel::resetReferences(const QObject *obj) {
+  if ((nullptr == obj) || (_scanlist.data() != obj))
+    return;
+  _scanlist = nullptr;
+  emit modified();
 }
 
 
@@ -192,16 +209,16 @@ AnalogChannel::aprsSystem() const {
 }
 void
 AnalogChannel::setAPRSSystem(APRSSystem *sys) {
-  if (_aprsSystem)
-    disconnect(_aprsSystem, SIGNAL(destroyed(QObject*)), this, SLOT(onAPRSSystemDeleted()));
   _aprsSystem = sys;
-  if (_aprsSystem)
-    connect(_aprsSystem, SIGNAL(destroyed(QObject*)), this, SLOT(onAPRSSystemDeleted()));
 }
 
 void
-AnalogChannel::onAPRSSystemDeleted() {
+AnalogChannel::resetReferences(const QObject *obj) {
+  Channel::resetReferences(obj);
+  if ((nullptr == obj) || (_aprsSystem.data() != obj))
+    return;
   _aprsSystem = nullptr;
+  emit modified();
 }
 
 
@@ -216,14 +233,7 @@ DigitalChannel::DigitalChannel(const QString &name, double rxFreq, double txFreq
     _colorCode(colorCode), _timeSlot(timeslot), _rxGroup(rxGroup), _txContact(txContact),
     _posSystem(posSystem), _roaming(roaming)
 {
-  if (_rxGroup)
-    connect(_rxGroup, SIGNAL(destroyed()), this, SLOT(onRxGroupDeleted()));
-  if (_txContact)
-    connect(_txContact, SIGNAL(destroyed()), this, SLOT(onTxContactDeleted()));
-  if (_posSystem)
-    connect(_posSystem, SIGNAL(destroyed()), this, SLOT(onPosSystemDeleted()));
-  if (_roaming)
-    connect(_roaming, SIGNAL(destroyed()), this, SLOT(onRoamingZoneDeleted()));
+  // pass...
 }
 
 DigitalChannel::Admit
@@ -265,11 +275,7 @@ DigitalChannel::rxGroupList() const {
 
 bool
 DigitalChannel::setRXGroupList(RXGroupList *g) {
-  if (_rxGroup)
-    disconnect(_rxGroup, SIGNAL(destroyed()), this, SLOT(onRxGroupDeleted()));
   _rxGroup = g;
-  if (_rxGroup)
-    connect(_rxGroup, SIGNAL(destroyed()), this, SLOT(onRxGroupDeleted()));
   emit modified();
   return true;
 }
@@ -281,11 +287,7 @@ DigitalChannel::txContact() const {
 
 bool
 DigitalChannel::setTXContact(DigitalContact *c) {
-  if (_txContact)
-    disconnect(_txContact, SIGNAL(destroyed()), this, SLOT(onTxContactDeleted()));
   _txContact = c;
-  if (_txContact)
-    connect(_txContact, SIGNAL(destroyed()), this, SLOT(onTxContactDeleted()));
   emit modified();
   return true;
 }
@@ -297,11 +299,7 @@ DigitalChannel::posSystem() const {
 
 bool
 DigitalChannel::setPosSystem(PositioningSystem *sys) {
-  if (_posSystem)
-    disconnect(_posSystem, SIGNAL(destroyed()), this, SLOT(onPosSystemDeleted()));
   _posSystem = sys;
-  if (_posSystem)
-    connect(_posSystem, SIGNAL(destroyed()), this, SLOT(onPosSystemDeleted()));
   emit modified();
   return true;
 }
@@ -314,33 +312,35 @@ DigitalChannel::roaming() const {
 
 bool
 DigitalChannel::setRoaming(RoamingZone *zone) {
-  if (_roaming)
-    disconnect(_roaming, SIGNAL(destroyed(QObject*)), this, SLOT(onRoamingZoneDeleted()));
   _roaming = zone;
-  if (_roaming)
-    connect(_roaming, SIGNAL(destroyed(QObject*)), this, SLOT(onRoamingZoneDeleted()));
   emit modified();
   return true;
 }
 
 void
-DigitalChannel::onRxGroupDeleted() {
-  setRXGroupList(nullptr);
-}
-
-void
-DigitalChannel::onTxContactDeleted() {
-  setTXContact(nullptr);
-}
-
-void
-DigitalChannel::onPosSystemDeleted() {
-  setPosSystem(nullptr);
-}
-
-void
-DigitalChannel::onRoamingZoneDeleted() {
-  setRoaming(nullptr);
+DigitalChannel::resetReferences(const QObject *obj) {
+  Channel::resetReferences(obj);
+  if (nullptr == obj)
+    return;
+  bool reset = false;
+  if (_rxGroup.data() == obj) {
+    _rxGroup = nullptr;
+    reset = true;
+  }
+  if (_txContact.data() == obj) {
+    _txContact = nullptr;
+    reset = true;
+  }
+  if (_posSystem.data() == obj) {
+    _posSystem = nullptr;
+    reset = true;
+  }
+  if (_roaming.data() == obj) {
+    _roaming = nullptr;
+    reset = true;
+  }
+  if (reset)
+    emit modified();
 }
 
 
@@ -371,7 +371,8 @@ SelectedChannel::get() {
  * Implementation of ChannelList
  * ********************************************************************************************* */
 ChannelList::ChannelList(QObject *parent)
-  : QAbstractTableModel(parent), _channels()
+  : QAbstractTableModel(parent), _channels(), _rows(), _rowsValid(true), _frequencyIndex(),
+    _analogTxIndex(), _frequencyIndexValid(false)
 {
   connect(this, SIGNAL(modified()), this, SLOT(onChannelEdited()));
 }
@@ -386,13 +387,21 @@ ChannelList::clear() {
   for (int i=0; i<count(); i++)
     _channels[i]->deleteLater();
   _channels.clear();
+  _rows.clear();
+  _rowsValid = true;
+  _frequencyIndexValid = false;
 }
 
 int
 ChannelList::indexOf(Channel *channel) const {
-  if (! _channels.contains(channel))
+  if (! _rows.contains(channel))
     return -1;
-  return _channels.indexOf(channel);
+  if (! _rowsValid) {
+    for (int i=0; i<_channels.size(); i++)
+      _rows[_channels[i]] = i;
+    _rowsValid = true;
+  }
+  return _rows.value(channel);
 }
 
 Channel *
@@ -403,15 +412,16 @@ ChannelList::channel(int idx) const {
 }
 
 DigitalChannel *
-ChannelList::findDigitalChannel(double rx, double tx, DigitalChannel::TimeSlot ts, uint cc) const {
-  for (int i=0; i<count(); i++) {
-    if (! _channels[i]->is<DigitalChannel>())
-      continue;
-    /// @bug I should certainly change the frequency handling to integer values!
-    if ( (1e-6<std::abs(_channels[i]->txFrequency()-tx)) ||
-         (1e-6<std::abs(_channels[i]->rxFrequency()-rx)) )
+ChannelList::findDigitalChannel(Frequency rx, Frequency tx, DigitalChannel::TimeSlot ts, uint cc) const {
+  const QHash<QPair<Frequency, Frequency>, QVector<Channel *> > &index = frequencyIndex();
+  QHash<QPair<Frequency, Frequency>, QVector<Channel *> >::const_iterator item =
+      index.constFind(qMakePair(rx, tx));
+  if (index.constEnd() == item)
+    return nullptr;
+  foreach (Channel *ch, item.value()) {
+    if (! ch->is<DigitalChannel>())
       continue;
-    DigitalChannel *digi = _channels[i]->as<DigitalChannel>();
+    DigitalChannel *digi = ch->as<DigitalChannel>();
     if (digi->timeslot() != ts)
       continue;
     if (digi->colorCode() != cc)
@@ -422,22 +432,38 @@ ChannelList::findDigitalChannel(double rx, double tx, DigitalChannel::TimeSlot t
 }
 
 AnalogChannel *
-ChannelList::findAnalogChannelByTxFreq(double freq) const {
-  for (int i=0; i<count(); i++) {
-    if (! _channels[i]->is<AnalogChannel>())
-      continue;
-    if (1e-6 > std::abs(_channels[i]->txFrequency()-freq))
-      return _channels[i]->as<AnalogChannel>();
+ChannelList::findAnalogChannelByTxFreq(Frequency freq) const {
+  frequencyIndex();
+  QHash<Frequency, QVector<AnalogChannel *> >::const_iterator item = _analogTxIndex.constFind(freq);
+  if ((_analogTxIndex.constEnd() == item) || item.value().isEmpty())
+    return nullptr;
+  return item.value().first();
+}
+
+const QHash<QPair<Frequency, Frequency>, QVector<Channel *> > &
+ChannelList::frequencyIndex() const {
+  if (_frequencyIndexValid)
+    return _frequencyIndex;
+  _frequencyIndex.clear();
+  _analogTxIndex.clear();
+  foreach (Channel *ch, _channels) {
+    _frequencyIndex[qMakePair(ch->rxFrequencyHz(), ch->txFrequencyHz())].append(ch);
+    if (ch->is<AnalogChannel>())
+      _analogTxIndex[ch->txFrequencyHz()].append(ch->as<AnalogChannel>());
   }
-  return nullptr;
+  _frequencyIndexValid = true;
+  return _frequencyIndex;
 }
 
 int
 ChannelList::addChannel(Channel *channel, int row) {
-  if (_channels.contains(channel))
+  if (_rows.contains(channel))
     return -1;
   if ((row<0) || (row>_channels.size()))
     row = _channels.size();
+  // Appending keeps the rows of all other channels
+  _rowsValid = _rowsValid && (row == _channels.size());
+  _rows.insert(channel, row);
   beginInsertRows(QModelIndex(), row, row);
   connect(channel, SIGNAL(modified()), this, SIGNAL(modified()));
   connect(channel, SIGNAL(destroyed(QObject *)), this, SLOT(onChannelDeleted(QObject *)));
@@ -454,6 +480,8 @@ ChannelList::remChannel(int idx) {
   beginRemoveRows(QModelIndex(), idx, idx);
   Channel *channel = _channels.at(idx);
   _channels.remove(idx);
+  _rows.remove(channel);
+  _rowsValid = false;
   channel->deleteLater();
   endRemoveRows();
   emit modified();
@@ -462,9 +490,9 @@ ChannelList::remChannel(int idx) {
 
 bool
 ChannelList::remChannel(Channel *channel) {
-  if (! _channels.contains(channel))
+  int idx = indexOf(channel);
+  if (0 > idx)
     return false;
-  int idx = _channels.indexOf(channel);
   return remChannel(idx);
 }
 
@@ -474,17 +502,25 @@ ChannelList::moveUp(int row) {
     return false;
   beginMoveRows(QModelIndex(), row, row, QModelIndex(), row-1);
   std::swap(_channels[row], _channels[row-1]);
+  _rowsValid = false;
   endMoveRows();
   emit modified();
   return true;
 }
 
+void
+ChannelList::resetReferences(const QObject *obj) {
+  foreach (Channel *channel, _channels)
+    channel->resetReferences(obj);
+}
+
 bool
 ChannelList::moveDown(int row) {
   if ((0>row) || ((row-1)>=count()))
     return false;
   beginMoveRows(QModelIndex(), row, row, QModelIndex(), row+2);
   std::swap(_channels[row], _channels[row+1]);
+  _rowsValid = false;
   endMoveRows();
   emit modified();
   return true;
@@ -703,6 +739,8 @@ ChannelList::onChannelDeleted(QObject *obj) {
 
 void
 ChannelList::onChannelEdited() {
+  // Frequencies or order may have changed
+  _frequencyIndexValid = false;
   if (0 == count())
     return;
   QModelIndex tl = index(0,0), br = index(count()-1, columnCount(QModelIndex()));
@@ -3,8 +3,11 @@
 
 #include <QObject>
 #include <QAbstractTableModel>
+#include <QHash>
+#include <QPointer>
 
 #include "signaling.hh"
+#include "frequency.hh"
 
 class Config;
 class RXGroupList;
@@ -82,6 +85,14 @@ public:
   double txFrequency() const;
   /** (Re-)Sets the TX frequency of the channel in MHz. */
   bool setTXFrequency(double freq);
+  /** Returns the RX frequency of the channel in Hz. */
+  Frequency rxFrequencyHz() const;
+  /** (Re-)Sets the RX frequency of the channel in Hz. */
+  bool setRXFrequencyHz(Frequency freq);
+  /** Returns the TX frequency of the channel in Hz. */
+  Frequency txFrequencyHz() const;
+  /** (Re-)Sets the TX frequency of the channel in Hz. */
+  bool setTXFrequencyHz(Frequency freq);
 
   /** Returns the power setting of the channel. */
   Power power() const;
@@ -103,29 +114,29 @@ public:
   /** (Re-) Sets the default scan list for the channel. */
   bool setScanList(ScanList *list);
 
+  /** Resets all references of the channel to the given object, e.g., before it gets removed from
+   * the config. Emits @c modified if a reference was reset. */
+  virtual void resetReferences(const QObject *obj);
+
 signals:
   /** Is emitted if the channel gets modified. */
   void modified();
 
-protected slots:
-  /** Internal hander for deleted scan lists. */
-  void onScanListDeleted(QObject *obj);
-
 protected:
   /** The channel name. */
   QString _name;
-  /** The RX frequency in MHz. */
-  double _rxFreq;
-  /** The TX frequency in MHz. */
-  double _txFreq;
+  /** The RX frequency in Hz. */
+  Frequency _rxFreq;
+  /** The TX frequency in Hz. */
+  Frequency _txFreq;
   /** The transmit power setting. */
   Power _power;
   /** Transmit timeout in seconds. */
   uint  _txTimeOut;
   /** RX only flag. */
   bool  _rxOnly;
-  /** Default scan list of the channel. */
-  ScanList *_scanlist;
+  /** Default scan list of the channel, gets reset if the list is deleted. */
+  QPointer<ScanList> _scanlist;
 };
 
 
@@ -206,9 +217,8 @@ public:
   /** Sets the APRS system. */
   void setAPRSSystem(APRSSystem *sys);
 
-protected slots:
-  /** Internal call-back that gets called if the associated APRS gets deleted. */
-  void onAPRSSystemDeleted();
+  /** Also resets the APRS system, if it is the given object. */
+  void resetReferences(const QObject *obj);
 
 protected:
   /** Holds the admit criterion. */
@@ -222,7 +232,7 @@ protected:
   /** The channel bandwidth. */
 	Bandwidth _bw;
   /** A reference to the APRS system used on the channel or @c nullptr if disabled. */
-  APRSSystem *_aprsSystem;
+  QPointer<APRSSystem> _aprsSystem;
 };
 
 
@@ -308,15 +318,9 @@ public:
   /** Associates the given roaming zone with this channel. */
   bool setRoaming(RoamingZone *zone);
 
-protected slots:
-  /** Internal callback if RX group list is deleted. */
-	void onRxGroupDeleted();
-  /** Internal callback if TX contact is deleted. */
-	void onTxContactDeleted();
-  /** Internal callback if GPS system is deleted. */
-  void onPosSystemDeleted();
-  /** Internal callback if roaming zone is deleted. */
-  void onRoamingZoneDeleted();
+  /** Also resets the RX group list, TX contact, positioning system and roaming zone, if one of
+   * them is the given object. */
+  void resetReferences(const QObject *obj);
 
 protected:
   /** The admit criterion. */
@@ -326,13 +330,13 @@ protected:
   /** The time slot for the channel. */
 	TimeSlot _timeSlot;
   /** The RX group list for this channel. */
-	RXGroupList *_rxGroup;
+  QPointer<RXGroupList> _rxGroup;
   /** The default TX contact. */
-	DigitalContact *_txContact;
+  QPointer<DigitalContact> _txContact;
   /** The GPS system. */
-  PositioningSystem *_posSystem;
+  QPointer<PositioningSystem> _posSystem;
   /** Roaming zone for the channel. */
-  RoamingZone *_roaming;
+  QPointer<RoamingZone> _roaming;
 };
 
 
@@ -383,10 +387,10 @@ public:
   int indexOf(Channel *channel) const;
   /** Gets the channel at the specified index. */
 	Channel *channel(int idx) const;
-  /** Finds a digial channel with the given frequencies, time slot and color code. */
-  DigitalChannel *findDigitalChannel(double rx, double tx, DigitalChannel::TimeSlot ts, uint cc) const;
-  /** Finds an analog channel with the given frequeny. */
-  AnalogChannel *findAnalogChannelByTxFreq(double freq) const;
+  /** Finds a digial channel with the given frequencies (in Hz), time slot and color code. */
+  DigitalChannel *findDigitalChannel(Frequency rx, Frequency tx, DigitalChannel::TimeSlot ts, uint cc) const;
+  /** Finds an analog channel with the given TX frequeny (in Hz). */
+  AnalogChannel *findAnalogChannelByTxFreq(Frequency freq) const;
   /** Adds a channel to the list at the specified row.
    * If row<0 the channel gets appendet to the list.*/
 	int addChannel(Channel *channel, int row=-1);
@@ -398,6 +402,9 @@ public:
   bool moveUp(int idx);
   /** Moves the channel at index @c idx one step up. */
   bool moveDown(int idx);
+  /** Resets all references of all channels to the given object, e.g., before it gets removed
+   * from the config. */
+  void resetReferences(const QObject *obj);
 
 	// QAbstractTableModel interface
   /** Implements QAbstractTableModel, returns number of rows. */
@@ -419,9 +426,25 @@ protected slots:
   /** Internal callback on modified channels. */
   void onChannelEdited();
 
+protected:
+  /** Returns the index of channels by RX and TX frequency, (re-)builds it if needed. */
+  const QHash<QPair<Frequency, Frequency>, QVector<Channel *> > &frequencyIndex() const;
+
 protected:
   /** Just the vector of channels. */
 	QVector<Channel *> _channels;
+  /** Maps every channel of the list to its row. The keys are always up to date, the rows only
+   * if @c _rowsValid is set. Avoids linear searches when adding and looking up channels. */
+  mutable QHash<Channel *, int> _rows;
+  /** If @c true, the rows of @c _rows are up to date. */
+  mutable bool _rowsValid;
+  /** Maps RX and TX frequencies to the channels in list order. Built on demand and invalidated
+   * on every change of the list. */
+  mutable QHash<QPair<Frequency, Frequency>, QVector<Channel *> > _frequencyIndex;
+  /** Maps the TX frequency to the analog channels in list order. */
+  mutable QHash<Frequency, QVector<AnalogChannel *> > _analogTxIndex;
+  /** If @c true, the frequency indices are up to date. */
+  mutable bool _frequencyIndexValid;
 };
 
 
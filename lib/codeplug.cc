@@ -1,5 +1,9 @@
 #include "codeplug.hh"
 #include "config.hh"
+#include "logger.hh"
+#include <QtAlgorithms>
+#include <algorithm>
+#include <string.h>
 
 
 /* ********************************************************************************************* *
@@ -12,6 +16,34 @@ CodePlug::Flags::Flags()
 }
 
 
+/* ********************************************************************************************* *
+ * Implementation of CodePlug::ParsedChannel
+ * ********************************************************************************************* */
+CodePlug::ParsedChannel::ParsedChannel()
+  : name(), rxFrequency(0), txFrequency(0),
+    rxTone(Signaling::SIGNALING_NONE), txTone(Signaling::SIGNALING_NONE)
+{
+  // pass...
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of CodePlug::Identity
+ * ********************************************************************************************* */
+CodePlug::Identity::Identity()
+  : id(0), name(), introLine1(), introLine2()
+{
+  // pass...
+}
+
+CodePlug::Identity::Identity(const Config *config)
+  : id(config->id()), name(config->name()), introLine1(config->introLine1()),
+    introLine2(config->introLine2())
+{
+  // pass...
+}
+
+
 /* ********************************************************************************************* *
  * Implementation of CodePlug
  * ********************************************************************************************* */
@@ -24,3 +56,322 @@ CodePlug::CodePlug(QObject *parent)
 CodePlug::~CodePlug() {
 	// pass...
 }
+
+QVector<CodePlug::PagedImage::Run>
+CodePlug::overwriteMap(const Config *config, uint32_t img) const {
+  Q_UNUSED(config); Q_UNUSED(img);
+  return QVector<PagedImage::Run>();
+}
+
+bool
+CodePlug::patchIdentity(const Identity &identity) {
+  Q_UNUSED(identity);
+  _errorMessage = tr("%1(): Cannot patch the identity of this codeplug.").arg(__func__);
+  return false;
+}
+
+bool
+CodePlug::isOverwritten(const QVector<PagedImage::Run> &map, uint32_t address, uint32_t size) {
+  // The map is sorted, hence extend the covered head of the range run by run
+  uint32_t end = address+size;
+  foreach (const PagedImage::Run &run, map) {
+    if (address >= end)
+      break;
+    if (run.address > address)
+      return false;
+    address = std::max(address, run.address+run.size);
+  }
+  return address >= end;
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of CodePlug::PagedImage
+ * ********************************************************************************************* */
+/** Number of pages allocated at once within the arena. */
+#define PAGES_PER_CHUNK 64
+/** Number of entries of the first level of the page table. */
+#define TABLE_SIZE      0x1000
+
+CodePlug::PagedImage::PagedImage()
+  : _pages(), _table(TABLE_SIZE), _chunks(), _next(nullptr), _free(0), _fragmented(false)
+{
+  // pass...
+}
+
+CodePlug::PagedImage::~PagedImage() {
+  foreach (uint8_t *chunk, _chunks)
+    delete[] chunk;
+}
+
+void
+CodePlug::PagedImage::clear() {
+  foreach (uint8_t *chunk, _chunks)
+    delete[] chunk;
+  _chunks.clear();
+  _pages.clear();
+  _table = QVector<QVector<int>>(TABLE_SIZE);
+  _next = nullptr;
+  _free = 0;
+  _fragmented = false;
+}
+
+int
+CodePlug::PagedImage::page(uint32_t address) const {
+  const QVector<int> &table = _table[address>>20];
+  if (table.isEmpty())
+    return -1;
+  return table[(address>>10) & 0x3ff];
+}
+
+uint64_t
+CodePlug::PagedImage::blockMask(uint32_t page, uint32_t address, uint32_t size) {
+  uint64_t start = std::max(uint64_t(page), uint64_t(address));
+  uint64_t end = std::min(uint64_t(page)+PAGE_SIZE, uint64_t(address)+size);
+  if (start >= end)
+    return 0;
+  uint32_t b0 = (start-page)/BLOCK_SIZE, b1 = (end-page+BLOCK_SIZE-1)/BLOCK_SIZE;
+  if (64 == (b1-b0))
+    return ~uint64_t(0);
+  return ((uint64_t(1)<<(b1-b0))-1) << b0;
+}
+
+uint8_t *
+CodePlug::PagedImage::allocPages(uint32_t n) {
+  if (n > _free) {
+    uint32_t pages = std::max(uint32_t(PAGES_PER_CHUNK), n);
+    _next = new uint8_t[pages*PAGE_SIZE]();
+    _chunks.append(_next);
+    _free = pages;
+  }
+  uint8_t *memory = _next;
+  _next += n*PAGE_SIZE;
+  _free -= n;
+  return memory;
+}
+
+bool
+CodePlug::PagedImage::reserve(uint32_t address, uint32_t size) {
+  if (0 == size)
+    return true;
+  return map(address, size);
+}
+
+bool
+CodePlug::PagedImage::map(uint32_t address, uint32_t size) {
+  uint32_t first = address & ~(PAGE_SIZE-1);
+  uint32_t last  = uint32_t((uint64_t(address)+size-1) & ~uint64_t(PAGE_SIZE-1));
+  uint32_t n = (last-first)/PAGE_SIZE + 1;
+
+  // Allocated pages never move. Hence, the range can only be contiguous if the allocated pages
+  // are contiguous and all missing pages follow them at the end of the arena.
+  uint32_t missing = 0, tail = n;
+  bool contiguous = true;
+  const uint8_t *expected = nullptr;
+  for (uint32_t i=0; i<n; i++) {
+    int idx = page(first+i*PAGE_SIZE);
+    if (0 > idx) {
+      missing++; tail = std::min(tail, i);
+      continue;
+    }
+    if (expected && (expected != _pages[idx].memory))
+      contiguous = false;
+    expected = _pages[idx].memory + PAGE_SIZE;
+    // An allocated page behind a missing one
+    if (tail < i)
+      contiguous = false;
+  }
+  if (missing && expected && ((expected != _next) || (missing > _free)))
+    contiguous = false;
+
+  // Allocate missing pages
+  uint8_t *memory = missing ? allocPages(missing) : nullptr;
+  for (uint32_t i=0; i<n; i++) {
+    uint32_t addr = first+i*PAGE_SIZE;
+    if (0 <= page(addr))
+      continue;
+    QVector<int> &table = _table[addr>>20];
+    if (table.isEmpty())
+      table = QVector<int>(0x400, -1);
+    Page pg; pg.address = addr; pg.memory = memory; pg.valid = 0; pg.dirty = 0;
+    table[(addr>>10) & 0x3ff] = _pages.size();
+    _pages.append(pg);
+    memory += PAGE_SIZE;
+  }
+
+  if (! contiguous) {
+    _fragmented = true;
+    logError() << "Memory range 0x" << QString::number(address, 16) << " of size 0x"
+               << QString::number(size, 16) << " is not contiguous: It overlaps with pages "
+               << "allocated separately.";
+  }
+  return contiguous;
+}
+
+bool
+CodePlug::PagedImage::allocate(uint32_t address, uint32_t size, uint8_t fill) {
+  if (0 == size)
+    return true;
+
+  uint32_t first = address & ~(PAGE_SIZE-1);
+  uint32_t last  = uint32_t((uint64_t(address)+size-1) & ~uint64_t(PAGE_SIZE-1));
+  uint32_t n = (last-first)/PAGE_SIZE + 1;
+  bool contiguous = map(address, size);
+
+  // Fill and mark new blocks
+  for (uint32_t i=0; i<n; i++) {
+    Page &pg = _pages[page(first+i*PAGE_SIZE)];
+    uint64_t blocks = blockMask(pg.address, address, size) & (~pg.valid);
+    for (uint32_t b=0; b<64; b++) {
+      if (blocks & (uint64_t(1)<<b))
+        memset(pg.memory+b*BLOCK_SIZE, fill, BLOCK_SIZE);
+    }
+    pg.valid |= blocks;
+    pg.dirty |= blocks;
+  }
+
+  return contiguous;
+}
+
+bool
+CodePlug::PagedImage::isFragmented() const {
+  return _fragmented;
+}
+
+bool
+CodePlug::PagedImage::isAllocated(uint32_t address, uint32_t size) const {
+  uint32_t first = address & ~(PAGE_SIZE-1);
+  for (uint64_t p=first; p<(uint64_t(address)+size); p+=PAGE_SIZE) {
+    int idx = page(p);
+    if (0 > idx)
+      return false;
+    uint64_t mask = blockMask(p, address, size);
+    if (mask != (_pages[idx].valid & mask))
+      return false;
+  }
+  return true;
+}
+
+uint8_t *
+CodePlug::PagedImage::data(uint32_t address) {
+  int idx = page(address);
+  if (0 > idx)
+    return nullptr;
+  uint32_t offset = address & (PAGE_SIZE-1);
+  if (0 == (_pages[idx].valid & (uint64_t(1)<<(offset/BLOCK_SIZE))))
+    return nullptr;
+  return _pages[idx].memory + offset;
+}
+
+const uint8_t *
+CodePlug::PagedImage::data(uint32_t address) const {
+  int idx = page(address);
+  if (0 > idx)
+    return nullptr;
+  uint32_t offset = address & (PAGE_SIZE-1);
+  if (0 == (_pages[idx].valid & (uint64_t(1)<<(offset/BLOCK_SIZE))))
+    return nullptr;
+  return _pages[idx].memory + offset;
+}
+
+void
+CodePlug::PagedImage::markDirty(uint32_t address, uint32_t size) {
+  uint32_t first = address & ~(PAGE_SIZE-1);
+  for (uint64_t p=first; p<(uint64_t(address)+size); p+=PAGE_SIZE) {
+    int idx = page(p);
+    if (0 <= idx)
+      _pages[idx].dirty |= (_pages[idx].valid & blockMask(p, address, size));
+  }
+}
+
+void
+CodePlug::PagedImage::markClean(uint32_t address, uint32_t size) {
+  uint32_t first = address & ~(PAGE_SIZE-1);
+  for (uint64_t p=first; p<(uint64_t(address)+size); p+=PAGE_SIZE) {
+    int idx = page(p);
+    if (0 <= idx)
+      _pages[idx].dirty &= ~blockMask(p, address, size);
+  }
+}
+
+bool
+CodePlug::PagedImage::isDirty(uint32_t address, uint32_t size) const {
+  uint32_t first = address & ~(PAGE_SIZE-1);
+  for (uint64_t p=first; p<(uint64_t(address)+size); p+=PAGE_SIZE) {
+    int idx = page(p);
+    if ((0 <= idx) && (_pages[idx].dirty & blockMask(p, address, size)))
+      return true;
+  }
+  return false;
+}
+
+QVector<CodePlug::PagedImage::Run>
+CodePlug::PagedImage::runs(bool dirtyOnly, uint32_t maxSize) const {
+  QVector<Run> runs;
+  Run run; run.address = 0; run.size = 0;
+  const uint8_t *end = nullptr;
+  for (int i=0; i<_table.size(); i++) {
+    if (_table[i].isEmpty())
+      continue;
+    for (int j=0; j<_table[i].size(); j++) {
+      int idx = _table[i][j];
+      if (0 > idx)
+        continue;
+      const Page &pg = _pages[idx];
+      uint64_t blocks = dirtyOnly ? (pg.valid & pg.dirty) : pg.valid;
+      for (uint32_t b=0; b<64; b++) {
+        if (0 == (blocks & (uint64_t(1)<<b)))
+          continue;
+        uint32_t addr = pg.address + b*BLOCK_SIZE;
+        const uint8_t *mem = pg.memory + b*BLOCK_SIZE;
+        // Extend current run, if address and memory are contiguous
+        if (run.size && ((run.address+run.size) == addr) && (end == mem)
+            && ((0 == maxSize) || ((run.size+BLOCK_SIZE) <= maxSize))) {
+          run.size += BLOCK_SIZE;
+        } else {
+          if (run.size)
+            runs.append(run);
+          run.address = addr; run.size = BLOCK_SIZE;
+        }
+        end = mem + BLOCK_SIZE;
+      }
+    }
+  }
+  if (run.size)
+    runs.append(run);
+  return runs;
+}
+
+uint32_t
+CodePlug::PagedImage::memSize() const {
+  uint32_t size = 0;
+  foreach (const Page &pg, _pages)
+    size += qPopulationCount(quint64(pg.valid))*BLOCK_SIZE;
+  return size;
+}
+
+void
+CodePlug::PagedImage::toImage(DFUFile::Image &image) const {
+  for (int i=image.numElements()-1; i>=0; i--)
+    image.remElement(i);
+  foreach (const Run &run, runs()) {
+    image.addElement(run.address, run.size);
+    memcpy(image.element(image.numElements()-1).data().data(), data(run.address), run.size);
+  }
+}
+
+void
+CodePlug::PagedImage::fromImage(const DFUFile::Image &image) {
+  clear();
+  for (int i=0; i<image.numElements(); i++) {
+    const DFUFile::Element &el = image.element(i);
+    allocate(el.address(), el.data().size());
+    // Copy page-wise, the element may overlap with pages allocated for the previous one
+    for (uint32_t o=0; o<uint32_t(el.data().size()); ) {
+      uint32_t addr = el.address()+o;
+      uint32_t n = std::min(uint32_t(el.data().size())-o, PAGE_SIZE-(addr & (PAGE_SIZE-1)));
+      memcpy(data(addr), el.data().constData()+o, n);
+      o += n;
+    }
+  }
+}
@@ -4,6 +4,8 @@
 #include <QObject>
 #include "dfufile.hh"
 #include "userdatabase.hh"
+#include "contact.hh"
+#include "signaling.hh"
 
 class Config;
 
@@ -35,6 +37,164 @@ public:
     Flags();
   };
 
+  /** Plain representation of those channel settings that are costly to decode (name, frequencies
+   * and tones). Codeplugs parse their channels into this class in parallel before the channel
+   * objects get created on the thread owning the config. */
+  class ParsedChannel {
+  public:
+    /** The name of the channel. */
+    QString name;
+    /** The RX frequency in MHz. */
+    double rxFrequency;
+    /** The TX frequency in MHz. */
+    double txFrequency;
+    /** The RX CTCSS/DCS tone. */
+    Signaling::Code rxTone;
+    /** The TX CTCSS/DCS tone. */
+    Signaling::Code txTone;
+
+    /** Default constructor. */
+    ParsedChannel();
+  };
+
+  /** The settings identifying a single radio. These are the only settings that differ between
+   * the codeplugs of a fleet of radios, see @c CodePlug::patchIdentity. */
+  class Identity {
+  public:
+    /** The DMR ID of the radio. */
+    uint32_t id;
+    /** The name of the radio. */
+    QString name;
+    /** The first intro line. */
+    QString introLine1;
+    /** The second intro line. */
+    QString introLine2;
+
+    /** Default constructor. */
+    Identity();
+    /** Constructs the identity of the radio configured by the given config. */
+    explicit Identity(const Config *config);
+  };
+
+  /** Sparse memory image of a codeplug.
+   *
+   * The address space is divided into pages of @c PAGE_SIZE bytes, that get allocated on demand
+   * from a common arena. A two-level page table translates addresses to pages in constant time.
+   * Each page holds a valid and a dirty bitmap of its blocks of @c BLOCK_SIZE bytes. Valid blocks
+   * were allocated, dirty blocks were not yet transferred from or to the device.
+   *
+   * Allocated pages never move, hence pointers returned by @c data remain valid until the image
+   * gets cleared or destroyed. Memory allocated within one call to @c allocate is contiguous,
+   * unless @c allocate returns @c false. Then, pointers returned by @c data must not be used
+   * beyond the page they point into. */
+  class PagedImage
+  {
+  public:
+    /** Size of a page in bytes. */
+    static const uint32_t PAGE_SIZE  = 0x400;
+    /** Size of a block in bytes, the granularity of the valid and dirty bitmaps. */
+    static const uint32_t BLOCK_SIZE = 0x10;
+
+    /** A contiguous range of allocated memory. */
+    class Run {
+    public:
+      /** The start address. */
+      uint32_t address;
+      /** The size in bytes. */
+      uint32_t size;
+    };
+
+  public:
+    /** Constructs an empty image. */
+    PagedImage();
+    /** Destructor, frees the arena. */
+    ~PagedImage();
+
+    /** Frees all pages. */
+    void clear();
+
+    /** Allocates the given memory range. Blocks that were not allocated yet get filled with
+     * @c fill and are marked dirty. The range is extended to complete blocks. Returns @c false
+     * if the range is not contiguous, because it overlaps with pages allocated separately. The
+     * range gets allocated nevertheless and the image is marked as fragmented. */
+    bool allocate(uint32_t address, uint32_t size, uint8_t fill=0x00);
+    /** Reserves contiguous memory for the given range without allocating any blocks. Records
+     * allocated later within the range are contiguous, even if they straddle pages. Returns
+     * @c false if the range overlaps with pages allocated separately. */
+    bool reserve(uint32_t address, uint32_t size);
+    /** Returns @c true if any range was not allocated contiguously since the last @c clear. */
+    bool isFragmented() const;
+    /** Returns @c true if the complete range is allocated. */
+    bool isAllocated(uint32_t address, uint32_t size=1) const;
+    /** Returns a pointer to the memory at the given address or @c nullptr if not allocated. */
+    uint8_t *data(uint32_t address);
+    /** Returns a pointer to the memory at the given address or @c nullptr if not allocated. */
+    const uint8_t *data(uint32_t address) const;
+
+    /** Marks the allocated blocks within the given range as dirty. */
+    void markDirty(uint32_t address, uint32_t size);
+    /** Marks the allocated blocks within the given range as clean. */
+    void markClean(uint32_t address, uint32_t size);
+    /** Returns @c true if any block within the given range is dirty. */
+    bool isDirty(uint32_t address, uint32_t size) const;
+
+    /** Returns the allocated (or only the dirty) memory as a list of contiguous runs in ascending
+     * order of their addresses. If @c maxSize is not 0, runs get split into pieces of at most
+     * @c maxSize bytes. */
+    QVector<Run> runs(bool dirtyOnly=false, uint32_t maxSize=0) const;
+    /** Returns the number of allocated bytes. */
+    uint32_t memSize() const;
+
+    /** Replaces all elements of the given image with the allocated runs. */
+    void toImage(DFUFile::Image &image) const;
+    /** Replaces the content of this image with the elements of the given image. */
+    void fromImage(const DFUFile::Image &image);
+
+  protected:
+    /** A single page. */
+    class Page {
+    public:
+      /** The address of the page. */
+      uint32_t address;
+      /** The memory of the page within the arena. */
+      uint8_t *memory;
+      /** Bitmap of valid blocks. */
+      uint64_t valid;
+      /** Bitmap of dirty blocks. */
+      uint64_t dirty;
+    };
+
+    /** Returns the index of the page containing the address or -1 if not allocated. */
+    int page(uint32_t address) const;
+    /** Returns the bitmap of the blocks of the page overlapping with the given range. */
+    static uint64_t blockMask(uint32_t page, uint32_t address, uint32_t size);
+    /** Allocates @c n contiguous pages within the arena. */
+    uint8_t *allocPages(uint32_t n);
+    /** Creates all missing pages of the given range. Returns @c false if the range is not
+     * contiguous. */
+    bool map(uint32_t address, uint32_t size);
+
+  private:
+    /** Copying is not allowed, pointers into the arena would be shared. */
+    PagedImage(const PagedImage &other);
+    /** Copying is not allowed, pointers into the arena would be shared. */
+    PagedImage &operator=(const PagedImage &other);
+
+  protected:
+    /** All allocated pages. */
+    QVector<Page> _pages;
+    /** Two-level page table, maps the upper 12 address bits to a table of page indices. */
+    QVector<QVector<int>> _table;
+    /** The chunks of the arena. */
+    QVector<uint8_t *> _chunks;
+    /** The next unused page within the last chunk. */
+    uint8_t *_next;
+    /** Number of unused pages within the last chunk. */
+    uint32_t _free;
+    /** Set if any range was not allocated contiguously. */
+    bool _fragmented;
+  };
+
 protected:
   /** Hidden default constructor. */
 	explicit CodePlug(QObject *parent=nullptr);
@@ -49,6 +209,68 @@ public:
   /** Encodes a given abstract configuration (@c config) to the device specific binary code-plug.
    * This must be implemented by the device-specific codeplug. */
   virtual bool encode(Config *config, const Flags &flags=Flags()) = 0;
+
+  /** Returns the overwrite map of the specified image for the given configuration. That is, the
+   * memory ranges (in ascending order) whose content is completely determined by @c encode. When
+   * updating a codeplug, these ranges need not to be read from the device before encoding. The
+   * default implementation returns an empty map, i.e., the complete codeplug gets read. */
+  virtual QVector<PagedImage::Run> overwriteMap(const Config *config, uint32_t img=0) const;
+
+  /** Returns @c true if the given memory range is completely covered by the overwrite map. */
+  static bool isOverwritten(const QVector<PagedImage::Run> &map, uint32_t address, uint32_t size);
+
+  /** Replaces the identity (DMR ID, radio name and intro lines) of an encoded codeplug. Only the
+   * fields holding the identity are touched. Hence, the codeplugs of a fleet of radios can be
+   * derived from a single encoded template. The default implementation fails, as the codeplug
+   * does not know where the identity is stored. */
+  virtual bool patchIdentity(const Identity &identity);
+};
+
+
+/** Generic deferred loader for codeplug contacts.
+ *
+ * Holds a copy of the encoded contacts (e.g., @c D878UVCodeplug::contact_t) found during decoding
+ * and constructs the @c DigitalContact objects only once the @c ContactList accesses them. As the
+ * records are copied, the loader remains valid after the codeplug has been deleted.
+ *
+ * The template argument must provide the @c toContactObj() and @c getId() methods.
+ *
+ * @ingroup conf */
+template <class T>
+class CodePlugContactLoader: public ContactList::Loader
+{
+public:
+  /** Constructs an empty loader, reserving space for @c n records. */
+  explicit CodePlugContactLoader(int n=0)
+    : ContactList::Loader(), _records()
+  {
+    _records.reserve(n);
+  }
+
+  /** Appends a copy of the given encoded contact. */
+  void append(const T *record) {
+    _records.append(*record);
+  }
+
+  /** Returns the number of records held. */
+  int count() const {
+    return _records.size();
+  }
+
+  /** Constructs the @c idx-th contact. */
+  DigitalContact *load(int idx) {
+    return _records.at(idx).toContactObj();
+  }
+
+  /** Returns the number of the @c idx-th contact from the encoded record. */
+  bool number(int idx, uint &number) const {
+    number = _records.at(idx).getId();
+    return true;
+  }
+
+protected:
+  /** Copies of the encoded contacts. */
+  QVector<T> _records;
 };
 
 #endif // CODEPLUG_HH
@@ -0,0 +1,323 @@
+#include "codeplugarchive.hh"
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QCryptographicHash>
+#include <QMap>
+#include <algorithm>
+#include "dfufile.hh"
+#include "logger.hh"
+
+/** Version of the manifest format. */
+#define MANIFEST_VERSION 1
+
+
+/* ********************************************************************************************* *
+ * Implementation of CodeplugArchive::Entry & CodeplugArchive::Difference
+ * ********************************************************************************************* */
+CodeplugArchive::Entry::Entry()
+  : name(), source(), added(), size(0), blocks(0)
+{
+  // pass...
+}
+
+CodeplugArchive::Difference::Difference(int img, uint32_t addr, uint32_t n)
+  : image(img), address(addr), size(n)
+{
+  // pass...
+}
+
+
+/// @cond with_internal_docs
+/** A block reference of a manifest. */
+struct BlockRef {
+  /** The hash of the block. */
+  QString hash;
+  /** The size of the block. */
+  uint32_t size;
+};
+
+/** Collects the block references of a manifest by image and address. */
+static QMap<QPair<int, uint32_t>, BlockRef>
+blockRefs(const QJsonObject &manifest) {
+  QMap<QPair<int, uint32_t>, BlockRef> refs;
+  foreach (const QJsonValue &value, manifest.value("segments").toArray()) {
+    QJsonObject segment = value.toObject();
+    if (! segment.contains("block"))
+      continue;
+    QPair<int, uint32_t> key(segment.value("image").toInt(),
+                             uint32_t(segment.value("address").toDouble()));
+    refs.insert(key, {segment.value("block").toString(),
+                      uint32_t(segment.value("size").toDouble())});
+  }
+  return refs;
+}
+
+/** Appends the given difference, merging it with the last one if adjacent. */
+static void
+appendDifference(QList<CodeplugArchive::Difference> &differences, int image, uint32_t address,
+                 uint32_t size)
+{
+  if ((! differences.isEmpty()) && (differences.last().image == image) &&
+      ((differences.last().address+differences.last().size) == address)) {
+    differences.last().size += size;
+    return;
+  }
+  differences.append(CodeplugArchive::Difference(image, address, size));
+}
+/// @endcond
+
+
+/* ********************************************************************************************* *
+ * Implementation of CodeplugArchive
+ * ********************************************************************************************* */
+CodeplugArchive::CodeplugArchive(const QString &path, QObject *parent)
+  : QObject(parent), _directory(path), _errorMessage()
+{
+  _directory.mkpath("blocks");
+  _directory.mkpath("manifests");
+}
+
+const QString &
+CodeplugArchive::errorMessage() const {
+  return _errorMessage;
+}
+
+QString
+CodeplugArchive::blockPath(const QString &hash) const {
+  return _directory.filePath(QString("blocks/%1/%2").arg(hash.left(2), hash.mid(2)));
+}
+
+QString
+CodeplugArchive::manifestPath(const QString &name) const {
+  return _directory.filePath(QString("manifests/%1.json").arg(name));
+}
+
+QString
+CodeplugArchive::storeBlock(const QByteArray &data, bool &stored) {
+  QString hash = QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex();
+  QString path = blockPath(hash);
+  stored = false;
+  if (QFileInfo::exists(path))
+    return hash;
+
+  _directory.mkpath(QString("blocks/%1").arg(hash.left(2)));
+  QSaveFile file(path);
+  if ((! file.open(QIODevice::WriteOnly)) || (0 > file.write(qCompress(data, 9))) ||
+      (! file.commit())) {
+    _errorMessage = tr("Cannot store block '%1': %2").arg(path, file.errorString());
+    return QString();
+  }
+  stored = true;
+  return hash;
+}
+
+bool
+CodeplugArchive::loadBlock(const QString &hash, QByteArray &data) {
+  QFile file(blockPath(hash));
+  if (! file.open(QIODevice::ReadOnly)) {
+    _errorMessage = tr("Cannot read block '%1': %2").arg(file.fileName(), file.errorString());
+    return false;
+  }
+  data = qUncompress(file.readAll());
+  if (QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex() != hash.toLatin1()) {
+    _errorMessage = tr("Block '%1' is corrupted.").arg(file.fileName());
+    return false;
+  }
+  return true;
+}
+
+bool
+CodeplugArchive::loadManifest(const QString &name, QJsonObject &manifest) {
+  QFile file(manifestPath(name));
+  if (! file.open(QIODevice::ReadOnly)) {
+    _errorMessage = tr("Cannot read manifest of '%1': %2").arg(name, file.errorString());
+    return false;
+  }
+
+  QJsonParseError err;
+  manifest = QJsonDocument::fromJson(file.readAll(), &err).object();
+  if (QJsonParseError::NoError != err.error) {
+    _errorMessage = tr("Cannot parse manifest of '%1': %2").arg(name, err.errorString());
+    return false;
+  }
+  if (MANIFEST_VERSION != manifest.value("version").toInt()) {
+    _errorMessage = tr("Unsupported manifest version %1 of '%2'.")
+        .arg(manifest.value("version").toInt()).arg(name);
+    return false;
+  }
+  return true;
+}
+
+bool
+CodeplugArchive::add(const QString &filename, const QString &name) {
+  QString entry = name.isEmpty() ? QFileInfo(filename).completeBaseName() : name;
+  if (entry.isEmpty() || entry.contains('/') || entry.contains('\\')) {
+    _errorMessage = tr("Invalid name '%1'.").arg(entry);
+    return false;
+  }
+
+  // Parse file to get the element layout, the raw content is stored verbatim
+  DFUFile dfu;
+  if (! dfu.read(filename)) {
+    _errorMessage = dfu.errorMessage();
+    return false;
+  }
+  QFile file(filename);
+  if (! file.open(QIODevice::ReadOnly)) {
+    _errorMessage = tr("Cannot read '%1': %2").arg(filename, file.errorString());
+    return false;
+  }
+  QByteArray raw = file.readAll();
+
+  QJsonArray segments;
+  uint32_t pos = 0;
+  uint blocks = 0, stored = 0;
+  for (int i=0; i<dfu.numImages(); i++) {
+    for (int e=0; e<dfu.image(i).numElements(); e++) {
+      const DFUFile::Element &element = dfu.image(i).element(e);
+      uint32_t offset = dfu.fileOffset(i, e);
+      if (offset > pos)
+        segments.append(QJsonObject{{"data", QString(raw.mid(pos, offset-pos).toBase64())}});
+      uint32_t size = element.data().size();
+      for (uint32_t o=0; o<size; o+=BLOCK_SIZE) {
+        uint32_t n = std::min(uint32_t(BLOCK_SIZE), size-o);
+        bool isNew;
+        QString hash = storeBlock(raw.mid(offset+o, n), isNew);
+        if (hash.isEmpty())
+          return false;
+        segments.append(QJsonObject{{"image", i}, {"address", double(element.address()+o)},
+                                    {"size", double(n)}, {"block", hash}});
+        blocks++; stored += (isNew ? 1 : 0);
+      }
+      pos = offset+size;
+    }
+  }
+  segments.append(QJsonObject{{"data", QString(raw.mid(pos).toBase64())}});
+
+  QJsonObject manifest;
+  manifest.insert("version", MANIFEST_VERSION);
+  manifest.insert("name", entry);
+  manifest.insert("source", QFileInfo(filename).absoluteFilePath());
+  manifest.insert("added", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+  manifest.insert("size", double(raw.size()));
+  manifest.insert("blocks", double(blocks));
+  manifest.insert("sha1",
+                  QString(QCryptographicHash::hash(raw, QCryptographicHash::Sha1).toHex()));
+  manifest.insert("segments", segments);
+
+  QSaveFile out(manifestPath(entry));
+  if ((! out.open(QIODevice::WriteOnly)) ||
+      (0 > out.write(QJsonDocument(manifest).toJson(QJsonDocument::Compact))) ||
+      (! out.commit())) {
+    _errorMessage = tr("Cannot write manifest of '%1': %2").arg(entry, out.errorString());
+    return false;
+  }
+
+  logDebug() << "Archived '" << filename << "' as '" << entry << "': " << stored << " of "
+             << blocks << " blocks stored.";
+  return true;
+}
+
+bool
+CodeplugArchive::list(QList<Entry> &entries) {
+  QDir manifests(_directory.filePath("manifests"));
+  QFileInfoList files = manifests.entryInfoList(QStringList("*.json"), QDir::Files, QDir::Name);
+  foreach (const QFileInfo &info, files) {
+    QJsonObject manifest;
+    if (! loadManifest(info.completeBaseName(), manifest))
+      return false;
+    Entry entry;
+    entry.name = manifest.value("name").toString();
+    entry.source = manifest.value("source").toString();
+    entry.added = QDateTime::fromString(manifest.value("added").toString(), Qt::ISODate);
+    entry.size = manifest.value("size").toDouble();
+    entry.blocks = manifest.value("blocks").toDouble();
+    entries.append(entry);
+  }
+  return true;
+}
+
+bool
+CodeplugArchive::extract(const QString &name, const QString &filename) {
+  QJsonObject manifest;
+  if (! loadManifest(name, manifest))
+    return false;
+
+  QSaveFile file(filename);
+  if (! file.open(QIODevice::WriteOnly)) {
+    _errorMessage = tr("Cannot create '%1': %2").arg(filename, file.errorString());
+    return false;
+  }
+
+  // Rebuild the file segment by segment, only a single block is kept in memory
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  foreach (const QJsonValue &value, manifest.value("segments").toArray()) {
+    QJsonObject segment = value.toObject();
+    QByteArray data;
+    if (segment.contains("block")) {
+      if (! loadBlock(segment.value("block").toString(), data))
+        return false;
+    } else {
+      data = QByteArray::fromBase64(segment.value("data").toString().toLatin1());
+    }
+    hash.addData(data);
+    if (data.size() != file.write(data)) {
+      _errorMessage = tr("Cannot write '%1': %2").arg(filename, file.errorString());
+      return false;
+    }
+  }
+
+  if (hash.result().toHex() != manifest.value("sha1").toString().toLatin1()) {
+    _errorMessage = tr("Rebuilt file '%1' does not match the archived one.").arg(name);
+    return false;
+  }
+
+  if (! file.commit()) {
+    _errorMessage = tr("Cannot write '%1': %2").arg(filename, file.errorString());
+    return false;
+  }
+  return true;
+}
+
+bool
+CodeplugArchive::diff(const QString &a, const QString &b, QList<Difference> &differences) {
+  QJsonObject manifestA, manifestB;
+  if ((! loadManifest(a, manifestA)) || (! loadManifest(b, manifestB)))
+    return false;
+
+  QMap<QPair<int, uint32_t>, BlockRef> refsA = blockRefs(manifestA), refsB = blockRefs(manifestB);
+  QList<QPair<int, uint32_t>> keys = refsA.keys() + refsB.keys();
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+  foreach (const auto &key, keys) {
+    // Blocks present in one file only differ completely
+    if (! refsB.contains(key)) {
+      appendDifference(differences, key.first, key.second, refsA[key].size);
+      continue;
+    } else if (! refsA.contains(key)) {
+      appendDifference(differences, key.first, key.second, refsB[key].size);
+      continue;
+    }
+
+    const BlockRef &ra = refsA[key], &rb = refsB[key];
+    if (ra.hash == rb.hash)
+      continue;
+
+    // Only blocks with different hashes are read and compared byte by byte
+    QByteArray da, db;
+    if ((! loadBlock(ra.hash, da)) || (! loadBlock(rb.hash, db)))
+      return false;
+    uint32_t n = std::max(da.size(), db.size());
+    for (uint32_t i=0; i<n; i++) {
+      if ((i < uint32_t(da.size())) && (i < uint32_t(db.size())) && (da.at(i) == db.at(i)))
+        continue;
+      appendDifference(differences, key.first, key.second+i, 1);
+    }
+  }
+
+  return true;
+}
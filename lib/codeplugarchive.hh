@@ -0,0 +1,96 @@
+#ifndef CODEPLUGARCHIVE_HH
+#define CODEPLUGARCHIVE_HH
+
+#include <QObject>
+#include <QDir>
+#include <QDateTime>
+#include <QJsonObject>
+
+/** Block-deduplicated store of binary codeplugs (DFU files).
+ *
+ * The codeplugs of radios of a fleet are mostly identical and so are their call-sign DBs. Hence
+ * the archive splits the data of each @c DFUFile::Element into blocks of @c BLOCK_SIZE bytes,
+ * aligned to the start of the element. Each block is stored once, compressed and named by the
+ * SHA1 hash of its content, within the @c blocks sub-directory. For every archived file, a JSON
+ * manifest within the @c manifests sub-directory lists the file headers verbatim followed by
+ * references to the blocks, in file order. Hence any file can be rebuilt byte by byte and two
+ * files can be compared by comparing the block hashes first.
+ *
+ * @ingroup util */
+class CodeplugArchive: public QObject
+{
+  Q_OBJECT
+
+public:
+  /** Size of the blocks in bytes. */
+  static const uint32_t BLOCK_SIZE = 0x1000;
+
+  /** Summary of an archived file. */
+  class Entry {
+  public:
+    /** The name of the archived file. */
+    QString name;
+    /** The path of the file it was archived from. */
+    QString source;
+    /** The time it was added. */
+    QDateTime added;
+    /** The size of the file in bytes. */
+    uint32_t size;
+    /** The number of blocks referenced. */
+    uint blocks;
+
+    /** Default constructor. */
+    Entry();
+  };
+
+  /** A range of bytes that differs between two archived files. */
+  class Difference {
+  public:
+    /** The index of the image within the DFU file. */
+    int image;
+    /** The address of the first differing byte. */
+    uint32_t address;
+    /** The number of differing bytes. */
+    uint32_t size;
+
+    /** Constructor. */
+    Difference(int img=0, uint32_t addr=0, uint32_t n=0);
+  };
+
+public:
+  /** Opens (and creates if needed) the archive at the given directory. */
+  explicit CodeplugArchive(const QString &path, QObject *parent=nullptr);
+
+  /** Returns the error message in case of an error. */
+  const QString &errorMessage() const;
+
+  /** Adds the specified DFU file to the archive using the given name. If the name is empty, the
+   * base name of the file is used. An archived file of the same name gets replaced. */
+  bool add(const QString &filename, const QString &name=QString());
+  /** Lists all archived files. */
+  bool list(QList<Entry> &entries);
+  /** Rebuilds the archived file @c name as @c filename. */
+  bool extract(const QString &name, const QString &filename);
+  /** Compares the archived files @c a and @c b. Only blocks with differing hashes are read. */
+  bool diff(const QString &a, const QString &b, QList<Difference> &differences);
+
+protected:
+  /** Stores the given block unless present and returns its hash. */
+  QString storeBlock(const QByteArray &data, bool &stored);
+  /** Reads the block with the given hash. */
+  bool loadBlock(const QString &hash, QByteArray &data);
+  /** Returns the path of the block with the given hash. */
+  QString blockPath(const QString &hash) const;
+  /** Returns the path of the manifest of the given archived file. */
+  QString manifestPath(const QString &name) const;
+  /** Reads the manifest of the given archived file. */
+  bool loadManifest(const QString &name, QJsonObject &manifest);
+
+protected:
+  /** The archive directory. */
+  QDir _directory;
+  /** Holds the error message. */
+  QString _errorMessage;
+};
+
+#endif // CODEPLUGARCHIVE_HH
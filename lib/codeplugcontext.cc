@@ -53,11 +53,30 @@ CodeplugContext::addDigitalContact(DigitalContact *con, int index) {
   return true;
 }
 
+bool
+CodeplugContext::addDigitalContacts(const QVector<int> &indices, ContactList::Loader *loader) {
+  foreach (int index, indices) {
+    if (_digitalContactTable.contains(index)) {
+      delete loader;
+      return false;
+    }
+  }
+  int cidx = _config->contacts()->addDeferred(indices.size(), loader);
+  for (int i=0; i<indices.size(); i++)
+    _digitalContactTable[indices[i]] = cidx+i;
+  return true;
+}
+
 DigitalContact *
 CodeplugContext::getDigitalContact(int index) const {
   if (! _digitalContactTable.contains(index))
     return nullptr;
-  return _config->contacts()->digitalContact(_digitalContactTable[index]);
+  // Table holds the row within all contacts, this also avoids to construct all deferred
+  // contacts in front of the requested one.
+  Contact *contact = _config->contacts()->contact(_digitalContactTable[index]);
+  if (nullptr == contact)
+    return nullptr;
+  return contact->as<DigitalContact>();
 }
 
 
@@ -30,6 +30,11 @@ public:
   bool hasDigitalContact(int index) const;
   /** Adds a digital contact to the config and maps the given index to that contact. */
   bool addDigitalContact(DigitalContact *con, int index);
+  /** Adds deferred digital contacts to the config and maps the given indices to these contacts.
+   * The i-th index is mapped to the i-th contact constructed by the given @c loader. The contact
+   * objects are created once they are accessed, e.g., when linking channels or group lists.
+   * The config takes the ownership of the loader. */
+  bool addDigitalContacts(const QVector<int> &indices, ContactList::Loader *loader);
   /** Gets a digital contact for the specified index or @c nullptr if not defined. */
   DigitalContact *getDigitalContact(int index) const;
 
@@ -7,7 +7,9 @@
 #include <cmath>
 #include "csvreader.hh"
 #include "csvwriter.hh"
+#include "configsnapshot.hh"
 #include "userdatabase.hh"
+#include "logger.hh"
 
 
 /* ********************************************************************************************* *
@@ -18,7 +20,7 @@ Config::Config(QObject *parent)
     _channels(new ChannelList(this)), _zones(new ZoneList(this)), _scanlists(new ScanLists(this)),
     _gpsSystems(new PositioningSystems(this)), _roaming(new RoamingZoneList(this)),
     _id(0), _name(), _introLine1(), _introLine2(), _mic_level(2),
-    _speech(false)
+    _speech(false), _snapshot()
 {
   connect(_contacts, SIGNAL(modified()), this, SIGNAL(modified()));
   connect(_rxGroupLists, SIGNAL(modified()), this, SIGNAL(modified()));
@@ -28,6 +30,17 @@ Config::Config(QObject *parent)
   connect(_gpsSystems, SIGNAL(modified()), this, SIGNAL(modified()));
   connect(_roaming, SIGNAL(modified()), this, SIGNAL(modified()));
   connect(this, SIGNAL(modified()), this, SLOT(onConfigModified()));
+  // Channels refer to objects of these lists
+  connect(_contacts, SIGNAL(rowsAboutToBeRemoved(QModelIndex,int,int)),
+          this, SLOT(onRowsAboutToBeRemoved(QModelIndex,int,int)));
+  connect(_rxGroupLists, SIGNAL(rowsAboutToBeRemoved(QModelIndex,int,int)),
+          this, SLOT(onRowsAboutToBeRemoved(QModelIndex,int,int)));
+  connect(_scanlists, SIGNAL(rowsAboutToBeRemoved(QModelIndex,int,int)),
+          this, SLOT(onRowsAboutToBeRemoved(QModelIndex,int,int)));
+  connect(_gpsSystems, SIGNAL(rowsAboutToBeRemoved(QModelIndex,int,int)),
+          this, SLOT(onRowsAboutToBeRemoved(QModelIndex,int,int)));
+  connect(_roaming, SIGNAL(rowsAboutToBeRemoved(QModelIndex,int,int)),
+          this, SLOT(onRowsAboutToBeRemoved(QModelIndex,int,int)));
 }
 
 bool
@@ -184,6 +197,7 @@ Config::setSpeech(bool enabled) {
 
 void
 Config::reset() {
+  _snapshot.clear();
   // Reset lists
   _scanlists->clear();
   _zones->clear();
@@ -204,6 +218,27 @@ Config::reset() {
 void
 Config::onConfigModified() {
   _modified = true;
+  // Snapshots taken before stay valid, they are implicitly shared copies
+  _snapshot.clear();
+}
+
+void
+Config::onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last) {
+  Q_UNUSED(parent);
+  for (int i=first; i<=last; i++) {
+    QObject *obj = nullptr;
+    if (sender() == _contacts)
+      obj = _contacts->contact(i);
+    else if (sender() == _rxGroupLists)
+      obj = _rxGroupLists->list(i);
+    else if (sender() == _scanlists)
+      obj = _scanlists->scanlist(i);
+    else if (sender() == _gpsSystems)
+      obj = _gpsSystems->system(i);
+    else if (sender() == _roaming)
+      obj = _roaming->zone(i);
+    _channels->resetReferences(obj);
+  }
 }
 
 bool
@@ -246,4 +281,43 @@ Config::writeCSV(QTextStream &stream, QString &errorMessage)
   return true;
 }
 
+bool
+Config::readSnapshot(const QString &filename, QString &errorMessage) {
+  if (! ConfigSnapshot::read(this, filename, errorMessage))
+    return false;
+  _modified = false;
+  return true;
+}
 
+QByteArray
+Config::snapshot() const {
+  if (! _snapshot.isEmpty())
+    return _snapshot;
+
+  QString errorMessage;
+  if (! ConfigSnapshot::write(this, _snapshot, errorMessage)) {
+    logError() << "Cannot take snapshot of config: " << errorMessage;
+    _snapshot.clear();
+  }
+  return _snapshot;
+}
+
+Config *
+Config::fromSnapshot(const QByteArray &snapshot, QString &errorMessage, QObject *parent) {
+  Config *config = new Config(parent);
+  if (! ConfigSnapshot::read(config, (const uchar *)snapshot.constData(), snapshot.size(),
+                             errorMessage)) {
+    delete config;
+    return nullptr;
+  }
+  config->setModified(false);
+  return config;
+}
+
+bool
+Config::writeSnapshot(const QString &filename, QString &errorMessage) {
+  if (! ConfigSnapshot::write(this, filename, errorMessage))
+    return false;
+  _modified = false;
+  return true;
+}
@@ -102,6 +102,24 @@ public:
   /** Exports the configuration to the given text stream in text format. */
   bool writeCSV(QTextStream &stream, QString &errorMessage);
 
+  /** Imports a configuration from the given binary snapshot file, see @c ConfigSnapshot. */
+  bool readSnapshot(const QString &filename, QString &errorMessage);
+  /** Exports the configuration to the given binary snapshot file, see @c ConfigSnapshot. */
+  bool writeSnapshot(const QString &filename, QString &errorMessage);
+
+  /** Returns an immutable snapshot of the configuration, see @c ConfigSnapshot.
+   *
+   * The snapshot is implicitly shared and gets serialized at most once per modification. Hence,
+   * taking snapshots of an unmodified configuration is cheap. Snapshots can be handed to other
+   * threads and loaded there using @c fromSnapshot (e.g., to encode, verify or export the
+   * configuration), while this configuration is still being edited. Must be called from the
+   * thread owning this configuration. Returns an empty array on error. */
+  QByteArray snapshot() const;
+  /** Creates a new configuration from the given snapshot, see @c snapshot. Returns @c nullptr on
+   * error. */
+  static Config *fromSnapshot(const QByteArray &snapshot, QString &errorMessage,
+                              QObject *parent=nullptr);
+
 signals:
   /** Gets emitted if the configuration gets changed. */
 	void modified();
@@ -109,6 +127,9 @@ signals:
 protected slots:
   /** Iternal callback. */
   void onConfigModified();
+  /** Internal callback, resets the references of the channels to objects being removed from the
+   * other lists. */
+  void onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
 
 protected:
   /** If @c true, the configuration was modified. */
@@ -140,6 +161,8 @@ protected:
   uint _mic_level;
   /** If @c true, speech synthesis is enabled. */
   bool _speech;
+  /** The last snapshot, gets cleared on every modification. */
+  mutable QByteArray _snapshot;
 };
 
 #endif // CONFIG_HH
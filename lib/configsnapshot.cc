@@ -0,0 +1,656 @@
+#include "configsnapshot.hh"
+#include "config.hh"
+#include "logger.hh"
+#include <QFile>
+#include <QHash>
+#include <QVector>
+#include <QtEndian>
+
+#define SNAPSHOT_MAGIC       "QDMRSNAP"  // Magic bytes at the beginning of each snapshot
+#define SNAPSHOT_SUFFIX      ".dmrb"     // File extension of snapshots
+#define HEADER_SIZE          16          // Size of the snapshot header
+
+#define REF_NONE             0xffffffff  // No reference
+#define REF_SPECIAL          0xfffffffe  // Selected channel or default roaming zone
+
+#define CONTACT_DTMF         0x00
+#define CONTACT_DIGITAL      0x01
+#define CHANNEL_ANALOG       0x00
+#define CHANNEL_DIGITAL      0x01
+#define POSSYS_GPS           0x00
+#define POSSYS_APRS          0x01
+
+
+/// @cond with_internal_docs
+/** Assembles the string table and body of a snapshot. */
+class SnapshotWriter
+{
+public:
+  SnapshotWriter() : _strings(), _stringIndex(), _body() {
+    // pass...
+  }
+
+  void u8(uint8_t value) {
+    _body.append(char(value));
+  }
+
+  void u32(uint32_t value) {
+    uchar buffer[4]; qToLittleEndian(value, buffer);
+    _body.append((const char *)buffer, sizeof(buffer));
+  }
+
+  void i64(qint64 value) {
+    uchar buffer[8]; qToLittleEndian(value, buffer);
+    _body.append((const char *)buffer, sizeof(buffer));
+  }
+
+  void str(const QString &value) {
+    QHash<QString, uint32_t>::const_iterator it = _stringIndex.find(value);
+    if (_stringIndex.end() == it) {
+      it = _stringIndex.insert(value, _strings.size());
+      _strings.append(value);
+    }
+    u32(it.value());
+  }
+
+  void ref(const QHash<const QObject *, uint32_t> &index, const QObject *obj) {
+    u32((nullptr == obj) ? REF_NONE : index.value(obj, REF_NONE));
+  }
+
+  QByteArray finish() const {
+    QByteArray table;
+    uchar buffer[4];
+    qToLittleEndian(uint32_t(_strings.size()), buffer);
+    table.append((const char *)buffer, sizeof(buffer));
+    foreach (const QString &s, _strings) {
+      QByteArray utf8 = s.toUtf8();
+      qToLittleEndian(uint32_t(utf8.size()), buffer);
+      table.append((const char *)buffer, sizeof(buffer));
+      table.append(utf8);
+    }
+
+    QByteArray data(HEADER_SIZE, 0x00);
+    memcpy(data.data(), SNAPSHOT_MAGIC, 8);
+    qToLittleEndian(uint16_t(ConfigSnapshot::VERSION), (uchar *)data.data()+0x08);
+    qToLittleEndian(uint32_t(HEADER_SIZE+table.size()+_body.size()), (uchar *)data.data()+0x0c);
+    data.append(table);
+    data.append(_body);
+    return data;
+  }
+
+protected:
+  QVector<QString> _strings;
+  QHash<QString, uint32_t> _stringIndex;
+  QByteArray _body;
+};
+
+
+/** Linear, bounds-checked reader over the memory of a snapshot. */
+class SnapshotReader
+{
+public:
+  SnapshotReader(const uchar *data, qint64 size)
+    : _ptr(data), _end(data+size), _ok(true), _strings()
+  {
+    // pass...
+  }
+
+  bool ok() const { return _ok; }
+
+  uint8_t u8() {
+    if (! take(1)) return 0;
+    return _ptr[-1];
+  }
+
+  uint32_t u32() {
+    if (! take(4)) return 0;
+    return qFromLittleEndian<uint32_t>(_ptr-4);
+  }
+
+  qint64 i64() {
+    if (! take(8)) return 0;
+    return qFromLittleEndian<qint64>(_ptr-8);
+  }
+
+  /** Reads the number of records of a list. Each record takes at least one byte, hence larger
+   * counts indicate a corrupt snapshot. */
+  int count() {
+    uint32_t n = u32();
+    if (qint64(n) > (_end-_ptr)) {
+      _ok = false;
+      return 0;
+    }
+    return n;
+  }
+
+  bool readStrings() {
+    uint32_t n = u32();
+    // Each string takes at least 4 bytes, avoids huge allocations on corrupt files
+    if ((! _ok) || (qint64(n)*4 > (_end-_ptr)))
+      return _ok = false;
+    _strings.reserve(n);
+    for (uint32_t i=0; i<n; i++) {
+      uint32_t len = u32();
+      if (! take(len))
+        return false;
+      _strings.append(QString::fromUtf8((const char *)_ptr-len, len));
+    }
+    return true;
+  }
+
+  QString str() {
+    uint32_t idx = u32();
+    if (idx >= uint32_t(_strings.size())) {
+      _ok = false;
+      return QString();
+    }
+    return _strings[idx];
+  }
+
+protected:
+  bool take(qint64 n) {
+    if ((! _ok) || ((_end-_ptr) < n))
+      return _ok = false;
+    _ptr += n;
+    return true;
+  }
+
+protected:
+  const uchar *_ptr;
+  const uchar *_end;
+  bool _ok;
+  QVector<QString> _strings;
+};
+/// @endcond
+
+
+/* ********************************************************************************************* *
+ * Implementation of ConfigSnapshot
+ * ********************************************************************************************* */
+bool
+ConfigSnapshot::isSnapshotFile(const QString &filename) {
+  return filename.endsWith(SNAPSHOT_SUFFIX);
+}
+
+bool
+ConfigSnapshot::write(const Config *config, QByteArray &data, QString &errorMessage) {
+  Q_UNUSED(errorMessage);
+
+  // Index all objects once, avoids the linear search of indexOf() for every reference
+  QHash<const QObject *, uint32_t> contacts, groupLists, channels, scanLists, posSystems, roaming;
+  for (int i=0; i<config->contacts()->count(); i++)
+    contacts[config->contacts()->contact(i)] = i;
+  for (int i=0; i<config->rxGroupLists()->count(); i++)
+    groupLists[config->rxGroupLists()->list(i)] = i;
+  for (int i=0; i<config->channelList()->count(); i++)
+    channels[config->channelList()->channel(i)] = i;
+  channels[SelectedChannel::get()] = REF_SPECIAL;
+  for (int i=0; i<config->scanlists()->count(); i++)
+    scanLists[config->scanlists()->scanlist(i)] = i;
+  for (int i=0; i<config->posSystems()->count(); i++)
+    posSystems[config->posSystems()->system(i)] = i;
+  for (int i=0; i<config->roaming()->count(); i++)
+    roaming[config->roaming()->zone(i)] = i;
+  roaming[DefaultRoamingZone::get()] = REF_SPECIAL;
+
+  SnapshotWriter w;
+
+  // General settings
+  w.u32(config->id());
+  w.str(config->name());
+  w.str(config->introLine1());
+  w.str(config->introLine2());
+  w.u8(config->micLevel());
+  w.u8(config->speech() ? 1 : 0);
+
+  // Contacts
+  w.u32(config->contacts()->count());
+  for (int i=0; i<config->contacts()->count(); i++) {
+    Contact *contact = config->contacts()->contact(i);
+    if (contact->is<DigitalContact>()) {
+      w.u8(CONTACT_DIGITAL);
+      w.str(contact->name());
+      w.u8(contact->rxTone() ? 1 : 0);
+      w.u8(contact->as<DigitalContact>()->type());
+      w.u32(contact->as<DigitalContact>()->number());
+    } else {
+      w.u8(CONTACT_DTMF);
+      w.str(contact->name());
+      w.u8(contact->rxTone() ? 1 : 0);
+      w.str(contact->as<DTMFContact>()->number());
+    }
+  }
+
+  // RX group lists
+  w.u32(config->rxGroupLists()->count());
+  for (int i=0; i<config->rxGroupLists()->count(); i++) {
+    RXGroupList *list = config->rxGroupLists()->list(i);
+    w.str(list->name());
+    w.u32(list->count());
+    for (int j=0; j<list->count(); j++)
+      w.ref(contacts, list->contact(j));
+  }
+
+  // Channels
+  w.u32(config->channelList()->count());
+  for (int i=0; i<config->channelList()->count(); i++) {
+    Channel *channel = config->channelList()->channel(i);
+    w.u8(channel->is<DigitalChannel>() ? CHANNEL_DIGITAL : CHANNEL_ANALOG);
+    w.str(channel->name());
+    w.i64(channel->rxFrequencyHz());
+    w.i64(channel->txFrequencyHz());
+    w.u8(channel->power());
+    w.u32(channel->txTimeout());
+    w.u8(channel->rxOnly() ? 1 : 0);
+    w.ref(scanLists, channel->scanList());
+    if (channel->is<DigitalChannel>()) {
+      DigitalChannel *digi = channel->as<DigitalChannel>();
+      w.u8(digi->admit());
+      w.u8(digi->colorCode());
+      w.u8(digi->timeslot());
+      w.ref(groupLists, digi->rxGroupList());
+      w.ref(contacts, digi->txContact());
+      w.ref(posSystems, digi->posSystem());
+      w.ref(roaming, digi->roaming());
+    } else {
+      AnalogChannel *analog = channel->as<AnalogChannel>();
+      w.u8(analog->admit());
+      w.u8(analog->squelch());
+      w.u32(analog->rxTone());
+      w.u32(analog->txTone());
+      w.u8(analog->bandwidth());
+      w.ref(posSystems, analog->aprsSystem());
+    }
+  }
+
+  // Zones
+  w.u32(config->zones()->count());
+  for (int i=0; i<config->zones()->count(); i++) {
+    Zone *zone = config->zones()->zone(i);
+    w.str(zone->name());
+    w.u32(zone->A()->count());
+    for (int j=0; j<zone->A()->count(); j++)
+      w.ref(channels, zone->A()->channel(j));
+    w.u32(zone->B()->count());
+    for (int j=0; j<zone->B()->count(); j++)
+      w.ref(channels, zone->B()->channel(j));
+  }
+
+  // Scan lists
+  w.u32(config->scanlists()->count());
+  for (int i=0; i<config->scanlists()->count(); i++) {
+    ScanList *list = config->scanlists()->scanlist(i);
+    w.str(list->name());
+    w.ref(channels, list->priorityChannel());
+    w.ref(channels, list->secPriorityChannel());
+    w.ref(channels, list->txChannel());
+    w.u32(list->count());
+    for (int j=0; j<list->count(); j++)
+      w.ref(channels, list->channel(j));
+  }
+
+  // Positioning systems
+  w.u32(config->posSystems()->count());
+  for (int i=0; i<config->posSystems()->count(); i++) {
+    PositioningSystem *sys = config->posSystems()->system(i);
+    if (sys->is<GPSSystem>()) {
+      GPSSystem *gps = sys->as<GPSSystem>();
+      w.u8(POSSYS_GPS);
+      w.str(gps->name());
+      w.ref(contacts, gps->contact());
+      w.ref(channels, gps->revertChannel());
+      w.u32(gps->period());
+    } else {
+      APRSSystem *aprs = sys->as<APRSSystem>();
+      w.u8(POSSYS_APRS);
+      w.str(aprs->name());
+      w.ref(channels, aprs->channel());
+      w.u32(aprs->period());
+      w.str(aprs->source());
+      w.u8(aprs->srcSSID());
+      w.str(aprs->destination());
+      w.u8(aprs->destSSID());
+      w.str(aprs->path());
+      w.u32(aprs->icon());
+      w.str(aprs->message());
+    }
+  }
+
+  // Roaming zones
+  w.u32(config->roaming()->count());
+  for (int i=0; i<config->roaming()->count(); i++) {
+    RoamingZone *zone = config->roaming()->zone(i);
+    w.str(zone->name());
+    w.u32(zone->count());
+    for (int j=0; j<zone->count(); j++)
+      w.ref(channels, zone->channel(j));
+  }
+
+  data = w.finish();
+  return true;
+}
+
+bool
+ConfigSnapshot::write(const Config *config, const QString &filename, QString &errorMessage) {
+  QByteArray data;
+  if (! write(config, data, errorMessage))
+    return false;
+
+  QFile file(filename);
+  if (! file.open(QIODevice::WriteOnly)) {
+    errorMessage = QString("Cannot open file %1: %2").arg(filename).arg(file.errorString());
+    return false;
+  }
+  if (data.size() != file.write(data)) {
+    errorMessage = QString("Cannot write snapshot %1: %2").arg(filename).arg(file.errorString());
+    return false;
+  }
+  file.close();
+  return true;
+}
+
+
+bool
+ConfigSnapshot::read(Config *config, const uchar *data, qint64 size, QString &errorMessage) {
+  // Check header
+  if ((HEADER_SIZE > size) || (0 != memcmp(data, SNAPSHOT_MAGIC, 8))) {
+    errorMessage = QString("Cannot read snapshot: Not a qdmr snapshot.");
+    return false;
+  }
+  uint16_t version = qFromLittleEndian<uint16_t>(data+0x08);
+  if (VERSION != version) {
+    errorMessage = QString("Cannot read snapshot: Unsupported version %1, expected %2.")
+        .arg(version).arg(VERSION);
+    return false;
+  }
+  if (qFromLittleEndian<uint32_t>(data+0x0c) != size) {
+    errorMessage = QString("Cannot read snapshot: Snapshot truncated.");
+    return false;
+  }
+
+  SnapshotReader r(data+HEADER_SIZE, size-HEADER_SIZE);
+  if (! r.readStrings()) {
+    errorMessage = QString("Cannot read snapshot: Invalid string table.");
+    return false;
+  }
+
+  // The snapshot is read into new objects first. The config is only replaced, once the complete
+  // snapshot has been read.
+  QVector<Contact *> contacts;
+  QVector<RXGroupList *> groupLists;
+  QVector<Channel *> channels;
+  QVector<Zone *> zones;
+  QVector<ScanList *> scanLists;
+  QVector<PositioningSystem *> posSystems;
+  QVector<RoamingZone *> roaming;
+  auto fail = [&](const QString &message) {
+    errorMessage = QString("Cannot read snapshot: %1").arg(message);
+    // Delete the objects referring to others first
+    qDeleteAll(roaming); qDeleteAll(posSystems); qDeleteAll(scanLists); qDeleteAll(zones);
+    qDeleteAll(channels); qDeleteAll(groupLists); qDeleteAll(contacts);
+    return false;
+  };
+
+  // General settings
+  uint32_t id = r.u32();
+  QString radioName = r.str(), introLine1 = r.str(), introLine2 = r.str();
+  uint micLevel = r.u8();
+  bool speech = r.u8();
+
+  // Contacts
+  contacts.resize(r.count());
+  for (int i=0; r.ok() && (i<contacts.size()); i++) {
+    uint8_t type = r.u8();
+    QString name = r.str();
+    bool rxTone = r.u8();
+    if (CONTACT_DIGITAL == type) {
+      uint8_t callType = r.u8();
+      if (DigitalContact::AllCall < callType)
+        return fail(QString("Invalid call type %1 of contact '%2'.").arg(callType).arg(name));
+      contacts[i] = new DigitalContact(DigitalContact::Type(callType), name, r.u32(), rxTone);
+    } else {
+      contacts[i] = new DTMFContact(name, r.str(), rxTone);
+    }
+  }
+
+  // RX group lists, contacts are already known
+  groupLists.resize(r.count());
+  for (int i=0; r.ok() && (i<groupLists.size()); i++) {
+    groupLists[i] = new RXGroupList(r.str());
+    for (int j=0, n=r.count(); r.ok() && (j<n); j++) {
+      uint32_t idx = r.u32();
+      if ((idx >= uint32_t(contacts.size())) || (nullptr == contacts[idx]) ||
+          (! contacts[idx]->is<DigitalContact>()))
+        return fail(QString("Invalid contact %1 in group list '%2'.")
+                    .arg(idx).arg(groupLists[i]->name()));
+      groupLists[i]->addContact(contacts[idx]->as<DigitalContact>());
+    }
+  }
+
+  // Channels, references to scan lists, positioning systems and roaming zones are resolved
+  // once these are read.
+  channels.resize(r.count());
+  QVector<uint32_t> scanRefs(channels.size()), posRefs(channels.size()), roamRefs(channels.size());
+  for (int i=0; r.ok() && (i<channels.size()); i++) {
+    uint8_t type = r.u8();
+    QString name = r.str();
+    Frequency rx = r.i64(), tx = r.i64();
+    uint8_t power = r.u8();
+    uint tot = r.u32();
+    bool rxOnly = r.u8();
+    scanRefs[i] = r.u32();
+    if (Channel::MinPower < power)
+      return fail(QString("Invalid power %1 of channel '%2'.").arg(power).arg(name));
+    if (CHANNEL_DIGITAL == type) {
+      uint8_t admit = r.u8();
+      uint cc = r.u8();
+      uint8_t ts = r.u8();
+      uint32_t gl = r.u32(), contact = r.u32();
+      posRefs[i] = r.u32(); roamRefs[i] = r.u32();
+      if ((DigitalChannel::AdmitColorCode < admit) || (DigitalChannel::TimeSlot2 < ts))
+        return fail(QString("Invalid admit criterion or time slot of channel '%1'.").arg(name));
+      if (((REF_NONE != gl) && (gl >= uint32_t(groupLists.size()))) ||
+          ((REF_NONE != contact) && ((contact >= uint32_t(contacts.size())) ||
+                                     (nullptr == contacts[contact]) ||
+                                     (! contacts[contact]->is<DigitalContact>()))))
+        return fail(QString("Invalid reference in channel '%1'.").arg(name));
+      channels[i] = new DigitalChannel(
+            name, hz2mhz(rx), hz2mhz(tx), Channel::Power(power), tot, rxOnly,
+            DigitalChannel::Admit(admit), cc, DigitalChannel::TimeSlot(ts),
+            (REF_NONE == gl) ? nullptr : groupLists[gl],
+            (REF_NONE == contact) ? nullptr : contacts[contact]->as<DigitalContact>(),
+            nullptr, nullptr, nullptr);
+    } else {
+      uint8_t admit = r.u8();
+      uint squelch = r.u8();
+      uint32_t rxTone = r.u32(), txTone = r.u32();
+      uint8_t bw = r.u8();
+      posRefs[i] = r.u32(); roamRefs[i] = REF_NONE;
+      if ((AnalogChannel::AdmitTone < admit) || (AnalogChannel::BWWide < bw))
+        return fail(QString("Invalid admit criterion or bandwidth of channel '%1'.").arg(name));
+      if ((uint32_t(Signaling::DCS_754I) < rxTone) || (uint32_t(Signaling::DCS_754I) < txTone))
+        return fail(QString("Invalid sub tone of channel '%1'.").arg(name));
+      channels[i] = new AnalogChannel(
+            name, hz2mhz(rx), hz2mhz(tx), Channel::Power(power), tot, rxOnly,
+            AnalogChannel::Admit(admit), squelch, Signaling::Code(rxTone),
+            Signaling::Code(txTone), AnalogChannel::Bandwidth(bw), nullptr);
+    }
+  }
+
+  // Resolves a channel reference, REF_SPECIAL refers to the selected channel.
+  auto channel = [&channels](uint32_t idx, bool &ok) -> Channel * {
+    if (REF_NONE == idx)
+      return nullptr;
+    if (REF_SPECIAL == idx)
+      return SelectedChannel::get();
+    if (idx >= uint32_t(channels.size())) {
+      ok = false;
+      return nullptr;
+    }
+    return channels[idx];
+  };
+  // Resolves a list member, members must refer to a channel.
+  auto member = [&channel](uint32_t idx, bool &ok) -> Channel * {
+    Channel *ch = channel(idx, ok);
+    if (nullptr == ch)
+      ok = false;
+    return ch;
+  };
+  bool refsOk = true;
+
+  // Zones
+  zones.resize(r.count());
+  for (int i=0; r.ok() && (i<zones.size()); i++) {
+    zones[i] = new Zone(r.str());
+    for (int j=0, n=r.count(); r.ok() && refsOk && (j<n); j++) {
+      if (Channel *ch = member(r.u32(), refsOk))
+        zones[i]->A()->addChannel(ch);
+    }
+    for (int j=0, n=r.count(); r.ok() && refsOk && (j<n); j++) {
+      if (Channel *ch = member(r.u32(), refsOk))
+        zones[i]->B()->addChannel(ch);
+    }
+  }
+
+  // Scan lists
+  scanLists.resize(r.count());
+  for (int i=0; r.ok() && refsOk && (i<scanLists.size()); i++) {
+    scanLists[i] = new ScanList(r.str());
+    scanLists[i]->setPriorityChannel(channel(r.u32(), refsOk));
+    scanLists[i]->setSecPriorityChannel(channel(r.u32(), refsOk));
+    scanLists[i]->setTXChannel(channel(r.u32(), refsOk));
+    for (int j=0, n=r.count(); r.ok() && refsOk && (j<n); j++) {
+      if (Channel *ch = member(r.u32(), refsOk))
+        scanLists[i]->addChannel(ch);
+    }
+  }
+
+  // Positioning systems
+  posSystems.resize(r.count());
+  for (int i=0; r.ok() && refsOk && (i<posSystems.size()); i++) {
+    uint8_t type = r.u8();
+    QString name = r.str();
+    if (POSSYS_GPS == type) {
+      uint32_t contact = r.u32();
+      Channel *revert = channel(r.u32(), refsOk);
+      uint period = r.u32();
+      if (((REF_NONE != contact) && ((contact >= uint32_t(contacts.size())) ||
+                                     (! contacts[contact]->is<DigitalContact>()))) ||
+          ((nullptr != revert) && (! revert->is<DigitalChannel>()))) {
+        return fail(QString("Invalid reference in GPS system '%1'.").arg(name));
+      }
+      posSystems[i] = new GPSSystem(
+            name, (REF_NONE == contact) ? nullptr : contacts[contact]->as<DigitalContact>(),
+            (nullptr == revert) ? nullptr : revert->as<DigitalChannel>(), period);
+    } else {
+      Channel *ch = channel(r.u32(), refsOk);
+      uint period = r.u32();
+      QString src = r.str(); uint srcSSID = r.u8();
+      QString dest = r.str(); uint destSSID = r.u8();
+      QString path = r.str();
+      APRSSystem::Icon icon = APRSSystem::Icon(r.u32());
+      QString message = r.str();
+      if ((nullptr != ch) && (! ch->is<AnalogChannel>())) {
+        return fail(QString("Invalid channel in APRS system '%1'.").arg(name));
+      }
+      posSystems[i] = new APRSSystem(name, (nullptr == ch) ? nullptr : ch->as<AnalogChannel>(),
+                                     dest, destSSID, src, srcSSID, path, icon, message, period);
+    }
+  }
+
+  // Roaming zones
+  roaming.resize(r.count());
+  for (int i=0; r.ok() && refsOk && (i<roaming.size()); i++) {
+    roaming[i] = new RoamingZone(r.str());
+    for (int j=0, n=r.count(); r.ok() && refsOk && (j<n); j++) {
+      Channel *ch = member(r.u32(), refsOk);
+      if ((nullptr == ch) || (! ch->is<DigitalChannel>()))
+        refsOk = false;
+      else
+        roaming[i]->addChannel(ch->as<DigitalChannel>());
+    }
+  }
+
+  if (! r.ok())
+    return fail("Unexpected end of data.");
+  if (! refsOk)
+    return fail("Invalid channel reference.");
+
+  // Resolve deferred channel references
+  for (int i=0; i<channels.size(); i++) {
+    if ((REF_NONE != scanRefs[i]) && (scanRefs[i] >= uint32_t(scanLists.size())))
+      return fail(QString("Invalid scan list in channel '%1'.").arg(channels[i]->name()));
+    if ((REF_NONE != posRefs[i]) && (posRefs[i] >= uint32_t(posSystems.size())))
+      return fail(QString("Invalid positioning system in channel '%1'.").arg(channels[i]->name()));
+    if ((REF_NONE != roamRefs[i]) && (REF_SPECIAL != roamRefs[i]) &&
+        (roamRefs[i] >= uint32_t(roaming.size())))
+      return fail(QString("Invalid roaming zone in channel '%1'.").arg(channels[i]->name()));
+
+    if (REF_NONE != scanRefs[i])
+      channels[i]->setScanList(scanLists[scanRefs[i]]);
+    if (channels[i]->is<DigitalChannel>()) {
+      DigitalChannel *digi = channels[i]->as<DigitalChannel>();
+      if (REF_NONE != posRefs[i])
+        digi->setPosSystem(posSystems[posRefs[i]]);
+      if (REF_SPECIAL == roamRefs[i])
+        digi->setRoaming(DefaultRoamingZone::get());
+      else if (REF_NONE != roamRefs[i])
+        digi->setRoaming(roaming[roamRefs[i]]);
+    } else if (REF_NONE != posRefs[i]) {
+      if (! posSystems[posRefs[i]]->is<APRSSystem>())
+        return fail(QString("Positioning system of channel '%1' is not an APRS system.")
+                    .arg(channels[i]->name()));
+      channels[i]->as<AnalogChannel>()->setAPRSSystem(posSystems[posRefs[i]]->as<APRSSystem>());
+    }
+  }
+
+  // Replace the config
+  config->reset();
+  config->setId(id);
+  config->setName(radioName);
+  config->setIntroLine1(introLine1);
+  config->setIntroLine2(introLine2);
+  config->setMicLevel(micLevel);
+  config->setSpeech(speech);
+  foreach (Contact *contact, contacts)
+    config->contacts()->addContact(contact);
+  foreach (RXGroupList *list, groupLists)
+    config->rxGroupLists()->addList(list);
+  foreach (Channel *channel, channels)
+    config->channelList()->addChannel(channel);
+  foreach (Zone *zone, zones)
+    config->zones()->addZone(zone);
+  foreach (ScanList *list, scanLists)
+    config->scanlists()->addScanList(list);
+  foreach (PositioningSystem *sys, posSystems)
+    config->posSystems()->addSystem(sys);
+  foreach (RoamingZone *zone, roaming)
+    config->roaming()->addZone(zone);
+
+  return true;
+}
+
+bool
+ConfigSnapshot::read(Config *config, const QString &filename, QString &errorMessage) {
+  QFile file(filename);
+  if (! file.open(QIODevice::ReadOnly)) {
+    errorMessage = QString("Cannot open file %1: %2").arg(filename).arg(file.errorString());
+    return false;
+  }
+
+  // Map the complete snapshot, fall back to reading it if the file cannot be mapped.
+  QByteArray buffer;
+  const uchar *data = file.map(0, file.size());
+  bool mapped = (nullptr != data);
+  if (! mapped) {
+    logDebug() << "Cannot map snapshot '" << filename << "': " << file.errorString()
+               << ". Read it instead.";
+    buffer = file.readAll();
+    data = (const uchar *)buffer.constData();
+  }
+
+  bool ok = read(config, data, file.size(), errorMessage);
+  if (mapped)
+    file.unmap((uchar *)data);
+  return ok;
+}
@@ -0,0 +1,59 @@
+#ifndef CONFIGSNAPSHOT_HH
+#define CONFIGSNAPSHOT_HH
+
+#include <QString>
+#include <QByteArray>
+
+class Config;
+
+/** Reads and writes the binary snapshot format of a generic configuration.
+ *
+ * Unlike the text format (see @c CSVWriter and @c CSVReader), the snapshot format is meant to be
+ * saved and loaded fast. All strings are stored once in a string table and all references between
+ * objects are stored as indices. Hence, a snapshot can be loaded within a single linear pass over
+ * the (memory mapped) file.
+ *
+ * All values are stored in little-endian byte order:
+ * @verbatim
+ * Header, 16 bytes:
+ *   0x00  magic "QDMRSNAP",
+ *   0x08  format version, 16bit,
+ *   0x0a  reserved, 16bit 0x0000,
+ *   0x0c  total size of the snapshot in bytes, 32bit.
+ * String table:
+ *   count (32bit), then for each string its length in bytes (32bit) followed by the UTF-8 bytes.
+ * General settings:
+ *   id (32bit), name, intro line 1, intro line 2 (string indices, 32bit), mic level (8bit),
+ *   speech (8bit).
+ * Contacts, RX group lists, channels, zones, scan lists, positioning systems and roaming zones:
+ *   each as a count (32bit) followed by the records of the list.
+ * @endverbatim
+ * References to other objects are indices into the respective list, 0xffffffff means no reference
+ * and 0xfffffffe refers to the selected channel or the default roaming zone.
+ *
+ * @ingroup conf */
+class ConfigSnapshot
+{
+public:
+  /** The current format version. */
+  static const uint16_t VERSION = 1;
+
+  /** Returns @c true if the given file name has the snapshot file extension. */
+  static bool isSnapshotFile(const QString &filename);
+
+  /** Serializes the given @c config into a snapshot.
+   * @returns @c true on success. */
+  static bool write(const Config *config, QByteArray &data, QString &errorMessage);
+  /** Serializes the given @c config into the specified file.
+   * @returns @c true on success. */
+  static bool write(const Config *config, const QString &filename, QString &errorMessage);
+
+  /** Reads a snapshot from the given memory and stores it into @c config.
+   * @returns @c true on success. */
+  static bool read(Config *config, const uchar *data, qint64 size, QString &errorMessage);
+  /** Maps the specified file into memory and reads the snapshot into @c config.
+   * @returns @c true on success. */
+  static bool read(Config *config, const QString &filename, QString &errorMessage);
+};
+
+#endif // CONFIGSNAPSHOT_HH
@@ -0,0 +1,381 @@
+#include "configverifier.hh"
+#include "config.hh"
+#include <QTimer>
+
+
+/// @cond with_internal_docs
+/** Reports duplicate names within a list using a hash table. Each name gets reported once. */
+class DuplicateNames
+{
+public:
+  /** Constructor, @c format specifies the message and @c n the expected number of names. */
+  inline DuplicateNames(const QString &format, int n): _format(format) { _names.reserve(n); }
+
+  /** Checks the given name. */
+  inline void check(const QString &name, QList<VerifyIssue> &issues) {
+    int &count = _names[name];
+    if (1 == (count++))
+      issues.append(VerifyIssue(VerifyIssue::WARNING, nullptr, _format, {name}));
+  }
+
+protected:
+  /** The message format. */
+  QString _format;
+  /** Counts the occurences of each name. */
+  QHash<QString, int> _names;
+};
+/// @endcond
+
+
+/* ********************************************************************************************* *
+ * Implementation of ConfigVerifier
+ * ********************************************************************************************* */
+ConfigVerifier::ConfigVerifier(const Radio::Features &features, QObject *parent)
+  : QObject(parent), _features(features), _cache(), _config(nullptr), _pending(false), _issues(),
+    _maxIssue(VerifyIssue::NONE)
+{
+  // pass...
+}
+
+VerifyIssue::Type
+ConfigVerifier::verify(Config *config, QList<VerifyIssue> &issues)
+{
+  // Is still beta?
+  if (_features.betaWarning)
+    issues.append(VerifyIssue(
+                    VerifyIssue::WARNING,
+                    tr("Support for this radio is still new and not well tested. "
+                       "The code-plug might be incomplete, non-functional or even harmful.")));
+
+  /*
+   *  Check general config
+   */
+  if (config->name().size() > _features.maxNameLength)
+    issues.append(VerifyIssue(
+                    VerifyIssue::WARNING, config,
+                    tr("Radio name of length %1 exceeds limit of %2 characters."),
+                    {config->name().size(), _features.maxNameLength}));
+
+  if (config->introLine1().size() > _features.maxIntroLineLength)
+    issues.append(VerifyIssue(
+                    VerifyIssue::WARNING, config,
+                    tr("Intro line 1 of length %1 exceeds limit of %2 characters."),
+                    {config->introLine1().size(), _features.maxIntroLineLength}));
+
+  if (config->introLine2().size() > _features.maxIntroLineLength)
+    issues.append(VerifyIssue(
+                    VerifyIssue::WARNING, config,
+                    tr("Intro line 2 of length %1 exceeds limit of %2 characters."),
+                    {config->introLine2().size(), _features.maxIntroLineLength}));
+
+  /*
+   *  Check contact list
+   */
+  ContactList *contacts = config->contacts();
+  if (contacts->count() > _features.maxContacts)
+    issues.append(VerifyIssue(
+                    VerifyIssue::ERROR, contacts,
+                    tr("Number of contacts %1 exceeds limit of %2."),
+                    {contacts->count(), _features.maxContacts}));
+
+  DuplicateNames contactNames(tr("Duplicate contact name '%1'."), contacts->count());
+  for (int i=0; i<contacts->count(); i++) {
+    Contact *contact = contacts->contact(i);
+    contactNames.check(contact->name(), issues);
+    verifyObject(contact, &ConfigVerifier::verifyContact, issues);
+  }
+
+  /*
+   *  Check RX group lists.
+   */
+  RXGroupLists *groupLists = config->rxGroupLists();
+  if (groupLists->count() > _features.maxGrouplists)
+    issues.append(VerifyIssue(
+                    VerifyIssue::ERROR, groupLists,
+                    tr("Number of Rx group lists %1 exceeds limit of %2"),
+                    {groupLists->count(), _features.maxGrouplists}));
+
+  DuplicateNames groupListNames(tr("Duplicate Rx group list name '%1'."), groupLists->count());
+  for (int i=0; i<groupLists->count(); i++) {
+    RXGroupList *list = groupLists->list(i);
+    groupListNames.check(list->name(), issues);
+    verifyObject(list, &ConfigVerifier::verifyGroupList, issues);
+  }
+
+  /*
+   * Check channel list
+   */
+  ChannelList *channels = config->channelList();
+  if (channels->count() > _features.maxChannels)
+      issues.append(VerifyIssue(
+                      VerifyIssue::ERROR, channels,
+                      tr("Number of channels %1 exceeds limit %2."),
+                      {channels->count(), _features.maxChannels}));
+
+  DuplicateNames channelNames(tr("Duplicate channel name '%1'."), channels->count());
+  for (int i=0; i<channels->count(); i++) {
+    Channel *channel = channels->channel(i);
+    channelNames.check(channel->name(), issues);
+    verifyObject(channel, &ConfigVerifier::verifyChannel, issues);
+    // The issues of a digital channel refer to its TX contact, which may get deleted
+    if (channel->is<DigitalChannel>() && channel->as<DigitalChannel>()->txContact())
+      dependsOn(channel, channel->as<DigitalChannel>()->txContact());
+  }
+
+  /*
+   * Check zone list
+   */
+  ZoneList *zones = config->zones();
+  if (zones->count() > _features.maxZones)
+    issues.append(VerifyIssue(
+                    VerifyIssue::ERROR, zones,
+                    tr("Number of zones %1 exceeds limit %2"),
+                    {zones->count(), _features.maxZones}));
+
+  DuplicateNames zoneNames(tr("Duplicate zone name '%1'."), zones->count());
+  for (int i=0; i<zones->count(); i++) {
+    Zone *zone = zones->zone(i);
+    zoneNames.check(zone->name(), issues);
+    verifyObject(zone, &ConfigVerifier::verifyZone, issues);
+  }
+
+  /*
+   * Check scan lists
+   */
+  if (_features.hasScanlists) {
+    ScanLists *scanlists = config->scanlists();
+    if (scanlists->count() > _features.maxScanlists)
+      issues.append(VerifyIssue(
+                      VerifyIssue::ERROR, scanlists,
+                      tr("Number of scanlists %1 exceeds limit %2"),
+                      {scanlists->count(), _features.maxScanlists}));
+
+    DuplicateNames scanlistNames(tr("Duplicate scan list name '%1'."), scanlists->count());
+    for (int i=0; i<scanlists->count(); i++) {
+      ScanList *list = scanlists->scanlist(i);
+      scanlistNames.check(list->name(), issues);
+      verifyObject(list, &ConfigVerifier::verifyScanList, issues);
+      // The issues of the scan list refer to the name of the priority channel
+      if (list->priorityChannel())
+        dependsOn(list, list->priorityChannel());
+    }
+  }
+
+  /*
+   * Check roaming zones and channels
+   */
+  if (_features.hasRoaming) {
+    RoamingZoneList *roaming = config->roaming();
+    // Check total numer of unique roaming channels
+    QSet<DigitalChannel *> roamingChannels; roaming->uniqueChannels(roamingChannels);
+    if (roamingChannels.size() > _features.maxRoamingChannels)
+      issues.append(VerifyIssue(
+                      VerifyIssue::ERROR, roaming,
+                      tr("Total number of roaming channels %1 exceeds limit %2"),
+                      {roamingChannels.size(), _features.maxRoamingChannels}));
+    // Check number of roaming zones
+    if (roaming->count() > _features.maxRoamingZones)
+      issues.append(VerifyIssue(
+                      VerifyIssue::ERROR, roaming,
+                      tr("Number of roaming zones %1 exceeds limit %2"),
+                      {roaming->count(), _features.maxRoamingZones}));
+    for (int i=0; i<roaming->count(); i++)
+      verifyObject(roaming->zone(i), &ConfigVerifier::verifyRoamingZone, issues);
+  }
+
+  // Get max issue severity
+  VerifyIssue::Type maxType = VerifyIssue::NONE;
+  foreach (const VerifyIssue &issue, issues) {
+    if (issue.type() > maxType)
+      maxType = issue.type();
+  }
+  return maxType;
+}
+
+void
+ConfigVerifier::verifyContact(Contact *contact, QList<VerifyIssue> &issues) const {
+  if (contact->name().size() > _features.maxContactNameLength)
+    issues.append(VerifyIssue(
+                    VerifyIssue::WARNING, contact,
+                    tr("Contact name '%1' length %2 exceeds limit of %3 characters."),
+                    {contact->name(), contact->name().size(), _features.maxContactNameLength}));
+
+  if (contact->is<DigitalContact>() && (! _features.hasDigital))
+    issues.append(VerifyIssue(
+                    VerifyIssue::ERROR, contact,
+                    tr("Radio does not support digital contact '%1'"), {contact->name()}));
+
+  if (contact->is<DTMFContact>() && (! _features.hasAnalog))
+    issues.append(VerifyIssue(
+                    VerifyIssue::ERROR, contact,
+                    tr("Radio does not support DTMF contact '%1'"), {contact->name()}));
+}
+
+void
+ConfigVerifier::verifyGroupList(RXGroupList *list, QList<VerifyIssue> &issues) const {
+  if (list->name().size() > _features.maxGrouplistNameLength)
+    issues.append(VerifyIssue(
+                    VerifyIssue::WARNING, list,
+                    tr("Group list name '%1' of length %2 exceeds limit of %3 characters."),
+                    {list->name(), list->name().size(), _features.maxGrouplistNameLength}));
+
+  if (list->count() > _features.maxContactsInGrouplist)
+    issues.append(VerifyIssue(
+                    VerifyIssue::ERROR, list,
+                    tr("Number of contacts (%2) in group list '%1' exceeds limit %3."),
+                    {list->name(), list->count(), _features.maxContactsInGrouplist}));
+}
+
+void
+ConfigVerifier::verifyChannel(Channel *channel, QList<VerifyIssue> &issues) const {
+  if (channel->name().size() > _features.maxChannelNameLength)
+    issues.append(VerifyIssue(
+                    VerifyIssue::WARNING, channel,
+                    tr("Channel name '%1' length %2 exceeds limit of %3 characters."),
+                    {channel->name(), channel->name().length(), _features.maxChannelNameLength}));
+
+  if (channel->is<DigitalChannel>() && (! _features.hasDigital))
+    issues.append(VerifyIssue(
+                    VerifyIssue::ERROR, channel,
+                    tr("Radio does not support digital channel'%1'"), {channel->name()}));
+
+  if (channel->is<AnalogChannel>() && (! _features.hasAnalog))
+    issues.append(VerifyIssue(
+                    VerifyIssue::ERROR, channel,
+                    tr("Radio does not support analog channel'%1'"), {channel->name()}));
+
+  if (channel->is<DigitalChannel>() && (nullptr == channel->as<DigitalChannel>()->txContact())
+      && (! _features.allowChannelNoDefaultContact))
+    issues.append(VerifyIssue(
+                    VerifyIssue::WARNING, channel,
+                    tr("Radio requires TX contact for channel '%1'!"), {channel->name()}));
+}
+
+void
+ConfigVerifier::verifyZone(Zone *zone, QList<VerifyIssue> &issues) const {
+  if (zone->name().size()>_features.maxZoneNameLength)
+    issues.append(VerifyIssue(
+                    VerifyIssue::WARNING, zone,
+                    tr("Zone name '%1' length %2 exceeds limit of %3 characters."),
+                    {zone->name(), zone->name().size(), _features.maxZoneNameLength}));
+
+  if (zone->A()->count() > _features.maxChannelsInZone)
+    issues.append(VerifyIssue(
+                    VerifyIssue::ERROR, zone,
+                    tr("Number of channels %2 in zone '%1' A exceeds limit %3."),
+                    {zone->name(), zone->A()->count(), _features.maxChannelsInZone}));
+
+  if (zone->B()->count() > _features.maxChannelsInZone)
+    issues.append(VerifyIssue(
+                    VerifyIssue::ERROR, zone,
+                    tr("Number of channels %2 in zone '%1' B exceeds limit %3."),
+                    {zone->name(), zone->B()->count(), _features.maxChannelsInZone}));
+
+  if ((0 < zone->B()->count()) && (! _features.hasABZone))
+    issues.append(VerifyIssue(
+                    VerifyIssue::NOTIFICATION, zone,
+                    tr("Radio does not support dual-zones. Zone '%1' will be split into two."),
+                    {zone->name()}));
+}
+
+void
+ConfigVerifier::verifyScanList(ScanList *list, QList<VerifyIssue> &issues) const {
+  if (list->name().size() > _features.maxScanlistNameLength)
+    issues.append(VerifyIssue(
+                    VerifyIssue::WARNING, list,
+                    tr("Scan list name '%1' length %2 exceeds limit of %3 characters."),
+                    {list->name(), list->name().size(), _features.maxScanlistNameLength}));
+
+  if (0 == list->priorityChannel())
+    issues.append(VerifyIssue(
+                    VerifyIssue::WARNING, list,
+                    tr("Scan list '%1' has no priority channel set."), {list->name()}));
+  else if (! list->contains(list->priorityChannel()))
+    issues.append(VerifyIssue(
+                    VerifyIssue::WARNING, list,
+                    tr("Scan list '%1' does not contain priority channel '%2'."),
+                    {list->name(), list->priorityChannel()->name()}));
+}
+
+void
+ConfigVerifier::verifyRoamingZone(RoamingZone *zone, QList<VerifyIssue> &issues) const {
+  if (zone->count() > _features.maxChannelsInRoamingZone)
+    issues.append(VerifyIssue(
+                    VerifyIssue::WARNING, zone,
+                    tr("Number of channels (%1) in roaming zone '%2' exceeds limit %3"),
+                    {zone->count(), zone->name(), _features.maxChannelsInRoamingZone}));
+}
+
+void
+ConfigVerifier::watch(Config *config) {
+  if (_config)
+    disconnect(_config, SIGNAL(modified()), this, SLOT(onConfigModified()));
+  _config = config;
+  _issues.clear();
+  _maxIssue = VerifyIssue::NONE;
+  if (nullptr == _config)
+    return;
+
+  connect(_config, SIGNAL(modified()), this, SLOT(onConfigModified()));
+  _maxIssue = verify(_config, _issues);
+  emit issuesChanged();
+}
+
+const QList<VerifyIssue> &
+ConfigVerifier::issues() const {
+  return _issues;
+}
+
+VerifyIssue::Type
+ConfigVerifier::maxIssue() const {
+  return _maxIssue;
+}
+
+void
+ConfigVerifier::dependsOn(const QObject *obj, QObject *dependency) {
+  if (! _dependents.contains(dependency, obj))
+    _dependents.insert(dependency, obj);
+  track(dependency);
+}
+
+void
+ConfigVerifier::track(QObject *obj) {
+  connect(obj, SIGNAL(modified()), this, SLOT(onObjectModified()), Qt::UniqueConnection);
+  connect(obj, SIGNAL(destroyed(QObject*)), this, SLOT(onObjectDestroyed(QObject*)),
+          Qt::UniqueConnection);
+}
+
+void
+ConfigVerifier::invalidate(const QObject *obj) {
+  _cache.remove(obj);
+  // Dependencies get re-registered with the next verification of the dependent objects
+  foreach (const QObject *dependent, _dependents.values(obj))
+    _cache.remove(dependent);
+  _dependents.remove(obj);
+}
+
+void
+ConfigVerifier::onObjectModified() {
+  invalidate(sender());
+}
+
+void
+ConfigVerifier::onObjectDestroyed(QObject *obj) {
+  invalidate(obj);
+}
+
+void
+ConfigVerifier::onConfigModified() {
+  // Coalesce several modifications into a single re-verification
+  if (_pending)
+    return;
+  _pending = true;
+  QTimer::singleShot(0, this, [this]() {
+    _pending = false;
+    if (nullptr == _config)
+      return;
+    _issues.clear();
+    _maxIssue = verify(_config, _issues);
+    emit issuesChanged();
+  });
+}
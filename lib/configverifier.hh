@@ -0,0 +1,116 @@
+#ifndef CONFIGVERIFIER_HH
+#define CONFIGVERIFIER_HH
+
+#include <QObject>
+#include <QHash>
+#include <QMultiHash>
+#include "radio.hh"
+
+class Contact;
+class RXGroupList;
+class Channel;
+class Zone;
+class ScanList;
+class RoamingZone;
+
+/** Verifies a generic configuration against the features of a radio.
+ *
+ * Each list of the configuration is verified in a single pass. The issues of each object
+ * (channel, contact, zone etc.) are kept until the object gets modified. Hence, repeated
+ * verifications of the same configuration only re-verify the objects modified since the last
+ * run. List-wide checks like limits and duplicate names are hashed and re-evaluated each run.
+ *
+ * If a configuration is watched (see @c watch), the verification is re-run whenever the
+ * configuration gets modified and @c issuesChanged gets emitted. This allows to keep a live
+ * issue list.
+ *
+ * @ingroup rif */
+class ConfigVerifier : public QObject
+{
+  Q_OBJECT
+
+public:
+  /** Constructs a verifier for the given radio features. */
+  explicit ConfigVerifier(const Radio::Features &features, QObject *parent=nullptr);
+
+  /** Verifies the given configuration and appends all issues to @c issues. Returns the maximum
+   * severity of all issues. */
+  VerifyIssue::Type verify(Config *config, QList<VerifyIssue> &issues);
+
+  /** Watches the given configuration. The configuration gets re-verified whenever it is modified.
+   * Pass @c nullptr to stop watching. */
+  void watch(Config *config);
+  /** Returns the issues of the last verification. */
+  const QList<VerifyIssue> &issues() const;
+  /** Returns the maximum severity of the last verification. */
+  VerifyIssue::Type maxIssue() const;
+
+signals:
+  /** Gets emitted whenever the watched configuration was re-verified. */
+  void issuesChanged();
+
+protected:
+  /** Verifies a single contact. */
+  void verifyContact(Contact *contact, QList<VerifyIssue> &issues) const;
+  /** Verifies a single RX group list. */
+  void verifyGroupList(RXGroupList *list, QList<VerifyIssue> &issues) const;
+  /** Verifies a single channel. */
+  void verifyChannel(Channel *channel, QList<VerifyIssue> &issues) const;
+  /** Verifies a single zone. */
+  void verifyZone(Zone *zone, QList<VerifyIssue> &issues) const;
+  /** Verifies a single scan list. */
+  void verifyScanList(ScanList *list, QList<VerifyIssue> &issues) const;
+  /** Verifies a single roaming zone. */
+  void verifyRoamingZone(RoamingZone *zone, QList<VerifyIssue> &issues) const;
+
+  /** Appends the issues of the given object to @c issues. The object only gets verified if it
+   * was modified since the last verification. */
+  template <class T>
+  void verifyObject(T *obj, void (ConfigVerifier::*check)(T *, QList<VerifyIssue> &) const,
+                    QList<VerifyIssue> &issues)
+  {
+    typename QHash<const QObject *, QList<VerifyIssue>>::const_iterator it = _cache.find(obj);
+    if (_cache.end() == it) {
+      QList<VerifyIssue> objIssues;
+      (this->*check)(obj, objIssues);
+      it = _cache.insert(obj, objIssues);
+      track(obj);
+    }
+    issues.append(it.value());
+  }
+
+  /** Drops the cached issues of @c obj whenever @c dependency gets modified or deleted. This is
+   * needed if the issues of an object refer to another object, e.g., the name of the priority
+   * channel of a scan list. */
+  void dependsOn(const QObject *obj, QObject *dependency);
+  /** Connects to the modified and destroyed signals of the given object. */
+  void track(QObject *obj);
+  /** Drops the cached issues of the given object and all objects depending on it. */
+  void invalidate(const QObject *obj);
+
+protected slots:
+  /** Drops the cached issues of the modified object. */
+  void onObjectModified();
+  /** Drops the cached issues of the deleted object. */
+  void onObjectDestroyed(QObject *obj);
+  /** Re-verifies the watched configuration. */
+  void onConfigModified();
+
+protected:
+  /** The radio features to verify against. */
+  Radio::Features _features;
+  /** The cached issues of each verified object. */
+  QHash<const QObject *, QList<VerifyIssue>> _cache;
+  /** Maps each object to the cached objects, whose issues depend on it. */
+  QMultiHash<const QObject *, const QObject *> _dependents;
+  /** The watched configuration. */
+  Config *_config;
+  /** If @c true, a re-verification of the watched configuration is pending. */
+  bool _pending;
+  /** The issues of the last verification of the watched configuration. */
+  QList<VerifyIssue> _issues;
+  /** The maximum severity of the last verification of the watched configuration. */
+  VerifyIssue::Type _maxIssue;
+};
+
+#endif // CONFIGVERIFIER_HH
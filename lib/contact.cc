@@ -97,15 +97,41 @@ DigitalContact::setNumber(uint number) {
 }
 
 
+/* ********************************************************************************************* *
+ * Implementation of ContactList::Loader
+ * ********************************************************************************************* */
+ContactList::Loader::Loader()
+{
+  // pass...
+}
+
+ContactList::Loader::~Loader() {
+  // pass...
+}
+
+bool
+ContactList::Loader::number(int idx, uint &number) const {
+  Q_UNUSED(idx);
+  Q_UNUSED(number);
+  return false;
+}
+
+
 /* ********************************************************************************************* *
  * Implementation of ContactList
  * ********************************************************************************************* */
 ContactList::ContactList(QObject *parent)
-  : QAbstractTableModel(parent), _contacts()
+  : QAbstractTableModel(parent), _contacts(), _rows(), _rowsValid(true), _loader(nullptr),
+    _loaderOffset(0), _pending(0)
 {
   connect(this, SIGNAL(modified()), this, SLOT(onContactEdited()));
 }
 
+ContactList::~ContactList() {
+  if (_loader)
+    delete _loader;
+}
+
 int
 ContactList::count() const {
   return _contacts.size();
@@ -115,7 +141,7 @@ int
 ContactList::digitalCount() const {
   int c=0;
   for (int i=0; i<_contacts.size(); i++)
-    if (_contacts.at(i)->is<DigitalContact>())
+    if ((nullptr == _contacts.at(i)) || _contacts.at(i)->is<DigitalContact>())
       c++;
   return c;
 }
@@ -124,7 +150,7 @@ int
 ContactList::dtmfCount() const {
   int c=0;
   for (int i=0; i<_contacts.size(); i++)
-    if (_contacts.at(i)->is<DTMFContact>())
+    if ((nullptr != _contacts.at(i)) && _contacts.at(i)->is<DTMFContact>())
       c++;
   return c;
 }
@@ -132,15 +158,28 @@ ContactList::dtmfCount() const {
 void
 ContactList::clear() {
   for (int i=0; i<count(); i++)
-    _contacts[i]->deleteLater();
+    if (_contacts[i])
+      _contacts[i]->deleteLater();
   _contacts.clear();
+  _rows.clear();
+  _rowsValid = true;
+  if (_loader)
+    delete _loader;
+  _loader = nullptr;
+  _pending = 0;
 }
 
 int
 ContactList::indexOf(Contact *contact) const {
-  if (! _contacts.contains(contact))
+  if (! _rows.contains(contact))
     return -1;
-  return _contacts.indexOf(contact);
+  if (! _rowsValid) {
+    for (int i=0; i<_contacts.size(); i++)
+      if (_contacts[i])
+        _rows[_contacts[i]] = i;
+    _rowsValid = true;
+  }
+  return _rows.value(contact);
 }
 
 int
@@ -149,7 +188,7 @@ ContactList::indexOfDigital(DigitalContact *contact) const {
   for (int i=0; i<_contacts.size(); i++) {
     if (_contacts.at(i) == contact)
       return idx;
-    else if (_contacts.at(i)->is<DigitalContact>())
+    else if ((nullptr == _contacts.at(i)) || _contacts.at(i)->is<DigitalContact>())
       idx++;
   }
   return -1;
@@ -161,7 +200,7 @@ ContactList::indexOfDTMF(DTMFContact *contact) const {
   for (int i=0; i<_contacts.size(); i++) {
     if (_contacts.at(i) == contact)
       return idx;
-    else if (_contacts.at(i)->is<DTMFContact>())
+    else if ((nullptr != _contacts.at(i)) && _contacts.at(i)->is<DTMFContact>())
       idx++;
   }
   return -1;
@@ -169,17 +208,18 @@ ContactList::indexOfDTMF(DTMFContact *contact) const {
 
 Contact *
 ContactList::contact(int idx) const {
-  if (idx >= _contacts.size())
+  if ((0 > idx) || (idx >= _contacts.size()))
     return nullptr;
-  return _contacts[idx];
+  return at(idx);
 }
 
 DigitalContact *
 ContactList::digitalContact(int idx) const {
   for (int i=0; i<_contacts.size(); i++) {
-    if (_contacts.at(i)->is<DigitalContact>()) {
+    // Deferred contacts are always digital ones
+    if ((nullptr == _contacts.at(i)) || _contacts.at(i)->is<DigitalContact>()) {
       if (0 == idx)
-        return _contacts.at(i)->as<DigitalContact>();
+        return at(i)->as<DigitalContact>();
       else
         idx--;
     }
@@ -190,7 +230,12 @@ ContactList::digitalContact(int idx) const {
 DigitalContact *
 ContactList::findDigitalContact(uint number) const {
   for (int i=0; i<_contacts.size(); i++) {
-    if (! _contacts.at(i)->is<DigitalContact>())
+    // Skip deferred contacts with another number, without constructing them
+    uint deferred;
+    if ((nullptr == _contacts.at(i)) && _loader->number(i-_loaderOffset, deferred)
+        && (deferred != number))
+      continue;
+    if (! at(i)->is<DigitalContact>())
       continue;
     if (_contacts.at(i)->as<DigitalContact>()->number() == number)
       return _contacts.at(i)->as<DigitalContact>();
@@ -201,7 +246,7 @@ ContactList::findDigitalContact(uint number) const {
 DTMFContact *
 ContactList::dtmfContact(int idx) const {
   for (int i=0; i<_contacts.size(); i++) {
-    if (_contacts.at(i)->is<DTMFContact>()) {
+    if ((nullptr != _contacts.at(i)) && _contacts.at(i)->is<DTMFContact>()) {
       if (0 == idx)
         return _contacts.at(i)->as<DTMFContact>();
       else
@@ -215,9 +260,13 @@ bool
 ContactList::remContact(int idx) {
   if (idx >= _contacts.size())
     return false;
+  // Removing a row shifts the deferred contacts, load them first
+  loadAll();
   Contact *contact = _contacts[idx];
   beginRemoveRows(QModelIndex(), idx, idx);
   _contacts.remove(idx);
+  _rows.remove(contact);
+  _rowsValid = false;
   endRemoveRows();
   contact->deleteLater();
   emit modified();
@@ -226,19 +275,23 @@ ContactList::remContact(int idx) {
 
 bool
 ContactList::remContact(Contact *contact) {
-  if (! _contacts.contains(contact))
+  int idx = indexOf(contact);
+  if (0 > idx)
     return false;
-  int idx = _contacts.indexOf(contact);
   return remContact(idx);
 }
 
 int
 ContactList::addContact(Contact *contact, int row) {
-  if (_contacts.contains(contact)) {
-    return _contacts.indexOf(contact);
+  if (_rows.contains(contact)) {
+    return indexOf(contact);
   }
+  loadAll();
   if ((row<0) || (row>_contacts.size()))
     row = _contacts.size();
+  // Appending keeps the rows of all other contacts
+  _rowsValid = _rowsValid && (row == _contacts.size());
+  _rows.insert(contact, row);
   contact->setParent(this);
   connect(contact, SIGNAL(destroyed(QObject*)), this, SLOT(onContactDeleted(QObject*)));
   connect(contact, SIGNAL(modified()), this, SIGNAL(modified()));
@@ -249,12 +302,58 @@ ContactList::addContact(Contact *contact, int row) {
   return row;
 }
 
+int
+ContactList::addDeferred(int n, Loader *loader) {
+  // Only one loader at a time
+  loadAll();
+  int row = _contacts.size();
+  if (0 >= n) {
+    delete loader;
+    return row;
+  }
+  beginInsertRows(QModelIndex(), row, row+n-1);
+  _contacts.insert(row, n, nullptr);
+  _loader = loader;
+  _loaderOffset = row;
+  _pending = n;
+  endInsertRows();
+  emit modified();
+  return row;
+}
+
+void
+ContactList::loadAll() const {
+  for (int i=0; (0<_pending) && (i<_contacts.size()); i++)
+    at(i);
+}
+
+Contact *
+ContactList::at(int idx) const {
+  if (Contact *contact = _contacts.at(idx))
+    return contact;
+  // Construct deferred contact
+  DigitalContact *contact = _loader->load(idx-_loaderOffset);
+  ContactList *self = const_cast<ContactList *>(this);
+  contact->setParent(self);
+  connect(contact, SIGNAL(destroyed(QObject*)), self, SLOT(onContactDeleted(QObject*)));
+  connect(contact, SIGNAL(modified()), self, SIGNAL(modified()));
+  _contacts[idx] = contact;
+  _rows.insert(contact, idx);
+  if (0 == (--_pending)) {
+    delete _loader;
+    _loader = nullptr;
+  }
+  return contact;
+}
+
 bool
 ContactList::moveUp(int row) {
   if ((row <= 0) || (row>=count()))
     return false;
+  loadAll();
   beginMoveRows(QModelIndex(), row, row, QModelIndex(), row-1);
   std::swap(_contacts[row-1],_contacts[row]);
+  _rowsValid = false;
   endMoveRows();
   emit modified();
   return true;
@@ -264,8 +363,10 @@ bool
 ContactList::moveDown(int row) {
   if ((row >= (count()-1)) || (0 > row))
     return false;
+  loadAll();
   beginMoveRows(QModelIndex(), row, row, QModelIndex(), row+2);
   std::swap(_contacts[row+1],_contacts[row]);
+  _rowsValid = false;
   endMoveRows();
   emit modified();
   return true;
@@ -289,7 +390,7 @@ ContactList::data(const QModelIndex &index, int role) const {
     return QVariant();
 
   if (Qt::DisplayRole == role) {
-    Contact *contact = _contacts.at(index.row());
+    Contact *contact = at(index.row());
     if (contact->is<DTMFContact>()) {
       DTMFContact *dtmf = contact->as<DTMFContact>();
       switch (index.column()) {
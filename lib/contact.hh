@@ -3,6 +3,7 @@
 
 #include <QObject>
 #include <QVector>
+#include <QHash>
 #include <QAbstractTableModel>
 
 
@@ -146,9 +147,34 @@ class ContactList: public QAbstractTableModel
 {
 	Q_OBJECT
 
+public:
+  /** Interface for deferred contact decoding.
+   *
+   * Codeplugs may hold several thousand contacts. Instead of constructing all @c DigitalContact
+   * objects during decoding, a codeplug may register a loader with the contact list. The list then
+   * reserves the rows and constructs the contacts only once they are accessed. */
+  class Loader
+  {
+  protected:
+    /** Hidden constructor. */
+    Loader();
+
+  public:
+    /** Destructor. */
+    virtual ~Loader();
+    /** Constructs the @c idx-th deferred contact. The returned contact must be a
+     * @c DigitalContact, the list takes the ownership. */
+    virtual DigitalContact *load(int idx) = 0;
+    /** Stores the number of the @c idx-th deferred contact in @c number without constructing it.
+     * Returns @c false if the number is not known before loading the contact (default). */
+    virtual bool number(int idx, uint &number) const;
+  };
+
 public:
   /** Constructs an empty contact list. */
 	explicit ContactList(QObject *parent=nullptr);
+  /** Destructor. */
+  virtual ~ContactList();
 
   /** Returns the number of contacts. */
 	int count() const;
@@ -179,6 +205,12 @@ public:
   /** Adds a contact to the list at the given @ç row.
    * If row < 0, the contact gets appended to the list. */
   int addContact(Contact *contact, int row=-1);
+  /** Appends @c n contacts to the list, that are constructed by the given @c loader once they are
+   * accessed. The list takes the ownership of the loader. Returns the row of the first deferred
+   * contact. */
+  int addDeferred(int n, Loader *loader);
+  /** Constructs all deferred contacts. */
+  void loadAll() const;
   /** Removes the contact at the given index. */
   bool remContact(int idx);
   /** Removes the given contact from the list. */
@@ -210,8 +242,23 @@ protected slots:
   void onContactEdited();
 
 protected:
-  /** Just the vector of contacts. */
-	QVector<Contact *> _contacts;
+  /** Returns the contact at the given row, constructs it if deferred. */
+  Contact *at(int idx) const;
+
+protected:
+  /** Just the vector of contacts. Deferred contacts are @c nullptr until loaded. */
+	mutable QVector<Contact *> _contacts;
+  /** Maps every loaded contact of the list to its row. The keys are always up to date, the rows
+   * only if @c _rowsValid is set. Avoids linear searches when adding and looking up contacts. */
+  mutable QHash<Contact *, int> _rows;
+  /** If @c true, the rows of @c _rows are up to date. */
+  mutable bool _rowsValid;
+  /** The loader of deferred contacts, @c nullptr if there are none. */
+  mutable Loader *_loader;
+  /** The row of the first deferred contact. */
+  int _loaderOffset;
+  /** The number of deferred contacts not yet loaded. */
+  mutable int _pending;
 };
 
 #endif // CONTACT_HH
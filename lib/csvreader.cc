@@ -3,35 +3,36 @@
 #include "utils.hh"
 #include "logger.hh"
 
-#include <QRegExp>
+#include <QRegularExpression>
+#include <QStringList>
 #include <QDebug>
 
-QVector< QPair<QRegExp, CSVLexer::Token::TokenType> > CSVLexer::_pattern = {
-  { QRegExp("^n([0-9]{3})"),                     CSVLexer::Token::T_DCS_N },
-  { QRegExp("^i([0-9]{3})"),                     CSVLexer::Token::T_DCS_I },
-  { QRegExp("^([a-zA-Z0-9]{1,6}-[0-9]{1,2})"),   CSVLexer::Token::T_APRSCALL },
-  { QRegExp("^([a-zA-Z_][a-zA-Z0-9_]*)"),        CSVLexer::Token::T_KEYWORD },
-  { QRegExp("^\"([^\"\r\n]*)\""),                CSVLexer::Token::T_STRING },
-  { QRegExp("^([+-]?[0-9]+(\\.[0-9]*)?)"),       CSVLexer::Token::T_NUMBER },
-  { QRegExp("^(:)"),                             CSVLexer::Token::T_COLON },
-  { QRegExp("^(-)"),                             CSVLexer::Token::T_NOT_SET },
-  { QRegExp("^(\\+)"),                           CSVLexer::Token::T_ENABLED },
-  { QRegExp("^(,)"),                             CSVLexer::Token::T_COMMA },
-  { QRegExp("^([ \t]+)"),                        CSVLexer::Token::T_WHITESPACE },
-  { QRegExp("^(\r?\n)"),                         CSVLexer::Token::T_NEWLINE},
-  { QRegExp("^(#[^\n\r]*)"),                     CSVLexer::Token::T_COMMENT},
+const QVector< QPair<QRegularExpression, CSVLexer::Token::TokenType> > CSVLexer::_pattern = {
+  { QRegularExpression("^n([0-9]{3})"),                   CSVLexer::Token::T_DCS_N },
+  { QRegularExpression("^i([0-9]{3})"),                   CSVLexer::Token::T_DCS_I },
+  { QRegularExpression("^([a-zA-Z0-9]{1,6}-[0-9]{1,2})"), CSVLexer::Token::T_APRSCALL },
+  { QRegularExpression("^([a-zA-Z_][a-zA-Z0-9_]*)"),      CSVLexer::Token::T_KEYWORD },
+  { QRegularExpression("^\"([^\"\r\n]*)\""),              CSVLexer::Token::T_STRING },
+  { QRegularExpression("^([+-]?[0-9]+(\\.[0-9]*)?)"),     CSVLexer::Token::T_NUMBER },
+  { QRegularExpression("^(:)"),                           CSVLexer::Token::T_COLON },
+  { QRegularExpression("^(-)"),                           CSVLexer::Token::T_NOT_SET },
+  { QRegularExpression("^(\\+)"),                         CSVLexer::Token::T_ENABLED },
+  { QRegularExpression("^(,)"),                           CSVLexer::Token::T_COMMA },
+  { QRegularExpression("^([ \t]+)"),                      CSVLexer::Token::T_WHITESPACE },
+  { QRegularExpression("^(\r?\n)"),                       CSVLexer::Token::T_NEWLINE },
+  { QRegularExpression("^(#[^\n\r]*)"),                   CSVLexer::Token::T_COMMENT },
 };
 
 
 /* ********************************************************************************************* *
  * Implementation of CSVLexer
  * ********************************************************************************************* */
-CSVLexer::CSVLexer(QTextStream &stream, QObject *parent)
+CSVLexer::CSVLexer(QTextStream &stream, qint64 line, QObject *parent)
   : QObject(parent), _errorMessage(), _stream(stream), _stack(), _currentLine()
 {
   _stream.seek(0);
   _stack.reserve(10);
-  _stack.push_back({0, 1, 1});
+  _stack.push_back({0, line, 1});
   _currentLine = _stream.readLine();
 }
 
@@ -60,12 +61,16 @@ CSVLexer::lex() {
     _stack.back().column = 1;
     return token;
   }
-  foreach (auto pattern, _pattern) {
-    if (0 == pattern.first.indexIn(_currentLine)) {
-      Token token = {pattern.second, pattern.first.cap(1), _stack.back().line, _stack.back().column};
-      _stack.back().offset += pattern.first.matchedLength();
+  // Matching does not modify the patterns, hence they are shared by the lexers of all threads.
+  // QRegularExpression compiles a pattern once, guarded by a lock.
+  for (int i=0; i<_pattern.size(); i++) {
+    const QPair<QRegularExpression, Token::TokenType> &pattern = _pattern.at(i);
+    QRegularExpressionMatch match = pattern.first.match(_currentLine);
+    if (match.hasMatch()) {
+      Token token = {pattern.second, match.captured(1), _stack.back().line, _stack.back().column};
+      _stack.back().offset += match.capturedLength(0);
       _stack.back().column += token.value.size();
-      _currentLine = _currentLine.mid(pattern.first.matchedLength());
+      _currentLine = _currentLine.mid(match.capturedLength(0));
       return token;
     }
   }
@@ -198,7 +203,7 @@ CSVHandler::handleGroupList(qint64 idx, const QString &name, const QList<qint64>
 }
 
 bool
-CSVHandler::handleDigitalChannel(qint64 idx, const QString &name, double rx, double tx, Channel::Power power, qint64 scan,
+CSVHandler::handleDigitalChannel(qint64 idx, const QString &name, Frequency rx, Frequency tx, Channel::Power power, qint64 scan,
     qint64 tot, bool ro, DigitalChannel::Admit admit, qint64 color, DigitalChannel::TimeSlot slot,
     qint64 gl, qint64 contact, qint64 gps, qint64 roam, qint64 line, qint64 column, QString &errorMessage)
 {
@@ -224,7 +229,7 @@ CSVHandler::handleDigitalChannel(qint64 idx, const QString &name, double rx, dou
 }
 
 bool
-CSVHandler::handleAnalogChannel(qint64 idx, const QString &name, double rx, double tx, Channel::Power power, qint64 scan,
+CSVHandler::handleAnalogChannel(qint64 idx, const QString &name, Frequency rx, Frequency tx, Channel::Power power, qint64 scan,
     qint64 aprs, qint64 tot, bool ro, AnalogChannel::Admit admit, qint64 squelch, Signaling::Code rxTone, Signaling::Code txTone,
     AnalogChannel::Bandwidth bw, qint64 line, qint64 column, QString &errorMessage)
 {
@@ -333,7 +338,7 @@ CSVHandler::handleRoamingZone(qint64 idx, const QString &name, const QList<qint6
  * Implementation of CSVParser
  * ********************************************************************************************* */
 CSVParser::CSVParser(CSVHandler *handler, QObject *parent)
-  : QObject(parent), _errorMessage(), _handler(handler)
+  : QObject(parent), _errorMessage(), _handler(handler), _rows()
 {
   // pass...
 }
@@ -348,8 +353,70 @@ CSVParser::parse(QTextStream &stream) {
   if (! stream.seek(0))
     return false;
 
-  CSVLexer lexer(stream);
+  // Split the file into sections, each starting with a line beginning with a keyword. That is,
+  // a table header or a single setting.
+  QVector<Section> sections;
+  QStringList lines = stream.readAll().split('\n');
+  for (int i=0; i<lines.size(); i++) {
+    QString trimmed = lines[i].trimmed();
+    if (sections.isEmpty() || ((! trimmed.isEmpty()) && trimmed.at(0).isLetter()))
+      sections.append({QString(), i+1});
+    sections.last().text.append(lines[i]);
+    if ((i+1) < lines.size())
+      sections.last().text.append('\n');
+  }
+
+  // Parse the sections independently into rows
+  QVector<QVector<Row>> rows(sections.size());
+  QVector<QString> errors(sections.size());
+  QVector<char> success(sections.size(), 0);
+  const Section *sectionPtr = sections.constData();
+  QVector<Row> *rowsPtr = rows.data();
+  QString *errorsPtr = errors.data();
+  char *successPtr = success.data();
+  parallel_for(sections.size(), [sectionPtr, rowsPtr, errorsPtr, successPtr](int i) {
+    QString text = sectionPtr[i].text;
+    QTextStream sectionStream(&text, QIODevice::ReadOnly);
+    CSVLexer lexer(sectionStream, sectionPtr[i].line);
+    CSVParser parser(nullptr);
+    successPtr[i] = parser._parse(lexer);
+    rowsPtr[i] = parser._rows;
+    errorsPtr[i] = parser._errorMessage;
+  }, 1);
+
+  // Report the first error in file order
+  _rows.clear();
+  for (int i=0; i<sections.size(); i++) {
+    if (! success[i]) {
+      _errorMessage = errors[i];
+      _rows.clear();
+      return false;
+    }
+    _rows += rows[i];
+  }
+
+  return replay();
+}
+
+bool
+CSVParser::replay() {
+  if (nullptr == _handler)
+    return true;
+  for (int i=0; i<_rows.size(); i++) {
+    if (! _rows[i](_handler, _errorMessage))
+      return false;
+  }
+  return true;
+}
+
+bool
+CSVParser::_record(const Row &row) {
+  _rows.append(row);
+  return true;
+}
 
+bool
+CSVParser::_parse(CSVLexer &lexer) {
   for (CSVLexer::Token token=lexer.next(); CSVLexer::Token::T_END_OF_STREAM != token.type; token = lexer.next()) {
     if (CSVLexer::Token::T_NEWLINE == token.type)
       continue;
@@ -440,7 +507,9 @@ CSVParser::_parse_radio_id(CSVLexer &lexer) {
     return false;
   }
 
-  return _handler->handleRadioId(id, line, column, _errorMessage);
+  return _record([=](CSVHandler *handler, QString &errorMessage) {
+    return handler->handleRadioId(id, line, column, errorMessage);
+  });
 }
 
 bool
@@ -467,7 +536,9 @@ CSVParser::_parse_radio_name(CSVLexer &lexer) {
     return false;
   }
 
-  return _handler->handleRadioName(name, line, column, _errorMessage);
+  return _record([=](CSVHandler *handler, QString &errorMessage) {
+    return handler->handleRadioName(name, line, column, errorMessage);
+  });
 }
 
 bool
@@ -494,7 +565,9 @@ CSVParser::_parse_introline1(CSVLexer &lexer) {
     return false;
   }
 
-  return _handler->handleIntroLine1(text, line, column, _errorMessage);
+  return _record([=](CSVHandler *handler, QString &errorMessage) {
+    return handler->handleIntroLine1(text, line, column, errorMessage);
+  });
 }
 
 bool
@@ -521,7 +594,9 @@ CSVParser::_parse_introline2(CSVLexer &lexer) {
     return false;
   }
 
-  return _handler->handleIntroLine2(text, line, column, _errorMessage);
+  return _record([=](CSVHandler *handler, QString &errorMessage) {
+    return handler->handleIntroLine2(text, line, column, errorMessage);
+  });
 }
 
 bool
@@ -549,7 +624,9 @@ CSVParser::_parse_mic_level(CSVLexer &lexer) {
     return false;
   }
 
-  return _handler->handleMicLevel(level, line, column, _errorMessage);
+  return _record([=](CSVHandler *handler, QString &errorMessage) {
+    return handler->handleMicLevel(level, line, column, errorMessage);
+  });
 }
 
 bool
@@ -579,7 +656,9 @@ CSVParser::_parse_speech(CSVLexer &lexer) {
     return false;
   }
 
-  return _handler->handleSpeech(speech, line, column, _errorMessage);
+  return _record([=](CSVHandler *handler, QString &errorMessage) {
+    return handler->handleSpeech(speech, line, column, errorMessage);
+  });
 }
 
 bool
@@ -608,11 +687,13 @@ CSVParser::_parse_userdb(CSVLexer &lexer) {
     return false;
   }
 
-  logWarn() << line << "," << column << ": The 'UserDB' setting is obsolete. "
-            << "It will be removed in future releases. Just delete this line.";
-
-  // Ignore user DB setting
-  return true;
+  // Ignore user DB setting, the warning is logged while the rows are handled
+  return _record([=](CSVHandler *handler, QString &errorMessage) {
+    Q_UNUSED(handler); Q_UNUSED(errorMessage);
+    logWarn() << line << "," << column << ": The 'UserDB' setting is obsolete. "
+              << "It will be removed in future releases. Just delete this line.";
+    return true;
+  });
 }
 
 bool
@@ -713,9 +794,16 @@ CSVParser::_parse_contact(qint64 idx, CSVLexer &lexer) {
     return false;
   }
 
-  if (dtmf)
-    return _handler->handleDTMFContact(idx, name, dtmf_num, rxToneEnabled, line, column, _errorMessage);
-  return _handler->handleDigitalContact(idx, name, type, id, rxToneEnabled, line, column, _errorMessage);
+  if (dtmf) {
+    return _record([=](CSVHandler *handler, QString &errorMessage) {
+      return handler->handleDTMFContact(idx, name, dtmf_num, rxToneEnabled, line, column,
+                                        errorMessage);
+    });
+  }
+  return _record([=](CSVHandler *handler, QString &errorMessage) {
+    return handler->handleDigitalContact(idx, name, type, id, rxToneEnabled, line, column,
+                                         errorMessage);
+  });
 }
 
 
@@ -774,7 +862,9 @@ CSVParser::_parse_rx_group(qint64 idx, CSVLexer &lexer) {
     return false;
   }
 
-  return _handler->handleGroupList(idx, name, lst, line, column, _errorMessage);
+  return _record([=](CSVHandler *handler, QString &errorMessage) {
+    return handler->handleGroupList(idx, name, lst, line, column, errorMessage);
+  });
 }
 
 bool
@@ -823,9 +913,9 @@ CSVParser::_parse_digital_channel(qint64 idx, CSVLexer &lexer) {
         .arg(token.line).arg(token.column).arg(token.type).arg(token.value);
     return false;
   }
-  double rx = token.value.toDouble(&ok);
-  if (! ok) {
-    _errorMessage = QString("Parse error @ %1,%2: Cannot convert '%3' to double.")
+  Frequency rx;
+  if (! parse_frequency_hz(token.value, rx)) {
+    _errorMessage = QString("Parse error @ %1,%2: Cannot convert '%3' to frequency.")
         .arg(token.line).arg(token.column).arg(token.value);
     return false;
   }
@@ -836,9 +926,9 @@ CSVParser::_parse_digital_channel(qint64 idx, CSVLexer &lexer) {
         .arg(token.line).arg(token.column).arg(token.type).arg(token.value);
     return false;
   }
-  double tx = token.value.toDouble(&ok);
-  if (! ok) {
-    _errorMessage = QString("Parse error @ %1,%2: Cannot convert '%3' to double.")
+  Frequency tx;
+  if (! parse_frequency_hz(token.value, tx)) {
+    _errorMessage = QString("Parse error @ %1,%2: Cannot convert '%3' to frequency.")
         .arg(token.line).arg(token.column).arg(token.value);
     return false;
   }
@@ -1007,8 +1097,11 @@ CSVParser::_parse_digital_channel(qint64 idx, CSVLexer &lexer) {
   }
 
 done:
-  return _handler->handleDigitalChannel(idx, name, rx, tx, pwr, scanlist, tot, rxOnly, admit, color,
-                                        slot, rxGroupList, txContact, gps, roam, line, column, _errorMessage);
+  return _record([=](CSVHandler *handler, QString &errorMessage) {
+    return handler->handleDigitalChannel(idx, name, rx, tx, pwr, scanlist, tot, rxOnly, admit,
+                                         color, slot, rxGroupList, txContact, gps, roam, line,
+                                         column, errorMessage);
+  });
 }
 
 bool
@@ -1056,7 +1149,12 @@ CSVParser::_parse_analog_channel(qint64 idx, CSVLexer &lexer) {
         .arg(token.line).arg(token.column).arg(token.type).arg(token.value);
     return false;
   }
-  double rx = token.value.toDouble();
+  Frequency rx;
+  if (! parse_frequency_hz(token.value, rx)) {
+    _errorMessage = QString("Parse error @ %1,%2: Cannot convert '%3' to frequency.")
+        .arg(token.line).arg(token.column).arg(token.value);
+    return false;
+  }
 
   token = lexer.next();
   if (CSVLexer::Token::T_NUMBER != token.type) {
@@ -1064,7 +1162,12 @@ CSVParser::_parse_analog_channel(qint64 idx, CSVLexer &lexer) {
         .arg(token.line).arg(token.column).arg(token.type).arg(token.value);
     return false;
   }
-  double tx = token.value.toDouble();
+  Frequency tx;
+  if (! parse_frequency_hz(token.value, tx)) {
+    _errorMessage = QString("Parse error @ %1,%2: Cannot convert '%3' to frequency.")
+        .arg(token.line).arg(token.column).arg(token.value);
+    return false;
+  }
   if (token.value.startsWith('+') || token.value.startsWith('-'))
     tx = rx + tx;
 
@@ -1223,8 +1326,10 @@ CSVParser::_parse_analog_channel(qint64 idx, CSVLexer &lexer) {
   }
 
 done:
-  return _handler->handleAnalogChannel(idx, name, rx, tx, pwr, scanlist, aprs, tot, rxOnly, admit, squelch,
-                                       rxTone, txTone, bw, line, column, _errorMessage);
+  return _record([=](CSVHandler *handler, QString &errorMessage) {
+    return handler->handleAnalogChannel(idx, name, rx, tx, pwr, scanlist, aprs, tot, rxOnly, admit,
+                                        squelch, rxTone, txTone, bw, line, column, errorMessage);
+  });
 }
 
 bool
@@ -1289,7 +1394,9 @@ CSVParser::_parse_zone(qint64 idx, CSVLexer &lexer) {
     return false;
   }
 
-  return _handler->handleZone(idx, name, a, lst, line, column, _errorMessage);
+  return _record([=](CSVHandler *handler, QString &errorMessage) {
+    return handler->handleZone(idx, name, a, lst, line, column, errorMessage);
+  });
 }
 
 
@@ -1364,7 +1471,10 @@ CSVParser::_parse_gps_system(qint64 id, CSVLexer &lexer) {
     return false;
   }
 
-  return _handler->handleGPSSystem(id, name, contact, period, chan, line, column, _errorMessage);
+  return _record([=](CSVHandler *handler, QString &errorMessage) {
+    return handler->handleGPSSystem(id, name, contact, period, chan, line, column,
+                                    errorMessage);
+  });
 }
 
 
@@ -1487,8 +1597,10 @@ CSVParser::_parse_aprs_system(qint64 id, CSVLexer &lexer) {
     return false;
   }
 
-  return _handler->handleAPRSSystem(id, name, channel, period, src, srcSSID, dest, destSSID,
-                                    path, iconname, message, line, column, _errorMessage);
+  return _record([=](CSVHandler *handler, QString &errorMessage) {
+    return handler->handleAPRSSystem(id, name, channel, period, src, srcSSID, dest, destSSID,
+                                     path, iconname, message, line, column, errorMessage);
+  });
 }
 
 
@@ -1605,7 +1717,10 @@ CSVParser::_parse_scanlist(qint64 idx, CSVLexer &lexer) {
     return false;
   }
 
-  return _handler->handleScanList(idx, name, pch1, pch2, txch, lst, line, column, _errorMessage);
+  return _record([=](CSVHandler *handler, QString &errorMessage) {
+    return handler->handleScanList(idx, name, pch1, pch2, txch, lst, line, column,
+                                   errorMessage);
+  });
 }
 
 bool
@@ -1662,7 +1777,9 @@ CSVParser::_parse_roaming_zone(qint64 idx, CSVLexer &lexer) {
     return false;
   }
 
-  return _handler->handleRoamingZone(idx, name, lst, line, column, _errorMessage);
+  return _record([=](CSVHandler *handler, QString &errorMessage) {
+    return handler->handleRoamingZone(idx, name, lst, line, column, errorMessage);
+  });
 }
 
 
@@ -1689,6 +1806,7 @@ CSVReader::read(Config *config, QTextStream &stream, QString &errorMessage) {
   CSVReader reader(config);
   CSVParser parser(&reader);
 
+  // Parses the file and creates all objects
   if (! parser.parse(stream)) {
     errorMessage = parser.errorMessage();
     errorMessage.append(tr("\nThe generic code-plug format might be changed with a new release of qdmr."
@@ -1697,7 +1815,8 @@ CSVReader::read(Config *config, QTextStream &stream, QString &errorMessage) {
   }
   reader._link = true;
 
-  if (! parser.parse(stream)) {
+  // Links the objects, the rows parsed before are handled again
+  if (! parser.replay()) {
     errorMessage = parser.errorMessage();
     return false;
   }
@@ -1857,7 +1976,7 @@ CSVReader::handleGroupList(qint64 idx, const QString &name, const QList<qint64>
 }
 
 bool
-CSVReader::handleDigitalChannel(qint64 idx, const QString &name, double rx, double tx, Channel::Power power, qint64 scan,
+CSVReader::handleDigitalChannel(qint64 idx, const QString &name, Frequency rx, Frequency tx, Channel::Power power, qint64 scan,
     qint64 tot, bool ro, DigitalChannel::Admit admit, qint64 color, DigitalChannel::TimeSlot slot,
     qint64 gl, qint64 contact, qint64 gps, qint64 roam, qint64 line, qint64 column, QString &errorMessage)
 {
@@ -1925,7 +2044,7 @@ CSVReader::handleDigitalChannel(qint64 idx, const QString &name, double rx, doub
     return false;
   }
 
-  DigitalChannel *chan = new DigitalChannel(name, rx, tx, power, tot, ro, admit, color, slot,
+  DigitalChannel *chan = new DigitalChannel(name, hz2mhz(rx), hz2mhz(tx), power, tot, ro, admit, color, slot,
                                             nullptr, nullptr, nullptr, nullptr, nullptr);
   _config->channelList()->addChannel(chan);
   _channels[idx] = chan;
@@ -1935,7 +2054,7 @@ CSVReader::handleDigitalChannel(qint64 idx, const QString &name, double rx, doub
 
 
 bool
-CSVReader::handleAnalogChannel(qint64 idx, const QString &name, double rx, double tx, Channel::Power power, qint64 scan,
+CSVReader::handleAnalogChannel(qint64 idx, const QString &name, Frequency rx, Frequency tx, Channel::Power power, qint64 scan,
     qint64 aprs, qint64 tot, bool ro, AnalogChannel::Admit admit, qint64 squelch, Signaling::Code rxTone, Signaling::Code txTone,
     AnalogChannel::Bandwidth bw, qint64 line, qint64 column, QString &errorMessage)
 {
@@ -1974,7 +2093,7 @@ CSVReader::handleAnalogChannel(qint64 idx, const QString &name, double rx, doubl
     return false;
   }
 
-  AnalogChannel *chan = new AnalogChannel(name, rx, tx, power, tot, ro, admit, squelch, rxTone,
+  AnalogChannel *chan = new AnalogChannel(name, hz2mhz(rx), hz2mhz(tx), power, tot, ro, admit, squelch, rxTone,
                                           txTone, bw, nullptr);
   _config->channelList()->addChannel(chan);
   _channels[idx] = chan;
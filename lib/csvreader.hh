@@ -5,6 +5,8 @@
 #include <QTextStream>
 #include <QMap>
 #include <QVector>
+#include <QRegularExpression>
+#include <functional>
 
 #include "channel.hh"
 #include "contact.hh"
@@ -69,8 +71,9 @@ public:
   } State;
 
 public:
-  /** Constructs a lexer for the given stream. */
-  CSVLexer(QTextStream &stream, QObject *parent=nullptr);
+  /** Constructs a lexer for the given stream. The first line of the stream gets the number
+   * @c line. */
+  CSVLexer(QTextStream &stream, qint64 line=1, QObject *parent=nullptr);
 
   /** Saves the current lexer state. */
   void push();
@@ -96,7 +99,7 @@ protected:
   /// The current line count
   QString _currentLine;
   /// The list of patterns to match
-  static QVector< QPair<QRegExp, Token::TokenType> > _pattern;
+  static const QVector< QPair<QRegularExpression, Token::TokenType> > _pattern;
 };
 
 
@@ -140,11 +143,11 @@ public:
                                qint64 line, qint64 column, QString &errorMessage);
   /** Gets called once a digital channel has been parsed. */
   virtual bool handleDigitalChannel(
-      qint64 idx, const QString &name, double rx, double tx, Channel::Power power, qint64 scan,
+      qint64 idx, const QString &name, Frequency rx, Frequency tx, Channel::Power power, qint64 scan,
       qint64 tot, bool ro, DigitalChannel::Admit admit, qint64 color, DigitalChannel::TimeSlot slot,
       qint64 gl, qint64 contact, qint64 gps, qint64 roam, qint64 line, qint64 column, QString &errorMessage);
   /** Gets called once a analog channel has been parsed. */
-  virtual bool handleAnalogChannel(qint64 idx, const QString &name, double rx, double tx, Channel::Power power, qint64 scan, qint64 aprs,
+  virtual bool handleAnalogChannel(qint64 idx, const QString &name, Frequency rx, Frequency tx, Channel::Power power, qint64 scan, qint64 aprs,
       qint64 tot, bool ro, AnalogChannel::Admit admit, qint64 squelch, Signaling::Code rxTone, Signaling::Code txTone,
       AnalogChannel::Bandwidth bw, qint64 line, qint64 column, QString &errorMessage);
   /** Gets called once a zone list has been parsed. */
@@ -171,22 +174,46 @@ public:
 /** The actual config file parser.
  *
  * This class parses the config file and calls the associated callback functions of a handler
- * instance that is responsible to assemble the final @c Config instance. */
+ * instance that is responsible to assemble the final @c Config instance.
+ *
+ * The file consists of independent tables and settings, hence it gets split into sections at
+ * every line starting with a keyword. The sections are tokenized and parsed in parallel into
+ * rows, only then the rows are passed to the handler in file order. */
 class CSVParser: public QObject
 {
   Q_OBJECT
 
+public:
+  /** A parsed row, passes the parsed values to the given handler. */
+  typedef std::function<bool(CSVHandler *handler, QString &errorMessage)> Row;
+
 public:
   /** Constructs a parser using the given handler instance. */
   explicit CSVParser(CSVHandler *handler, QObject *parent=nullptr);
 
-  /** Parses the given text stream. */
+  /** Parses the given text stream and passes all rows to the handler. */
   bool parse(QTextStream &stream);
+  /** Passes all rows parsed by the last call to @c parse to the handler again. */
+  bool replay();
 
   /** Returns the current error message, for example if @c parse returns @c false. */
   const QString &errorMessage() const;
 
 protected:
+  /** A section of the file. */
+  typedef struct {
+    /** The text of the section. */
+    QString text;
+    /** The line number of the first line. */
+    qint64 line;
+  } Section;
+
+protected:
+  /** Parses all tables and settings of the given lexer into rows. */
+  bool _parse(CSVLexer &lexer);
+  /** Appends the given row. */
+  bool _record(const Row &row);
+
   /** Internal function to parse DMR IDs. */
   bool _parse_radio_id(CSVLexer &lexer);
   /** Internal function to parse radio names. */
@@ -243,6 +270,8 @@ protected:
   QString _errorMessage;
   /** The handler instance. */
   CSVHandler *_handler;
+  /** The parsed rows. */
+  QVector<Row> _rows;
 };
 
 
@@ -276,11 +305,11 @@ public:
   virtual bool handleGroupList(qint64 idx, const QString &name, const QList<qint64> &contacts,
                                qint64 line, qint64 column, QString &errorMessage);
   virtual bool handleDigitalChannel(
-      qint64 idx, const QString &name, double rx, double tx, Channel::Power power, qint64 scan,
+      qint64 idx, const QString &name, Frequency rx, Frequency tx, Channel::Power power, qint64 scan,
       qint64 tot, bool ro, DigitalChannel::Admit admit, qint64 color, DigitalChannel::TimeSlot slot,
       qint64 gl, qint64 contact, qint64 gps, qint64 roam, qint64 line, qint64 column, QString &errorMessage);
   virtual bool handleAnalogChannel(
-      qint64 idx, const QString &name, double rx, double tx, Channel::Power power, qint64 scan, qint64 aprs,
+      qint64 idx, const QString &name, Frequency rx, Frequency tx, Channel::Power power, qint64 scan, qint64 aprs,
       qint64 tot, bool ro, AnalogChannel::Admit admit, qint64 squelch, Signaling::Code rxTone, Signaling::Code txTone,
       AnalogChannel::Bandwidth bw, qint64 line, qint64 column, QString &errorMessage);
   virtual bool handleZone(qint64 idx, const QString &name, bool a, const QList<qint64> &channels,
@@ -64,11 +64,11 @@ CSVWriter::write(const Config *config, QTextStream &stream, QString &errorMessag
     DigitalChannel *digi = config->channelList()->channel(i)->as<DigitalChannel>();
     stream << qSetFieldWidth(8)  << (i+1)
            << qSetFieldWidth(20) << ("\"" + digi->name() + "\"")
-           << qSetFieldWidth(11) << format_frequency(digi->rxFrequency());
-    if (digi->txFrequency()<digi->rxFrequency())
-      stream << qSetFieldWidth(11) << format_frequency(digi->txFrequency()-digi->rxFrequency());
+           << qSetFieldWidth(11) << format_frequency_hz(digi->rxFrequencyHz());
+    if (digi->txFrequencyHz()<digi->rxFrequencyHz())
+      stream << qSetFieldWidth(11) << format_frequency_hz(digi->txFrequencyHz()-digi->rxFrequencyHz());
     else
-      stream << qSetFieldWidth(11) << format_frequency(digi->txFrequency());
+      stream << qSetFieldWidth(11) << format_frequency_hz(digi->txFrequencyHz());
     stream << qSetFieldWidth(6)  << power2string(digi->power())
            << qSetFieldWidth(5)  << ( nullptr != digi->scanList() ?
           QString::number(config->scanlists()->indexOf(digi->scanList())+1) : QString("-") )
@@ -126,11 +126,11 @@ CSVWriter::write(const Config *config, QTextStream &stream, QString &errorMessag
     AnalogChannel *analog = config->channelList()->channel(i)->as<AnalogChannel>();
     stream << qSetFieldWidth(8)  << (i+1)
            << qSetFieldWidth(20) << ("\"" + analog->name() + "\"")
-           << qSetFieldWidth(10) << format_frequency(analog->rxFrequency());
-    if (analog->txFrequency()<analog->rxFrequency())
-      stream << qSetFieldWidth(11) << format_frequency(analog->txFrequency()-analog->rxFrequency());
+           << qSetFieldWidth(10) << format_frequency_hz(analog->rxFrequencyHz());
+    if (analog->txFrequencyHz()<analog->rxFrequencyHz())
+      stream << qSetFieldWidth(11) << format_frequency_hz(analog->txFrequencyHz()-analog->rxFrequencyHz());
     else
-      stream << qSetFieldWidth(11) << format_frequency(analog->txFrequency());
+      stream << qSetFieldWidth(11) << format_frequency_hz(analog->txFrequencyHz());
     stream << qSetFieldWidth(6)  << power2string(analog->power())
            << qSetFieldWidth(5)  << ( nullptr != analog->scanList() ? QString::number(config->scanlists()->indexOf(analog->scanList())+1) : QString("-") )
            << qSetFieldWidth(4)  << ( (0 == analog->txTimeout()) ? QString("-") : QString::number(analog->txTimeout()) )
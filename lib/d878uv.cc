@@ -1,11 +1,86 @@
 #include "d878uv.hh"
 #include "config.hh"
 #include "logger.hh"
+#include "uploadjournal.hh"
+#include "uploadcache.hh"
+#include <QThreadPool>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <algorithm>
 
 #define RBSIZE 16
 #define WBSIZE 16
 
 
+/// @cond with_internal_docs
+/** Encodes all sections of a @c D878UVCodeplug that do not depend on the memory read from the
+ * device within the thread pool. Finished sections get queued for the writer. The memory must be
+ * allocated before the encoder is started.
+ *
+ * The encoder reads the configuration without any locking. Hence, the configuration must not be
+ * modified until the encoder is done. The radio passes its private copy loaded from the snapshot
+ * (see @c Radio::loadSnapshot), never the configuration edited by the user. The sections only
+ * write to their @c D878UVCodeplug::sectionSpans, which are disjoint from the memory read from
+ * the device meanwhile. */
+class SectionEncoder: public QRunnable
+{
+public:
+  SectionEncoder(D878UVCodeplug &codeplug, Config *config, const CodePlug::Flags &flags)
+    : QRunnable(), _codeplug(codeplug), _config(config), _flags(flags), _started(false),
+      _done(false)
+  {
+    setAutoDelete(false);
+  }
+
+  /** Waits for the encoder, it must not be destroyed while running. */
+  ~SectionEncoder() {
+    QMutexLocker lock(&_mutex);
+    while (_started && (! _done))
+      _cond.wait(&_mutex);
+  }
+
+  void start() {
+    _started = true;
+    QThreadPool::globalInstance()->start(this);
+  }
+
+  void run() {
+    for (int s=D878UVCodeplug::RadioIDSection; s<D878UVCodeplug::SettingsSection; s++) {
+      _codeplug.encodeSection(D878UVCodeplug::Section(s), _config, _flags);
+      QMutexLocker lock(&_mutex);
+      _finished.enqueue(D878UVCodeplug::Section(s));
+      _cond.wakeAll();
+    }
+    QMutexLocker lock(&_mutex);
+    _done = true;
+    _cond.wakeAll();
+  }
+
+  /** Takes the next finished section from the queue. If @c block is @c true, waits until a
+   * section is finished. Returns @c false if there is no finished section (left). */
+  bool next(D878UVCodeplug::Section &section, bool block) {
+    QMutexLocker lock(&_mutex);
+    while (block && _finished.isEmpty() && (! _done))
+      _cond.wait(&_mutex);
+    if (_finished.isEmpty())
+      return false;
+    section = _finished.dequeue();
+    return true;
+  }
+
+protected:
+  D878UVCodeplug &_codeplug;
+  Config *_config;
+  CodePlug::Flags _flags;
+  QMutex _mutex;
+  QWaitCondition _cond;
+  QQueue<D878UVCodeplug::Section> _finished;
+  bool _started, _done;
+};
+/// @endcond
+
+
 static Radio::Features _d878uv_features =
 {
   // show beta-warning
@@ -58,13 +133,14 @@ static Radio::Features _d878uv_features =
 
   // call-sign database limits
   .hasCallsignDB          = true,  // hasCallsignDB
-  .callsignDBImplemented  = false, // callsignDBImplemented
-  .maxCallsignsInDB       = 0      // maxCallsignsInDB
+  .callsignDBImplemented  = true,  // callsignDBImplemented
+  .maxCallsignsInDB       = 200000 // maxCallsignsInDB
 };
 
 
 D878UV::D878UV(QObject *parent)
-  : Radio(parent), _name("Anytone AT-D878UV"), _dev(nullptr), _codeplugFlags(), _config(nullptr)
+  : Radio(parent), _name("Anytone AT-D878UV"), _dev(nullptr), _codeplugFlags(), _config(nullptr),
+    _userDB(nullptr)
 {
   // pass...
 }
@@ -110,7 +186,7 @@ D878UV::startUpload(Config *config, bool blocking, const CodePlug::Flags &flags)
   if (StatusIdle != _task)
     return false;
 
-  if (! (_config = config))
+  if (! takeSnapshot(config))
     return false;
 
   _task = StatusUpload;
@@ -126,12 +202,20 @@ D878UV::startUpload(Config *config, bool blocking, const CodePlug::Flags &flags)
 
 bool
 D878UV::startUploadCallsignDB(UserDatabase *db, bool blocking) {
-  Q_UNUSED(db);
-  Q_UNUSED(blocking);
+  if (StatusIdle != _task)
+    return false;
+
+  if (! (_userDB = db))
+    return false;
 
-  _errorMessage = tr("RD5R does not support a callsign DB.");
+  _task = StatusUploadCallsigns;
+  if (blocking) {
+    this->run();
+    return (StatusIdle == _task);
+  }
 
-  return false;
+  this->start();
+  return true;
 }
 
 void
@@ -152,6 +236,10 @@ D878UV::run() {
   } else if (StatusUpload == _task) {
     emit uploadStarted();
 
+    SnapshotGuard snapshot(this, _config);
+    if (snapshot.isNull())
+      return;
+
     if (! upload())
       return;
 
@@ -161,13 +249,24 @@ D878UV::run() {
     _dev->deleteLater();
 
     emit uploadComplete(this);
+  } else if (StatusUploadCallsigns == _task) {
+    emit uploadStarted();
+
+    if (! uploadCallsigns())
+      return;
+
+    _task = StatusIdle;
+    _dev->reboot();
+    _dev->close();
+    _dev->deleteLater();
+
+    emit uploadComplete(this);
+    _userDB = nullptr;
   }
 }
 
 bool
 D878UV::download() {
-  logDebug() << "Download of " << _codeplug.image(0).numElements() << " bitmaps.";
-
   // The first thing happening within the thread is creating the interface to the device.
   // For some reason this object cannot be created outside of the thread.
   _dev = new AnytoneInterface(this);
@@ -179,13 +278,15 @@ D878UV::download() {
     return false;
   }
 
+  // Start from an empty codeplug holding the bitmaps only
+  _codeplug.clear();
+
   // Download bitmaps
-  for (int n=0; n<_codeplug.image(0).numElements(); n++) {
-    uint addr = _codeplug.image(0).element(n).address();
-    uint size = _codeplug.image(0).element(n).data().size();
-    if (! _dev->read(0, addr, _codeplug.data(addr), size)) {
+  QVector<CodePlug::PagedImage::Run> runs = _codeplug.memory().runs(true);
+  for (int n=0; n<runs.size(); n++) {
+    if (cancelRequested() || (! _dev->read(0, runs[n].address, _codeplug.data(runs[n].address), runs[n].size))) {
       _errorMessage = QString("%1 Cannot download codeplug: %2").arg(__func__)
-          .arg(_dev->errorMessage());
+          .arg(transferError(_dev));
       logError() << _errorMessage;
       _task = StatusError;
       _dev->reboot();
@@ -194,37 +295,28 @@ D878UV::download() {
       emit downloadError(this);
       return false;
     }
-    emit downloadProgress(float(n*100)/_codeplug.image(0).numElements());
+    _codeplug.memory().markClean(runs[n].address, runs[n].size);
+    setProgress(float(n*10)/runs.size(), runs[n].size);
   }
 
-  // Allocate remaining memory sections
-  uint nstart = _codeplug.image(0).numElements();
-  _codeplug.allocateForDecoding();
-
-  // Check every segment in the remaining codeplug
-  for (int n=nstart; n<_codeplug.image(0).numElements(); n++) {
-    if (! _codeplug.image(0).element(n).isAligned(RBSIZE)) {
-      _errorMessage = QString("%1 Cannot download codeplug: Codeplug element %2 (addr=%3, size=%4) "
-                              "is not aligned with blocksize %5.").arg(__func__)
-          .arg(n).arg(_codeplug.image(0).element(n).address())
-          .arg(_codeplug.image(0).element(n).data().size()).arg(RBSIZE);
-      logError() << _errorMessage;
-      _task = StatusError;
-      _dev->reboot();
-      _dev->close();
-      _dev->deleteLater();
-      emit downloadError(this);
-      return false;
-    }
+  // Allocate remaining memory sections. These are block-aligned, hence aligned with RBSIZE.
+  if (! _codeplug.allocateForDecoding()) {
+    _errorMessage = QString("%1 Cannot download codeplug: %2").arg(__func__)
+        .arg(_codeplug.errorMessage());
+    _task = StatusError;
+    _dev->reboot();
+    _dev->close();
+    _dev->deleteLater();
+    emit downloadError(this);
+    return false;
   }
 
-  // Download remaining memory sections
-  for (int n=nstart; n<_codeplug.image(0).numElements(); n++) {
-    uint addr = _codeplug.image(0).element(n).address();
-    uint size = _codeplug.image(0).element(n).data().size();
-    if (! _dev->read(0, addr, _codeplug.data(addr), size)) {
+  // Download remaining memory sections, that is all memory not read yet
+  runs = _codeplug.memory().runs(true);
+  for (int n=0; n<runs.size(); n++) {
+    if (cancelRequested() || (! _dev->read(0, runs[n].address, _codeplug.data(runs[n].address), runs[n].size))) {
       _errorMessage = QString("%1 Cannot download codeplug: %2").arg(__func__)
-          .arg(_dev->errorMessage());
+          .arg(transferError(_dev));
       logError() << _errorMessage;
       _task = StatusError;
       _dev->reboot();
@@ -233,7 +325,8 @@ D878UV::download() {
       emit downloadError(this);
       return false;
     }
-    emit downloadProgress(float(n*100)/_codeplug.image(0).numElements());
+    _codeplug.memory().markClean(runs[n].address, runs[n].size);
+    setProgress(10+float(n*90)/runs.size(), runs[n].size);
   }
 
   return true;
@@ -252,14 +345,15 @@ D878UV::upload() {
     return false;
   }
 
+  // Start from an empty codeplug holding the bitmaps only
+  _codeplug.clear();
+
   // Download bitmaps first
-  size_t nbitmaps = _codeplug.numImages();
-  for (int n=0; n<_codeplug.image(0).numElements(); n++) {
-    uint addr = _codeplug.image(0).element(n).address();
-    uint size = _codeplug.image(0).element(n).data().size();
-    if (! _dev->read(0, addr, _codeplug.data(addr), size)) {
+  QVector<CodePlug::PagedImage::Run> runs = _codeplug.memory().runs(true);
+  for (int n=0; n<runs.size(); n++) {
+    if (cancelRequested() || (! _dev->read(0, runs[n].address, _codeplug.data(runs[n].address), runs[n].size))) {
       _errorMessage = QString("%1 Cannot read codeplug for update: %2").arg(__func__)
-          .arg(_dev->errorMessage());
+          .arg(transferError(_dev));
       logError() << _errorMessage;
       _task = StatusError;
       _dev->reboot();
@@ -268,19 +362,70 @@ D878UV::upload() {
       emit uploadError(this);
       return false;
     }
-    emit uploadProgress(float(n*25)/_codeplug.image(0).numElements());
+    _codeplug.memory().markClean(runs[n].address, runs[n].size);
+    setProgress(float(n*5)/runs.size(), runs[n].size);
   }
 
+  // The bitmaps as read identify the device state for the upload cache
+  QVector<CodePlug::PagedImage::Run> bitmaps = runs;
+  QByteArray deviceState = UploadCache::hash(_codeplug.memory(), bitmaps);
+
   // Allocate all memory sections that must be read first
   // and written back to the device more or less untouched
-  _codeplug.allocateUntouched();
-  // Download new memory sections for update
-  for (int n=nbitmaps; n<_codeplug.image(0).numElements(); n++) {
-    uint addr = _codeplug.image(0).element(n).address();
-    uint size = _codeplug.image(0).element(n).data().size();
-    if (! _dev->read(0, addr, _codeplug.data(addr), size)) {
+  if (! _codeplug.allocateUntouched()) {
+    _errorMessage = QString("%1 Cannot upload codeplug: %2").arg(__func__)
+        .arg(_codeplug.errorMessage());
+    _task = StatusError;
+    _dev->reboot();
+    _dev->close();
+    _dev->deleteLater();
+    emit uploadError(this);
+    return false;
+  }
+  QVector<CodePlug::PagedImage::Run> untouched = _codeplug.memory().runs(true);
+
+  // Update bitmaps for all elements representing the common Config
+  _codeplug.setBitmaps(_config);
+  // Allocate all memory elements representing the common config. The memory layout is fixed from
+  // here on and all allocated memory is pending to be written.
+  if (! _codeplug.allocateForEncoding()) {
+    _errorMessage = QString("%1 Cannot upload codeplug: %2").arg(__func__)
+        .arg(_codeplug.errorMessage());
+    _task = StatusError;
+    _dev->reboot();
+    _dev->close();
+    _dev->deleteLater();
+    emit uploadError(this);
+    return false;
+  }
+  uint done = 0, total = _codeplug.memory().memSize();
+  foreach (const CodePlug::PagedImage::Run &run, _codeplug.memory().runs())
+    _codeplug.memory().markDirty(run.address, run.size);
+  foreach (const CodePlug::PagedImage::Run &run, untouched)
+    total += run.size;
+
+  // All sections that do not depend on the device content get encoded in the background, while
+  // the untouched memory is read. Finished sections are written as soon as possible. Hence, the
+  // journal gets bound to the memory layout before the first write, the content of every piece is
+  // identified by its CRC. Records unchanged since the last upload are skipped, if the bitmaps
+  // match the ones written by it.
+  UploadJournal journal(name()+" codeplug", _dev->identity());
+  UploadCache cache(name()+" codeplug", _dev->identity());
+  journal.open(UploadJournal::layout(_codeplug.memory()));
+  if (journal.isResumable())
+    logDebug() << "Resume previous upload, skip pieces already written.";
+  journal.begin();
+  if (cache.load(deviceState))
+    logDebug() << "Write records changed since the last upload only.";
+  SectionEncoder encoder(_codeplug, _config, _codeplugFlags);
+  encoder.start();
+
+  // Download untouched memory sections for update
+  D878UVCodeplug::Section section;
+  for (int n=0; n<untouched.size(); n++) {
+    if (cancelRequested() || (! _dev->read(0, untouched[n].address, _codeplug.data(untouched[n].address), untouched[n].size))) {
       _errorMessage = QString("%1 Cannot read codeplug for update: %2").arg(__func__)
-          .arg(_dev->errorMessage());
+          .arg(transferError(_dev));
       logError() << _errorMessage;
       _task = StatusError;
       _dev->reboot();
@@ -289,18 +434,42 @@ D878UV::upload() {
       emit uploadError(this);
       return false;
     }
-    emit uploadProgress(25+float(n*25)/_codeplug.image(0).numElements());
+    done += untouched[n].size;
+    setProgress(5+float(done)*95/total, untouched[n].size);
+    // Write sections encoded in the meantime
+    while (encoder.next(section, false)) {
+      if (! writePending(D878UVCodeplug::sectionSpans(section), journal, cache, done, total)) {
+        _task = StatusError;
+        _dev->reboot();
+        _dev->close();
+        _dev->deleteLater();
+        emit uploadError(this);
+        return false;
+      }
+    }
   }
 
-  // Update bitmaps for all elements representing the common Config
-  _codeplug.setBitmaps(_config);
-  // Allocate all memory elements representing the common config
-  _codeplug.allocateForEncoding();
+  // Records skipped so far get written, if the untouched memory changed since the last upload
+  done -= cache.verify(_codeplug.memory(), UploadCache::hash(_codeplug.memory(), untouched));
 
-  // Update binary codeplug from config
-  if (! _codeplug.encode(_config, _codeplugFlags)) {
-    _errorMessage = QString("Cannot encode codeplug: %1").arg(_codeplug.errorMessage());
-    logError() << _errorMessage;
+  // Write all remaining sections, once encoded
+  while (encoder.next(section, true)) {
+    if (! writePending(D878UVCodeplug::sectionSpans(section), journal, cache, done, total)) {
+      _task = StatusError;
+      _dev->reboot();
+      _dev->close();
+      _dev->deleteLater();
+      emit uploadError(this);
+      return false;
+    }
+  }
+
+  // Update the memory read from the device. This happens after the encoder has finished, as the
+  // settings refer to other objects of the config.
+  _codeplug.encodeSection(D878UVCodeplug::SettingsSection, _config, _codeplugFlags);
+
+  // Write bitmaps, settings and untouched memory
+  if (! writePending(QVector<CodePlug::PagedImage::Run>(), journal, cache, done, total)) {
     _task = StatusError;
     _dev->reboot();
     _dev->close();
@@ -308,17 +477,102 @@ D878UV::upload() {
     emit uploadError(this);
     return false;
   }
+  journal.finish();
+
+  // Record the upload, the device state is given by the bitmaps and untouched memory as written
+  cache.store(UploadCache::hash(_codeplug.memory(), bitmaps),
+              UploadCache::hash(_codeplug.memory(), untouched));
+
+  //_codeplug.write("debug_codeplug.dfu");
+  return true;
+}
+
+bool
+D878UV::writePending(const QVector<CodePlug::PagedImage::Run> &spans, UploadJournal &journal,
+                     UploadCache &cache, uint &done, uint total)
+{
+  // Skip memory that did not change since the last upload, if the device content still matches
+  if (uint32_t skipped = cache.skipUnchanged(_codeplug.memory(), spans)) {
+    done += skipped;
+    setProgress(5+float(done)*95/total);
+  }
 
-  // Sort all elements before uploading
-  _codeplug.image(0).sort();
+  // Split pending memory at the given spans
+  QVector<CodePlug::PagedImage::Run> pieces;
+  foreach (const CodePlug::PagedImage::Run &run, _codeplug.memory().runs(true)) {
+    if (spans.isEmpty()) {
+      pieces.append(run);
+      continue;
+    }
+    foreach (const CodePlug::PagedImage::Run &span, spans) {
+      uint32_t start = std::max(run.address, span.address);
+      uint32_t end = std::min(run.address+run.size, span.address+span.size);
+      if (start < end)
+        pieces.append({start, end-start});
+    }
+  }
 
-  // Upload all elements back to the device
-  for (int n=0; n<_codeplug.image(0).numElements(); n++) {
-    uint addr = _codeplug.image(0).element(n).address();
-    uint size = _codeplug.image(0).element(n).data().size();
-    if (! _dev->write(0, addr, _codeplug.data(addr), size)) {
+  foreach (const CodePlug::PagedImage::Run &piece, pieces) {
+    uint32_t crc = UploadJournal::crc(_codeplug.data(piece.address), piece.size);
+    // Skip memory written by a previous upload, if the device content matches
+    bool written = false;
+    if (journal.isConfirmed(piece.address, crc)) {
+      QByteArray buffer(piece.size, 0);
+      written = _dev->read(0, piece.address, (uint8_t *)buffer.data(), piece.size)
+          && (crc == UploadJournal::crc((uint8_t *)buffer.data(), piece.size));
+      if (! written)
+        journal.reject(piece.address);
+    }
+    if ((! written) && (cancelRequested() || (! _dev->write(0, piece.address, _codeplug.data(piece.address), piece.size)))) {
       _errorMessage = QString("%1 Cannot upload codeplug: %2").arg(__func__)
-          .arg(_dev->errorMessage());
+          .arg(transferError(_dev));
+      logError() << _errorMessage;
+      return false;
+    }
+    journal.confirm(piece.address, crc);
+    _codeplug.memory().markClean(piece.address, piece.size);
+    done += piece.size;
+    setProgress(5+float(done)*95/total, piece.size);
+  }
+
+  return true;
+}
+
+bool
+D878UV::uploadCallsigns() {
+  // The first thing happening within the thread is creating the interface to the device.
+  // For some reason this object cannot be created outside of the thread.
+  _dev = new AnytoneInterface(this);
+  if (! _dev->isOpen()) {
+    _errorMessage = QString("Cannot open device: %1").arg(_dev->errorMessage());
+    _dev->deleteLater();
+    _task = StatusError;
+    emit uploadError(this);
+    return false;
+  }
+
+  if (! _dev->write_start(0, 0)) {
+    _errorMessage = QString("%1 Cannot upload call-sign DB: %2").arg(__func__)
+        .arg(_dev->errorMessage());
+    logError() << _errorMessage;
+    _task = StatusError;
+    _dev->close();
+    _dev->deleteLater();
+    emit uploadError(this);
+    return false;
+  }
+
+  // Encode and upload the call-sign DB chunk by chunk
+  _callsigns.encode(_userDB, _d878uv_features.maxCallsignsInDB);
+  logDebug() << "Upload call-sign DB of " << _callsigns.count() << " entries ("
+             << _callsigns.size() << "b).";
+
+  uint32_t addr; QByteArray data;
+  qint64 written = 0;
+  while (_callsigns.next(addr, data)) {
+    if (cancelRequested() || (! _dev->write(0, addr, (uint8_t *)data.data(), data.size()))) {
+      _errorMessage = QString("%1 Cannot upload call-sign DB: %2").arg(__func__)
+          .arg(transferError(_dev));
       logError() << _errorMessage;
       _task = StatusError;
       _dev->reboot();
@@ -327,9 +581,9 @@ D878UV::upload() {
       emit uploadError(this);
       return false;
     }
-    emit uploadProgress(50+float(n*50)/_codeplug.image(0).numElements());
+    written += data.size();
+    setProgress(float(written*100)/_callsigns.size(), data.size());
   }
-  //_codeplug.write("debug_codeplug.dfu");
+
   return true;
 }
-
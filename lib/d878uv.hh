@@ -11,6 +11,10 @@
 #include "radio.hh"
 #include "anytone_interface.hh"
 #include "d878uv_codeplug.hh"
+#include "d878uv_callsigndb.hh"
+
+class UploadJournal;
+class UploadCache;
 
 
 /** Implements an interface to Anytone AT-D878UV VHF/UHF 7W DMR (Tier I & II) radios.
@@ -64,6 +68,16 @@ protected:
   bool download();
   /** Uploads the encoded codeplug to the radio. This method block until the upload is complete. */
   bool upload();
+  /** Encodes and uploads the call-sign DB to the radio. This method block until the upload is
+   * complete. */
+  bool uploadCallsigns();
+  /** Writes all pending memory of the codeplug within the given address ranges (or all pending
+   * memory, if @c spans is empty) to the device and records it in the @c journal. Memory
+   * confirmed by the journal is skipped, if it matches the device content. So is memory that
+   * did not change since the last upload recorded by the @c cache. @c done gets incremented by
+   * the number of bytes written or skipped out of @c total. */
+  bool writePending(const QVector<CodePlug::PagedImage::Run> &spans, UploadJournal &journal,
+                    UploadCache &cache, uint &done, uint total);
 
 protected:
   /** The device identifier. */
@@ -79,6 +93,8 @@ protected:
   UserDatabase *_userDB;
   /** The actual binary codeplug representation. */
   D878UVCodeplug _codeplug;
+  /** The streaming call-sign DB encoder. */
+  D878UVCallsignDB _callsigns;
 };
 
 #endif // __D878UV_HH__
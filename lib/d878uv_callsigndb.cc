@@ -0,0 +1,142 @@
+#include "d878uv_callsigndb.hh"
+#include "utils.hh"
+#include <QtEndian>
+#include <algorithm>
+
+#define INDEX_START          0x04000000  // Start of the ID index
+#define LIMITS_ADDR          0x044c0000  // Address of the DB limits
+#define RECORD_BANK_0        0x04500000  // Start of the first record bank
+#define RECORD_BANK_SIZE     0x000186a0  // Size of each record bank
+#define RECORD_BANK_OFFSET   0x00040000  // Offset between record banks
+#define CHUNK_SIZE           0x00000400  // Maximum size of emitted chunks
+
+
+/* ********************************************************************************************* *
+ * Implementation of D878UVCallsignDB
+ * ********************************************************************************************* */
+D878UVCallsignDB::D878UVCallsignDB()
+  : _db(nullptr), _order(), _size(0), _next(0), _index(), _indexOffset(0), _records(),
+    _recordOffset(0), _done(true)
+{
+  // pass...
+}
+
+void
+D878UVCallsignDB::encode(const UserDatabase *db, uint maxUsers) {
+  _db = db;
+  _order.clear();
+  _index.clear(); _indexOffset = 0;
+  _records.clear(); _recordOffset = 0;
+  _next = 0;
+  _done = false;
+
+  // Select the first n users and order them by their ID
+  int n = std::min(db->count(), qint64(maxUsers));
+  _order.resize(n);
+  for (int i=0; i<n; i++)
+    _order[i] = i;
+  std::sort(_order.begin(), _order.end(),
+            [db](int a, int b) { return db->user(a).id < db->user(b).id; });
+
+  // Determine the number of bytes to write
+  qint64 records = 0;
+  for (int i=0; i<n; i++)
+    records += encodeRecord(db->user(i)).size();
+  _size = align_size(8*qint64(n), 16) + align_size(records, 16) + 16;
+}
+
+uint
+D878UVCallsignDB::count() const {
+  return _order.size();
+}
+
+qint64
+D878UVCallsignDB::size() const {
+  return _size;
+}
+
+bool
+D878UVCallsignDB::next(uint32_t &addr, QByteArray &data) {
+  if (_done)
+    return false;
+
+  // Index and records are encoded in lockstep, such that only a chunk of each is kept in memory.
+  while (_next < _order.size()) {
+    if (takeIndex(addr, data, false) || takeRecords(addr, data, false))
+      return true;
+    appendUser();
+  }
+
+  // Flush remaining index entries and records
+  if (takeIndex(addr, data, true) || takeRecords(addr, data, true))
+    return true;
+
+  // Finally, write limits
+  addr = LIMITS_ADDR;
+  data = QByteArray(16, 0x00);
+  qToLittleEndian(uint32_t(_order.size()), (uchar *)data.data()+0);
+  qToLittleEndian(recordAddress(_recordOffset), (uchar *)data.data()+4);
+  _done = true;
+  return true;
+}
+
+void
+D878UVCallsignDB::appendUser() {
+  const UserDatabase::User &user = _db->user(_order[_next++]);
+  uchar entry[8];
+  qToBigEndian(encode_bcd8(user.id), entry+0);
+  qToLittleEndian(uint32_t(_recordOffset+_records.size()), entry+4);
+  _index.append((const char *)entry, sizeof(entry));
+  _records.append(encodeRecord(user));
+}
+
+bool
+D878UVCallsignDB::takeIndex(uint32_t &addr, QByteArray &data, bool flush) {
+  if ((_index.size() < CHUNK_SIZE) && ((! flush) || _index.isEmpty()))
+    return false;
+
+  int n = std::min(_index.size(), CHUNK_SIZE);
+  addr = INDEX_START + _indexOffset;
+  data = _index.left(n);
+  data.append(QByteArray(align_size(n, 16)-n, 0x00));
+  _index.remove(0, n);
+  _indexOffset += n;
+  return true;
+}
+
+bool
+D878UVCallsignDB::takeRecords(uint32_t &addr, QByteArray &data, bool flush) {
+  // Chunks must not cross bank boundaries
+  int limit = std::min(uint32_t(CHUNK_SIZE), RECORD_BANK_SIZE - (_recordOffset % RECORD_BANK_SIZE));
+  if ((_records.size() < limit) && ((! flush) || _records.isEmpty()))
+    return false;
+
+  int n = std::min(_records.size(), limit);
+  addr = recordAddress(_recordOffset);
+  data = _records.left(n);
+  data.append(QByteArray(align_size(n, 16)-n, 0x00));
+  _records.remove(0, n);
+  _recordOffset += n;
+  return true;
+}
+
+uint32_t
+D878UVCallsignDB::recordAddress(uint32_t offset) {
+  return RECORD_BANK_0 + (offset/RECORD_BANK_SIZE)*RECORD_BANK_OFFSET + (offset%RECORD_BANK_SIZE);
+}
+
+QByteArray
+D878UVCallsignDB::encodeRecord(const UserDatabase::User &user) {
+  QString name = user.name;
+  if (! user.surname.isEmpty())
+    name += " " + user.surname;
+
+  QByteArray rec(2, 0x00);
+  rec.append(name.left(16).toLatin1()).append('\0');
+  rec.append('\0');                                     // city
+  rec.append(user.call.left(8).toLatin1()).append('\0');
+  rec.append('\0');                                     // state
+  rec.append(user.country.left(16).toLatin1()).append('\0');
+  rec.append('\0');                                     // comment
+  return rec;
+}
@@ -0,0 +1,87 @@
+#ifndef D878UVCALLSIGNDB_HH
+#define D878UVCALLSIGNDB_HH
+
+#include <QVector>
+#include <QByteArray>
+#include "userdatabase.hh"
+
+/** Streaming encoder of the call-sign (digital contact) database of Anytone AT-D878UV radios.
+ *
+ * Unlike the call-sign DBs of the TyT and OpenGD77 devices, the D878UV call-sign DB can hold
+ * several 100k entries. Hence the database is not assembled as a complete binary image in memory.
+ * Instead, the encoder emits the database as a sequence of small chunks (see @c next) which can
+ * be written to the device immediately.
+ *
+ * The database consists of three parts:
+ * @verbatim
+ * 0x04000000  ID index, 8 bytes per entry, ordered by ID:
+ *               0x00  DMR ID, 8 digit BCD big-endian,
+ *               0x04  offset of the record within the records, 32bit little-endian.
+ * 0x044c0000  Limits, 16 bytes:
+ *               0x00  number of entries, 32bit little-endian,
+ *               0x04  end address of the last record, 32bit little-endian,
+ *               0x08  8 bytes 0x00.
+ * 0x04500000  Records, 0x186a0 bytes per bank, banks every 0x40000 bytes. Each record is:
+ *               0x00  call type, 0x00 = private call,
+ *               0x01  ring style, 0x00 = off,
+ *               0x02  name, city, call, state, country, comment as 0-terminated ASCII strings.
+ * @endverbatim
+ *
+ * @ingroup d878uv */
+class D878UVCallsignDB
+{
+public:
+  /** Constructs an empty call-sign DB encoder. */
+  D878UVCallsignDB();
+
+  /** Prepares the encoding of the given user-database. The first @c maxUsers entries of the
+   * (sorted) database get selected and ordered by their ID. The actual encoding happens
+   * chunk-by-chunk in @c next. */
+  void encode(const UserDatabase *db, uint maxUsers=200000);
+
+  /** Returns the number of selected users. */
+  uint count() const;
+  /** Returns the total number of bytes, that will be emitted by @c next. */
+  qint64 size() const;
+
+  /** Encodes the next chunk of the database. Returns @c false if there are no chunks left.
+   * @param addr On exit, contains the device address of the chunk.
+   * @param data On exit, contains the chunk data. The size is always a multiple of 16 bytes. */
+  bool next(uint32_t &addr, QByteArray &data);
+
+protected:
+  /** Appends the index entry and record of the next selected user to the pending buffers. */
+  void appendUser();
+  /** Emits the next chunk of the pending index entries, if there is a complete one or
+   * @c flush is @c true. */
+  bool takeIndex(uint32_t &addr, QByteArray &data, bool flush);
+  /** Emits the next chunk of the pending records, if there is a complete one or
+   * @c flush is @c true. Chunks never cross a bank boundary. */
+  bool takeRecords(uint32_t &addr, QByteArray &data, bool flush);
+  /** Maps the given offset within the records to a device address. */
+  static uint32_t recordAddress(uint32_t offset);
+  /** Encodes the record of the given user. */
+  static QByteArray encodeRecord(const UserDatabase::User &user);
+
+protected:
+  /** A weak reference to the user-database. */
+  const UserDatabase *_db;
+  /** Indices of the selected users ordered by their ID. */
+  QVector<int> _order;
+  /** Total number of bytes, that will be emitted. */
+  qint64 _size;
+  /** Index of the next user to encode. */
+  int _next;
+  /** Pending index entries. */
+  QByteArray _index;
+  /** Offset of the first pending index entry. */
+  uint32_t _indexOffset;
+  /** Pending records. */
+  QByteArray _records;
+  /** Offset of the first pending record byte. */
+  uint32_t _recordOffset;
+  /** If @c true, the limits were emitted and the encoding is complete. */
+  bool _done;
+};
+
+#endif // D878UVCALLSIGNDB_HH
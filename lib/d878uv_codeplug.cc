@@ -175,7 +175,8 @@ static_assert(
 
 using namespace Signaling;
 
-Code ctcss_num2code[52] = {
+/** Maps the CTCSS tone index of the device to the Signaling::Code. */
+static const Code ctcss_num2code[52] = {
   SIGNALING_NONE, // 62.5 not supported
   CTCSS_67_0Hz,  CTCSS_71_0Hz,  CTCSS_74_4Hz,  CTCSS_77_0Hz,  CTCSS_79_9Hz,  CTCSS_82_5Hz,
   CTCSS_85_4Hz,  CTCSS_88_5Hz,  CTCSS_91_5Hz,  CTCSS_94_8Hz,  CTCSS_97_4Hz,  CTCSS_100_0Hz,
@@ -203,12 +204,19 @@ Code ctcss_num2code[52] = {
   SIGNALING_NONE, SIGNALING_NONE // 254.1 and custom CTCSS not supported.
 };
 
-uint8_t ctcss_code2num(Signaling::Code code) {
-  for (uint8_t i=0; i<52; i++) {
-    if (code == ctcss_num2code[i])
-      return i;
-  }
-  return 0;
+/** Maps the Signaling::Code, starting with @c CTCSS_67_0Hz, to the CTCSS tone index of the
+ * device. This is the inverse of @c ctcss_num2code. */
+static const uint8_t ctcss_code2num_table[] = {
+   1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24,
+  25, 27, 29, 31, 33, 35, 37, 40, 42, 43, 44, 46, 47, 48
+};
+static_assert(sizeof(ctcss_code2num_table) == (CTCSS_250_3Hz-CTCSS_67_0Hz+1),
+              "CTCSS tone index table does not match Signaling::Code.");
+
+static uint8_t ctcss_code2num(Signaling::Code code) {
+  if (! Signaling::isCTCSS(code))
+    return 0;
+  return ctcss_code2num_table[code-CTCSS_67_0Hz];
 }
 
 
@@ -362,8 +370,24 @@ D878UVCodeplug::channel_t::setTXTone(Code code) {
   }
 }
 
+void
+D878UVCodeplug::channel_t::parse(CodePlug::ParsedChannel &parsed) const {
+  parsed.name = getName();
+  parsed.rxFrequency = getRXFrequency();
+  parsed.txFrequency = getTXFrequency();
+  parsed.rxTone = getRXTone();
+  parsed.txTone = getTXTone();
+}
+
 Channel *
 D878UVCodeplug::channel_t::toChannelObj() const {
+  CodePlug::ParsedChannel parsed;
+  parse(parsed);
+  return toChannelObj(parsed);
+}
+
+Channel *
+D878UVCodeplug::channel_t::toChannelObj(const CodePlug::ParsedChannel &parsed) const {
   // Decode power setting
   Channel::Power power = Channel::LowPower;
   switch ((channel_t::Power) this->power) {
@@ -401,8 +425,8 @@ D878UVCodeplug::channel_t::toChannelObj() const {
     else
       bw = AnalogChannel::BWWide;
     ch = new AnalogChannel(
-          getName(), getRXFrequency(), getTXFrequency(), power, 0.0, rxOnly, admit,
-          1, getRXTone(), getTXTone(), bw, nullptr);
+          parsed.name, parsed.rxFrequency, parsed.txFrequency, power, 0.0, rxOnly, admit,
+          1, parsed.rxTone, parsed.txTone, bw, nullptr);
   } else if (MODE_DIGITAL == channel_mode) {
     DigitalChannel::Admit admit = DigitalChannel::AdmitNone;
     switch ((channel_t::Admit) tx_permit) {
@@ -419,10 +443,10 @@ D878UVCodeplug::channel_t::toChannelObj() const {
     }
     DigitalChannel::TimeSlot ts = (slot2 ? DigitalChannel::TimeSlot2 : DigitalChannel::TimeSlot1);
     ch = new DigitalChannel(
-          getName(), getRXFrequency(), getTXFrequency(), power, 0.0, rxOnly, admit,
+          parsed.name, parsed.rxFrequency, parsed.txFrequency, power, 0.0, rxOnly, admit,
           color_code, ts, nullptr, nullptr, nullptr, nullptr, nullptr);
   } else {
-    logError() << "Cannot create channel '" << getName()
+    logError() << "Cannot create channel '" << parsed.name
                << "': Mixed channel types not supported.";
     return nullptr;
   }
@@ -1144,7 +1168,7 @@ D878UVCodeplug::aprs_setting_t::toAPRSSystem() {
 void
 D878UVCodeplug::aprs_setting_t::linkAPRSSystem(APRSSystem *sys, CodeplugContext &ctx) {
   // First, try to find a matching analog channel in list
-  AnalogChannel *ch = ctx.config()->channelList()->findAnalogChannelByTxFreq(getFrequency());
+  AnalogChannel *ch = ctx.config()->channelList()->findAnalogChannelByTxFreq(mhz2hz(getFrequency()));
   if (! ch) {
     // If no channel is found, create one with the settings from APRS channel:
     ch = new AnalogChannel("APRS Channel", getFrequency(), getFrequency(), getPower(),
@@ -1317,22 +1341,22 @@ D878UVCodeplug::contact_map_t::setIndex(uint32_t index) {
 /* ******************************************************************************************** *
  * Implementation of D878UVCodeplug::roaming_channel_t
  * ******************************************************************************************** */
-double
+Frequency
 D878UVCodeplug::roaming_channel_t::getRXFrequency() const {
-  return decode_frequency(qFromBigEndian(rx_frequency));
+  return decode_frequency_hz(qFromBigEndian(rx_frequency));
 }
 void
-D878UVCodeplug::roaming_channel_t::setRXFrequency(double f) {
-  rx_frequency = qToBigEndian(encode_frequency(f));
+D878UVCodeplug::roaming_channel_t::setRXFrequency(Frequency f) {
+  rx_frequency = qToBigEndian(encode_frequency_hz(f));
 }
 
-double
+Frequency
 D878UVCodeplug::roaming_channel_t::getTXFrequency() const {
-  return decode_frequency(qFromBigEndian(tx_frequency));
+  return decode_frequency_hz(qFromBigEndian(tx_frequency));
 }
 void
-D878UVCodeplug::roaming_channel_t::setTXFrequency(double f) {
-  tx_frequency = qToBigEndian(encode_frequency(f));
+D878UVCodeplug::roaming_channel_t::setTXFrequency(Frequency f) {
+  tx_frequency = qToBigEndian(encode_frequency_hz(f));
 }
 
 DigitalChannel::TimeSlot
@@ -1370,8 +1394,8 @@ D878UVCodeplug::roaming_channel_t::setName(const QString &name) {
 void
 D878UVCodeplug::roaming_channel_t::fromChannel(DigitalChannel *ch) {
   setName(ch->name());
-  setRXFrequency(ch->rxFrequency());
-  setTXFrequency(ch->txFrequency());
+  setRXFrequency(ch->rxFrequencyHz());
+  setTXFrequency(ch->txFrequencyHz());
   setColorCode(ch->colorCode());
   setTimeslot(ch->timeslot());
 }
@@ -1379,12 +1403,12 @@ D878UVCodeplug::roaming_channel_t::fromChannel(DigitalChannel *ch) {
 DigitalChannel *
 D878UVCodeplug::roaming_channel_t::toChannel(CodeplugContext &ctx) {
   // Find matching channel for RX, TX frequency, TS and CC
-  double rx = getRXFrequency(), tx = getTXFrequency();
+  Frequency rx = getRXFrequency(), tx = getTXFrequency();
   DigitalChannel *digi = ctx.config()->channelList()->findDigitalChannel(
         rx, tx, getTimeslot(), getColorCode());
   if (nullptr == digi) {
     // If no matching channel can be found -> create one
-    digi = new DigitalChannel(getName(), getRXFrequency(), getTXFrequency(),
+    digi = new DigitalChannel(getName(), hz2mhz(rx), hz2mhz(tx),
                               Channel::LowPower, 0, false, DigitalChannel::AdmitColorCode,
                               getColorCode(), getTimeslot(), nullptr, nullptr, nullptr,
                               nullptr, nullptr);
@@ -1447,56 +1471,104 @@ D878UVCodeplug::D878UVCodeplug(QObject *parent)
   : CodePlug(parent)
 {
   addImage("Anytone AT-D878UV Codeplug");
+  clear();
+}
 
+void
+D878UVCodeplug::clear() {
+  _memory.clear();
+  // The hot keys share a page with the status message and RX group list bitmaps
+  _memory.reserve(ADDR_HOTKEY, RXGRP_BITMAP+RXGRP_BITMAP_SIZE-ADDR_HOTKEY);
   // Channel bitmap
-  image(0).addElement(CHANNEL_BITMAP, CHANNEL_BITMAP_SIZE);
+  _memory.allocate(CHANNEL_BITMAP, CHANNEL_BITMAP_SIZE);
   // Zone bitmap
-  image(0).addElement(ZONE_BITMAPS, ZONE_BITMAPS_SIZE);
+  _memory.allocate(ZONE_BITMAPS, ZONE_BITMAPS_SIZE);
   // Contacts bitmap
-  image(0).addElement(CONTACTS_BITMAP, CONTACTS_BITMAP_SIZE);
+  _memory.allocate(CONTACTS_BITMAP, CONTACTS_BITMAP_SIZE);
   // Analog contacts bitmap
-  image(0).addElement(ANALOGCONTACT_BITMAP, ANALOGCONTACT_BITMAP_SIZE);
+  _memory.allocate(ANALOGCONTACT_BITMAP, ANALOGCONTACT_BITMAP_SIZE);
   // RX group list bitmaps
-  image(0).addElement(RXGRP_BITMAP, RXGRP_BITMAP_SIZE);
+  _memory.allocate(RXGRP_BITMAP, RXGRP_BITMAP_SIZE);
   // Scan list bitmaps
-  image(0).addElement(SCAN_BITMAP, SCAN_BITMAP_SIZE);
+  _memory.allocate(SCAN_BITMAP, SCAN_BITMAP_SIZE);
   // Radio IDs bitmaps
-  image(0).addElement(RADIOID_BITMAP, RADIOID_BITMAP_SIZE);
+  _memory.allocate(RADIOID_BITMAP, RADIOID_BITMAP_SIZE);
   // Messag bitmaps
-  image(0).addElement(MESSAGE_BYTEMAP, MESSAGE_BYTEMAP_SIZE);
+  _memory.allocate(MESSAGE_BYTEMAP, MESSAGE_BYTEMAP_SIZE);
   // Status messages
-  image(0).addElement(STATUSMESSAGE_BITMAP, STATUSMESSAGE_BITMAP_SIZE);
+  _memory.allocate(STATUSMESSAGE_BITMAP, STATUSMESSAGE_BITMAP_SIZE);
   // FM Broadcast bitmaps
-  image(0).addElement(FMBC_BITMAP, FMBC_BITMAP_SIZE);
+  _memory.allocate(FMBC_BITMAP, FMBC_BITMAP_SIZE);
   // Roaming channel bitmaps
-  image(0).addElement(ADDR_ROAMING_CHANNEL_BITMAP, ROAMING_CHANNEL_BITMAP_SIZE);
+  _memory.allocate(ADDR_ROAMING_CHANNEL_BITMAP, ROAMING_CHANNEL_BITMAP_SIZE);
   // Roaming zone bitmaps
-  image(0).addElement(ADDR_ROAMING_ZONE_BITMAP, ROAMING_ZONE_BITMAP_SIZE);
+  _memory.allocate(ADDR_ROAMING_ZONE_BITMAP, ROAMING_ZONE_BITMAP_SIZE);
 }
 
-void
-D878UVCodeplug::clear() {
+CodePlug::PagedImage &
+D878UVCodeplug::memory() {
+  return _memory;
 }
 
-void
+const CodePlug::PagedImage &
+D878UVCodeplug::memory() const {
+  return _memory;
+}
+
+unsigned char *
+D878UVCodeplug::data(uint32_t offset, uint32_t img) {
+  Q_UNUSED(img);
+  return _memory.data(offset);
+}
+
+const unsigned char *
+D878UVCodeplug::data(uint32_t offset, uint32_t img) const {
+  Q_UNUSED(img);
+  return _memory.data(offset);
+}
+
+bool
+D878UVCodeplug::read(QFile &file) {
+  if (! DFUFile::read(file))
+    return false;
+  if (0 == numImages())
+    addImage("Anytone AT-D878UV Codeplug");
+  // Move elements into the memory image
+  _memory.fromImage(image(0));
+  for (int i=image(0).numElements()-1; i>=0; i--)
+    image(0).remElement(i);
+  return true;
+}
+
+bool
+D878UVCodeplug::write(QFile &file) {
+  // Export memory image as elements for the time of writing
+  _memory.toImage(image(0));
+  bool ok = DFUFile::write(file);
+  for (int i=image(0).numElements()-1; i>=0; i--)
+    image(0).remElement(i);
+  return ok;
+}
+
+bool
 D878UVCodeplug::allocateUntouched() {
   // Allocate VFO channels
-  image(0).addElement(VFO_A_ADDR, sizeof(channel_t));
-  image(0).addElement(VFO_A_ADDR+0x2000, sizeof(channel_t));
-  image(0).addElement(VFO_B_ADDR, sizeof(channel_t));
-  image(0).addElement(VFO_B_ADDR+0x2000, sizeof(channel_t));
+  _memory.allocate(VFO_A_ADDR, sizeof(channel_t));
+  _memory.allocate(VFO_A_ADDR+0x2000, sizeof(channel_t));
+  _memory.allocate(VFO_B_ADDR, sizeof(channel_t));
+  _memory.allocate(VFO_B_ADDR+0x2000, sizeof(channel_t));
 
   // General config
-  image(0).addElement(ADDR_GENERAL_CONFIG, GENERAL_CONFIG_SIZE);
-  image(0).addElement(ADDR_GENERAL_CONFIG_EXT1, GENERAL_CONFIG_EXT1_SIZE);
-  image(0).addElement(ADDR_GENERAL_CONFIG_EXT2, GENERAL_CONFIG_EXT2_SIZE);
+  _memory.allocate(ADDR_GENERAL_CONFIG, GENERAL_CONFIG_SIZE);
+  _memory.allocate(ADDR_GENERAL_CONFIG_EXT1, GENERAL_CONFIG_EXT1_SIZE);
+  _memory.allocate(ADDR_GENERAL_CONFIG_EXT2, GENERAL_CONFIG_EXT2_SIZE);
 
   // GPS settings
-  image(0).addElement(ADDR_GPS_SETTING, GPS_SETTING_SIZE);
+  _memory.allocate(ADDR_GPS_SETTING, GPS_SETTING_SIZE);
 
   // APRS settings
-  image(0).addElement(ADDR_APRS_SETTING, APRS_SETTING_SIZE);
-  image(0).addElement(ADDR_APRS_MESSAGE, APRS_MESSAGE_SIZE);
+  _memory.allocate(ADDR_APRS_SETTING, APRS_SETTING_SIZE);
+  _memory.allocate(ADDR_APRS_MESSAGE, APRS_MESSAGE_SIZE);
 
   /*
    * Kept but untouched memory regions.
@@ -1505,6 +1577,8 @@ D878UVCodeplug::allocateUntouched() {
   /*
    * Allocate analog contacts
    */
+  if (! reserveAnalogContactBanks())
+    return checkAllocation(__func__);
   uint8_t *analog_contact_bytemap = data(ANALOGCONTACT_BITMAP);
   uint contactCount = 0;
   for (uint8_t i=0; i<NUM_ANALOGCONTACTS; i++) {
@@ -1514,11 +1588,12 @@ D878UVCodeplug::allocateUntouched() {
     contactCount++;
     uint32_t addr = ANALOGCONTACT_BANK_0 + (i/ANALOGCONTACTS_PER_BANK)*ANALOGCONTACT_BANK_SIZE;
     if (nullptr == data(addr, 0)) {
-      image(0).addElement(addr, ANALOGCONTACT_BANK_SIZE);
+      if (! _memory.allocate(addr, ANALOGCONTACT_BANK_SIZE))
+        return checkAllocation(__func__);
       memset(data(addr), 0x00, ANALOGCONTACT_BANK_SIZE);
     }
   }
-  image(0).addElement(ANALOGCONTACT_INDEX_LIST, 0xff, ANALOGCONTACT_LIST_SIZE);
+  _memory.allocate(ANALOGCONTACT_INDEX_LIST, ANALOGCONTACT_LIST_SIZE, 0xff);
 
   // Prefab. SMS messages
   uint8_t *messages_bytemap = data(MESSAGE_BYTEMAP);
@@ -1530,39 +1605,41 @@ D878UVCodeplug::allocateUntouched() {
     message_count++;
     uint32_t addr = MESSAGE_BANK_0 + bank*MESSAGE_BANK_SIZE;
     if (nullptr == data(addr, 0)) {
-      image(0).addElement(addr, MESSAGE_BANK_SIZE);
+      _memory.allocate(addr, MESSAGE_BANK_SIZE);
     }
   }
   if (message_count) {
-    image(0).addElement(MESSAGE_INDEX_LIST, 0x10*message_count);
+    _memory.allocate(MESSAGE_INDEX_LIST, 0x10*message_count);
   }
 
   // Allocate Hot Keys
-  image(0).addElement(ADDR_HOTKEY, HOTKEY_SIZE);
+  _memory.allocate(ADDR_HOTKEY, HOTKEY_SIZE);
   // Encryption keys
-  image(0).addElement(ADDR_ENCRYPTION_KEYS, ENCRYPTION_KEYS_SIZE);
+  _memory.allocate(ADDR_ENCRYPTION_KEYS, ENCRYPTION_KEYS_SIZE);
   // Offset frequencies
-  image(0).addElement(ADDR_OFFSET_FREQ, OFFSET_FREQ_SIZE);
+  _memory.allocate(ADDR_OFFSET_FREQ, OFFSET_FREQ_SIZE);
   // Alarm settings
-  image(0).addElement(ADDR_ALARM_SETTING, ALARM_SETTING_SIZE);
+  _memory.allocate(ADDR_ALARM_SETTING, ALARM_SETTING_SIZE);
   // FM broad-cast settings
-  image(0).addElement(ADDR_FMBC, FMBC_SIZE+FMBC_VFO_SIZE);
+  _memory.allocate(ADDR_FMBC, FMBC_SIZE+FMBC_VFO_SIZE);
 
   // Unknown memory region
-  image(0).addElement(0x024C0C80, 0x010);
-  image(0).addElement(0x024C0D00, 0x200);
-  image(0).addElement(0x024C0000, 0x020);
-  image(0).addElement(0x024C1000, 0x0D0);
-  image(0).addElement(0x024C1100, 0x010);
-  image(0).addElement(0x024C1280, 0x020);
-  image(0).addElement(0x024C1440, 0x030);
-  image(0).addElement(0x024C1700, 0x040);
-  image(0).addElement(0x024C1800, 0x500);
-  image(0).addElement(0x024C2400, 0x030);
-  image(0).addElement(0x024C2600, 0x010);
+  _memory.allocate(0x024C0C80, 0x010);
+  _memory.allocate(0x024C0D00, 0x200);
+  _memory.allocate(0x024C0000, 0x020);
+  _memory.allocate(0x024C1000, 0x0D0);
+  _memory.allocate(0x024C1100, 0x010);
+  _memory.allocate(0x024C1280, 0x020);
+  _memory.allocate(0x024C1440, 0x030);
+  _memory.allocate(0x024C1700, 0x040);
+  _memory.allocate(0x024C1800, 0x500);
+  _memory.allocate(0x024C2400, 0x030);
+  _memory.allocate(0x024C2600, 0x010);
+
+  return checkAllocation(__func__);
 }
 
-void
+bool
 D878UVCodeplug::allocateForEncoding() {
   /*
    * Allocate channels
@@ -1579,10 +1656,11 @@ D878UVCodeplug::allocateForEncoding() {
         + bank*CHANNEL_BANK_OFFSET
         + idx*sizeof(channel_t);
     if (nullptr == data(addr, 0)) {
-      image(0).addElement(addr, sizeof(channel_t));
+      _memory.allocate(addr, sizeof(channel_t));
     }
     if (nullptr == data(addr+0x2000, 0)) {
-      image(0).addElement(addr+0x2000, sizeof(channel_t));
+      if (! _memory.allocate(addr+0x2000, sizeof(channel_t)))
+        return checkAllocation(__func__);
       memset(data(addr+0x2000), 0x00, sizeof(channel_t));
     }
   }
@@ -1598,13 +1676,15 @@ D878UVCodeplug::allocateForEncoding() {
     if (0 == ((zone_bitmap[byte]>>bit) & 0x01))
       continue;
     // Allocate zone itself
-    image(0).addElement(ADDR_ZONE+i*ZONE_OFFSET, ZONE_SIZE);
-    image(0).addElement(ADDR_ZONE_NAME+i*ZONE_NAME_OFFSET, ZONE_NAME_SIZE);
+    _memory.allocate(ADDR_ZONE+i*ZONE_OFFSET, ZONE_SIZE);
+    _memory.allocate(ADDR_ZONE_NAME+i*ZONE_NAME_OFFSET, ZONE_NAME_SIZE);
   }
 
   /*
    * Allocate contacts
    */
+  if (! reserveContactBanks())
+    return checkAllocation(__func__);
   uint8_t *contact_bitmap = data(CONTACTS_BITMAP);
   uint contactCount=0;
   for (uint16_t i=0; i<NUM_CONTACTS; i++) {
@@ -1614,14 +1694,17 @@ D878UVCodeplug::allocateForEncoding() {
     contactCount++;
     uint32_t addr = CONTACT_BANK_0+(i/CONTACTS_PER_BANK)*CONTACT_BANK_SIZE;
     if (nullptr == data(addr, 0)) {
-      image(0).addElement(addr, CONTACT_BANK_SIZE);
+      if (! _memory.allocate(addr, CONTACT_BANK_SIZE))
+        return checkAllocation(__func__);
       memset(data(addr), 0x00, CONTACT_BANK_SIZE);
     }
   }
   if (contactCount) {
-    image(0).addElement(CONTACT_INDEX_LIST, align_size(4*contactCount, 16));
+    if (! _memory.allocate(CONTACT_INDEX_LIST, align_size(4*contactCount, 16)))
+      return checkAllocation(__func__);
     memset(data(CONTACT_INDEX_LIST), 0xff, align_size(4*contactCount, 16));
-    image(0).addElement(CONTACT_ID_MAP, align_size(CONTACT_ID_ENTRY_SIZE*(1+contactCount), 16));
+    if (! _memory.allocate(CONTACT_ID_MAP, align_size(CONTACT_ID_ENTRY_SIZE*(1+contactCount), 16)))
+      return checkAllocation(__func__);
     memset(data(CONTACT_ID_MAP), 0xff, align_size(CONTACT_ID_ENTRY_SIZE*(1+contactCount), 16));
   }
 
@@ -1638,7 +1721,8 @@ D878UVCodeplug::allocateForEncoding() {
     // Allocate RX group lists indivitually
     uint32_t addr = ADDR_RXGRP_0 + i*RXGRP_OFFSET;
     if (nullptr == data(addr, 0)) {
-      image(0).addElement(addr, RXGRP_SIZE);
+      if (! _memory.allocate(addr, RXGRP_SIZE))
+        return checkAllocation(__func__);
       memset(data(addr), 0xff, RXGRP_SIZE);
     }
   }
@@ -1657,7 +1741,8 @@ D878UVCodeplug::allocateForEncoding() {
     // Allocate scan lists indivitually
     uint32_t addr = SCAN_LIST_BANK_0 + bank*SCAN_LIST_BANK_OFFSET + bank_idx*SCAN_LIST_OFFSET;
     if (nullptr == data(addr, 0)) {
-      image(0).addElement(addr, SCAN_LIST_SIZE);
+      if (! _memory.allocate(addr, SCAN_LIST_SIZE))
+        return checkAllocation(__func__);
       memset(data(addr), 0xff, SCAN_LIST_SIZE);
     }
   }
@@ -1675,7 +1760,7 @@ D878UVCodeplug::allocateForEncoding() {
     // Allocate radio IDs individually
     uint32_t addr = ADDR_RADIOIDS + i*RADIOID_SIZE;
     if (nullptr == data(addr, 0)) {
-      image(0).addElement(addr, RADIOID_SIZE);
+      _memory.allocate(addr, RADIOID_SIZE);
     }
   }
 
@@ -1693,7 +1778,7 @@ D878UVCodeplug::allocateForEncoding() {
     uint32_t addr = ADDR_ROAMING_CHANNEL_0 + i*ROAMING_CHANNEL_OFFSET;
     if (nullptr == data(addr, 0)) {
       logDebug() << "Allocate roaming channel at " << hex << addr;
-      image(0).addElement(addr, ROAMING_CHANNEL_SIZE);
+      _memory.allocate(addr, ROAMING_CHANNEL_SIZE);
     }
   }
   uint8_t *roaming_zone_bitmap = data(ADDR_ROAMING_ZONE_BITMAP);
@@ -1707,12 +1792,14 @@ D878UVCodeplug::allocateForEncoding() {
     uint32_t addr = ADDR_ROAMING_ZONE_0 + i*ROAMING_ZONE_OFFSET;
     if (nullptr == data(addr, 0)) {
       logDebug() << "Allocate roaming zone at " << hex << addr;
-      image(0).addElement(addr, ROAMING_ZONE_SIZE);
+      _memory.allocate(addr, ROAMING_ZONE_SIZE);
     }
   }
+
+  return checkAllocation(__func__);
 }
 
-void
+bool
 D878UVCodeplug::allocateForDecoding() {
   /*
    * Allocate channels
@@ -1729,7 +1816,7 @@ D878UVCodeplug::allocateForDecoding() {
         + bank*CHANNEL_BANK_OFFSET
         + idx*sizeof(channel_t);
     if (nullptr == data(addr, 0))
-      image(0).addElement(addr, sizeof(channel_t));
+      _memory.allocate(addr, sizeof(channel_t));
   }
 
   /*
@@ -1743,13 +1830,15 @@ D878UVCodeplug::allocateForDecoding() {
     if (0 == ((zone_bitmap[byte]>>bit) & 0x01))
       continue;
     // Allocate zone itself
-    image(0).addElement(ADDR_ZONE+i*ZONE_OFFSET, ZONE_SIZE);
-    image(0).addElement(ADDR_ZONE_NAME+i*ZONE_NAME_OFFSET, ZONE_NAME_SIZE);
+    _memory.allocate(ADDR_ZONE+i*ZONE_OFFSET, ZONE_SIZE);
+    _memory.allocate(ADDR_ZONE_NAME+i*ZONE_NAME_OFFSET, ZONE_NAME_SIZE);
   }
 
   /*
    * Allocate contacts
    */
+  if (! reserveContactBanks())
+    return checkAllocation(__func__);
   uint8_t *contact_bitmap = data(CONTACTS_BITMAP);
   for (uint16_t i=0; i<NUM_CONTACTS; i++) {
     // Get byte and bit for contact, as well as bank of contact
@@ -1759,13 +1848,15 @@ D878UVCodeplug::allocateForDecoding() {
       continue;
     uint32_t addr = CONTACT_BANK_0+(i/CONTACTS_PER_BANK)*CONTACT_BANK_SIZE;
     if (nullptr == data(addr, 0)) {
-      image(0).addElement(addr, CONTACT_BANK_SIZE);
+      _memory.allocate(addr, CONTACT_BANK_SIZE);
     }
   }
 
   /*
    * Allocate analog contacts
    */
+  if (! reserveAnalogContactBanks())
+    return checkAllocation(__func__);
   uint8_t *analog_contact_bytemap = data(ANALOGCONTACT_BITMAP);
   for (uint8_t i=0; i<NUM_ANALOGCONTACTS; i++) {
     // if disabled -> skip
@@ -1773,7 +1864,7 @@ D878UVCodeplug::allocateForDecoding() {
       continue;
     uint32_t addr = ANALOGCONTACT_BANK_0 + (i/ANALOGCONTACTS_PER_BANK)*ANALOGCONTACT_BANK_SIZE;
     if (nullptr == data(addr, 0)) {
-      image(0).addElement(addr, ANALOGCONTACT_BANK_SIZE);
+      _memory.allocate(addr, ANALOGCONTACT_BANK_SIZE);
     }
   }
 
@@ -1790,7 +1881,7 @@ D878UVCodeplug::allocateForDecoding() {
     // Allocate RX group lists indivitually
     uint32_t addr = ADDR_RXGRP_0 + i*RXGRP_OFFSET;
     if (nullptr == data(addr, 0)) {
-      image(0).addElement(addr, RXGRP_SIZE);
+      _memory.allocate(addr, RXGRP_SIZE);
     }
   }
 
@@ -1808,7 +1899,7 @@ D878UVCodeplug::allocateForDecoding() {
     // Allocate scan lists indivitually
     uint32_t addr = SCAN_LIST_BANK_0 + bank*SCAN_LIST_BANK_OFFSET + bank_idx*SCAN_LIST_OFFSET;
     if (nullptr == data(addr, 0)) {
-      image(0).addElement(addr, SCAN_LIST_SIZE);
+      _memory.allocate(addr, SCAN_LIST_SIZE);
     }
   }
 
@@ -1825,7 +1916,7 @@ D878UVCodeplug::allocateForDecoding() {
     // Allocate radio IDs individually
     uint32_t addr = ADDR_RADIOIDS + i*RADIOID_SIZE;
     if (nullptr == data(addr, 0)) {
-      image(0).addElement(addr, RADIOID_SIZE);
+      _memory.allocate(addr, RADIOID_SIZE);
     }
   }
 
@@ -1842,7 +1933,7 @@ D878UVCodeplug::allocateForDecoding() {
     // Allocate roaming channel
     uint32_t addr = ADDR_ROAMING_CHANNEL_0 + i*ROAMING_CHANNEL_OFFSET;
     if (nullptr == data(addr, 0)) {
-      image(0).addElement(addr, ROAMING_CHANNEL_SIZE);
+      _memory.allocate(addr, ROAMING_CHANNEL_SIZE);
     }
   }
   uint8_t *roaming_zone_bitmap = data(ADDR_ROAMING_ZONE_BITMAP);
@@ -1855,17 +1946,58 @@ D878UVCodeplug::allocateForDecoding() {
     // Allocate roaming zone
     uint32_t addr = ADDR_ROAMING_ZONE_0 + i*ROAMING_ZONE_OFFSET;
     if (nullptr == data(addr, 0)) {
-      image(0).addElement(addr, ROAMING_ZONE_SIZE);
+      _memory.allocate(addr, ROAMING_ZONE_SIZE);
     }
   }
 
   // General config
-  image(0).addElement(ADDR_GENERAL_CONFIG, GENERAL_CONFIG_SIZE);
+  _memory.allocate(ADDR_GENERAL_CONFIG, GENERAL_CONFIG_SIZE);
   // GPS settings
-  image(0).addElement(ADDR_GPS_SETTING, GPS_SETTING_SIZE);
+  _memory.allocate(ADDR_GPS_SETTING, GPS_SETTING_SIZE);
   // APRS settings and messages
-  image(0).addElement(ADDR_APRS_SETTING, APRS_SETTING_SIZE);
-  image(0).addElement(ADDR_APRS_MESSAGE, APRS_MESSAGE_SIZE);
+  _memory.allocate(ADDR_APRS_SETTING, APRS_SETTING_SIZE);
+  _memory.allocate(ADDR_APRS_MESSAGE, APRS_MESSAGE_SIZE);
+
+  return checkAllocation(__func__);
+}
+
+bool
+D878UVCodeplug::reserveContactBanks() {
+  // Contact banks straddle pages, hence all banks up to the last one in use are reserved at once
+  const uint8_t *contact_bitmap = data(CONTACTS_BITMAP);
+  int last = -1;
+  for (uint16_t i=0; i<NUM_CONTACTS; i++) {
+    // enabled if false
+    if (0 == ((contact_bitmap[i/8]>>(i%8)) & 0x01))
+      last = i;
+  }
+  if (0 > last)
+    return true;
+  return _memory.reserve(CONTACT_BANK_0, (last/CONTACTS_PER_BANK+1)*CONTACT_BANK_SIZE);
+}
+
+bool
+D878UVCodeplug::reserveAnalogContactBanks() {
+  // Analog contact banks straddle pages too
+  const uint8_t *analog_contact_bytemap = data(ANALOGCONTACT_BITMAP);
+  int last = -1;
+  for (uint8_t i=0; i<NUM_ANALOGCONTACTS; i++) {
+    if (0 != analog_contact_bytemap[i])
+      last = i;
+  }
+  if (0 > last)
+    return true;
+  return _memory.reserve(ANALOGCONTACT_BANK_0,
+                         (last/ANALOGCONTACTS_PER_BANK+1)*ANALOGCONTACT_BANK_SIZE);
+}
+
+bool
+D878UVCodeplug::checkAllocation(const char *func) {
+  if (! _memory.isFragmented())
+    return true;
+  _errorMessage = QString("%1(): Cannot allocate codeplug: Records are not contiguous.").arg(func);
+  logError() << _errorMessage;
+  return false;
 }
 
 
@@ -1934,143 +2066,239 @@ D878UVCodeplug::setBitmaps(Config *config)
 bool
 D878UVCodeplug::encode(Config *config, const Flags &flags)
 {
-  // Encode radio IDs
-  radioid_t *radio_ids = (radioid_t *)data(ADDR_RADIOIDS);
-  radio_ids[0].setId(config->id());
-  radio_ids[0].setName(config->name());
+  // Records are written through raw pointers, these must not run past their pages
+  if (! checkAllocation(__func__))
+    return false;
+  for (int s=RadioIDSection; s<=SettingsSection; s++)
+    encodeSection(Section(s), config, flags);
+  return true;
+}
+
+bool
+D878UVCodeplug::patchIdentity(const Identity &identity) {
+  radioid_t *radio_id = (radioid_t *)data(ADDR_RADIOIDS);
+  general_settings_base_t *settings = (general_settings_base_t *)data(ADDR_GENERAL_CONFIG);
+  if ((nullptr == radio_id) || (nullptr == settings)) {
+    _errorMessage = QString("%1(): Cannot patch identity: Codeplug is not encoded.").arg(__func__);
+    logError() << _errorMessage;
+    return false;
+  }
+
+  radio_id->setId(identity.id);
+  radio_id->setName(identity.name);
+  settings->setIntroLine1(identity.introLine1);
+  settings->setIntroLine2(identity.introLine2);
+  _memory.markDirty(ADDR_RADIOIDS, RADIOID_SIZE);
+  _memory.markDirty(ADDR_GENERAL_CONFIG, GENERAL_CONFIG_SIZE);
+  return true;
+}
+
+void
+D878UVCodeplug::encodeSection(Section section, Config *config, const Flags &flags)
+{
+  switch (section) {
+  case RadioIDSection: {
+    // Encode radio IDs
+    radioid_t *radio_ids = (radioid_t *)data(ADDR_RADIOIDS);
+    radio_ids[0].setId(config->id());
+    radio_ids[0].setName(config->name());
+    break;
+  }
 
-  // Encode general config
-  ((general_settings_base_t *)data(ADDR_GENERAL_CONFIG))->fromConfig(config, flags);
-  ((general_settings_ext1_t *)data(ADDR_GENERAL_CONFIG_EXT1))->fromConfig(config, flags);
-  ((general_settings_ext2_t *)data(ADDR_GENERAL_CONFIG_EXT2))->fromConfig(config, flags);
+  case ChannelSection: {
+    // Encode channels
+    for (int i=0; i<config->channelList()->count(); i++) {
+      // enable channel
+      uint16_t bank = i/128, idx = i%128;
+      channel_t *ch = (channel_t *)data(CHANNEL_BANK_0
+                                        + bank*CHANNEL_BANK_OFFSET
+                                        + idx*sizeof(channel_t));
+      ch->fromChannelObj(config->channelList()->channel(i), config);
+    }
+    break;
+  }
 
-  // Encode channels
-  for (int i=0; i<config->channelList()->count(); i++) {
-    // enable channel
-    uint16_t bank = i/128, idx = i%128;
-    channel_t *ch = (channel_t *)data(CHANNEL_BANK_0
-                                      + bank*CHANNEL_BANK_OFFSET
-                                      + idx*sizeof(channel_t));
-    ch->fromChannelObj(config->channelList()->channel(i), config);
+  case ContactSection: {
+    // Encode contacts
+    QVector<contact_map_t> contact_id_map;
+    contact_id_map.reserve(config->contacts()->digitalCount());
+    for (int i=0; i<config->contacts()->digitalCount(); i++) {
+      contact_t *con = (contact_t *)data(CONTACT_BANK_0+i*sizeof(contact_t));
+      con->fromContactObj(config->contacts()->digitalContact(i));
+      ((uint32_t *)data(CONTACT_INDEX_LIST))[i] = qToLittleEndian(i);
+      contact_map_t entry;
+      entry.setID(config->contacts()->digitalContact(i)->number(),
+                  DigitalContact::GroupCall == config->contacts()->digitalContact(i)->type());
+      entry.setIndex(i);
+      contact_id_map.append(entry);
+    }
+    std::sort(contact_id_map.begin(), contact_id_map.end(),
+              [](const contact_map_t &a, const contact_map_t &b) {
+      return a.ID() < b.ID();
+    });
+    for (int i=0; i<contact_id_map.size(); i++) {
+      ((contact_map_t *)data(CONTACT_ID_MAP))[i] = contact_id_map[i];
+    }
+    break;
   }
 
-  // Encode contacts
-  QVector<contact_map_t> contact_id_map;
-  contact_id_map.reserve(config->contacts()->digitalCount());
-  for (int i=0; i<config->contacts()->digitalCount(); i++) {
-    contact_t *con = (contact_t *)data(CONTACT_BANK_0+i*sizeof(contact_t));
-    con->fromContactObj(config->contacts()->digitalContact(i));
-    ((uint32_t *)data(CONTACT_INDEX_LIST))[i] = qToLittleEndian(i);
-    contact_map_t entry;
-    entry.setID(config->contacts()->digitalContact(i)->number(),
-                DigitalContact::GroupCall == config->contacts()->digitalContact(i)->type());
-    entry.setIndex(i);
-    contact_id_map.append(entry);
-  }
-  std::sort(contact_id_map.begin(), contact_id_map.end(),
-            [](const contact_map_t &a, const contact_map_t &b) {
-    return a.ID() < b.ID();
-  });
-  for (int i=0; i<contact_id_map.size(); i++) {
-    ((contact_map_t *)data(CONTACT_ID_MAP))[i] = contact_id_map[i];
-  }
-
-  // Encode RX group-lists
-  for (int i=0; i<config->rxGroupLists()->count(); i++) {
-    grouplist_t *grp = (grouplist_t *)data(ADDR_RXGRP_0 + i*RXGRP_OFFSET);
-    grp->fromGroupListObj(config->rxGroupLists()->list(i), config);
-  }
-
-  // Encode zones
-  uint zidx = 0;
-  for (int i=0; i<config->zones()->count(); i++) {
-    // Clear name and channel list
-    uint8_t  *name     = (uint8_t *)data(ADDR_ZONE_NAME + zidx*ZONE_NAME_OFFSET);
-    uint16_t *channels = (uint16_t *)data(ADDR_ZONE + zidx*ZONE_OFFSET);
-    memset(name, 0, ZONE_NAME_OFFSET);
-    memset(channels, 0xff, ZONE_OFFSET);
-    if (config->zones()->zone(i)->B()->count())
-      encode_ascii(name, config->zones()->zone(i)->name()+" A", 16, 0);
-    else
-      encode_ascii(name, config->zones()->zone(i)->name(), 16, 0);
-    // Handle list A
-    for (int j=0; j<config->zones()->zone(i)->A()->count(); j++) {
-      channels[j] = qToLittleEndian(
-            config->channelList()->indexOf(
-              config->zones()->zone(i)->A()->channel(j)));
+  case GroupListSection: {
+    // Encode RX group-lists
+    for (int i=0; i<config->rxGroupLists()->count(); i++) {
+      grouplist_t *grp = (grouplist_t *)data(ADDR_RXGRP_0 + i*RXGRP_OFFSET);
+      grp->fromGroupListObj(config->rxGroupLists()->list(i), config);
     }
-    zidx++;
-    if (! config->zones()->zone(i)->B()->count())
-      continue;
+    break;
+  }
+
+  case ZoneSection: {
+    // Encode zones
+    uint zidx = 0;
+    for (int i=0; i<config->zones()->count(); i++) {
+      // Clear name and channel list
+      uint8_t  *name     = (uint8_t *)data(ADDR_ZONE_NAME + zidx*ZONE_NAME_OFFSET);
+      uint16_t *channels = (uint16_t *)data(ADDR_ZONE + zidx*ZONE_OFFSET);
+      memset(name, 0, ZONE_NAME_OFFSET);
+      memset(channels, 0xff, ZONE_OFFSET);
+      if (config->zones()->zone(i)->B()->count())
+        encode_ascii(name, config->zones()->zone(i)->name()+" A", 16, 0);
+      else
+        encode_ascii(name, config->zones()->zone(i)->name(), 16, 0);
+      // Handle list A
+      for (int j=0; j<config->zones()->zone(i)->A()->count(); j++) {
+        channels[j] = qToLittleEndian(
+              config->channelList()->indexOf(
+                config->zones()->zone(i)->A()->channel(j)));
+      }
+      zidx++;
+      if (! config->zones()->zone(i)->B()->count())
+        continue;
 
-    // Process list B if present
-    name     = (uint8_t *)data(ADDR_ZONE_NAME+zidx*ZONE_NAME_OFFSET);
-    channels = (uint16_t *)data(ADDR_ZONE+zidx*ZONE_OFFSET);
-    memset(name, 0, ZONE_NAME_OFFSET);
-    memset(channels, 0xff, ZONE_OFFSET);
-    encode_ascii(name, config->zones()->zone(i)->name()+" B", 16, 0);
-    // Handle list B
-    for (int j=0; j<config->zones()->zone(i)->B()->count(); j++) {
-      channels[j] = qToLittleEndian(
-            config->channelList()->indexOf(
-              config->zones()->zone(i)->B()->channel(j)));
+      // Process list B if present
+      name     = (uint8_t *)data(ADDR_ZONE_NAME+zidx*ZONE_NAME_OFFSET);
+      channels = (uint16_t *)data(ADDR_ZONE+zidx*ZONE_OFFSET);
+      memset(name, 0, ZONE_NAME_OFFSET);
+      memset(channels, 0xff, ZONE_OFFSET);
+      encode_ascii(name, config->zones()->zone(i)->name()+" B", 16, 0);
+      // Handle list B
+      for (int j=0; j<config->zones()->zone(i)->B()->count(); j++) {
+        channels[j] = qToLittleEndian(
+              config->channelList()->indexOf(
+                config->zones()->zone(i)->B()->channel(j)));
+      }
+      zidx++;
     }
-    zidx++;
+    break;
   }
 
-  // Encode scan lists
-  for (int i=0; i<config->scanlists()->count(); i++) {
-    uint8_t bank = i/NUM_SCANLISTS_PER_BANK, idx = i%NUM_SCANLISTS_PER_BANK;
-    scanlist_t *scan = (scanlist_t *)data(
-          SCAN_LIST_BANK_0 + bank*SCAN_LIST_BANK_OFFSET + idx*SCAN_LIST_OFFSET);
-    scan->fromScanListObj(config->scanlists()->scanlist(i), config);
-  }
-
-  // Encode GPS systems
-  gps_systems_t *gps = (gps_systems_t *)data(ADDR_GPS_SETTING);
-  gps->fromGPSSystems(config);
-  if (0 < config->posSystems()->gpsCount()) {
-    // If there is at least one GPS system defined -> set auto TX interval.
-    //  This setting might be overridden by any analog APRS system below
-    aprs_setting_t *aprs = (aprs_setting_t *)data(ADDR_APRS_SETTING);
-    aprs->setAutoTxInterval(config->posSystems()->gpsSystem(0)->period());
-    aprs->setManualTxInterval(config->posSystems()->gpsSystem(0)->period());
-  }
-
-  // Encode APRS system (there can only be one)
-  if (0 < config->posSystems()->aprsCount()) {
-    ((aprs_setting_t *)data(ADDR_APRS_SETTING))->fromAPRSSystem(config->posSystems()->aprsSystem(0));
-    uint8_t *aprsmsg = (uint8_t *)data(ADDR_APRS_MESSAGE);
-    encode_ascii(aprsmsg, config->posSystems()->aprsSystem(0)->message(), 60, 0x00);
-  }
-
-  // Encode roaming channels
-  QHash<DigitalChannel *, int> roaming_ch_map;
-  {
-    // Get set of unique roaming channels
-    QSet<DigitalChannel*> roaming_channels;
-    config->roaming()->uniqueChannels(roaming_channels);
-    // Encode channels and store in index<->channel map
-    int i=0; QSet<DigitalChannel*>::iterator ch=roaming_channels.begin();
-    for(; ch != roaming_channels.end(); ch++, i++) {
-      roaming_ch_map[*ch] = i;
-      uint32_t addr = ADDR_ROAMING_CHANNEL_0+i*ROAMING_CHANNEL_OFFSET;
-      roaming_channel_t *rch = (roaming_channel_t *)data(addr);
-      rch->fromChannel(*ch);
-      logDebug() << "Encode roaming channel " << (*ch)->name() << " (" << i
+  case ScanListSection: {
+    // Encode scan lists
+    for (int i=0; i<config->scanlists()->count(); i++) {
+      uint8_t bank = i/NUM_SCANLISTS_PER_BANK, idx = i%NUM_SCANLISTS_PER_BANK;
+      scanlist_t *scan = (scanlist_t *)data(
+            SCAN_LIST_BANK_0 + bank*SCAN_LIST_BANK_OFFSET + idx*SCAN_LIST_OFFSET);
+      scan->fromScanListObj(config->scanlists()->scanlist(i), config);
+    }
+    break;
+  }
+
+  case RoamingSection: {
+    // Encode roaming channels
+    QHash<DigitalChannel *, int> roaming_ch_map;
+    {
+      // Get set of unique roaming channels
+      QSet<DigitalChannel*> roaming_channels;
+      config->roaming()->uniqueChannels(roaming_channels);
+      // Encode channels and store in index<->channel map
+      int i=0; QSet<DigitalChannel*>::iterator ch=roaming_channels.begin();
+      for(; ch != roaming_channels.end(); ch++, i++) {
+        roaming_ch_map[*ch] = i;
+        uint32_t addr = ADDR_ROAMING_CHANNEL_0+i*ROAMING_CHANNEL_OFFSET;
+        roaming_channel_t *rch = (roaming_channel_t *)data(addr);
+        rch->fromChannel(*ch);
+        logDebug() << "Encode roaming channel " << (*ch)->name() << " (" << i
+                   << ") at " << hex << addr;
+      }
+    }
+    // Encode roaming zones
+    for (int i=0; i<config->roaming()->count(); i++){
+      uint32_t addr = ADDR_ROAMING_ZONE_0+i*ROAMING_ZONE_OFFSET;
+      roaming_zone_t *zone = (roaming_zone_t *)data(addr);
+      logDebug() << "Encode roaming zone " << config->roaming()->zone(i)->name() << " (" << (i+1)
                  << ") at " << hex << addr;
+      zone->fromRoamingZone(config->roaming()->zone(i), roaming_ch_map);
     }
+    break;
   }
-  // Encode roaming zones
-  for (int i=0; i<config->roaming()->count(); i++){
-    uint32_t addr = ADDR_ROAMING_ZONE_0+i*ROAMING_ZONE_OFFSET;
-    roaming_zone_t *zone = (roaming_zone_t *)data(addr);
-    logDebug() << "Encode roaming zone " << config->roaming()->zone(i)->name() << " (" << (i+1)
-               << ") at " << hex << addr;
-    zone->fromRoamingZone(config->roaming()->zone(i), roaming_ch_map);
+
+  case SettingsSection: {
+    // Encode general config
+    ((general_settings_base_t *)data(ADDR_GENERAL_CONFIG))->fromConfig(config, flags);
+    ((general_settings_ext1_t *)data(ADDR_GENERAL_CONFIG_EXT1))->fromConfig(config, flags);
+    ((general_settings_ext2_t *)data(ADDR_GENERAL_CONFIG_EXT2))->fromConfig(config, flags);
+
+    // Encode GPS systems
+    gps_systems_t *gps = (gps_systems_t *)data(ADDR_GPS_SETTING);
+    gps->fromGPSSystems(config);
+    if (0 < config->posSystems()->gpsCount()) {
+      // If there is at least one GPS system defined -> set auto TX interval.
+      //  This setting might be overridden by any analog APRS system below
+      aprs_setting_t *aprs = (aprs_setting_t *)data(ADDR_APRS_SETTING);
+      aprs->setAutoTxInterval(config->posSystems()->gpsSystem(0)->period());
+      aprs->setManualTxInterval(config->posSystems()->gpsSystem(0)->period());
+    }
+
+    // Encode APRS system (there can only be one)
+    if (0 < config->posSystems()->aprsCount()) {
+      ((aprs_setting_t *)data(ADDR_APRS_SETTING))->fromAPRSSystem(config->posSystems()->aprsSystem(0));
+      uint8_t *aprsmsg = (uint8_t *)data(ADDR_APRS_MESSAGE);
+      encode_ascii(aprsmsg, config->posSystems()->aprsSystem(0)->message(), 60, 0x00);
+    }
+    break;
   }
+  }
+}
 
-  return true;
+QVector<CodePlug::PagedImage::Run>
+D878UVCodeplug::sectionSpans(Section section) {
+  QVector<PagedImage::Run> spans;
+  switch (section) {
+  case RadioIDSection:
+    spans.append({ADDR_RADIOIDS, NUM_RADIOIDS*RADIOID_SIZE});
+    break;
+  case ChannelSection:
+    spans.append({CHANNEL_BANK_0, CHANNEL_BANK_31+CHANNEL_BANK_31_SIZE-CHANNEL_BANK_0});
+    break;
+  case ContactSection:
+    spans.append({CONTACT_INDEX_LIST, 4*NUM_CONTACTS});
+    spans.append({CONTACT_BANK_0, NUM_CONTACT_BANKS*CONTACT_BANK_SIZE});
+    spans.append({CONTACT_ID_MAP, uint32_t(CONTACT_ID_ENTRY_SIZE*(1+NUM_CONTACTS))});
+    break;
+  case GroupListSection:
+    spans.append({ADDR_RXGRP_0, NUM_RXGRP*RXGRP_OFFSET});
+    break;
+  case ZoneSection:
+    spans.append({ADDR_ZONE, NUM_ZONES*ZONE_OFFSET});
+    spans.append({ADDR_ZONE_NAME, NUM_ZONES*ZONE_NAME_OFFSET});
+    break;
+  case ScanListSection:
+    spans.append({SCAN_LIST_BANK_0, (NUM_SCAN_LISTS/NUM_SCANLISTS_PER_BANK)*SCAN_LIST_BANK_OFFSET
+                  + NUM_SCANLISTS_PER_BANK*SCAN_LIST_OFFSET});
+    break;
+  case RoamingSection:
+    spans.append({ADDR_ROAMING_CHANNEL_0, NUM_ROAMING_CHANNEL*ROAMING_CHANNEL_OFFSET});
+    spans.append({ADDR_ROAMING_ZONE_0, NUM_ROAMING_ZONES*ROAMING_ZONE_OFFSET});
+    break;
+  case SettingsSection:
+    spans.append({ADDR_GENERAL_CONFIG, GENERAL_CONFIG_SIZE});
+    spans.append({ADDR_APRS_SETTING, APRS_SETTING_SIZE});
+    spans.append({ADDR_GPS_SETTING, GPS_SETTING_SIZE});
+    spans.append({ADDR_APRS_MESSAGE, APRS_MESSAGE_SIZE});
+    spans.append({ADDR_GENERAL_CONFIG_EXT1, GENERAL_CONFIG_EXT1_SIZE});
+    spans.append({ADDR_GENERAL_CONFIG_EXT2, GENERAL_CONFIG_EXT2_SIZE});
+    break;
+  }
+  return spans;
 }
 
 bool
@@ -2094,30 +2322,48 @@ D878UVCodeplug::decode(Config *config)
   general_settings_base_t *settings = (general_settings_base_t *)data(ADDR_GENERAL_CONFIG);
   settings->updateConfig(config);
 
-  // Create channels
+  // Index channels
   uint8_t *channel_bitmap = data(CHANNEL_BITMAP);
+  QVector<uint16_t> channel_indices;
+  QVector<channel_t *> channels;
   for (uint16_t i=0; i<NUM_CHANNELS; i++) {
     // Check if channel is enabled:
     uint16_t  bit = i%8, byte = i/8, bank = i/128, idx = i%128;
     if (0 == ((channel_bitmap[byte]>>bit) & 0x01))
       continue;
-    channel_t *ch = (channel_t *)data(CHANNEL_BANK_0
+    channel_indices.append(i);
+    channels.append((channel_t *)data(CHANNEL_BANK_0
                                       +bank*CHANNEL_BANK_OFFSET
-                                      +idx*sizeof(channel_t));
-    if (Channel *obj = ch->toChannelObj())
-      ctx.addChannel(obj, i);
+                                      +idx*sizeof(channel_t)));
+  }
+  // Parse channels in parallel
+  QVector<ParsedChannel> parsed_channels(channels.size());
+  parallel_for(channels.size(), [&channels, &parsed_channels](int i) {
+    channels[i]->parse(parsed_channels[i]);
+  });
+  // Create channels
+  for (int i=0; i<channels.size(); i++) {
+    if (Channel *obj = channels[i]->toChannelObj(parsed_channels[i]))
+      ctx.addChannel(obj, channel_indices[i]);
   }
 
-  // Create digital contacts
+  // Index digital contacts. The contact objects are created once they are accessed, either by
+  // linking channels and group lists below or by the views.
   uint8_t *contact_bitmap = data(CONTACTS_BITMAP);
+  QVector<int> contact_indices;
+  CodePlugContactLoader<contact_t> *contact_loader = new CodePlugContactLoader<contact_t>();
   for (uint16_t i=0; i<NUM_CONTACTS; i++) {
     // Check if contact is enabled:
     uint16_t  bit = i%8, byte = i/8;
     if (1 == ((contact_bitmap[byte]>>bit) & 0x01))
       continue;
-    contact_t *con = (contact_t *)data(CONTACT_BANK_0+i*sizeof(contact_t));
-    if (DigitalContact *obj = con->toContactObj())
-      ctx.addDigitalContact(obj, i);
+    contact_indices.append(i);
+    contact_loader->append((contact_t *)data(CONTACT_BANK_0+i*sizeof(contact_t)));
+  }
+  if (! ctx.addDigitalContacts(contact_indices, contact_loader)) {
+    _errorMessage = QString("%1(): Cannot index contacts: Duplicate contact index.").arg(__func__);
+    logError() << _errorMessage;
+    return false;
   }
 
   // Create RX group lists
@@ -391,8 +391,13 @@ public:
     /** Sets the TX CTCSS/DCS tone. */
     void setTXTone(Signaling::Code code);
 
+    /** Decodes name, frequencies and tones of the channel. This method does not create any
+     * QObject, hence it can be called from any thread. */
+    void parse(CodePlug::ParsedChannel &parsed) const;
     /** Constructs a generic @c Channel object from the codeplug channel. */
     Channel *toChannelObj() const;
+    /** Constructs a generic @c Channel object from the codeplug channel and its parsed settings. */
+    Channel *toChannelObj(const CodePlug::ParsedChannel &parsed) const;
     /** Links a previously constructed channel to the rest of the configuration. */
     bool linkChannelObj(Channel *c, const CodeplugContext &ctx) const;
     /** Initializes this codeplug channel from the given generic configuration. */
@@ -1165,14 +1170,14 @@ public:
     uint8_t name[16];              ///< Channel name, 16byte ASCII 0-terminated.
     uint8_t _unused26[6];          ///< Unused, set to 0x00
 
-    /** Decodes the RX frequency. */
-    double getRXFrequency() const;
-    /** Encodes the given RX frequency. */
-    void setRXFrequency(double f);
-    /** Decodes the TX frequency. */
-    double getTXFrequency() const;
-    /** Encodes the given TX frequency. */
-    void setTXFrequency(double f);
+    /** Decodes the RX frequency in Hz. */
+    Frequency getRXFrequency() const;
+    /** Encodes the given RX frequency in Hz. */
+    void setRXFrequency(Frequency f);
+    /** Decodes the TX frequency in Hz. */
+    Frequency getTXFrequency() const;
+    /** Encodes the given TX frequency in Hz. */
+    void setTXFrequency(Frequency f);
     /** Returns the time-slot of the roaming channel. */
     DigitalChannel::TimeSlot getTimeslot() const;
     /** Sets the time-slot of the roaming channel. */
@@ -1215,6 +1220,19 @@ public:
   };
 
 
+public:
+  /** Sections of the codeplug, that get encoded separately. */
+  typedef enum {
+    RadioIDSection = 0,  ///< Radio IDs.
+    ChannelSection,      ///< Channels.
+    ContactSection,      ///< Digital contacts, the contact index list and ID map.
+    GroupListSection,    ///< RX group lists.
+    ZoneSection,         ///< Zones.
+    ScanListSection,     ///< Scan lists.
+    RoamingSection,      ///< Roaming channels and zones.
+    SettingsSection      ///< General, GPS and APRS settings.
+  } Section;
+
 public:
   /** Empty constructor. */
   explicit D878UVCodeplug(QObject *parent = nullptr);
@@ -1226,18 +1244,61 @@ public:
   void setBitmaps(Config *config);
 
   /** Allocate all code-plug elements that must be downloaded for decoding. All code-plug elements
-   * with the radio that are not represented within the common Config are omitted. */
-  void allocateForDecoding();
+   * with the radio that are not represented within the common Config are omitted. Returns
+   * @c false if a record could not be allocated contiguously. */
+  bool allocateForDecoding();
   /** Allocate all code-plug elements that must be written back to the device to maintain a working
-   * codeplug. These elements might be updated during encoding. */
-  void allocateUntouched();
-  /** Allocate all code-plug elements that are defined through the common Config. */
-  void allocateForEncoding();
+   * codeplug. These elements might be updated during encoding. Returns @c false if a record could
+   * not be allocated contiguously. */
+  bool allocateUntouched();
+  /** Allocate all code-plug elements that are defined through the common Config. Returns
+   * @c false if a record could not be allocated contiguously. */
+  bool allocateForEncoding();
+
+  /** Returns the sparse memory image holding the binary codeplug. */
+  PagedImage &memory();
+  /** Returns the sparse memory image holding the binary codeplug. */
+  const PagedImage &memory() const;
+
+  /** Returns a pointer to the encoded raw data at the specified address. */
+  unsigned char *data(uint32_t offset, uint32_t img=0);
+  /** Returns a pointer to the encoded raw data at the specified address. */
+  const unsigned char *data(uint32_t offset, uint32_t img=0) const;
+
+  using DFUFile::read;
+  /** Reads a DFU file into the memory image. */
+  bool read(QFile &file);
+  using DFUFile::write;
+  /** Writes the memory image as a DFU file. */
+  bool write(QFile &file);
 
   /** Decodes the binary codeplug and stores its content in the given generic configuration. */
 	bool decode(Config *config);
   /** Encodes the given generic configuration as a binary codeplug. */
   bool encode(Config *config, const Flags &flags = Flags());
+  /** Encodes a single section of the given generic configuration. All sections but the
+   * @c SettingsSection are independent of the memory read from the device. Hence, they can be
+   * encoded while the device is still being read, once the memory has been allocated. */
+  void encodeSection(Section section, Config *config, const Flags &flags = Flags());
+  /** Returns the address ranges that may hold the given section. The ranges of all sections but
+   * the @c SettingsSection are disjoint from the bitmaps and the memory allocated by
+   * @c allocateUntouched. */
+  static QVector<PagedImage::Run> sectionSpans(Section section);
+  /** Patches the first radio ID and the intro lines. */
+  bool patchIdentity(const Identity &identity);
+
+protected:
+  /** Reserves the contact banks up to the last contact in use. */
+  bool reserveContactBanks();
+  /** Reserves the analog contact banks up to the last analog contact in use. */
+  bool reserveAnalogContactBanks();
+  /** Returns @c false and sets the error message if the memory is fragmented. */
+  bool checkAllocation(const char *func);
+
+protected:
+  /** The binary codeplug. The elements of the DFU image are only populated while reading or
+   * writing DFU files. */
+  PagedImage _memory;
 };
 
 #endif // D878UVCODEPLUG_HH
@@ -1,8 +1,15 @@
 #include "dfu_libusb.hh"
 #include <unistd.h>
+#include <algorithm>
 #include "logger.hh"
 #include "utils.hh"
 
+/** Default transfer size, if the device does not provide a DFU functional descriptor. */
+#define DEFAULT_TRANSFER_SIZE 1024
+/** Descriptor type of the DFU functional descriptor. */
+#define DFU_FUNCTIONAL_DESCRIPTOR 0x21
+/** Maximum time in ms to wait before polling the device again. */
+#define MAX_POLL_TIMEOUT 1000
 
 // USB request types.
 #define REQUEST_TYPE_TO_HOST    0xA1
@@ -34,7 +41,8 @@ enum {
 
 
 DFUDevice::DFUDevice(unsigned vid, unsigned pid, QObject *parent)
-  : QObject(parent), RadioInterface(), _ctx(nullptr), _dev(nullptr), _ident(nullptr)
+  : QObject(parent), RadioInterface(), _ctx(nullptr), _dev(nullptr), _status(),
+    _transferSize(DEFAULT_TRANSFER_SIZE), _ident(nullptr), _serialNumber()
 {
   //logDebug() << "Try to detect USB DFU interface " << Qt::hex << vid << ":" << pid << ".";
   logDebug() << "Try to detect USB DFU interface " << vid << ":" << pid << ".";
@@ -65,6 +73,9 @@ DFUDevice::DFUDevice(unsigned vid, unsigned pid, QObject *parent)
     return;
   }
 
+  read_transfer_size();
+  read_serial_number();
+
   // Enter Programming Mode.
   if (wait_idle())
     return;
@@ -94,6 +105,16 @@ DFUDevice::identifier() {
   return _ident;
 }
 
+QString
+DFUDevice::serialNumber() {
+  return _serialNumber;
+}
+
+uint
+DFUDevice::transferSize() const {
+  return _transferSize;
+}
+
 void
 DFUDevice::close() {
   if (isOpen()) {
@@ -197,7 +218,10 @@ DFUDevice::wait_idle()
       case appDETACH:
       case dfuDNBUSY:
       case dfuMANIFEST_WAIT_RESET:
-        usleep(100000);
+        // The device tells how long to wait with its status
+        if (get_status())
+          return 1;
+        poll_delay();
         continue;
 
       default:
@@ -227,12 +251,45 @@ DFUDevice::md380_command(uint8_t a, uint8_t b)
 
     if ((error = get_status()))
       return error;
-    usleep(100000);
+    poll_delay();
 
     return wait_idle();
 }
 
 
+int
+DFUDevice::wait_download()
+{
+  // The status request following a download starts the programming. The device then tells how
+  // long to wait before asking again.
+  int error;
+  if ((error = get_status()))
+    return error;
+  while (dfuDNBUSY == _status.state) {
+    poll_delay();
+    if ((error = get_status()))
+      return error;
+  }
+
+  if (dfuERROR == _status.state) {
+    _errorMessage = tr("%1 Device reported error status %2.").arg(__func__).arg(_status.status);
+    clear_status();
+    return 1;
+  }
+
+  return 0;
+}
+
+
+void
+DFUDevice::poll_delay()
+{
+  // Avoid spinning on devices reporting no poll timeout while busy and hanging on devices reporting
+  // bogus ones.
+  usleep(1000*std::min(uint(MAX_POLL_TIMEOUT), std::max(1U, uint(_status.poll_timeout))));
+}
+
+
 int
 DFUDevice::set_address(uint32_t address)
 {
@@ -283,6 +340,72 @@ DFUDevice::erase_block(uint32_t address)
 }
 
 
+void
+DFUDevice::read_transfer_size()
+{
+  libusb_config_descriptor *config = nullptr;
+  if ((0 > libusb_get_active_config_descriptor(libusb_get_device(_dev), &config)) || (! config))
+    return;
+
+  if (config->bNumInterfaces && config->interface[0].num_altsetting) {
+    const libusb_interface_descriptor &iface = config->interface[0].altsetting[0];
+    if (uint size = parseTransferSize(iface.extra, iface.extra_length))
+      _transferSize = size;
+  }
+  libusb_free_config_descriptor(config);
+
+  logDebug() << "DFU device supports transfers of " << _transferSize << "b.";
+}
+
+void
+DFUDevice::read_serial_number()
+{
+  libusb_device_descriptor desc;
+  if ((0 > libusb_get_device_descriptor(libusb_get_device(_dev), &desc)) ||
+      (0 == desc.iSerialNumber))
+    return;
+
+  unsigned char buffer[128];
+  int len = libusb_get_string_descriptor_ascii(_dev, desc.iSerialNumber, buffer, sizeof(buffer));
+  if (0 >= len)
+    return;
+
+  _serialNumber = QString::fromLatin1((const char *)buffer, len).simplified();
+  logDebug() << "DFU device reports serial number '" << _serialNumber << "'.";
+}
+
+
+uint
+DFUDevice::parseTransferSize(const unsigned char *extra, int length)
+{
+  // Search the extra descriptors of the interface for the DFU functional descriptor
+  for (int i=0; (i+1)<length; i+=extra[i]) {
+    if (0 == extra[i])
+      break;
+    if ((DFU_FUNCTIONAL_DESCRIPTOR == extra[i+1]) && (7 <= extra[i]) && (i+7 <= length))
+      return uint(extra[i+5]) | (uint(extra[i+6]) << 8);
+  }
+  return 0;
+}
+
+uint
+DFUDevice::block_size(uint32_t addr, int nbytes) const
+{
+  return blockSize(_transferSize, addr, nbytes);
+}
+
+uint
+DFUDevice::blockSize(uint transferSize, uint32_t addr, int nbytes)
+{
+  // DfuSe derives the address from the block number and the size of the request, hence the
+  // block must be aligned to its size.
+  uint bsize = transferSize;
+  while ((1 < bsize) && ((addr % bsize) || (uint(nbytes) % bsize)))
+    bsize /= 2;
+  return std::max(1U, bsize);
+}
+
+
 const char *
 DFUDevice::identify()
 {
@@ -345,15 +468,24 @@ DFUDevice::read(uint32_t bank, uint32_t addr, uint8_t *data, int nbytes) {
     _errorMessage = tr("%1 Cannot write data into nullptr!").arg(__func__);
     return false;
   }
-  uint32_t block = addr/1024;
-  int error = libusb_control_transfer(
-        _dev, REQUEST_TYPE_TO_HOST, REQUEST_UPLOAD, block+2, 0, data, nbytes, 0);
-  if (error < 0) {
-    _errorMessage = tr("%1 Cannot read block: %2 %3").arg(__func__).arg(error)
-        .arg(libusb_strerror((enum libusb_error) error));
-    return false;
+
+  // DfuSe allows for consecutive uploads without polling the status in between.
+  uint bsize = block_size(addr, nbytes);
+  for (int offset=0; offset<nbytes; offset+=bsize) {
+    uint32_t block = (addr+offset)/bsize;
+    int error = libusb_control_transfer(
+          _dev, REQUEST_TYPE_TO_HOST, REQUEST_UPLOAD, block+2, 0, data+offset, bsize, 0);
+    if (error < 0) {
+      _errorMessage = tr("%1 Cannot read block: %2 %3").arg(__func__).arg(error)
+          .arg(libusb_strerror((enum libusb_error) error));
+      return false;
+    } else if (uint(error) != bsize) {
+      _errorMessage = tr("%1 Cannot read block: Short read of %2b, expected %3b.")
+          .arg(__func__).arg(error).arg(bsize);
+      return false;
+    }
   }
-  return 0 == get_status();
+  return true;
 }
 
 bool
@@ -378,23 +510,27 @@ DFUDevice::write(uint32_t bank, uint32_t addr, uint8_t *data, int nbytes) {
     _errorMessage = tr("%1 Cannot read data from nullptr!").arg(__func__);
     return false;
   }
-  uint32_t block = addr/1024;
-  int error = libusb_control_transfer(
-        _dev, REQUEST_TYPE_TO_DEVICE, REQUEST_DNLOAD, block+2, 0, data, nbytes, 0);
-  if (error < 0) {
-    _errorMessage = tr("%1 Cannot write block: %2 %3").arg(__func__).arg(error)
-        .arg(libusb_strerror((enum libusb_error) error));
-    return false;
+
+  uint bsize = block_size(addr, nbytes);
+  for (int offset=0; offset<nbytes; offset+=bsize) {
+    uint32_t block = (addr+offset)/bsize;
+    int error = libusb_control_transfer(
+          _dev, REQUEST_TYPE_TO_DEVICE, REQUEST_DNLOAD, block+2, 0, data+offset, bsize, 0);
+    if (error < 0) {
+      _errorMessage = tr("%1 Cannot write block: %2 %3").arg(__func__).arg(error)
+          .arg(libusb_strerror((enum libusb_error) error));
+      return false;
+    }
+    // Stay in dfuDNLOAD_IDLE for the next block, wait_idle() aborts to dfuIDLE when needed.
+    if (wait_download())
+      return false;
   }
-  if ((error = get_status()))
-    return false;
-  return 0 == wait_idle();
+  return true;
 }
 
 bool
 DFUDevice::write_finish() {
-  // pass...
-  return true;
+  return 0 == wait_idle();
 }
 
 
@@ -32,8 +32,21 @@ public:
 
 	bool isOpen() const;
 	QString identifier();
+	QString serialNumber();
 	void close();
 
+  /** Returns the maximum number of bytes per transfer, as reported by the DFU functional
+   * descriptor of the device. Reads and writes larger than this get split. */
+  uint transferSize() const;
+
+  /** Returns the transfer size given by the DFU functional descriptor within the given extra
+   * descriptors of the DFU interface or 0, if there is none. */
+  static uint parseTransferSize(const unsigned char *extra, int length);
+  /** Returns the largest block size not exceeding @c transferSize usable to transfer @c nbytes at
+   * @c addr. That is, the largest power of two fraction of @c transferSize, the address and the
+   * size are aligned to. */
+  static uint blockSize(uint transferSize, uint32_t addr, int nbytes);
+
   /** Erases a memory section at @c start of size @c size. */
   bool erase(uint start, uint size, void (*progress)(uint, void *)=nullptr, void *ctx=nullptr);
 
@@ -60,6 +73,11 @@ protected:
 	int abort();
   /** Internal used function to wait for a response from the device. */
 	int wait_idle();
+  /** Internal used function to wait for the completion of a download request. */
+	int wait_download();
+  /** Internal used function to sleep for the poll timeout reported with the last status. The
+   * timeout is limited to @c MAX_POLL_TIMEOUT ms, the device gets polled again anyway. */
+	void poll_delay();
   /** Internal used function to send a controll command to the device. */
 	int md380_command(uint8_t a, uint8_t b);
   /** Internal used function to set the current I/O address. */
@@ -70,6 +88,12 @@ protected:
 	const char *identify();
   /** Internal used function to initialize the DFU connection to the device. */
 	const char *dfu_init(unsigned vid, unsigned pid);
+  /** Internal used function to read the transfer size from the DFU functional descriptor. */
+	void read_transfer_size();
+  /** Internal used function to read the serial number from the device descriptor. */
+	void read_serial_number();
+  /** Internal used function to determine the largest transfer size usable for the given range. */
+	uint block_size(uint32_t addr, int nbytes) const;
 
 protected:
   /** USB context. */
@@ -78,8 +102,12 @@ protected:
 	libusb_device_handle *_dev;
   /** Device status. */
 	status_t _status;
+  /** Maximum number of bytes per transfer. */
+  uint _transferSize;
   /** Read identifier. */
   const char *_ident;
+  /** Serial number of the device, empty if not reported. */
+  QString _serialNumber;
   /** Holds the last error message. */
   QString _errorMessage;
 };
@@ -60,6 +60,17 @@ DFUFile::size() const {
   return size+sizeof(file_suffix_t);
 }
 
+uint32_t
+DFUFile::fileOffset(int img, int el) const {
+  uint32_t offset = sizeof(file_prefix_t);
+  for (int i=0; i<img; i++)
+    offset += _images[i].size();
+  offset += sizeof(image_prefix_t);
+  for (int e=0; e<el; e++)
+    offset += _images[img].element(e).size();
+  return offset + sizeof(element_prefix_t);
+}
+
 uint32_t
 DFUFile::memSize() const {
   uint32_t size = 0;
@@ -64,6 +64,7 @@ class DFUFile: public QObject
 {
 	Q_OBJECT
 
+public:
   /** Represents a single element within a @c Image. */
 	class Element {
 	public:
@@ -179,6 +180,8 @@ public:
 	uint32_t size() const;
   /** Returns the total memory size stored in the DFU file. */
   uint32_t memSize() const;
+  /** Returns the offset of the data of element @c el of image @c img within the file. */
+  uint32_t fileOffset(int img, int el) const;
 
   /** Returns the number of images within the DFU file. */
 	int numImages() const;
@@ -204,14 +207,14 @@ public:
 	bool read(const QString &filename);
   /** Reads the specified DFU file.
    * @returns @c false on error. */
-	bool read(QFile &file);
+	virtual bool read(QFile &file);
 
   /** Writes to the specified file.
    * @returns @c false on error. */
 	bool write(const QString &filename);
   /** Writes to the specified file.
    * @returns @c false on error. */
-	bool write(QFile &file);
+	virtual bool write(QFile &file);
 
   /** Dumps a text representation of the DFU file structure to the specified text stream. */
 	void dump(QTextStream &stream) const;
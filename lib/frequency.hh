@@ -0,0 +1,25 @@
+#ifndef FREQUENCY_HH
+#define FREQUENCY_HH
+
+#include <QtGlobal>
+#include <cmath>
+
+/** Represents a frequency in Hz.
+ *
+ * Frequencies are stored as 64-bit integers in Hz. Unlike MHz as @c double, they can be
+ * compared exactly and used as hash keys.
+ *
+ * @ingroup conf */
+typedef qint64 Frequency;
+
+/** Converts the given frequency in MHz to Hz, rounding to the nearest Hz. */
+inline Frequency mhz2hz(double MHz) {
+  return Frequency(std::llround(MHz*1e6));
+}
+
+/** Converts the given frequency in Hz to MHz. */
+inline double hz2mhz(Frequency Hz) {
+  return double(Hz)/1e6;
+}
+
+#endif // FREQUENCY_HH
@@ -92,7 +92,6 @@ GD77::startDownload(bool blocking) {
   }
 
   _task = StatusDownload;
-  _config->reset();
 
   if (blocking) {
     run();
@@ -107,7 +106,7 @@ GD77::startUpload(Config *config, bool blocking, const CodePlug::Flags &flags) {
   if (StatusIdle != _task)
     return false;
 
-  if (! (_config = config))
+  if (! takeSnapshot(config))
     return false;
 
   _dev = new HID(0x15a2, 0x0073, this);
@@ -165,9 +164,9 @@ GD77::run() {
       uint size = _codeplug.image(0).element(n).data().size();
       uint b0 = addr/BSIZE, nb = size/BSIZE;
       for (uint b=0; b<nb; b++, bcount++) {
-        if (! _dev->read(0, (b0+b)*BSIZE, _codeplug.data((b0+b)*BSIZE), BSIZE)) {
+        if (cancelRequested() || (! _dev->read(0, (b0+b)*BSIZE, _codeplug.data((b0+b)*BSIZE), BSIZE))) {
           _errorMessage = QString("%1 Cannot download codeplug: %2").arg(__func__)
-              .arg(_dev->errorMessage());
+              .arg(transferError(_dev));
           _task = StatusError;
           _dev->read_finish();
           _dev->close();
@@ -176,7 +175,7 @@ GD77::run() {
           return;
         }
         logDebug() << "Read block " << (b0+b) << ".";
-        emit downloadProgress(float(bcount*100)/totb);
+        setProgress(float(bcount*100)/totb, BSIZE);
       }
     }
     _dev->read_finish();
@@ -190,6 +189,10 @@ GD77::run() {
   } else if (StatusUpload == _task) {
     emit uploadStarted();
 
+    SnapshotGuard snapshot(this, _config);
+    if (snapshot.isNull())
+      return;
+
     // Check every segment in the codeplug
     size_t totb = 0;
     for (int n=0; n<_codeplug.image(0).numElements(); n++) {
@@ -209,16 +212,19 @@ GD77::run() {
     }
     _dev->read_finish();
 
-    // First download codeplug from device:
+    // First download codeplug from device, skipping blocks overwritten by the encoder:
+    QVector<CodePlug::PagedImage::Run> overwritten = _codeplug.overwriteMap(_config);
     size_t bcount = 0;
     for (int n=0; n<_codeplug.image(0).numElements(); n++) {
       uint addr = _codeplug.image(0).element(n).address();
       uint size = _codeplug.image(0).element(n).data().size();
       uint b0 = addr/BSIZE, nb = size/BSIZE;
       for (uint b=0; b<nb; b++, bcount++) {
-        if (! _dev->read(0, (b0+b)*BSIZE, _codeplug.data((b0+b)*BSIZE), BSIZE)) {
+        if (CodePlug::isOverwritten(overwritten, (b0+b)*BSIZE, BSIZE))
+          continue;
+        if (cancelRequested() || (! _dev->read(0, (b0+b)*BSIZE, _codeplug.data((b0+b)*BSIZE), BSIZE))) {
           _errorMessage = QString("%1 Cannot upload codeplug: %2").arg(__func__)
-              .arg(_dev->errorMessage());
+              .arg(transferError(_dev));
           _task = StatusError;
           _dev->read_finish();
           _dev->close();
@@ -226,7 +232,7 @@ GD77::run() {
           emit downloadError(this);
           return;
         }
-        emit uploadProgress(float(bcount*50)/totb);
+        setProgress(float(bcount*50)/totb, BSIZE);
       }
     }
 
@@ -240,9 +246,9 @@ GD77::run() {
       uint size = _codeplug.image(0).element(n).data().size();
       uint b0 = addr/BSIZE, nb = size/BSIZE;
       for (size_t b=1; b<nb; b++,bcount++) {
-        if (! _dev->write(0, b*BSIZE, _codeplug.data((b0+b)*BSIZE), BSIZE)) {
+        if (cancelRequested() || (! _dev->write(0, b*BSIZE, _codeplug.data((b0+b)*BSIZE), BSIZE))) {
           _errorMessage = QString("%1 Cannot upload codeplug: %2").arg(__func__)
-              .arg(_dev->errorMessage());
+              .arg(transferError(_dev));
           _task = StatusError;
           _dev->write_finish();
           _dev->close();
@@ -250,7 +256,7 @@ GD77::run() {
           emit uploadError(this);
           return;
         }
-        emit uploadProgress(50+float(bcount*50)/totb);
+        setProgress(50+float(bcount*50)/totb, BSIZE);
       }
     }
 
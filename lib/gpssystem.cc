@@ -51,7 +51,7 @@ GPSSystem::GPSSystem(const QString &name, DigitalContact *contact,
 
 bool
 GPSSystem::hasContact() const {
-  return nullptr != _contact;
+  return ! _contact.isNull();
 }
 
 DigitalContact *
@@ -61,15 +61,12 @@ GPSSystem::contact() const {
 
 void
 GPSSystem::setContact(DigitalContact *contact) {
-  if (_contact)
-    disconnect(_contact, SIGNAL(destroyed(QObject*)), this, SLOT(onContactDeleted()));
   _contact = contact;
-  connect(_contact, SIGNAL(destroyed(QObject*)), this, SLOT(onContactDeleted()));
 }
 
 bool
 GPSSystem::hasRevertChannel() const {
-  return nullptr != _revertChannel;
+  return ! _revertChannel.isNull();
 }
 
 DigitalChannel *
@@ -79,21 +76,7 @@ GPSSystem::revertChannel() const {
 
 void
 GPSSystem::setRevertChannel(DigitalChannel *channel) {
-  if (_revertChannel)
-    disconnect(_revertChannel, SIGNAL(destroyed(QObject*)), this, SLOT(onRevertChannelDeleted()));
   _revertChannel = channel;
-  if (_revertChannel)
-    connect(_revertChannel, SIGNAL(destroyed(QObject*)), this, SLOT(onRevertChannelDeleted()));
-}
-
-void
-GPSSystem::onContactDeleted() {
-  _contact = nullptr;
-}
-
-void
-GPSSystem::onRevertChannelDeleted() {
-  _revertChannel = nullptr;
 }
 
 
@@ -106,8 +89,7 @@ APRSSystem::APRSSystem(const QString &name, AnalogChannel *channel, const QStrin
   : PositioningSystem(name, period, parent), _channel(channel), _destination(dest), _destSSID(destSSID),
     _source(src), _srcSSID(srcSSID), _path(path), _icon(icon), _message(message)
 {
-  if (_channel)
-    connect(_channel, SIGNAL(destroyed(QObject*)), this, SLOT(onChannelDeleted(QObject*)));
+  // pass...
 }
 
 AnalogChannel *
@@ -116,11 +98,7 @@ APRSSystem::channel() const {
 }
 void
 APRSSystem::setChannel(AnalogChannel *channel) {
-  if (_channel)
-    disconnect(_channel, SIGNAL(destroyed(QObject*)), this, SLOT(onChannelDeleted(QObject*)));
   _channel = channel;
-  if (_channel)
-    connect(_channel, SIGNAL(destroyed(QObject*)), this, SLOT(onChannelDeleted(QObject*)));
 }
 
 const QString &
@@ -179,12 +157,6 @@ APRSSystem::setMessage(const QString &msg) {
   _message = msg;
 }
 
-void
-APRSSystem::onChannelDeleted(QObject *obj) {
-  if (_channel == obj)
-    _channel = nullptr;
-}
-
 
 /* ********************************************************************************************* *
  * Implementation of GPSSystems table
@@ -3,6 +3,7 @@
 
 #include <QObject>
 #include <QAbstractTableModel>
+#include <QPointer>
 
 
 class Config;
@@ -99,17 +100,11 @@ public:
   /** Sets the revert channel for the GPS information to be send on. */
   void setRevertChannel(DigitalChannel *channel);
 
-protected slots:
-  /** Internal used callback to get notified if the destination contact is deleted. */
-  void onContactDeleted();
-  /** Internal used callback to get notified if the revert channel is deleted. */
-  void onRevertChannelDeleted();
-
 protected:
   /** Holds the destination contact for the GPS information. */
-  DigitalContact *_contact;
+  QPointer<DigitalContact> _contact;
   /** Holds the revert channel on which the GPS information is send on. */
-  DigitalChannel *_revertChannel;
+  QPointer<DigitalChannel> _revertChannel;
 };
 
 
@@ -204,13 +199,9 @@ public:
   /** Sets the optional APRS message text. */
   void setMessage(const QString &msg);
 
-protected slots:
-  /** Internal call-back if the transmit channel gets deleted. */
-  void onChannelDeleted(QObject *obj);
-
 protected:
   /** A weak reference to the transmit channel. */
-  AnalogChannel *_channel;
+  QPointer<AnalogChannel> _channel;
   /** Holds the destination call. */
   QString _destination;
   /** Holds the destination SSID. */
@@ -56,7 +56,8 @@ static Radio::Features _open_gd77_features =
 
 
 OpenGD77::OpenGD77(QObject *parent)
-  : Radio(parent), _name("Open GD-77"), _dev(nullptr), _config(nullptr), _codeplug(), _callsigns()
+  : Radio(parent), _name("Open GD-77"), _dev(nullptr), _config(nullptr), _userDB(nullptr),
+    _codeplug(), _callsigns()
 {
   // pass...
 }
@@ -115,7 +116,7 @@ OpenGD77::startUpload(Config *config, bool blocking, const CodePlug::Flags &flag
     return false;
   }
 
-  if (! (_config = config)) {
+  if (! takeSnapshot(config)) {
     logError() << "Cannot upload to radio, no config given.";
     return false;
   }
@@ -140,9 +141,8 @@ OpenGD77::startUploadCallsignDB(UserDatabase *db, bool blocking) {
     return false;
   }
 
-  // Assemble call-sign db from user DB
-  logDebug() << "Encode call-signs into db.";
-  _callsigns.encode(db);
+  // The call-sign DB gets encoded within the radio thread, once the device is known
+  _userDB = db;
 
   _task = StatusUploadCallsigns;
   if (blocking) {
@@ -233,9 +233,9 @@ OpenGD77::download()
       uint b0 = addr/BSIZE, nb = size/BSIZE;
 
       for (uint b=0; b<nb; b++, bcount+=BSIZE) {
-        if (! _dev->read(bank, (b0+b)*BSIZE, _codeplug.data((b0+b)*BSIZE, image), BSIZE)) {
+        if (cancelRequested() || (! _dev->read(bank, (b0+b)*BSIZE, _codeplug.data((b0+b)*BSIZE, image), BSIZE))) {
           _errorMessage = QString("In %1(), cannot read block %2:\n\t %3")
-              .arg(__func__).arg(b0+b).arg(_dev->errorMessage());
+              .arg(__func__).arg(b0+b).arg(transferError(_dev));
           logError() << _errorMessage;
           _task = StatusError;
           _dev->read_finish();
@@ -245,7 +245,7 @@ OpenGD77::download()
           emit downloadError(this);
           return;
         }
-        emit downloadProgress(float(bcount*100)/totb);
+        setProgress(float(bcount*100)/totb, BSIZE);
       }
     }
     _dev->read_finish();
@@ -264,6 +264,10 @@ OpenGD77::download()
 
 void
 OpenGD77::upload() {
+  SnapshotGuard snapshot(this, _config);
+  if (snapshot.isNull())
+    return;
+
   _dev = new OpenGD77Interface();
   if (! _dev->isOpen()) {
     _task = StatusError;
@@ -317,19 +321,22 @@ OpenGD77::upload() {
     return;
   }
 
-  // Then download codeplug
+  // Then download codeplug, skipping blocks overwritten by the encoder
   size_t bcount = 0;
   for (int image=0; image<_codeplug.numImages(); image++) {
     uint32_t bank = ( (0 == image) ? OpenGD77Codeplug::EEPROM : OpenGD77Codeplug::FLASH );
+    QVector<CodePlug::PagedImage::Run> overwritten = _codeplug.overwriteMap(_config, bank);
 
     for (int n=0; n<_codeplug.image(image).numElements(); n++) {
       uint addr = _codeplug.image(image).element(n).address();
       uint size = _codeplug.image(image).element(n).data().size();
       uint b0 = addr/BSIZE, nb = size/BSIZE;
       for (uint b=0; b<nb; b++, bcount+=BSIZE) {
-        if (! _dev->read(bank, (b0+b)*BSIZE, _codeplug.data((b0+b)*BSIZE, image), BSIZE)) {
+        if (CodePlug::isOverwritten(overwritten, (b0+b)*BSIZE, BSIZE))
+          continue;
+        if (cancelRequested() || (! _dev->read(bank, (b0+b)*BSIZE, _codeplug.data((b0+b)*BSIZE, image), BSIZE))) {
           _errorMessage = QString("In %1(), cannot read block %2:\n\t %3")
-              .arg(__func__).arg(b0+b).arg(_dev->errorMessage());
+              .arg(__func__).arg(b0+b).arg(transferError(_dev));
           logError() << _errorMessage;
           _task = StatusError;
           _dev->read_finish();
@@ -339,7 +346,7 @@ OpenGD77::upload() {
           emit uploadError(this);
           return;
         }
-        emit uploadProgress(float(bcount*50)/totb);
+        setProgress(float(bcount*50)/totb, BSIZE);
       }
     }
     _dev->read_finish();
@@ -370,9 +377,9 @@ OpenGD77::upload() {
       uint b0 = addr/BSIZE, nb = size/BSIZE;
 
       for (uint b=0; b<nb; b++, bcount+=BSIZE) {
-        if (! _dev->write(bank, (b0+b)*BSIZE, _codeplug.data((b0+b)*BSIZE, image), BSIZE)) {
+        if (cancelRequested() || (! _dev->write(bank, (b0+b)*BSIZE, _codeplug.data((b0+b)*BSIZE, image), BSIZE))) {
           _errorMessage = QString("In %1(), cannot write block %2:\n\t %3")
-              .arg(__func__).arg(b0+b).arg(_dev->errorMessage());
+              .arg(__func__).arg(b0+b).arg(transferError(_dev));
           logError() << _errorMessage;
           _task = StatusError;
           _dev->write_finish();
@@ -382,7 +389,7 @@ OpenGD77::upload() {
           emit uploadError(this);
           return;
         }
-        emit uploadProgress(float(bcount*50)/totb);
+        setProgress(float(bcount*50)/totb, BSIZE);
       }
     }
     _dev->write_finish();
@@ -413,6 +420,18 @@ OpenGD77::uploadCallsigns() {
 
   emit uploadStarted();
 
+  // Assemble call-sign db from user DB. Only re-encode entries that differ from the DB last
+  // written to this particular device, if it is still present on the device.
+  logDebug() << "Encode call-signs into db.";
+  QString device = _dev->identity();
+  UserDatabase::Snapshot previous = _userDB->lastWritten(name(), device);
+  if ((! previous.isEmpty()) &&
+      (! isOnDevice(_dev, OpenGD77Codeplug::FLASH, previous.address, previous.image, BSIZE))) {
+    logInfo() << "Call-sign DB on the device differs from the one last written, upload all.";
+    previous = UserDatabase::Snapshot();
+  }
+  _callsigns.encode(_userDB, previous);
+
   // Check every segment in the codeplug
   if (! _callsigns.isAligned(BSIZE)) {
     _errorMessage = QString("In %1(), cannot upload call-sign DB:\n\t "
@@ -440,18 +459,23 @@ OpenGD77::uploadCallsigns() {
     return;
   }
 
+  // Force a complete upload next time, if this one fails, see UserDatabase::clearLastWritten()
+  _userDB->clearLastWritten(name(), device);
+
   uint bcount = 0;
-  // Then upload callsign DB
+  // Then upload modified blocks of the callsign DB
   for (int n=0; n<_callsigns.image(0).numElements(); n++) {
     uint addr = _callsigns.image(0).element(n).address();
     uint size = _callsigns.image(0).element(n).data().size();
     uint b0 = addr/BSIZE, nb = size/BSIZE;
     for (uint b=0; b<nb; b++, bcount+=BSIZE) {
-      if (! _dev->write(OpenGD77Codeplug::FLASH, (b0+b)*BSIZE,
-                        _callsigns.data((b0+b)*BSIZE, 0), BSIZE))
+      if (! _callsigns.isDirty((b0+b)*BSIZE))
+        continue;
+      if (cancelRequested() || (! _dev->write(OpenGD77Codeplug::FLASH, (b0+b)*BSIZE,
+                                              _callsigns.data((b0+b)*BSIZE, 0), BSIZE)))
       {
         _errorMessage = QString("In %1(), cannot write block %2:\n\t %3")
-            .arg(__func__).arg(b0+b).arg(_dev->errorMessage());
+            .arg(__func__).arg(b0+b).arg(transferError(_dev));
         logError() << _errorMessage;
         _task = StatusError;
         _dev->write_finish();
@@ -461,11 +485,14 @@ OpenGD77::uploadCallsigns() {
         emit uploadError(this);
         return;
       }
-      emit uploadProgress(float(bcount*100)/totb);
+      setProgress(float(bcount*100)/totb, BSIZE);
     }
   }
   _dev->write_finish();
 
+  // Remember what was written to the device
+  _userDB->setLastWritten(name(), device, _callsigns.snapshot());
+
   _task = StatusIdle;
   _dev->reboot();
   _dev->close();
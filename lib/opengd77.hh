@@ -55,6 +55,8 @@ protected:
   OpenGD77Interface *_dev;
   /** The generic configuration. */
 	Config *_config;
+  /** A weak reference to the user-database. */
+  UserDatabase *_userDB;
   /** The actual binary codeplug representation. */
   OpenGD77Codeplug _codeplug;
   /** The acutal binary callsign DB representation. */
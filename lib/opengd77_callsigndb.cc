@@ -1,5 +1,6 @@
 #include "opengd77_callsigndb.hh"
 #include "utils.hh"
+#include "logger.hh"
 #include <QtEndian>
 
 #define OFFSET_USERDB       0x30000
@@ -7,6 +8,7 @@
 #define USERDB_NUM_ENTRIES  (USERDB_SIZE-sizeof(userdb_t))/sizeof(userdb_entry_t)
 
 #define BLOCK_SIZE  32
+#define SECTOR_SIZE 0x1000  // Granularity of modified blocks, flash sector size
 
 
 
@@ -66,6 +68,11 @@ OpenGD77CallsignDB::userdb_t::clear() {
   unused6 = unused9 = 0;
 }
 
+uint
+OpenGD77CallsignDB::userdb_t::getSize() const {
+  return qFromLittleEndian(count);
+}
+
 void
 OpenGD77CallsignDB::userdb_t::setSize(uint n) {
   count = qToLittleEndian(std::min(n, uint(USERDB_NUM_ENTRIES)));
@@ -87,8 +94,15 @@ OpenGD77CallsignDB::~OpenGD77CallsignDB() {
 
 bool
 OpenGD77CallsignDB::encode(UserDatabase *calldb) {
+  return encode(calldb, UserDatabase::Snapshot());
+}
+
+bool
+OpenGD77CallsignDB::encode(UserDatabase *calldb, const UserDatabase::Snapshot &previous) {
   // Limit entries to USERDB_NUM_ENTRIES
   uint n = std::min(calldb->count(), qint64(USERDB_NUM_ENTRIES));
+  _entries = calldb->snapshot(n).entries;
+  _dirty.clear();
   // If there are no entries -> done.
   if (0 == n)
     return true;
@@ -102,15 +116,68 @@ OpenGD77CallsignDB::encode(UserDatabase *calldb) {
 
   // Allocate segment for user db if requested
   uint size = align_size(sizeof(userdb_t)+n*sizeof(userdb_entry_t), BLOCK_SIZE);
-  this->image(0).addElement(OFFSET_USERDB, size);
+  if (0 == image(0).numElements())
+    this->image(0).addElement(OFFSET_USERDB, size);
+  else
+    this->image(0).element(0).data().fill(0x00, size);
+
+  // Start with the DB last written to the device, if there is one
+  bool incremental = ((! previous.isEmpty()) && (OFFSET_USERDB == previous.address));
+  uint prevN = 0;
+  UserDatabase::Diff diff;
+  if (incremental) {
+    memcpy(this->data(OFFSET_USERDB), previous.image.constData(),
+           std::min(size, uint(previous.image.size())));
+    prevN = ((userdb_t *)this->data(OFFSET_USERDB))->getSize();
+    diff = calldb->diff(previous, n);
+    logDebug() << "Update call-sign DB: " << diff.added.size() << " added, "
+               << diff.removed.size() << " removed, " << diff.changed.size() << " changed.";
+  }
 
   // Encode user DB
   userdb_t *userdb = (userdb_t *)this->data(OFFSET_USERDB);
-  userdb->clear(); userdb->setSize(n);
+  userdb_t header; header.setSize(n);
+  if ((! incremental) || memcmp(userdb, &header, sizeof(userdb_t))) {
+    memcpy(userdb, &header, sizeof(userdb_t));
+    markDirty(OFFSET_USERDB, sizeof(userdb_t));
+  }
   userdb_entry_t *db = (userdb_entry_t *)this->data(OFFSET_USERDB+sizeof(userdb_t));
   for (uint i=0; i<n; i++) {
+    // Re-encode only those entries that were moved or changed
+    if (incremental && (i<prevN) && (db[i].getNumber() == users[i].id)
+        && (! diff.changed.contains(users[i].id)))
+      continue;
+    db[i].clear();
     db[i].fromEntry(users[i]);
+    markDirty(OFFSET_USERDB+sizeof(userdb_t)+i*sizeof(userdb_entry_t), sizeof(userdb_entry_t));
+  }
+  // Clear remaining entries of the previous DB
+  for (uint i=n; (i<prevN) && ((sizeof(userdb_t)+(i+1)*sizeof(userdb_entry_t))<=size); i++) {
+    db[i].clear();
+    markDirty(OFFSET_USERDB+sizeof(userdb_t)+i*sizeof(userdb_entry_t), sizeof(userdb_entry_t));
   }
 
   return true;
 }
+
+bool
+OpenGD77CallsignDB::isDirty(uint32_t addr) const {
+  return _dirty.contains(addr/SECTOR_SIZE);
+}
+
+UserDatabase::Snapshot
+OpenGD77CallsignDB::snapshot() const {
+  UserDatabase::Snapshot snapshot;
+  snapshot.entries = _entries;
+  if (image(0).numElements()) {
+    snapshot.address = image(0).element(0).address();
+    snapshot.image = image(0).element(0).data();
+  }
+  return snapshot;
+}
+
+void
+OpenGD77CallsignDB::markDirty(uint32_t addr, uint32_t size) {
+  for (uint32_t b=addr/SECTOR_SIZE; b<=(addr+size-1)/SECTOR_SIZE; b++)
+    _dirty.insert(b);
+}
@@ -39,6 +39,7 @@ class OpenGD77CallsignDB : public DFUFile
     userdb_t();
     void clear();
 
+    uint getSize() const;
     void setSize(uint n);
   };
 
@@ -51,6 +52,25 @@ public:
 
   /** Encodes as many entries as possible of the given user-database. */
   virtual bool encode(UserDatabase *calldb);
+  /** Encodes as many entries as possible of the given user-database incrementally. That is, only
+   * those entries that differ from the given snapshot of the DB last written to the device get
+   * re-encoded. If the snapshot is empty, the complete DB gets encoded. */
+  virtual bool encode(UserDatabase *calldb, const UserDatabase::Snapshot &previous);
+
+  /** Returns @c true if the block at the given address was modified by the last encoding. */
+  bool isDirty(uint32_t addr) const;
+  /** Returns the snapshot of the encoded DB. */
+  UserDatabase::Snapshot snapshot() const;
+
+protected:
+  /** Marks all blocks within the given address range as modified. */
+  void markDirty(uint32_t addr, uint32_t size);
+
+protected:
+  /** IDs and content hashes of the encoded entries. */
+  QHash<uint, uint32_t> _entries;
+  /** Indices of all modified blocks. */
+  QSet<uint32_t> _dirty;
 };
 
 #endif // OPENGD77CALLSIGNDB_HH
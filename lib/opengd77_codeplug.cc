@@ -4,6 +4,7 @@
 #include "utils.hh"
 #include "logger.hh"
 #include <QDateTime>
+#include <cstddef>
 #include <QtEndian>
 
 // Stored in EEPROM
@@ -522,6 +523,39 @@ next:
   return true;
 }
 
+bool
+OpenGD77Codeplug::patchIdentity(const Identity &identity) {
+  general_settings_t *gs = (general_settings_t*) data(OFFSET_SETTINGS, EEPROM);
+  gs->setName(identity.name);
+  gs->setRadioId(identity.id);
+
+  intro_text_t *it = (intro_text_t*) data(OFFSET_INTRO, EEPROM);
+  it->setIntroLine1(identity.introLine1);
+  it->setIntroLine2(identity.introLine2);
+  return true;
+}
+
+QVector<CodePlug::PagedImage::Run>
+OpenGD77Codeplug::overwriteMap(const Config *config, uint32_t img) const {
+  QVector<PagedImage::Run> map;
+  // Records of used channels, the bitmaps of the banks are only updated. The first bank is held
+  // in EEPROM, all others in flash.
+  int nchan = std::min(NCHAN, config->channelList()->count());
+  if (EEPROM == img) {
+    if (0 < nchan)
+      map.append({uint32_t(OFFSET_BANK_0+offsetof(bank_t, chan)),
+                  uint32_t(std::min(128, nchan)*sizeof(channel_t))});
+  } else if (FLASH == img) {
+    for (int i=128; i<nchan; i+=128) {
+      uint32_t bank = OFFSET_BANK_1 + ((i>>7)-1)*sizeof(bank_t);
+      map.append({uint32_t(bank+offsetof(bank_t, chan)),
+                  uint32_t(std::min(128, nchan-i)*sizeof(channel_t))});
+    }
+    map.append({OFFSET_CONTACTS, NCONTACTS*sizeof(contact_t)});
+  }
+  return map;
+}
+
 bool
 OpenGD77Codeplug::decode(Config *config) {
   // Clear config object
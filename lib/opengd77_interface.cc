@@ -351,29 +351,18 @@ OpenGD77Interface::readEEPROM(uint32_t addr, uint8_t *data, uint16_t len) {
   }
 
   ReadRequest req; req.initReadEEPROM(addr, BLOCK_SIZE);
-  if (sizeof(ReadRequest) != QSerialPort::write((const char *)&req, sizeof(ReadRequest))) {
+  if (sizeof(ReadRequest) != transmit((const char *)&req, sizeof(ReadRequest))) {
     _errorMessage = tr("Cannot write to serial port: %1").arg(USBSerial::errorMessage());
     logError() << __FILE__ << ": " << _errorMessage;
     return false;
   }
 
-  if (! waitForReadyRead(1000)) {
-    _errorMessage = tr("Cannot read from serial port: Timeout!");
-    logError() << __FILE__ << ": " << _errorMessage;
-    return false;
-  }
-
+  // Read the header first, the payload size is known once it has been checked
   ReadResponse resp;
-  int retlen = QSerialPort::read((char *)&resp, sizeof(ReadResponse));
-
-  if (0 > retlen) {
+  if (! receiveExact((char *)&resp, sizeof(ReadResponse)-sizeof(resp.data), 1000)) {
     _errorMessage = tr("Cannot read from serial port: %1").arg(USBSerial::errorMessage());
     logError() << __FILE__ << ": " << _errorMessage;
     return false;
-  } else if (0 == retlen) {
-    _errorMessage = tr("Cannot read from serial port: Device returned empty message.");
-    logError() << __FILE__ << ": " << _errorMessage;
-    return false;
   }
 
   if ('R' != resp.type) {
@@ -389,6 +378,12 @@ OpenGD77Interface::readEEPROM(uint32_t addr, uint8_t *data, uint16_t len) {
     return false;
   }
 
+  if (! receiveExact((char *)resp.data, qFromBigEndian(resp.length), 1000)) {
+    _errorMessage = tr("Cannot read from serial port: %1").arg(USBSerial::errorMessage());
+    logError() << __FILE__ << ": " << _errorMessage;
+    return false;
+  }
+
   memcpy(data, resp.data, qFromBigEndian(resp.length));
   return true;
 }
@@ -399,28 +394,16 @@ OpenGD77Interface::writeEEPROM(uint32_t addr, const uint8_t *data, uint16_t len)
   WriteRequest req; req.initWriteEEPROM(addr, data, len);
   WriteResponse resp;
 
-  if ((8+len) != QSerialPort::write((const char *)&req, 8+len)) {
+  if ((8+len) != transmit((const char *)&req, 8+len)) {
     _errorMessage = tr("Cannot write to serial port: %1").arg(USBSerial::errorMessage());
     logError() << _errorMessage;
     return false;
   }
 
-  if (! waitForReadyRead(1000)) {
-    _errorMessage = tr("Cannot read from serial port: Timeout!");
-    logError() << _errorMessage;
-    return false;
-  }
-
-  int retlen = QSerialPort::read((char *)&resp, sizeof(WriteResponse));
-
-  if (0 > retlen) {
+  if (! receiveExact((char *)&resp, sizeof(WriteResponse), 1000)) {
     _errorMessage = tr("Cannot read from serial port: %1").arg(USBSerial::errorMessage());
     logError() << _errorMessage;
     return false;
-  } else if (0 == retlen) {
-    _errorMessage = tr("Cannot write EEPROM: Device returned empty message.");
-    logError() << _errorMessage;
-    return false;
   }
 
   if ((req.type != resp.type) || (req.command != resp.command)) {
@@ -443,29 +426,18 @@ OpenGD77Interface::readFlash(uint32_t addr, uint8_t *data, uint16_t len) {
 
   ReadRequest req;
   req.initReadFlash(addr, BLOCK_SIZE);
-  if (sizeof(ReadRequest) != QSerialPort::write((const char *)&req, sizeof(ReadRequest))) {
+  if (sizeof(ReadRequest) != transmit((const char *)&req, sizeof(ReadRequest))) {
     _errorMessage = tr("Cannot write to serial port: %1").arg(USBSerial::errorMessage());
     logError() << _errorMessage;
     return false;
   }
 
-  if (! waitForReadyRead(1000)) {
-    _errorMessage = tr("Cannot read from serial port: Timeout!");
-    logError() << _errorMessage;
-    return false;
-  }
-
+  // Read the header first, the payload size is known once it has been checked
   ReadResponse resp;
-  int retlen = QSerialPort::read((char *)&resp, sizeof(ReadResponse));
-
-  if (0 > retlen) {
+  if (! receiveExact((char *)&resp, sizeof(ReadResponse)-sizeof(resp.data), 1000)) {
     _errorMessage = tr("Cannot read from serial port: %1").arg(USBSerial::errorMessage());
     logError() << _errorMessage;
     return false;
-  } else if (0 == retlen) {
-    _errorMessage = tr("Cannot read from serial port: Device returned empty message.");
-    logError() << _errorMessage;
-    return false;
   }
 
   if ('R' != resp.type) {
@@ -481,6 +453,12 @@ OpenGD77Interface::readFlash(uint32_t addr, uint8_t *data, uint16_t len) {
     return false;
   }
 
+  if (! receiveExact((char *)resp.data, qFromBigEndian(resp.length), 1000)) {
+    _errorMessage = tr("Cannot read from serial port: %1").arg(USBSerial::errorMessage());
+    logError() << _errorMessage;
+    return false;
+  }
+
   memcpy(data, resp.data, qFromBigEndian(resp.length));
   return true;
 }
@@ -491,28 +469,16 @@ OpenGD77Interface::setFlashSector(uint32_t addr) {
   WriteRequest req; req.initSetFlashSector(addr);
   WriteResponse resp;
 
-  if (5 != QSerialPort::write((const char *)&req, 5)) {
+  if (5 != transmit((const char *)&req, 5)) {
     _errorMessage = tr("Cannot write to serial port: %1").arg(USBSerial::errorMessage());
     logError() << _errorMessage;
     return false;
   }
 
-  if (! waitForReadyRead(1000)) {
-    _errorMessage = tr("Cannot read from serial port: Timeout!");
-    logError() << _errorMessage;
-    return false;
-  }
-
-  int retlen = QSerialPort::read((char *)&resp, sizeof(WriteResponse));
-
-  if (0 > retlen) {
+  if (! receiveExact((char *)&resp, sizeof(WriteResponse), 1000)) {
     _errorMessage = tr("Cannot read from serial port: %1").arg(USBSerial::errorMessage());
     logError() << _errorMessage;
     return false;
-  } else if (0 == retlen) {
-    _errorMessage = tr("Cannot set flash sector: Device returned empty message.");
-    logError() << _errorMessage;
-    return false;
   }
 
   if ((req.type != resp.type) || (req.command != resp.command)) {
@@ -529,28 +495,16 @@ OpenGD77Interface::writeFlash(uint32_t addr, const uint8_t *data, uint16_t len)
   WriteRequest req; req.initWriteFlash(addr, data, len);
   WriteResponse resp;
 
-  if ((8+len) != QSerialPort::write((const char *)&req, 8+len)) {
+  if ((8+len) != transmit((const char *)&req, 8+len)) {
     _errorMessage = tr("Cannot write to serial port: %1").arg(USBSerial::errorMessage());
     logError() << _errorMessage;
     return false;
   }
 
-  if (! waitForReadyRead(1000)) {
-    _errorMessage = tr("Cannot read from serial port: Timeout!");
-    logError() << _errorMessage;
-    return false;
-  }
-
-  int retlen = QSerialPort::read((char *)&resp, sizeof(WriteResponse));
-
-  if (0 > retlen) {
+  if (! receiveExact((char *)&resp, sizeof(WriteResponse), 1000)) {
     _errorMessage = tr("Cannot read from serial port: %1").arg(USBSerial::errorMessage());
     logError() << _errorMessage;
     return false;
-  } else if (0 == retlen) {
-    _errorMessage = tr("Cannot write to buffer: Device returned empty message.");
-    logError() << _errorMessage;
-    return false;
   }
 
   if ((req.type != resp.type) || (req.command != resp.command)) {
@@ -569,28 +523,16 @@ OpenGD77Interface::finishWriteFlash() {
   req.initFinishWriteFlash();
   WriteResponse resp;
 
-  if ((2) != QSerialPort::write((const char *)&req, 2)) {
+  if ((2) != transmit((const char *)&req, 2)) {
     _errorMessage = tr("Cannot write to serial port: %1").arg(USBSerial::errorMessage());
     logError() << _errorMessage;
     return false;
   }
 
-  if (! waitForReadyRead(1000)) {
-    _errorMessage = tr("Cannot read from serial port: Timeout!");
-    logError() << _errorMessage;
-    return false;
-  }
-
-  int retlen = QSerialPort::read((char *)&resp, sizeof(WriteResponse));
-
-  if (0 > retlen) {
+  if (! receiveExact((char *)&resp, sizeof(WriteResponse), 1000)) {
     _errorMessage = tr("Cannot read from serial port: %1").arg(USBSerial::errorMessage());
     logError() << _errorMessage;
     return false;
-  } else if (0 == retlen) {
-    _errorMessage = tr("Cannot write to flash: Device returned empty message.");
-    logError() << _errorMessage;
-    return false;
   }
 
   if ((req.type != resp.type) || (req.command != resp.command)) {
@@ -608,28 +550,19 @@ OpenGD77Interface::sendShowCPSScreen() {
   uint8_t resp;
   req.initShowCPSScreen();
 
-  if (sizeof(CommandRequest) != QSerialPort::write((const char *) &req, sizeof(CommandRequest))) {
+  if (sizeof(CommandRequest) != transmit((const char *) &req, sizeof(CommandRequest))) {
     _errorMessage = tr("Cannot write to serial port: %1").arg(USBSerial::errorMessage());
     logError() << _errorMessage;
     return false;
   }
 
-  if (! waitForReadyRead(1000)) {
-    _errorMessage = tr("Cannot read from serial port: Timeout!");
+  if (! receiveExact((char *)&resp, 1, 1000)) {
+    _errorMessage = tr("Cannot read from serial port: %1").arg(USBSerial::errorMessage());
     logError() << _errorMessage;
     return false;
   }
 
-  int retlen = QSerialPort::read((char *)&resp, 1);
-  if (0 > retlen) {
-    _errorMessage = tr("Cannot read from serial port: %1").arg(USBSerial::errorMessage());
-    logError() << _errorMessage;
-    return false;
-  } else if (0 == retlen) {
-    _errorMessage = tr("Cannot send command: Device returned empty message.");
-    logError() << _errorMessage;
-    return false;
-  } else if ('-' != resp) {
+  if ('-' != resp) {
     _errorMessage = tr("Cannot send command: Deviced returned unexpected response '%1'").arg(resp);
     logError() << _errorMessage;
     return false;
@@ -644,29 +577,19 @@ OpenGD77Interface::sendClearScreen() {
   req.initClearScreen();
   uint8_t resp;
 
-  if (sizeof(CommandRequest) != QSerialPort::write((const char *) &req, sizeof(CommandRequest))) {
+  if (sizeof(CommandRequest) != transmit((const char *) &req, sizeof(CommandRequest))) {
     _errorMessage = tr("Cannot write to serial port: %1").arg(USBSerial::errorMessage());
     logError() << _errorMessage;
     return false;
   }
 
-  if (! waitForReadyRead(1000)) {
-    _errorMessage = tr("Cannot read from serial port: Timeout!");
+  if (! receiveExact((char *)&resp, 1, 1000)) {
+    _errorMessage = tr("Cannot read from serial port: %1").arg(USBSerial::errorMessage());
     logError() << _errorMessage;
     return false;
   }
 
-  int retlen = QSerialPort::read((char *)&resp, 1);
-
-  if (0 > retlen) {
-    _errorMessage = tr("Cannot read from serial port: %1").arg(USBSerial::errorMessage());
-    logError() << _errorMessage;
-    return false;
-  } else if (0 == retlen) {
-    _errorMessage = tr("Cannot send command: Device returned empty message.");
-    logError() << _errorMessage;
-    return false;
-  } else if ('-' != resp) {
+  if ('-' != resp) {
     _errorMessage = tr("Cannot send command: Deviced returned unexpected response '%1'").arg(resp);
     logError() << _errorMessage;
     return false;
@@ -681,29 +604,19 @@ OpenGD77Interface::sendDisplay(uint8_t x, uint8_t y, const char *message, uint8_
   req.initDisplay(x,y, message, iSize, alignment, inverted);
   uint8_t resp;
 
-  if (sizeof(CommandRequest) != QSerialPort::write((const char *) &req, sizeof(CommandRequest))) {
+  if (sizeof(CommandRequest) != transmit((const char *) &req, sizeof(CommandRequest))) {
     _errorMessage = tr("Cannot write to serial port: %1").arg(USBSerial::errorMessage());
     logError() << _errorMessage;
     return false;
   }
 
-  if (! waitForReadyRead(1000)) {
-    _errorMessage = tr("Cannot read from serial port: Timeout!");
+  if (! receiveExact((char *)&resp, 1, 1000)) {
+    _errorMessage = tr("Cannot read from serial port: %1").arg(USBSerial::errorMessage());
     logError() << _errorMessage;
     return false;
   }
 
-  int retlen = QSerialPort::read((char *)&resp, 1);
-
-  if (0 > retlen) {
-    _errorMessage = tr("Cannot read from serial port: %1").arg(USBSerial::errorMessage());
-    logError() << _errorMessage;
-    return false;
-  } else if (0 == retlen) {
-    _errorMessage = tr("Cannot send command: Device returned empty message.");
-    logError() << _errorMessage;
-    return false;
-  } else if ('-' != resp) {
+  if ('-' != resp) {
     _errorMessage = tr("Cannot send command: Deviced returned unexpected response '%1'").arg(resp);
     logError() << _errorMessage;
     return false;
@@ -717,30 +630,20 @@ OpenGD77Interface::sendRenderCPS() {
   CommandRequest req;
   req.initRenderCPS();
 
-  if (sizeof(CommandRequest) != QSerialPort::write((const char *) &req, sizeof(CommandRequest))) {
+  if (sizeof(CommandRequest) != transmit((const char *) &req, sizeof(CommandRequest))) {
     _errorMessage = tr("Cannot write to serial port: %1").arg(USBSerial::errorMessage());
     logError() << _errorMessage;
     return false;
   }
 
-  if (! waitForReadyRead(1000)) {
-    _errorMessage = tr("Cannot read from serial port: Timeout!");
-    logError() << _errorMessage;
-    return false;
-  }
-
   uint8_t resp;
-  int retlen = QSerialPort::read((char *)&resp, 1);
-
-  if (0 > retlen) {
+  if (! receiveExact((char *)&resp, 1, 1000)) {
     _errorMessage = tr("Cannot read from serial port: %1").arg(USBSerial::errorMessage());
     logError() << _errorMessage;
     return false;
-  } else if (0 == retlen) {
-    _errorMessage = tr("Cannot send command: Device returned empty message.");
-    logError() << _errorMessage;
-    return false;
-  } else if ('-' != resp) {
+  }
+
+  if ('-' != resp) {
     _errorMessage = tr("Cannot send command: Deviced returned unexpected response '%1'").arg(resp);
     logError() << _errorMessage;
     return false;
@@ -754,29 +657,19 @@ OpenGD77Interface::sendCloseScreen() {
   CommandRequest req; req.initCloseScreen();
   uint8_t resp;
 
-  if (sizeof(CommandRequest) != QSerialPort::write((const char *) &req, sizeof(CommandRequest))) {
+  if (sizeof(CommandRequest) != transmit((const char *) &req, sizeof(CommandRequest))) {
     _errorMessage = tr("Cannot write to serial port: %1").arg(USBSerial::errorMessage());
     logError() << _errorMessage;
     return false;
   }
 
-  if (! waitForReadyRead(1000)) {
-    _errorMessage = tr("Cannot read from serial port: Timeout!");
+  if (! receiveExact((char *)&resp, 1, 1000)) {
+    _errorMessage = tr("Cannot read from serial port: %1").arg(USBSerial::errorMessage());
     logError() << _errorMessage;
     return false;
   }
 
-  int retlen = QSerialPort::read((char *)&resp, 1);
-
-  if (0 > retlen) {
-    _errorMessage = tr("Cannot read from serial port: %1").arg(USBSerial::errorMessage());
-    logError() << _errorMessage;
-    return false;
-  } else if (0 == retlen) {
-    _errorMessage = tr("Cannot send command: Device returned empty message.");
-    logError() << _errorMessage;
-    return false;
-  } else if ('-' != resp) {
+  if ('-' != resp) {
     _errorMessage = tr("Cannot send command: Deviced returned unexpected response '%1'").arg(resp);
     logError() << _errorMessage;
     return false;
@@ -790,29 +683,19 @@ OpenGD77Interface::sendCommand(CommandRequest::Option option) {
   CommandRequest req; req.initCommand(option);
   uint8_t resp;
 
-  if (sizeof(CommandRequest) != QSerialPort::write((const char *) &req, sizeof(CommandRequest))) {
+  if (sizeof(CommandRequest) != transmit((const char *) &req, sizeof(CommandRequest))) {
     _errorMessage = tr("Cannot write to serial port: %1").arg(USBSerial::errorMessage());
     logError() << _errorMessage;
     return false;
   }
 
-  if (! waitForReadyRead(1000)) {
-    _errorMessage = tr("Cannot read from serial port: Timeout!");
+  if (! receiveExact((char *)&resp, 1, 1000)) {
+    _errorMessage = tr("Cannot read from serial port: %1").arg(USBSerial::errorMessage());
     logError() << _errorMessage;
     return false;
   }
 
-  int retlen = QSerialPort::read((char *)&resp, 1);
-
-  if (0 > retlen) {
-    _errorMessage = tr("Cannot read from serial port: %1").arg(USBSerial::errorMessage());
-    logError() << _errorMessage;
-    return false;
-  } else if (0 == retlen) {
-    _errorMessage = tr("Cannot send command: Device returned empty message.");
-    logError() << _errorMessage;
-    return false;
-  } else if ('-' != resp) {
+  if ('-' != resp) {
     _errorMessage = tr("Cannot send command: Deviced returned unexpected response '%1'").arg(resp);
     logError() << _errorMessage;
     return false;
@@ -1,4 +1,5 @@
 #include "radio.hh"
+#include "radiointerface.hh"
 #include "hid_interface.hh"
 #include "dfu_libusb.hh"
 #include "rd5r.hh"
@@ -8,283 +9,53 @@
 #include "d878uv.hh"
 #include "config.hh"
 #include "logger.hh"
-#include <QSet>
+#include "configverifier.hh"
+#include <string.h>
+
+
+/* ******************************************************************************************** *
+ * Implementation of VerifyIssue
+ * ******************************************************************************************** */
+QString
+VerifyIssue::message() const {
+  if (! _args.isEmpty()) {
+    foreach (const QVariant &arg, _args)
+      _message = _message.arg(arg.toString());
+    _args.clear();
+  }
+  return _message;
+}
 
 
 /* ******************************************************************************************** *
  * Implementation of Radio
  * ******************************************************************************************** */
 Radio::Radio(QObject *parent)
-  : QThread(parent), _task(StatusIdle)
+  : QThread(parent), _task(StatusIdle), _errorMessage(), _cancel(0), _snapshot(), _progress(),
+    _verifier(nullptr)
 {
-  // pass...
+  // These signals get emitted within the transfer thread. The direct connections reset and
+  // finish the progress in order, before any queued connection of the consumer gets notified.
+  connect(this, SIGNAL(downloadStarted()), this, SLOT(onDownloadStarted()), Qt::DirectConnection);
+  connect(this, SIGNAL(uploadStarted()), this, SLOT(onUploadStarted()), Qt::DirectConnection);
+  connect(this, SIGNAL(downloadFinished(Radio*,CodePlug*)), this, SLOT(onTransferDone()),
+          Qt::DirectConnection);
+  connect(this, SIGNAL(downloadError(Radio*)), this, SLOT(onTransferDone()),
+          Qt::DirectConnection);
+  connect(this, SIGNAL(uploadComplete(Radio*)), this, SLOT(onTransferDone()),
+          Qt::DirectConnection);
+  connect(this, SIGNAL(uploadError(Radio*)), this, SLOT(onTransferDone()), Qt::DirectConnection);
+  connect(&_progress, SIGNAL(sampled(TransferProgress::Sample)),
+          this, SLOT(onProgressSampled(TransferProgress::Sample)));
 }
 
 VerifyIssue::Type
 Radio::verifyConfig(Config *config, QList<VerifyIssue> &issues)
 {
-  // Is still beta?
-  if (features().betaWarning)
-    issues.append(VerifyIssue(
-                    VerifyIssue::WARNING,
-                    tr("Support for this radio is still new and not well tested. "
-                       "The code-plug might be incomplete, non-functional or even harmful.")));
-
-  /*
-   *  Check general config
-   */
-  if (config->name().size() > features().maxNameLength)
-    issues.append(VerifyIssue(
-                    VerifyIssue::WARNING,
-                    tr("Radio name of length %1 exceeds limit of %2 characters.")
-                    .arg(config->name().size()).arg(features().maxNameLength)));
-
-  if (config->introLine1().size() > features().maxIntroLineLength)
-    issues.append(VerifyIssue(
-                    VerifyIssue::WARNING,
-                    tr("Intro line 1 of length %1 exceeds limit of %2 characters.")
-                    .arg(config->introLine1().size()).arg(features().maxNameLength)));
-
-  if (config->introLine2().size() > features().maxIntroLineLength)
-    issues.append(VerifyIssue(
-                    VerifyIssue::WARNING,
-                    tr("Intro line 2 of length %1 exceeds limit of %2 characters.")
-                    .arg(config->introLine2().size()).arg(features().maxNameLength)));
-
-  /*
-   *  Check contact list
-   */
-  if (config->contacts()->count() > features().maxContacts)
-    issues.append(VerifyIssue(
-                    VerifyIssue::ERROR,
-                    tr("Number of contacts %1 exceeds limit of %2.")
-                    .arg(config->contacts()->count()).arg(features().maxContacts)));
-
-  for (int i=0; i<config->contacts()->count(); i++) {
-    QSet<QString> names;
-    Contact *contact = config->contacts()->contact(i);
-
-    if (names.contains(contact->name()))
-      issues.append(VerifyIssue(
-                      VerifyIssue::WARNING,
-                      tr("Duplicate contact name '%1'.").arg(contact->name())));
-    names.insert(contact->name());
-
-    if (contact->name().size() > features().maxContactNameLength)
-      issues.append(VerifyIssue(
-                      VerifyIssue::WARNING,
-                      tr("Contact name '%1' length %2 exceeds limit of %3 characters.")
-                      .arg(contact->name()).arg(contact->name().size()).arg(features().maxContactNameLength)));
-
-    if (contact->is<DigitalContact>() && (! features().hasDigital))
-      issues.append(VerifyIssue(
-                      VerifyIssue::ERROR,
-                      tr("Radio does not support digital contact '%1'")
-                      .arg(contact->name())));
-
-    if (contact->is<DTMFContact>() && (! features().hasAnalog))
-      issues.append(VerifyIssue(
-                      VerifyIssue::ERROR,
-                      tr("Radio does not support DTMF contact '%1'")
-                      .arg(contact->name())));
-  }
-
-  /*
-   *  Check RX group lists.
-   */
-  if (config->rxGroupLists()->count() > features().maxGrouplists)
-    issues.append(VerifyIssue(
-                    VerifyIssue::ERROR,
-                    tr("Number of Rx group lists %1 exceeds limit of %2")
-                    .arg(config->rxGroupLists()->count()).arg(features().maxGrouplists)));
-
-  for (int i=0; i<config->rxGroupLists()->count(); i++) {
-    QSet<QString> names;
-    RXGroupList *list = config->rxGroupLists()->list(i);
-
-    if (names.contains(list->name()))
-      issues.append(VerifyIssue(
-                      VerifyIssue::WARNING,
-                      tr("Duplicate Rx group list name '%1'.").arg(list->name())));
-    names.insert(list->name());
-
-    if (list->name().size() > features().maxGrouplistNameLength)
-      issues.append(VerifyIssue(
-                      VerifyIssue::WARNING,
-                      tr("Group list name '%1' of length %2 exceeds limit of %2 characters.")
-                      .arg(list->name()).arg(list->name().size()).arg(features().maxGrouplistNameLength)));
-
-    if (list->count() > features().maxContactsInGrouplist)
-      issues.append(VerifyIssue(
-                      VerifyIssue::ERROR,
-                      tr("Number of contacts (%2) in group list '%1' exceeds limit %3.")
-                      .arg(list->name()).arg(list->count()).arg(features().maxContactsInGrouplist)));
-  }
-
-  /*
-   * Check channel list
-   */
-  if (config->channelList()->count() > features().maxChannels)
-      issues.append(VerifyIssue(
-                      VerifyIssue::ERROR,
-                      tr("Number of channels %1 exceeds limit %2.")
-                      .arg(config->channelList()->count()).arg(features().maxChannels)));
-
-  for (int i=0; i<config->channelList()->count(); i++) {
-    QSet<QString> names;
-    Channel *channel = config->channelList()->channel(i);
-
-    if (names.contains(channel->name()))
-      issues.append(VerifyIssue(
-                      VerifyIssue::WARNING,
-                      tr("Duplicate channel name '%1'.").arg(channel->name())));
-    names.insert(channel->name());
-
-    if (channel->name().size() > features().maxChannelNameLength)
-      issues.append(VerifyIssue(
-                      VerifyIssue::WARNING,
-                      tr("Channel name '%1' length %2 exceeds limit of %3 characters.")
-                      .arg(channel->name()).arg(channel->name().length()).arg(features().maxChannelNameLength)));
-
-    if (channel->is<DigitalChannel>() && (! features().hasDigital))
-      issues.append(VerifyIssue(
-                      VerifyIssue::ERROR,
-                      tr("Radio does not support digital channel'%1'")
-                      .arg(channel->name())));
-
-    if (channel->is<AnalogChannel>() && (! features().hasAnalog))
-      issues.append(VerifyIssue(
-                      VerifyIssue::ERROR,
-                      tr("Radio does not support analog channel'%1'")
-                      .arg(channel->name())));
-
-    if (channel->is<DigitalChannel>() && (nullptr == channel->as<DigitalChannel>()->txContact())
-        && (! features().allowChannelNoDefaultContact))
-      issues.append(VerifyIssue(
-                      VerifyIssue::WARNING,
-                      tr("Radio requires TX contact for channel '%1'!")
-                      .arg(channel->name())));
-  }
-
-  /*
-   * Check zone list
-   */
-  if (config->zones()->count() > features().maxZones)
-    issues.append(VerifyIssue(
-                    VerifyIssue::ERROR,
-                    tr("Number of zones %1 exceeds limit %2")
-                    .arg(config->zones()->count()).arg(features().maxZones)));
-
-  for (int i=0; i<config->zones()->count(); i++) {
-    QSet<QString> names;
-    Zone *zone = config->zones()->zone(i);
-
-    if (names.contains(zone->name()))
-      issues.append(VerifyIssue(
-                      VerifyIssue::WARNING,
-                      tr("Duplicate zone name '%1'.").arg(zone->name())));
-    names.insert(zone->name());
-
-    if (zone->name().size()>features().maxZoneNameLength)
-      issues.append(VerifyIssue(
-                      VerifyIssue::WARNING,
-                      tr("Zone name '%1' length %2 exceeds limit of %3 characters.")
-                      .arg(zone->name()).arg(zone->name().size()).arg(features().maxZoneNameLength)));
-
-    if (zone->A()->count() > features().maxChannelsInZone)
-      issues.append(VerifyIssue(
-                      VerifyIssue::ERROR,
-                      tr("Number of channels %2 in zone '%1' A exceeds limit %3.")
-                      .arg(zone->name()).arg(zone->A()->count()).arg(features().maxChannelsInZone)));
-
-    if (zone->B()->count() > features().maxChannelsInZone)
-      issues.append(VerifyIssue(
-                      VerifyIssue::ERROR,
-                      tr("Number of channels %2 in zone '%1' B exceeds limit %3.")
-                      .arg(zone->name()).arg(zone->A()->count()).arg(features().maxChannelsInZone)));
-
-    if ((0 < zone->B()->count()) && (! features().hasABZone))
-      issues.append(VerifyIssue(
-                      VerifyIssue::NOTIFICATION,
-                      tr("Radio does not support dual-zones. Zone '%1' will be split into two.")
-                      .arg(zone->name())));
-
-  }
-
-  /*
-   * Check scan lists
-   */
-  if (features().hasScanlists) {
-    if (config->scanlists()->count() > features().maxScanlists)
-      issues.append(VerifyIssue(
-                      VerifyIssue::ERROR,
-                      tr("Number of scanlists %1 exceeds limit %2")
-                      .arg(config->scanlists()->count()).arg(features().maxScanlists)));
-
-    for (int i=0; i<config->scanlists()->count(); i++) {
-      QSet<QString> names;
-      ScanList *list = config->scanlists()->scanlist(i);
-
-      if (names.contains(list->name()))
-        issues.append(VerifyIssue(
-                        VerifyIssue::WARNING,
-                        tr("Duplicate scan list name '%1'.").arg(list->name())));
-      names.insert(list->name());
-
-      if (list->name().size() > features().maxScanlistNameLength)
-        issues.append(VerifyIssue(
-                        VerifyIssue::WARNING,
-                        tr("Scan list name '%1' length %2 exceeds limit of %3 characters.")
-                        .arg(list->name()).arg(list->name().size()).arg(features().maxScanlistNameLength)));
-
-      if (0 == list->priorityChannel())
-        issues.append(VerifyIssue(
-                        VerifyIssue::WARNING,
-                        tr("Scan list '%1' has no priority channel set.")
-                        .arg(list->name())));
-
-      else if (! list->contains(list->priorityChannel()))
-        issues.append(VerifyIssue(
-                        VerifyIssue::WARNING,
-                        tr("Scan list '%1' does not contain priority channel '%2'.")
-                        .arg(list->name()).arg(list->priorityChannel()->name())));
-    }
-  }
-
-  /*
-   * Check roaming zones and channels
-   */
-  if (features().hasRoaming) {
-    // Check total numer of unique roaming channels
-    QSet<DigitalChannel *> roamingChannels; config->roaming()->uniqueChannels(roamingChannels);
-    if (roamingChannels.size() > features().maxRoamingChannels)
-      issues.append(VerifyIssue(
-                      VerifyIssue::ERROR,
-                      tr("Total number of roaming channels %1 exceeds limit %2")
-                      .arg(roamingChannels.size()).arg(features().maxRoamingChannels)));
-    // Check number of roaming zones
-    if (config->roaming()->count() > features().maxRoamingZones)
-      issues.append(VerifyIssue(
-                      VerifyIssue::ERROR,
-                      tr("Number of roaming zones %1 exceeds limit %2")
-                      .arg(config->roaming()->count()).arg(features().maxRoamingZones)));
-    for (int i=0; i<config->roaming()->count(); i++) {
-      RoamingZone *zone = config->roaming()->zone(i);
-      if (zone->count() > features().maxChannelsInRoamingZone)
-        issues.append(VerifyIssue(
-                        VerifyIssue::WARNING,
-                        tr("Number of channels (%1) in roaming zone '%2' exceeds limit %3")
-                        .arg(roamingChannels.size()).arg(zone->name()).arg(features().maxRoamingChannels)));
-    }
-  }
-
-  // Get max issue severity
-  VerifyIssue::Type maxType = VerifyIssue::NONE;
-  foreach (VerifyIssue issue, issues) {
-    if (issue.type() > maxType)
-      maxType = issue.type();
-  }
-  return maxType;
+  // Features are constant, hence the verifier and its cache can be kept
+  if (nullptr == _verifier)
+    _verifier = new ConfigVerifier(features(), this);
+  return _verifier->verify(config, issues);
 }
 
 
@@ -372,8 +143,122 @@ Radio::errorMessage() const {
 
 void
 Radio::clearError() {
+  _cancel.storeRelease(0);
   if (StatusError == _task) {
     _task = StatusIdle;
     _errorMessage.clear();
   }
 }
+
+void
+Radio::cancel() {
+  _cancel.storeRelease(1);
+}
+
+bool
+Radio::cancelRequested() const {
+  return 0 != _cancel.loadAcquire();
+}
+
+const TransferProgress &
+Radio::progress() const {
+  return _progress;
+}
+
+void
+Radio::setProgress(int percent, qint64 bytes) {
+  _progress.update(percent, bytes);
+}
+
+void
+Radio::onDownloadStarted() {
+  _progress.start(TransferProgress::Download);
+}
+
+void
+Radio::onUploadStarted() {
+  _progress.start(TransferProgress::Upload);
+}
+
+void
+Radio::onTransferDone() {
+  _progress.finish();
+}
+
+void
+Radio::onProgressSampled(const TransferProgress::Sample &sample) {
+  if (TransferProgress::Download == sample.phase)
+    emit downloadProgress(sample.percent);
+  else if (TransferProgress::Upload == sample.phase)
+    emit uploadProgress(sample.percent);
+}
+
+QString
+Radio::transferError(const RadioInterface *dev) const {
+  if (cancelRequested())
+    return tr("Operation cancelled.");
+  return dev->errorMessage();
+}
+
+bool
+Radio::isOnDevice(RadioInterface *dev, uint32_t bank, uint32_t addr, const QByteArray &data,
+                  uint blockSize)
+{
+  if ((0 == blockSize) || data.isEmpty() || (data.size() % blockSize))
+    return false;
+
+  QVector<uint> offsets; offsets.append(0);
+  if (uint(data.size()) > blockSize)
+    offsets.append(data.size()-blockSize);
+
+  if (! dev->read_start(bank, addr))
+    return false;
+  QByteArray buffer(blockSize, 0);
+  bool ok = true;
+  foreach (uint offset, offsets) {
+    ok = dev->read(bank, addr+offset, (uint8_t *)buffer.data(), blockSize)
+        && (0 == memcmp(buffer.constData(), data.constData()+offset, blockSize));
+    if (! ok)
+      break;
+  }
+  dev->read_finish();
+  return ok;
+}
+
+bool
+Radio::takeSnapshot(const Config *config) {
+  if (nullptr == config)
+    return false;
+  _snapshot = config->snapshot();
+  return ! _snapshot.isEmpty();
+}
+
+Config *
+Radio::loadSnapshot() {
+  QString errorMessage;
+  Config *config = Config::fromSnapshot(_snapshot, errorMessage);
+  if (nullptr == config) {
+    _errorMessage = tr("Cannot load config snapshot: %1").arg(errorMessage);
+    logError() << _errorMessage;
+  }
+  return config;
+}
+
+Radio::SnapshotGuard::SnapshotGuard(Radio *radio, Config *&config)
+  : _copy(radio->loadSnapshot()), _config(config)
+{
+  _config = _copy.data();
+  if (_copy.isNull()) {
+    radio->_task = StatusError;
+    emit radio->uploadError(radio);
+  }
+}
+
+Radio::SnapshotGuard::~SnapshotGuard() {
+  _config = nullptr;
+}
+
+bool
+Radio::SnapshotGuard::isNull() const {
+  return _copy.isNull();
+}
@@ -9,10 +9,16 @@
 #define RADIO_HH
 
 #include <QThread>
+#include <QVariantList>
+#include <QAtomicInt>
+#include <QScopedPointer>
 #include "codeplug.hh"
+#include "transferprogress.hh"
 
 class Config;
 class UserDatabase;
+class RadioInterface;
+class ConfigVerifier;
 
 
 /** Simple container class to collect codeplug verification issues.
@@ -35,18 +41,30 @@ public:
 public:
   /** Constructor from @c type and @c message. */
 	inline VerifyIssue(Type type, const QString &message)
-	    : _type(type), _message(message) { }
+	    : _type(type), _object(nullptr), _message(message), _args() { }
+  /** Constructor from @c type, the related @c object, a @c format string and its arguments.
+   * The message gets only assembled when requested by @c message. */
+	inline VerifyIssue(Type type, const QObject *object, const QString &format,
+	                   const QVariantList &args)
+	    : _type(type), _object(object), _message(format), _args(args) { }
 
   /** Returns the verification issue type. */
 	inline Type type() const { return _type; }
+  /** Returns the object, the issue is related to or @c nullptr if it relates to the complete
+   * configuration. */
+	inline const QObject *object() const { return _object; }
   /** Returns the verification issue message. */
-	inline const QString & message() const { return _message; }
+	QString message() const;
 
 protected:
   /** The issue type. */
 	Type _type;
-  /** The issue message. */
-	QString _message;
+  /** The object, the issue relates to. */
+	const QObject *_object;
+  /** The issue message or format string. */
+	mutable QString _message;
+  /** The arguments of the format string, empty if the message is formatted. */
+	mutable QVariantList _args;
 };
 
 
@@ -168,7 +186,9 @@ public:
   virtual CodePlug &codeplug() = 0;
 
   /** Verifies the configuration against the radio features.
-   * On exit, @c issues will contain the issues found and the maximum severity is returned. */
+   * On exit, @c issues will contain the issues found and the maximum severity is returned. The
+   * verifier is kept with the radio, hence repeated verifications of the same configuration
+   * only re-verify the modified objects. */
   VerifyIssue::Type verifyConfig(Config *config, QList<VerifyIssue> &issues);
 
   /** Returns the current status. */
@@ -176,9 +196,20 @@ public:
 
   /** Returns the last error message. */
   const QString &errorMessage() const;
-  /** Clears the last error message and state. */
+  /** Clears the last error message and state as well as a pending cancellation. */
   void clearError();
 
+  /** Requests the cancellation of the running up- or download. The request is checked between the
+   * transfers of single blocks. A cancelled operation fails like any other failed transfer. The
+   * request gets cleared by @c clearError. This method is thread-safe. */
+  void cancel();
+  /** Returns @c true if the cancellation of the running operation was requested. */
+  bool cancelRequested() const;
+
+  /** Returns the rate-limited progress of the running transfer, including the number of bytes
+   * transferred and the estimated remaining time. */
+  const TransferProgress &progress() const;
+
 public:
   /** Detects a radio and returns the corresponding device specific radio instance. */
   static Radio *detect(QString &errorMessage, const QString &force="");
@@ -198,7 +229,8 @@ public slots:
 signals:
   /** Gets emitted once the codeplug download has been started. */
 	void downloadStarted();
-  /** Gets emitted on download progress (e.g., for progress bars). */
+  /** Gets emitted on download progress (e.g., for progress bars). Gets emitted within the thread
+   * of the radio object at most at @c TransferProgress::DEFAULT_RATE. */
 	void downloadProgress(int percent);
   /** Gets emitted once the codeplug download has been finished. */
   void downloadFinished(Radio *radio, CodePlug *codeplug);
@@ -207,18 +239,83 @@ signals:
 
   /** Gets emitted once the codeplug upload has been started. */
 	void uploadStarted();
-  /** Gets emitted on upload progress (e.g., for progress bars). */
+  /** Gets emitted on upload progress (e.g., for progress bars). Gets emitted within the thread
+   * of the radio object at most at @c TransferProgress::DEFAULT_RATE. */
 	void uploadProgress(int percent);
   /** Gets emitted if there was an error during the upload. */
 	void uploadError(Radio *radio);
   /** Gets emitted once the codeplug upload has been completed successfully. */
 	void uploadComplete(Radio *radio);
 
+protected slots:
+  /** Gets called within the transfer thread once a download has been started. */
+  void onDownloadStarted();
+  /** Gets called within the transfer thread once an upload has been started. */
+  void onUploadStarted();
+  /** Gets called within the transfer thread once a transfer completed or failed. */
+  void onTransferDone();
+  /** Gets called at the sample rate of the progress, emits @c downloadProgress or
+   * @c uploadProgress. */
+  void onProgressSampled(const TransferProgress::Sample &sample);
+
+protected:
+  /** Reports the progress of the running transfer in percent and the number of bytes
+   * transferred since the last report. The progress is sampled at a fixed rate, hence this method
+   * may be called for every block transferred. */
+  void setProgress(int percent, qint64 bytes=0);
+
+  /** Returns the error message of the given interface or a notice, that the operation was
+   * cancelled. */
+  QString transferError(const RadioInterface *dev) const;
+
+  /** Returns @c true if the given data is still present on the device at the specified bank and
+   * address. Only the first and last block of @c blockSize bytes are read back and compared. That
+   * is enough to detect content written by another device or application. */
+  bool isOnDevice(RadioInterface *dev, uint32_t bank, uint32_t addr, const QByteArray &data,
+                  uint blockSize);
+
+  /** Takes a snapshot of the given configuration to upload. Gets called by @c startUpload within
+   * the calling thread. */
+  bool takeSnapshot(const Config *config);
+  /** Creates a private copy of the configuration to upload from the snapshot. Gets called within
+   * the radio thread, hence the original configuration may be edited during the upload. Returns
+   * @c nullptr on error. */
+  Config *loadSnapshot();
+
+  /** Holds the private copy of the configuration during an upload, see @c loadSnapshot.
+   * The given pointer refers to the copy while the guard exists and gets reset once it gets
+   * destroyed, i.e., on every return from the upload. If the copy cannot be created, the radio
+   * is put into the error state and @c uploadError gets emitted. */
+  class SnapshotGuard
+  {
+  public:
+    /** Loads the snapshot of @c radio and points @c config to the copy. */
+    SnapshotGuard(Radio *radio, Config *&config);
+    /** Resets the pointer and deletes the copy. */
+    ~SnapshotGuard();
+    /** Returns @c true if the copy could not be created. */
+    bool isNull() const;
+
+  protected:
+    /** The private copy. */
+    QScopedPointer<Config> _copy;
+    /** The pointer to the copy. */
+    Config *&_config;
+  };
+
 protected:
   /** The current state/task. */
   Status _task;
   /** Holds the last error message. */
   QString _errorMessage;
+  /** Non-zero if the cancellation of the running operation was requested. */
+  QAtomicInt _cancel;
+  /** Snapshot of the configuration to upload. */
+  QByteArray _snapshot;
+  /** The progress of the running transfer. */
+  TransferProgress _progress;
+  /** The verifier of configurations, gets created with the first verification. */
+  ConfigVerifier *_verifier;
 };
 
 #endif // RADIO_HH
@@ -9,6 +9,19 @@ RadioInterface::~RadioInterface() {
   // pass...
 }
 
+QString
+RadioInterface::serialNumber() {
+  return QString();
+}
+
+QString
+RadioInterface::identity() {
+  QString serial = serialNumber();
+  if (serial.isEmpty())
+    return QString();
+  return identifier() + " " + serial;
+}
+
 bool
 RadioInterface::read_finish() {
   return true;
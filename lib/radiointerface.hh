@@ -32,6 +32,13 @@ public:
 
   /** Returns a device identifier. */
 	virtual QString identifier() = 0;
+  /** Returns the serial number of the device or an empty string, if the device does not report
+   * one. By default, an empty string is returned. */
+  virtual QString serialNumber();
+  /** Returns a string that distinguishes this device from other devices of the same model. That
+   * is, the identifier together with the serial number. If the device does not report a serial
+   * number, an empty string is returned as the device cannot be told apart from others. */
+  QString identity();
 
   /** Starts the write process into the specified bank and at the given address.
    * @param bank Specifies the memory bank to write to. Usually there is only one bank. Some radios,
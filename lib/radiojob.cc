@@ -0,0 +1,316 @@
+#include "radiojob.hh"
+#include "radio.hh"
+#include "logger.hh"
+#include <QEventLoop>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QMutex>
+
+
+/// @cond with_internal_docs
+/** The job resets the pointer on destruction, hence a function still running reports its result
+ * only to a living job. */
+class RadioJob::CallGuard
+{
+public:
+  /** Guards the job pointer. */
+  QMutex mutex;
+  /** The job or @c nullptr if it has been destroyed. */
+  RadioJob *job;
+};
+
+/** Runs the function of a job within the thread pool. */
+class RadioJobCall: public QRunnable
+{
+public:
+  /** Constructor. */
+  RadioJobCall(const QSharedPointer<RadioJob::CallGuard> &guard, const RadioJob::Function &function)
+    : QRunnable(), _guard(guard), _function(function)
+  {
+    // pass...
+  }
+
+  void run() {
+    QString errorMessage;
+    bool ok = _function(errorMessage);
+    // Completes the job within its own thread
+    QMutexLocker lock(&_guard->mutex);
+    if (_guard->job)
+      QMetaObject::invokeMethod(_guard->job, "onCallDone", Qt::QueuedConnection,
+                                Q_ARG(bool, ok), Q_ARG(QString, errorMessage));
+  }
+
+protected:
+  /** Shared with the job. */
+  QSharedPointer<RadioJob::CallGuard> _guard;
+  /** The function to call. */
+  RadioJob::Function _function;
+};
+/// @endcond
+
+
+/* ********************************************************************************************* *
+ * Implementation of RadioJob
+ * ********************************************************************************************* */
+RadioJob::RadioJob(Kind kind, const QString &name, Radio *radio, QObject *parent)
+  : QObject(parent), _kind(kind), _name(name), _state(Pending), _radio(radio), _config(nullptr),
+    _flags(), _userDB(nullptr), _function(), _guard(), _progress(0), _errorMessage(), _elapsed(),
+    _timeout(0), _watchdog(), _timedOut(false), _cancelled(false), _next(nullptr)
+{
+  _watchdog.setSingleShot(true);
+  connect(&_watchdog, SIGNAL(timeout()), this, SLOT(onTimeout()));
+}
+
+RadioJob::~RadioJob() {
+  if (_guard.isNull())
+    return;
+  QMutexLocker lock(&_guard->mutex);
+  _guard->job = nullptr;
+}
+
+RadioJob *
+RadioJob::download(Radio *radio, QObject *parent) {
+  return new RadioJob(Download, tr("Download codeplug"), radio, parent);
+}
+
+RadioJob *
+RadioJob::upload(Radio *radio, Config *config, const CodePlug::Flags &flags, QObject *parent) {
+  RadioJob *job = new RadioJob(Upload, tr("Upload codeplug"), radio, parent);
+  job->_config = config;
+  job->_flags = flags;
+  return job;
+}
+
+RadioJob *
+RadioJob::uploadCallsignDB(Radio *radio, UserDatabase *db, QObject *parent) {
+  RadioJob *job = new RadioJob(UploadCallsigns, tr("Upload call-sign DB"), radio, parent);
+  job->_userDB = db;
+  return job;
+}
+
+RadioJob *
+RadioJob::call(const QString &name, const Function &function, QObject *parent) {
+  RadioJob *job = new RadioJob(Call, name, nullptr, parent);
+  job->_function = function;
+  return job;
+}
+
+const QString &
+RadioJob::name() const {
+  return _name;
+}
+
+RadioJob::State
+RadioJob::state() const {
+  return _state;
+}
+
+bool
+RadioJob::isDone() const {
+  return (Finished == _state) || (Failed == _state) || (Cancelled == _state);
+}
+
+const QString &
+RadioJob::errorMessage() const {
+  return _errorMessage;
+}
+
+int
+RadioJob::progress() const {
+  return _progress;
+}
+
+qint64
+RadioJob::elapsed() const {
+  if (! _elapsed.isValid())
+    return 0;
+  return _elapsed.elapsed();
+}
+
+void
+RadioJob::setTimeout(int ms) {
+  _timeout = ms;
+  if (Running != _state)
+    return;
+  if (0 < _timeout)
+    _watchdog.start(_timeout);
+  else
+    _watchdog.stop();
+}
+
+RadioJob *
+RadioJob::then(RadioJob *next) {
+  _next = next;
+  if (nullptr == next->parent())
+    next->setParent(this);
+  // If this job is already done, pass the result on
+  if (Finished == _state)
+    next->start();
+  else if (isDone())
+    next->cancel();
+  return next;
+}
+
+bool
+RadioJob::wait() {
+  if (! isDone()) {
+    QEventLoop loop;
+    connect(this, SIGNAL(finished(RadioJob*)), &loop, SLOT(quit()));
+    loop.exec();
+  }
+  return Finished == _state;
+}
+
+void
+RadioJob::start() {
+  if (Pending != _state)
+    return;
+
+  _state = Running;
+  _elapsed.start();
+  if (0 < _timeout)
+    _watchdog.start(_timeout);
+  emit started(this);
+
+  QString msg;
+  if (! run(msg))
+    complete(Failed, msg);
+}
+
+bool
+RadioJob::run(QString &errorMessage) {
+  if (Call == _kind) {
+    _guard = QSharedPointer<CallGuard>(new CallGuard());
+    _guard->job = this;
+    QThreadPool::globalInstance()->start(new RadioJobCall(_guard, _function));
+    return true;
+  }
+
+  // Connect to the radio, signals get emitted from within the radio thread
+  _radio->clearError();
+  if (Download == _kind) {
+    connect(_radio, SIGNAL(downloadProgress(int)), this, SLOT(onProgress(int)));
+    connect(_radio, SIGNAL(downloadFinished(Radio*,CodePlug*)), this, SLOT(onRadioDone()));
+  } else {
+    connect(_radio, SIGNAL(uploadProgress(int)), this, SLOT(onProgress(int)));
+    connect(_radio, SIGNAL(uploadComplete(Radio*)), this, SLOT(onRadioDone()));
+  }
+  // Some radios report errors during the upload as download errors
+  connect(_radio, SIGNAL(downloadError(Radio*)), this, SLOT(onRadioError()));
+  connect(_radio, SIGNAL(uploadError(Radio*)), this, SLOT(onRadioError()));
+
+  bool ok = false;
+  switch (_kind) {
+  case Download: ok = _radio->startDownload(false); break;
+  case Upload: ok = _radio->startUpload(_config, false, _flags); break;
+  case UploadCallsigns: ok = _radio->startUploadCallsignDB(_userDB, false); break;
+  case Call: break;
+  }
+
+  if (! ok) {
+    disconnect(_radio, nullptr, this, nullptr);
+    errorMessage = _radio->errorMessage();
+    if (errorMessage.isEmpty())
+      errorMessage = tr("Cannot start '%1'.").arg(_name);
+  }
+  return ok;
+}
+
+void
+RadioJob::cancel() {
+  if (Pending == _state) {
+    complete(Cancelled, tr("'%1' cancelled.").arg(_name));
+  } else if (Running == _state) {
+    // The radio fails at the next block, see onRadioError(). A function gets cancelled once it
+    // returned, see onCallDone().
+    _cancelled = true;
+    if (_radio)
+      _radio->cancel();
+  }
+}
+
+void
+RadioJob::onProgress(int percent) {
+  if (Running != _state)
+    return;
+
+  _progress = percent;
+  if (0 < _timeout)
+    _watchdog.start(_timeout);
+
+  qint64 elapsed = this->elapsed(), remaining = -1;
+  if (0 < percent)
+    remaining = (elapsed*(100-percent))/percent;
+  emit progressChanged(percent);
+  emit telemetry(percent, elapsed, remaining);
+}
+
+void
+RadioJob::onRadioDone() {
+  if (Running != _state)
+    return;
+  // A cancel request arriving after the last block is void
+  _radio->clearError();
+  complete(Finished);
+}
+
+void
+RadioJob::onRadioError() {
+  if (Running != _state)
+    return;
+
+  QString msg = _radio->errorMessage();
+  _radio->clearError();
+  if (_timedOut)
+    complete(Failed, tr("'%1' timed out after %2 ms without progress.").arg(_name).arg(_timeout));
+  else if (_cancelled)
+    complete(Cancelled, tr("'%1' cancelled.").arg(_name));
+  else
+    complete(Failed, msg);
+}
+
+void
+RadioJob::onTimeout() {
+  if (Running != _state)
+    return;
+  logWarn() << "'" << _name << "' made no progress for " << _timeout << "ms: Cancel.";
+  _timedOut = true;
+  _cancelled = true;
+  if (_radio)
+    _radio->cancel();
+}
+
+void
+RadioJob::onCallDone(bool ok, const QString &errorMessage) {
+  if (Running != _state)
+    return;
+
+  if (_timedOut)
+    complete(Failed, tr("'%1' timed out after %2 ms.").arg(_name).arg(_timeout));
+  else if (_cancelled)
+    complete(Cancelled, tr("'%1' cancelled.").arg(_name));
+  else if (ok)
+    complete(Finished);
+  else
+    complete(Failed, errorMessage);
+}
+
+void
+RadioJob::complete(State state, const QString &errorMessage) {
+  _state = state;
+  _errorMessage = errorMessage;
+  _watchdog.stop();
+  if (_radio)
+    disconnect(_radio, nullptr, this, nullptr);
+  if (Finished == _state)
+    _progress = 100;
+
+  emit finished(this);
+
+  if (nullptr == _next)
+    return;
+  if (Finished == _state)
+    _next->start();
+  else
+    _next->cancel();
+}
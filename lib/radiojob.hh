@@ -0,0 +1,184 @@
+#ifndef RADIOJOB_HH
+#define RADIOJOB_HH
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QSharedPointer>
+#include <functional>
+#include "codeplug.hh"
+
+class Radio;
+class Config;
+class UserDatabase;
+
+/** Handle of an asynchronous operation on a radio.
+ *
+ * A job wraps one of the transfers of a @c Radio (codeplug download, codeplug upload or call-sign
+ * DB upload) or an arbitrary function (e.g., decoding or encoding a codeplug). Functions are run
+ * within the global thread pool. Jobs get created
+ * using the static factory methods and run in the background once started. The caller gets
+ * notified about the progress via @c progress and @c telemetry and about the result via
+ * @c finished. A running transfer can be cancelled at any time, the cancellation is checked
+ * between the transfers of single blocks.
+ *
+ * Jobs can be chained using @c then. The next job gets started once the previous one finished
+ * successfully and gets cancelled if the previous one failed. For example:
+ * @code
+ * RadioJob *job = RadioJob::download(radio);
+ * job->then(RadioJob::call(tr("Decode"), [&](QString &msg) { ... }))
+ *    ->then(RadioJob::uploadCallsignDB(radio, db));
+ * job->start();
+ * @endcode
+ *
+ * @ingroup rif */
+class RadioJob : public QObject
+{
+  Q_OBJECT
+
+public:
+  /** Possible states of a job. */
+  typedef enum {
+    Pending,     ///< Not started yet.
+    Running,     ///< Running.
+    Finished,    ///< Finished successfully.
+    Failed,      ///< Failed, see @c errorMessage.
+    Cancelled    ///< Cancelled before or while running.
+  } State;
+
+  /** A function run by a job. It returns @c false and sets the error message on failure. */
+  typedef std::function<bool(QString &errorMessage)> Function;
+
+protected:
+  /** Possible kinds of jobs. */
+  typedef enum {
+    Download,          ///< Downloads the codeplug.
+    Upload,            ///< Uploads the codeplug.
+    UploadCallsigns,   ///< Uploads the call-sign DB.
+    Call               ///< Calls a function.
+  } Kind;
+
+  /** Hidden constructor, consider using one of the factory methods. */
+  RadioJob(Kind kind, const QString &name, Radio *radio, QObject *parent=nullptr);
+
+public:
+  /** Destructor. A running function is not waited for, its result gets dropped. */
+  virtual ~RadioJob();
+
+  /** Creates a job downloading the codeplug from the given radio. */
+  static RadioJob *download(Radio *radio, QObject *parent=nullptr);
+  /** Creates a job encoding and uploading the given configuration to the radio. */
+  static RadioJob *upload(Radio *radio, Config *config,
+                          const CodePlug::Flags &flags=CodePlug::Flags(), QObject *parent=nullptr);
+  /** Creates a job encoding and uploading the call-sign DB to the radio. */
+  static RadioJob *uploadCallsignDB(Radio *radio, UserDatabase *db, QObject *parent=nullptr);
+  /** Creates a job calling the given function. The function is called within a thread of the
+   * global thread pool once the job gets started. The job completes within its own thread. */
+  static RadioJob *call(const QString &name, const Function &function, QObject *parent=nullptr);
+
+  /** Returns the name of the job. */
+  const QString &name() const;
+  /** Returns the state of the job. */
+  State state() const;
+  /** Returns @c true if the job is finished, failed or cancelled. */
+  bool isDone() const;
+  /** Returns the error message of a failed job. */
+  const QString &errorMessage() const;
+  /** Returns the progress of the job in percent. */
+  int progress() const;
+  /** Returns the time in ms since the job was started. */
+  qint64 elapsed() const;
+
+  /** Sets the stall timeout in ms. If the job makes no progress within this period, it gets
+   * cancelled and fails. A timeout of 0 (default) disables the timeout. */
+  void setTimeout(int ms);
+
+  /** Chains the given job to this one. The next job gets started once this one finished
+   * successfully and gets cancelled otherwise. Returns the next job, to allow for chaining
+   * several jobs. The next job gets owned by this one, if it has no parent yet. */
+  RadioJob *then(RadioJob *next);
+
+  /** Processes events until this job is done. The job (or one of its predecessors) must have been
+   * started. Returns @c true if the job finished successfully. */
+  bool wait();
+
+public slots:
+  /** Starts the job, if it is pending. */
+  void start();
+  /** Cancels the job. A pending job gets cancelled immediately, a running transfer gets cancelled
+   * before the next block is transferred. A running function cannot be interrupted, the job gets
+   * cancelled once the function returns. */
+  void cancel();
+
+signals:
+  /** Gets emitted once the job was started. */
+  void started(RadioJob *job);
+  /** Gets emitted on progress. */
+  void progressChanged(int percent);
+  /** Gets emitted on progress with the elapsed time and the estimated remaining time (or -1 if
+   * unknown) in ms. */
+  void telemetry(int percent, qint64 elapsed, qint64 remaining);
+  /** Gets emitted once the job is done, irrespective of its result. */
+  void finished(RadioJob *job);
+
+protected slots:
+  /** Gets called on progress of the radio. */
+  void onProgress(int percent);
+  /** Gets called once the radio completed the transfer. */
+  void onRadioDone();
+  /** Gets called if the transfer failed. */
+  void onRadioError();
+  /** Gets called if the job made no progress within the timeout. */
+  void onTimeout();
+  /** Gets called once the function returned. */
+  void onCallDone(bool ok, const QString &errorMessage);
+
+protected:
+  /** Starts the transfer or calls the function. */
+  bool run(QString &errorMessage);
+  /** Completes the job with the given state and starts or cancels the next job. */
+  void complete(State state, const QString &errorMessage=QString());
+
+protected:
+  /** Shared between the job and its running function, see @c RadioJobCall. */
+  class CallGuard;
+  friend class RadioJobCall;
+
+protected:
+  /** The kind of the job. */
+  Kind _kind;
+  /** The name of the job. */
+  QString _name;
+  /** The state of the job. */
+  State _state;
+  /** The radio or @c nullptr for function calls. */
+  Radio *_radio;
+  /** The configuration to upload. */
+  Config *_config;
+  /** The upload flags. */
+  CodePlug::Flags _flags;
+  /** The call-sign DB to upload. */
+  UserDatabase *_userDB;
+  /** The function to call. */
+  Function _function;
+  /** Shared with the running function, if any. */
+  QSharedPointer<CallGuard> _guard;
+  /** The current progress in percent. */
+  int _progress;
+  /** The error message of a failed job. */
+  QString _errorMessage;
+  /** Measures the time since the start. */
+  QElapsedTimer _elapsed;
+  /** The stall timeout in ms, 0 if disabled. */
+  int _timeout;
+  /** Fires if the job stalls. */
+  QTimer _watchdog;
+  /** If @c true, the job was cancelled due to the timeout. */
+  bool _timedOut;
+  /** If @c true, the cancellation of the running transfer was requested. */
+  bool _cancelled;
+  /** The next job or @c nullptr. */
+  RadioJob *_next;
+};
+
+#endif // RADIOJOB_HH
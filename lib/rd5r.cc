@@ -95,8 +95,7 @@ RD5R::startDownload(bool blocking) {
 
 bool
 RD5R::startUpload(Config *config, bool blocking, const CodePlug::Flags &flags) {
-  _config = config;
-  if (!_config)
+  if (! takeSnapshot(config))
     return false;
 
   _dev = new HID(0x15a2, 0x0073);
@@ -152,9 +151,9 @@ RD5R::run()
       int b0 = _codeplug.image(0).element(n).address()/BSIZE;
       int nb = _codeplug.image(0).element(n).data().size()/BSIZE;
       for (int i=0; i<nb; i++, bcount++) {
-        if (! _dev->read(0, (b0+i)*BSIZE, _codeplug.data((b0+i)*BSIZE), BSIZE)) {
+        if (cancelRequested() || (! _dev->read(0, (b0+i)*BSIZE, _codeplug.data((b0+i)*BSIZE), BSIZE))) {
           _errorMessage = tr("%1: Cannot download codeplug: %2").arg(__func__)
-              .arg(_dev->errorMessage());
+              .arg(transferError(_dev));
           _task = StatusError;
           _dev->read_finish();
           _dev->close();
@@ -162,7 +161,7 @@ RD5R::run()
           emit downloadError(this);
           return;
         }
-        emit downloadProgress(float(bcount*100)/btot);
+        setProgress(float(bcount*100)/btot, BSIZE);
       }
     }
     _task = StatusIdle;
@@ -174,6 +173,10 @@ RD5R::run()
   } else if (StatusUpload == _task) {
     emit uploadStarted();
 
+    SnapshotGuard snapshot(this, _config);
+    if (snapshot.isNull())
+      return;
+
     _dev = new HID(0x15a2, 0x0073);
     if (! _dev->isOpen()) {
       _errorMessage = tr("%1(): Cannot open Download codeplug: %2")
@@ -191,14 +194,18 @@ RD5R::run()
 
     uint bcount = 0;
     if (_codeplugFlags.updateCodePlug) {
-      // If codeplug gets updated, download codeplug from device first:
+      // If codeplug gets updated, download codeplug from device first. Blocks completely
+      // overwritten by the encoder are skipped.
+      QVector<CodePlug::PagedImage::Run> overwritten = _codeplug.overwriteMap(_config);
       for (int n=0; n<_codeplug.image(0).numElements(); n++) {
         int b0 = _codeplug.image(0).element(n).address()/BSIZE;
         int nb = _codeplug.image(0).element(n).data().size()/BSIZE;
         for (int i=0; i<nb; i++, bcount++) {
-          if (! _dev->read(0, (b0+i)*BSIZE, _codeplug.data((b0+i)*BSIZE), BSIZE)) {
+          if (CodePlug::isOverwritten(overwritten, (b0+i)*BSIZE, BSIZE))
+            continue;
+          if (cancelRequested() || (! _dev->read(0, (b0+i)*BSIZE, _codeplug.data((b0+i)*BSIZE), BSIZE))) {
             _errorMessage = tr("%1: Cannot upload codeplug: %2").arg(__func__)
-                .arg(_dev->errorMessage());
+                .arg(transferError(_dev));
             _task = StatusError;
             _dev->read_finish();
             _dev->close();
@@ -206,7 +213,7 @@ RD5R::run()
             emit uploadError(this);
             return;
           }
-          emit uploadProgress(float(bcount*50)/btot);
+          setProgress(float(bcount*50)/btot, BSIZE);
         }
       }
     }
@@ -229,9 +236,9 @@ RD5R::run()
       int b0 = _codeplug.image(0).element(n).address()/BSIZE;
       int nb = _codeplug.image(0).element(n).data().size()/BSIZE;
       for (int i=0; i<nb; i++, bcount++) {
-        if (! _dev->write(0, (b0+i)*BSIZE, _codeplug.data((b0+i)*BSIZE), BSIZE)) {
+        if (cancelRequested() || (! _dev->write(0, (b0+i)*BSIZE, _codeplug.data((b0+i)*BSIZE), BSIZE))) {
           _errorMessage = tr("%1: Cannot upload codeplug: %2").arg(__func__)
-              .arg(_dev->errorMessage());
+              .arg(transferError(_dev));
           _task = StatusError;
           _dev->write_finish();
           _dev->close();
@@ -239,7 +246,7 @@ RD5R::run()
           emit uploadError(this);
           return;
         }
-        emit uploadProgress(50+float(bcount*50)/btot);
+        setProgress(50+float(bcount*50)/btot, BSIZE);
       }
     }
     _dev->write_finish();
@@ -4,6 +4,7 @@
 #include "utils.hh"
 #include "logger.hh"
 #include <QDateTime>
+#include <cstddef>
 
 
 #define OFFSET_TIMESTMP     0x00088
@@ -1261,3 +1262,33 @@ next:
 
   return true;
 }
+
+bool
+RD5RCodeplug::patchIdentity(const Identity &identity) {
+  general_settings_t *gs = (general_settings_t*) data(OFFSET_SETTINGS);
+  gs->setName(identity.name);
+  gs->setRadioId(identity.id);
+
+  intro_text_t *it = (intro_text_t*) data(OFFSET_INTRO);
+  it->setIntroLine1(identity.introLine1);
+  it->setIntroLine2(identity.introLine2);
+  return true;
+}
+
+QVector<CodePlug::PagedImage::Run>
+RD5RCodeplug::overwriteMap(const Config *config, uint32_t img) const {
+  QVector<PagedImage::Run> map;
+  if (0 != img)
+    return map;
+
+  map.append({OFFSET_CONTACTS, NCONTACTS*sizeof(contact_t)});
+  map.append({OFFSET_DTMF, NDTMF*sizeof(dtmf_contact_t)});
+  // Records of used channels, the bitmaps of the banks are only updated
+  int nchan = std::min(NCHAN, config->channelList()->count());
+  for (int i=0; i<nchan; i+=128) {
+    uint32_t bank = (0 == (i>>7)) ? OFFSET_BANK_0 : (OFFSET_BANK_1 + ((i>>7)-1)*sizeof(bank_t));
+    map.append({uint32_t(bank+offsetof(bank_t, chan)),
+                uint32_t(std::min(128, nchan-i)*sizeof(channel_t))});
+  }
+  return map;
+}
@@ -770,6 +770,12 @@ public:
   bool decode(Config *config);
   /** Encodes the given generic configuration into this codeplug. */
   bool encode(Config *config, const Flags &flags = Flags());
+
+  /** Returns the ranges overwritten by @c encode: All contacts, DTMF contacts and the records of
+   * the used channels. */
+  QVector<PagedImage::Run> overwriteMap(const Config *config, uint32_t img=0) const;
+  /** Patches the radio name, DMR ID and intro lines. */
+  bool patchIdentity(const Identity &identity);
 };
 
 #endif // RD5R_CODEPLUG_HH
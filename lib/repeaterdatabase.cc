@@ -31,14 +31,40 @@ private:
 /// @endcond
 
 
+/* ********************************************************************************************* *
+ * Implementation of RepeaterDatabase::Loader
+ * ********************************************************************************************* */
+RepeaterDatabase::Loader::Loader(const QString &filename, const QGeoCoordinate &qth, bool update,
+                                 QObject *parent)
+  : QThread(parent), filename(filename), qth(qth), update(update), ok(false), repeater(),
+    callsigns(), errorMessage()
+{
+  // pass...
+}
+
+void
+RepeaterDatabase::Loader::run() {
+  ok = RepeaterDatabase::parse(filename, qth, repeater, callsigns, errorMessage);
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of RepeaterDatabase
+ * ********************************************************************************************* */
 RepeaterDatabase::RepeaterDatabase(const QGeoCoordinate &qth, uint updatePeriodDays, QObject *parent)
-  : QAbstractTableModel(parent), _qth(qth), _repeater(), _callsigns(), _network()
+  : QAbstractTableModel(parent), _updatePeriod(updatePeriodDays), _loader(nullptr), _qth(qth),
+    _repeater(), _callsigns(), _network()
 {
   connect(&_network, SIGNAL(finished(QNetworkReply*)),
           this, SLOT(downloadFinished(QNetworkReply*)));
 
-  if ((! load()) || (updatePeriodDays < dbAge()))
-    download();
+  QString path = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+  startLoader(path+"/repeater.json", true);
+}
+
+RepeaterDatabase::~RepeaterDatabase() {
+  if (_loader)
+    _loader->wait();
 }
 
 bool
@@ -54,9 +80,70 @@ RepeaterDatabase::repeater(int idx) const {
 
 bool
 RepeaterDatabase::load(const QString &filename) {
+  QVector<QJsonObject> repeater;
+  QHash<QString, uint> callsigns;
+  QString msg;
+  if (! parse(filename, _qth, repeater, callsigns, msg)) {
+    logError() << msg;
+    return false;
+  }
+
+  publish(repeater, callsigns, filename);
+  return true;
+}
+
+bool
+RepeaterDatabase::loadAsync() {
+  QString path = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+  return loadAsync(path+"/repeater.json");
+}
+
+bool
+RepeaterDatabase::loadAsync(const QString &filename) {
+  return startLoader(filename, false);
+}
+
+bool
+RepeaterDatabase::isLoading() const {
+  return nullptr != _loader;
+}
+
+bool
+RepeaterDatabase::startLoader(const QString &filename, bool update) {
+  if (_loader)
+    return false;
+
+  _loader = new Loader(filename, _qth, update, this);
+  connect(_loader, SIGNAL(finished()), this, SLOT(onLoaderFinished()));
+  _loader->start();
+  return true;
+}
+
+void
+RepeaterDatabase::onLoaderFinished() {
+  Loader *loader = _loader;
+  _loader = nullptr;
+
+  if (loader->ok)
+    publish(loader->repeater, loader->callsigns, loader->filename);
+  else
+    logError() << loader->errorMessage;
+
+  // If the database is missing or outdated, update it.
+  if (loader->update && ((! loader->ok) || (_updatePeriod < dbAge())))
+    download();
+
+  loader->deleteLater();
+}
+
+bool
+RepeaterDatabase::parse(const QString &filename, const QGeoCoordinate &qth,
+                        QVector<QJsonObject> &repeater, QHash<QString, uint> &callsigns,
+                        QString &errorMessage)
+{
   QFile file(filename);
   if (! file.open(QIODevice::ReadOnly)) {
-    logError() << "Cannot open repeater list '" << filename << "'.";
+    errorMessage = QString("Cannot open repeater list '%1'.").arg(filename);
     return false;
   }
   QByteArray data = file.readAll();
@@ -64,38 +151,47 @@ RepeaterDatabase::load(const QString &filename) {
 
   QJsonDocument doc = QJsonDocument::fromJson(data);
   if (! doc.isObject()) {
-    logError() << "Failed to load repeater DB: JSON document is not an object!";
+    errorMessage = "Failed to load repeater DB: JSON document is not an object!";
     return false;
   }
   if (! doc.object().contains("relais")) {
-    logError() << "Failed to load repeater DB: JSON object does not contain 'relais' item.";
+    errorMessage = "Failed to load repeater DB: JSON object does not contain 'relais' item.";
     return false;
   }
   if (! doc.object()["relais"].isArray()) {
-    logError() << "Failed to load repeater DB: 'relais' item is not an array.";
+    errorMessage = "Failed to load repeater DB: 'relais' item is not an array.";
     return false;
   }
 
-  beginResetModel();
-  _repeater.clear();
-  _callsigns.clear();
+  repeater.clear();
+  callsigns.clear();
 
   QJsonArray array = doc.object()["relais"].toArray();
-  _repeater.reserve(array.size());
+  repeater.reserve(array.size());
   for (int i=0; i<array.size(); i++) {
-    QJsonObject repeater = array.at(i).toObject();
-    _repeater.append(repeater);
-    _callsigns[repeater["callsign"].toString()] = i;
+    QJsonObject rep = array.at(i).toObject();
+    repeater.append(rep);
+    callsigns[rep["callsign"].toString()] = i;
   }
   // Sort repeater w.r.t. distance to me
-  if (_qth.isValid())
-    std::stable_sort(_repeater.begin(), _repeater.end(), DistanceIsLess(_qth));
-  // Done.
+  if (qth.isValid())
+    std::stable_sort(repeater.begin(), repeater.end(), DistanceIsLess(qth));
+
+  return true;
+}
+
+void
+RepeaterDatabase::publish(const QVector<QJsonObject> &repeater,
+                          const QHash<QString, uint> &callsigns, const QString &filename)
+{
+  beginResetModel();
+  _repeater = repeater;
+  _callsigns = callsigns;
   endResetModel();
 
   logDebug() << "Loaded repeater database with " << _repeater.size() << " entries from " << filename << ".";
 
-  return true;
+  emit loaded();
 }
 
 void
@@ -128,7 +224,7 @@ RepeaterDatabase::downloadFinished(QNetworkReply *reply) {
   file.flush();
   file.close();
 
-  load();
+  loadAsync();
   reply->deleteLater();
 }
 
@@ -9,6 +9,7 @@
 #include <QAbstractTableModel>
 #include <QSortFilterProxyModel>
 #include <QGeoPositionInfoSource>
+#include <QThread>
 
 /** Represents the complete downloaded repeater database from http://repeatermap.de.
  * @ingroup util */
@@ -16,18 +17,60 @@ class RepeaterDatabase : public QAbstractTableModel
 {
 	Q_OBJECT
 
+protected:
+	/** Parses and sorts the repeater database in a separate thread. */
+	class Loader: public QThread
+	{
+	public:
+		/** Constructs a loader for the specified file. If @c update is @c true, the database gets
+		 * downloaded if the file cannot be loaded or is outdated. */
+		Loader(const QString &filename, const QGeoCoordinate &qth, bool update, QObject *parent=nullptr);
+
+	protected:
+		/** Parses the file. */
+		void run();
+
+	public:
+		/** The file to load. */
+		QString filename;
+		/** The QTH to sort the repeaters. */
+		QGeoCoordinate qth;
+		/** If @c true, update the database if it cannot be loaded or is outdated. */
+		bool update;
+		/** If @c true, the file was loaded successfully. */
+		bool ok;
+		/** The loaded repeaters sorted with respect to the distance to QTH. */
+		QVector<QJsonObject> repeater;
+		/** Table of callsigns. */
+		QHash<QString, uint> callsigns;
+		/** The error message, if the file cannot be loaded. */
+		QString errorMessage;
+	};
+
 public:
 	/** Constructs a new repeater database.
-	 * The contructor will also start the download of the repeater database if the database was not
-	 * downloaded yet or the downloaded database is older than @c updatePeriodDays days.
+	 * The contructor loads the downloaded repeater database in a separate thread (see
+	 * @c isLoading). It will also start the download of the repeater database if the database was
+	 * not downloaded yet or the downloaded database is older than @c updatePeriodDays days.
 	 *
 	 * The repeater database will be sorted with respect to the distance to the specified QTH. */
 	explicit RepeaterDatabase(const QGeoCoordinate &qth, uint updatePeriodDays=5, QObject *parent=nullptr);
+	/** Destructor, waits for a running load to finish. */
+	virtual ~RepeaterDatabase();
 
 	/** Loads the downloaded repeater database. */
 	bool load();
 	/** Loads the downloaded repeater database from the specified location. */
 	bool load(const QString &filename);
+	/** Starts loading the downloaded repeater database in a separate thread. The repeaters get
+	 * published at once, when the load is complete. Then, the @c loaded signal gets emitted.
+	 * Returns @c false if there is already a load running. */
+	bool loadAsync();
+	/** Starts loading the downloaded repeater database from the specified location in a separate
+	 * thread. */
+	bool loadAsync(const QString &filename);
+	/** Returns @c true while the database is loaded in a separate thread. */
+	bool isLoading() const;
 
 	/** Returns the repeater at the specified index. */
   const QJsonObject &repeater(int idx) const;
@@ -42,6 +85,10 @@ public:
 	/** Implements the QAbstractTableModel, return the cell data. */
   QVariant data(const QModelIndex &index, int role=Qt::DisplayRole) const;
 
+signals:
+	/** Gets emitted once the repeater database has been loaded. */
+	void loaded();
+
 public slots:
 	/** Starts the download of the repeater database from https://repeatermap.de */
 	void download();
@@ -49,8 +96,26 @@ public slots:
 private slots:
 	/** Internal callback on completed download. */
 	void downloadFinished(QNetworkReply *reply);
+	/** Internal callback on completed load in a separate thread. */
+	void onLoaderFinished();
+
+private:
+	/** Parses and sorts the repeater database from the specified file. This function is
+	 * thread-safe. */
+	static bool parse(const QString &filename, const QGeoCoordinate &qth,
+	                  QVector<QJsonObject> &repeater, QHash<QString, uint> &callsigns,
+	                  QString &errorMessage);
+	/** Publishes the loaded repeaters. */
+	void publish(const QVector<QJsonObject> &repeater, const QHash<QString, uint> &callsigns,
+	             const QString &filename);
+	/** Starts a loader for the specified file. */
+	bool startLoader(const QString &filename, bool update);
 
 private:
+	/** The update period in days. */
+	uint _updatePeriod;
+	/** The running loader or @c nullptr. */
+	Loader *_loader;
 	/** My location. */
 	QGeoCoordinate _qth;
 	/** All repeaters sorted with respect to the distance to QTH. */
@@ -48,15 +48,22 @@ namespace Signaling
 
   /** Returns @c true if the given Signaling::Code enum entry refers to a CTCSS frequency. */
   bool isCTCSS(Code code);
-  /** Returns @c true if the given frequency is a valid CTCSS frequency. */
+  /** Returns @c true if the given frequency is a valid CTCSS frequency. The frequency is rounded
+   * to 0.1Hz. */
   bool isCTCSSFrequency(float freq);
   /** Maps CTCSS enum to CTCSS frequency.
    * Returns @c 0.0 if no valid CTCSS enum element is given (e.g., @c SIGNALING_NONE or one of the
    * DCS enum elements). */
   float toCTCSSFrequency(Code code);
-  /** Maps a CTCSS frequency to the corresponding Signaling::Code enum element.
+  /** Maps a CTCSS frequency, rounded to 0.1Hz, to the corresponding Signaling::Code enum element.
    * Retuns @c SIGNALING_NONE if an invalid CTCSS frequency is given. */
   Code fromCTCSSFrequency(float freq);
+  /** Maps CTCSS enum to CTCSS frequency in deci-Hz (e.g., 885 for 88.5Hz).
+   * Returns 0 if no valid CTCSS enum element is given. */
+  uint16_t toCTCSSDeciHz(Code code);
+  /** Maps a CTCSS frequency in deci-Hz to the corresponding Signaling::Code enum element.
+   * Returns @c SIGNALING_NONE if an invalid CTCSS frequency is given. */
+  Code fromCTCSSDeciHz(uint16_t dHz);
 
   /** Returns @c true if a valid DCS code number is given. */
   bool isDCSNumber(uint16_t num);
@@ -0,0 +1,90 @@
+#include "transferprogress.hh"
+#include <QThread>
+#include <algorithm>
+
+
+/* ********************************************************************************************* *
+ * Implementation of TransferProgress::Sample
+ * ********************************************************************************************* */
+TransferProgress::Sample::Sample()
+  : phase(Idle), percent(0), bytes(0), elapsed(0), remaining(-1)
+{
+  // pass...
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of TransferProgress
+ * ********************************************************************************************* */
+TransferProgress::TransferProgress(int rate, QObject *parent)
+  : QObject(parent), _interval(1000/std::max(1, rate)), _phase(Idle), _percent(0), _bytes(0),
+    _timer(), _elapsed(), _lastSample(), _lastPercent(-1), _lastBytes(0)
+{
+  qRegisterMetaType<TransferProgress::Sample>();
+  _timer.setInterval(_interval);
+  connect(&_timer, SIGNAL(timeout()), this, SLOT(onTimeout()));
+}
+
+void
+TransferProgress::start(Phase phase) {
+  _percent.storeRelease(0);
+  _bytes.storeRelease(0);
+  _phase.storeRelease(phase);
+  // Gets called directly if within the consumer thread
+  QMetaObject::invokeMethod(this, "onStarted");
+}
+
+void
+TransferProgress::update(int percent, qint64 bytes) {
+  _percent.storeRelease(percent);
+  if (bytes)
+    _bytes.fetchAndAddRelease(bytes);
+  // Blocking transfer, there is no event loop running the timer
+  if ((QThread::currentThread() == thread()) && _lastSample.isValid() &&
+      (_lastSample.elapsed() >= _interval))
+    onTimeout();
+}
+
+void
+TransferProgress::finish() {
+  QMetaObject::invokeMethod(this, "onFinished");
+}
+
+TransferProgress::Sample
+TransferProgress::sample() const {
+  Sample s;
+  s.phase = Phase(_phase.loadAcquire());
+  s.percent = _percent.loadAcquire();
+  s.bytes = _bytes.loadAcquire();
+  s.elapsed = _elapsed.isValid() ? _elapsed.elapsed() : 0;
+  if (0 < s.percent)
+    s.remaining = (s.elapsed*(100-s.percent))/s.percent;
+  return s;
+}
+
+void
+TransferProgress::onStarted() {
+  _lastPercent = -1;
+  _lastBytes = 0;
+  _elapsed.start();
+  _lastSample.start();
+  _timer.start();
+}
+
+void
+TransferProgress::onTimeout() {
+  Sample s = sample();
+  _lastSample.start();
+  if ((s.percent == _lastPercent) && (s.bytes == _lastBytes))
+    return;
+  _lastPercent = s.percent;
+  _lastBytes = s.bytes;
+  emit sampled(s);
+}
+
+void
+TransferProgress::onFinished() {
+  _timer.stop();
+  onTimeout();
+  _lastSample.invalidate();
+}
@@ -0,0 +1,109 @@
+#ifndef TRANSFERPROGRESS_HH
+#define TRANSFERPROGRESS_HH
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QAtomicInt>
+#include <QAtomicInteger>
+
+/** Rate-limited progress of a transfer running in another thread.
+ *
+ * The transfer loops of the radios report their progress for every block. Emitting a signal for
+ * each block queues an event into the event loop of the consumer (e.g., the GUI), which then
+ * redraws its progress bar thousands of times. Instead, the transfer thread only stores the
+ * progress in atomic counters using @c update, which costs no more than a few stores. The
+ * consumer samples these counters at a fixed rate and emits @c sampled, if the progress changed
+ * since the last sample.
+ *
+ * The object must live in the consumer thread. @c start, @c update and @c finish are
+ * thread-safe and are usually called from within the transfer thread. If they get called from
+ * within the consumer thread (i.e., a blocking transfer without event loop), the progress gets
+ * sampled during @c update at the same rate.
+ *
+ * @ingroup rif */
+class TransferProgress: public QObject
+{
+  Q_OBJECT
+
+public:
+  /** Default sample rate in Hz. */
+  static const int DEFAULT_RATE = 20;
+
+  /** Possible phases of a transfer. */
+  typedef enum {
+    Idle,      ///< No transfer running.
+    Download,  ///< Downloading from the device.
+    Upload     ///< Uploading to the device.
+  } Phase;
+
+  /** A sample of the progress. */
+  class Sample {
+  public:
+    /** The phase of the transfer. */
+    Phase phase;
+    /** The progress in percent. */
+    int percent;
+    /** The number of bytes transferred. */
+    qint64 bytes;
+    /** The time in ms since the transfer started. */
+    qint64 elapsed;
+    /** The estimated remaining time in ms or -1 if unknown. */
+    qint64 remaining;
+
+    /** Default constructor. */
+    Sample();
+  };
+
+public:
+  /** Constructor, @c rate specifies the sample rate in Hz. */
+  explicit TransferProgress(int rate=DEFAULT_RATE, QObject *parent=nullptr);
+
+  /** Starts a transfer of the given phase, resets the progress. Thread-safe. */
+  void start(Phase phase);
+  /** Updates the progress in percent and adds the given number of bytes transferred since the
+   * last update. Thread-safe. */
+  void update(int percent, qint64 bytes=0);
+  /** Finishes the transfer. The final progress gets sampled once more. Thread-safe. */
+  void finish();
+
+  /** Returns the current progress. Must be called from within the consumer thread. */
+  Sample sample() const;
+
+signals:
+  /** Gets emitted within the consumer thread at most at the sample rate, if the progress
+   * changed. */
+  void sampled(const TransferProgress::Sample &sample);
+
+protected slots:
+  /** Starts sampling. */
+  void onStarted();
+  /** Samples the progress. */
+  void onTimeout();
+  /** Samples the final progress and stops sampling. */
+  void onFinished();
+
+protected:
+  /** The sample interval in ms. */
+  int _interval;
+  /** The current phase. */
+  QAtomicInt _phase;
+  /** The current progress in percent. */
+  QAtomicInt _percent;
+  /** The number of bytes transferred. */
+  QAtomicInteger<qint64> _bytes;
+  /** Samples the progress. */
+  QTimer _timer;
+  /** Measures the time since the start. */
+  QElapsedTimer _elapsed;
+  /** Measures the time since the last sample. */
+  QElapsedTimer _lastSample;
+  /** The last progress sampled, -1 if none. */
+  int _lastPercent;
+  /** The number of bytes of the last sample. */
+  qint64 _lastBytes;
+};
+
+Q_DECLARE_METATYPE(TransferProgress::Sample)
+
+#endif // TRANSFERPROGRESS_HH
@@ -0,0 +1,193 @@
+#include "uploadcache.hh"
+#include <QStandardPaths>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QSaveFile>
+#include <QRegExp>
+#include <QFile>
+#include <QDir>
+#include <algorithm>
+#include "logger.hh"
+#include "uploadjournal.hh"
+
+#define CACHE_MAGIC   0x55504341
+#define CACHE_VERSION 2
+
+
+/** Returns the path of the cache file for the specified radio and device. */
+static QString
+cachePath(const QString &radio, const QString &device) {
+  QString name = (radio + " " + device).toLower();
+  name.replace(QRegExp("[^a-z0-9]+"), "_");
+  QString path = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+  return path + "/upload_" + name + ".cache";
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of UploadCache
+ * ********************************************************************************************* */
+UploadCache::UploadCache(const QString &radio, const QString &device)
+  : _radio(radio), _device(device), _content(), _previous(), _current(), _skipped()
+{
+  // pass...
+}
+
+bool
+UploadCache::exists(const QString &radio, const QString &device) {
+  return (! device.isEmpty()) && QFile::exists(cachePath(radio, device));
+}
+
+QVector<CodePlug::PagedImage::Run>
+UploadCache::units(const CodePlug::PagedImage &memory,
+                   const QVector<CodePlug::PagedImage::Run> &spans)
+{
+  QVector<CodePlug::PagedImage::Run> pieces, result;
+  foreach (const CodePlug::PagedImage::Run &run, memory.runs(true)) {
+    if (spans.isEmpty()) {
+      pieces.append(run);
+      continue;
+    }
+    foreach (const CodePlug::PagedImage::Run &span, spans) {
+      uint32_t start = std::max(run.address, span.address);
+      uint32_t end = std::min(run.address+run.size, span.address+span.size);
+      if (start < end)
+        pieces.append({start, end-start});
+    }
+  }
+
+  foreach (const CodePlug::PagedImage::Run &piece, pieces) {
+    uint32_t address = piece.address, end = piece.address+piece.size;
+    while (address < end) {
+      uint32_t next = std::min(end, (address/UploadCache::UNIT_SIZE+1)*UploadCache::UNIT_SIZE);
+      result.append({address, next-address});
+      address = next;
+    }
+  }
+  return result;
+}
+
+QByteArray
+UploadCache::hash(const CodePlug::PagedImage &memory,
+                  const QVector<CodePlug::PagedImage::Run> &runs)
+{
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  foreach (const CodePlug::PagedImage::Run &run, runs) {
+    uint32_t header[2] = { run.address, run.size };
+    hash.addData((const char *)header, sizeof(header));
+    if (const uint8_t *data = memory.data(run.address))
+      hash.addData((const char *)data, run.size);
+  }
+  return hash.result();
+}
+
+bool
+UploadCache::load(const QByteArray &state) {
+  _previous.clear();
+  _content.clear();
+  if (_device.isEmpty())
+    return false;
+  QFile file(cachePath(_radio, _device));
+  if (! file.open(QIODevice::ReadOnly))
+    return false;
+
+  QDataStream stream(&file);
+  quint32 magic, version;
+  QString cacheRadio, cacheDevice;
+  QByteArray cacheState;
+  stream >> magic >> version >> cacheRadio >> cacheDevice >> cacheState >> _content;
+  if ((QDataStream::Ok != stream.status()) || (CACHE_MAGIC != magic)
+      || (CACHE_VERSION != version)) {
+    logWarn() << "Ignore invalid upload cache '" << file.fileName() << "'.";
+  } else if ((cacheRadio != _radio) || (cacheDevice != _device)) {
+    logDebug() << "Upload cache '" << file.fileName() << "' belongs to another device.";
+  } else if (cacheState != state) {
+    logInfo() << "Device content changed since the last upload, write complete codeplug.";
+  } else {
+    while (! stream.atEnd()) {
+      quint32 address, crc;
+      stream >> address >> crc;
+      if (QDataStream::Ok != stream.status()) {
+        _previous.clear();
+        break;
+      }
+      _previous.insert(address, crc);
+    }
+  }
+  file.close();
+
+  // The upload changes the device, the record gets stored again once it has been completed
+  file.remove();
+
+  logDebug() << "Loaded upload cache with " << _previous.size() << " units.";
+  return ! _previous.isEmpty();
+}
+
+uint32_t
+UploadCache::verify(CodePlug::PagedImage &memory, const QByteArray &content) {
+  if (_previous.isEmpty() || (content == _content))
+    return 0;
+
+  logInfo() << "Device content changed since the last upload, write complete codeplug.";
+  uint32_t reverted = 0;
+  foreach (const CodePlug::PagedImage::Run &unit, _skipped) {
+    memory.markDirty(unit.address, unit.size);
+    reverted += unit.size;
+  }
+  _skipped.clear();
+  _previous.clear();
+  return reverted;
+}
+
+uint32_t
+UploadCache::skipUnchanged(CodePlug::PagedImage &memory,
+                           const QVector<CodePlug::PagedImage::Run> &spans)
+{
+  uint32_t skipped = 0;
+  foreach (const CodePlug::PagedImage::Run &unit, units(memory, spans)) {
+    uint32_t crc = UploadJournal::crc(memory.data(unit.address), unit.size);
+    _current.insert(unit.address, crc);
+    if ((! _previous.contains(unit.address)) || (crc != _previous.value(unit.address)))
+      continue;
+    memory.markClean(unit.address, unit.size);
+    _skipped.append(unit);
+    skipped += unit.size;
+  }
+  return skipped;
+}
+
+bool
+UploadCache::store(const QByteArray &state, const QByteArray &content) {
+  if (_device.isEmpty()) {
+    logDebug() << "Do not store upload cache, device cannot be told apart from others.";
+    return false;
+  }
+
+  QString path = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+  QDir directory;
+  if ((! directory.exists(path)) && (! directory.mkpath(path))) {
+    logWarn() << "Cannot create path '" << path << "': Next upload writes complete codeplug.";
+    return false;
+  }
+
+  QSaveFile file(cachePath(_radio, _device));
+  if (! file.open(QIODevice::WriteOnly)) {
+    logWarn() << "Cannot write upload cache '" << file.fileName() << "': "
+              << file.errorString() << ". Next upload writes complete codeplug.";
+    return false;
+  }
+
+  QDataStream stream(&file);
+  stream << quint32(CACHE_MAGIC) << quint32(CACHE_VERSION) << _radio << _device << state
+         << content;
+  for (QHash<uint32_t, uint32_t>::const_iterator it=_current.begin(); it!=_current.end(); it++)
+    stream << quint32(it.key()) << quint32(it.value());
+  if (! file.commit()) {
+    logWarn() << "Cannot write upload cache '" << file.fileName() << "': "
+              << file.errorString() << ". Next upload writes complete codeplug.";
+    return false;
+  }
+
+  logDebug() << "Stored upload cache with " << _current.size() << " units.";
+  return true;
+}
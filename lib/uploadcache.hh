@@ -0,0 +1,91 @@
+#ifndef UPLOADCACHE_HH
+#define UPLOADCACHE_HH
+
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QVector>
+#include "codeplug.hh"
+
+/** Record of the last complete codeplug upload to a device.
+ *
+ * After an upload, editing a single channel and uploading again rewrites every record of the
+ * codeplug, although the encoder reproduces most of them byte by byte. Hence, the cache records
+ * the CRC32 of every unit written to the device. A unit is the part of a contiguous range of
+ * memory within one aligned block of @c UNIT_SIZE bytes. During the next upload to the same
+ * device, all units whose encoded content matches the recorded one are marked clean and thus
+ * skipped. Only the changed records, bitmaps and index lists get transferred.
+ *
+ * The device may have been programmed in the meantime by another CPS or on the device itself.
+ * Therefore, the record is bound to a hash of the bitmaps read back from the device before the
+ * upload. If they differ from the ones written by the last upload, the record is discarded and the
+ * complete codeplug gets written. The units are not read back from the device before they get
+ * skipped: Reading costs a round-trip per 16 bytes, while writes are sent in windows. Hence,
+ * reading back a unit takes longer than writing it. As the bitmaps are known before the first unit
+ * is written, units can be skipped while the upload is pipelined.
+ *
+ * The record also holds a hash of the remaining memory read back before the upload (e.g., the
+ * settings). This memory is read while the first units are written already. If it differs from
+ * the one written by the last upload, all units skipped so far are marked dirty again by @c verify
+ * and the record is discarded.
+ *
+ * The record is kept per device (see @c RadioInterface::identity). Devices that cannot be told
+ * apart from others of the same model always get the complete codeplug.
+ *
+ * @ingroup rif */
+class UploadCache
+{
+public:
+  /** Alignment and maximum size of the units in bytes. */
+  static const uint32_t UNIT_SIZE = CodePlug::PagedImage::PAGE_SIZE;
+
+public:
+  /** Creates the cache of uploads to the specified radio and device. */
+  UploadCache(const QString &radio, const QString &device);
+
+  /** Returns @c true if there is a record of a previous upload to the specified device. */
+  static bool exists(const QString &radio, const QString &device);
+  /** Splits the dirty memory within the given spans into units. If @c spans is empty, all dirty
+   * memory is considered. */
+  static QVector<CodePlug::PagedImage::Run> units(const CodePlug::PagedImage &memory,
+                                                 const QVector<CodePlug::PagedImage::Run> &spans);
+  /** Computes the hash of the given ranges of the memory image, identifying the device state. */
+  static QByteArray hash(const CodePlug::PagedImage &memory,
+                         const QVector<CodePlug::PagedImage::Run> &runs);
+
+  /** Loads the record of the last upload, if it was made to the same device and the device state
+   * matches the given hash. The record gets removed from disk in any case, as the upload will
+   * change the device content. Returns @c true if the record can be used. */
+  bool load(const QByteArray &state);
+  /** Checks the hash of the remaining device content read before the upload against the record.
+   * If it does not match, all units skipped so far are marked dirty again in @c memory and the
+   * record is discarded.
+   * @returns The number of bytes marked dirty again. */
+  uint32_t verify(CodePlug::PagedImage &memory, const QByteArray &content);
+
+  /** Marks all dirty units within the given spans clean, whose content matches the record of the
+   * last upload. If @c spans is empty, all dirty memory is considered. The content of all
+   * considered units gets recorded for the next upload.
+   * @returns The number of bytes skipped. */
+  uint32_t skipUnchanged(CodePlug::PagedImage &memory,
+                         const QVector<CodePlug::PagedImage::Run> &spans);
+
+  /** Stores the record of the completed upload, bound to the given device state and content. */
+  bool store(const QByteArray &state, const QByteArray &content);
+
+protected:
+  /** The radio name. */
+  QString _radio;
+  /** The device identity, empty if the device cannot be told apart from others. */
+  QString _device;
+  /** The hash of the remaining device content written by the last upload. */
+  QByteArray _content;
+  /** Address to CRC of the units written by the last upload. */
+  QHash<uint32_t, uint32_t> _previous;
+  /** Address to CRC of the units of the current upload. */
+  QHash<uint32_t, uint32_t> _current;
+  /** The units skipped so far. */
+  QVector<CodePlug::PagedImage::Run> _skipped;
+};
+
+#endif // UPLOADCACHE_HH
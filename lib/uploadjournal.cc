@@ -0,0 +1,170 @@
+#include "uploadjournal.hh"
+#include <QStandardPaths>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QRegExp>
+#include <QDir>
+#include "logger.hh"
+#include "crc32.hh"
+
+#define JOURNAL_MAGIC   0x55504a4c
+#define JOURNAL_VERSION 1
+
+
+/** Returns the path of the journal file for the specified radio and device. */
+static QString
+journalPath(const QString &radio, const QString &device) {
+  QString name = (radio + " " + device).toLower();
+  name.replace(QRegExp("[^a-z0-9]+"), "_");
+  QString path = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+  return path + "/upload_" + name + ".journal";
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of UploadJournal
+ * ********************************************************************************************* */
+UploadJournal::UploadJournal(const QString &radio, const QString &device)
+  : _radio(radio), _device(device), _hash(), _file(journalPath(radio, device)), _confirmed()
+{
+  // pass...
+}
+
+UploadJournal::~UploadJournal() {
+  if (_file.isOpen())
+    _file.close();
+}
+
+void
+UploadJournal::open(const QByteArray &hash) {
+  _hash = hash;
+  if (! _file.open(QIODevice::ReadOnly))
+    return;
+
+  QDataStream stream(&_file);
+  quint32 magic, version;
+  QString journalRadio, journalDevice;
+  QByteArray journalHash;
+  stream >> magic >> version;
+  if ((JOURNAL_MAGIC != magic) || (JOURNAL_VERSION != version)) {
+    logWarn() << "Ignore invalid upload journal '" << _file.fileName() << "'.";
+    _file.close();
+    return;
+  }
+  stream >> journalRadio >> journalDevice >> journalHash;
+  if ((QDataStream::Ok != stream.status()) || (journalRadio != _radio)
+      || (journalDevice != _device) || (journalHash != _hash)) {
+    logDebug() << "Upload journal '" << _file.fileName() << "' belongs to another upload.";
+    _file.close();
+    return;
+  }
+
+  // Read records, a truncated last record is ignored
+  while (! stream.atEnd()) {
+    quint32 address, crc;
+    stream >> address >> crc;
+    if (QDataStream::Ok != stream.status())
+      break;
+    _confirmed.insert(address, crc);
+  }
+  _file.close();
+
+  logDebug() << "Loaded upload journal with " << _confirmed.size() << " confirmed units from '"
+             << _file.fileName() << "'.";
+}
+
+QByteArray
+UploadJournal::hash(const DFUFile::Image &image) {
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  for (int i=0; i<image.numElements(); i++) {
+    const DFUFile::Element &el = image.element(i);
+    uint32_t header[2] = { el.address(), uint32_t(el.data().size()) };
+    hash.addData((const char *)header, sizeof(header));
+    hash.addData(el.data());
+  }
+  return hash.result();
+}
+
+QByteArray
+UploadJournal::hash(const CodePlug::PagedImage &memory) {
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  foreach (const CodePlug::PagedImage::Run &run, memory.runs()) {
+    uint32_t header[2] = { run.address, run.size };
+    hash.addData((const char *)header, sizeof(header));
+    hash.addData((const char *)memory.data(run.address), run.size);
+  }
+  return hash.result();
+}
+
+QByteArray
+UploadJournal::layout(const CodePlug::PagedImage &memory) {
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  foreach (const CodePlug::PagedImage::Run &run, memory.runs()) {
+    uint32_t header[2] = { run.address, run.size };
+    hash.addData((const char *)header, sizeof(header));
+  }
+  return hash.result();
+}
+
+uint32_t
+UploadJournal::crc(const uint8_t *data, size_t n) {
+  CRC32 crc;
+  crc.update(data, n);
+  return crc.get();
+}
+
+bool
+UploadJournal::isResumable() const {
+  return ! _confirmed.isEmpty();
+}
+
+bool
+UploadJournal::isConfirmed(uint32_t address, uint32_t crc) const {
+  return _confirmed.contains(address) && (crc == _confirmed.value(address));
+}
+
+void
+UploadJournal::reject(uint32_t address) {
+  _confirmed.remove(address);
+}
+
+bool
+UploadJournal::begin() {
+  QString path = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+  QDir directory;
+  if ((! directory.exists(path)) && (!directory.mkpath(path))) {
+    logWarn() << "Cannot create path '" << path << "': Upload cannot be resumed.";
+    return false;
+  }
+
+  if (! _file.open(QIODevice::WriteOnly)) {
+    logWarn() << "Cannot write upload journal '" << _file.fileName() << "': "
+              << _file.errorString() << ". Upload cannot be resumed.";
+    return false;
+  }
+
+  QDataStream stream(&_file);
+  stream << quint32(JOURNAL_MAGIC) << quint32(JOURNAL_VERSION) << _radio << _device << _hash;
+  for (QHash<uint32_t, uint32_t>::const_iterator it=_confirmed.begin(); it!=_confirmed.end(); it++)
+    stream << quint32(it.key()) << quint32(it.value());
+  _file.flush();
+  return true;
+}
+
+void
+UploadJournal::confirm(uint32_t address, uint32_t crc) {
+  _confirmed.insert(address, crc);
+  if (! _file.isOpen())
+    return;
+  QDataStream stream(&_file);
+  stream << quint32(address) << quint32(crc);
+  _file.flush();
+}
+
+void
+UploadJournal::finish() {
+  _confirmed.clear();
+  if (_file.isOpen())
+    _file.close();
+  _file.remove();
+}
@@ -0,0 +1,78 @@
+#ifndef UPLOADJOURNAL_HH
+#define UPLOADJOURNAL_HH
+
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QFile>
+#include "codeplug.hh"
+
+/** Checkpoint journal of an upload to a device.
+ *
+ * Large uploads (e.g., the call-sign DB) may fail halfway due to a flaky USB connection. The
+ * journal records every unit (a sector or a codeplug element) acknowledged by the device together
+ * with the CRC32 of its content. The journal is kept in the application cache directory and is
+ * bound to the radio, the device identity and a hash of the upload. Hence, a retried upload to the
+ * same device can skip all units already written, once their content has been confirmed by reading
+ * them back. The journal gets removed once the upload has been completed.
+ *
+ * If the units are written while the image is still being assembled (e.g., the pipelined codeplug
+ * upload), the hash of the complete image is not known before the first write. Then, the journal
+ * is bound to the memory layout (see @c layout) and every unit is identified by its CRC only.
+ *
+ * @ingroup rif */
+class UploadJournal
+{
+public:
+  /** Creates the journal of an upload to the specified radio and device. The journal must be
+   * bound to the image using @c open before it can be written. */
+  UploadJournal(const QString &radio, const QString &device);
+  /** Destructor, closes the journal. */
+  ~UploadJournal();
+
+  /** Computes the hash of the given image. */
+  static QByteArray hash(const DFUFile::Image &image);
+  /** Computes the hash of the given memory image. */
+  static QByteArray hash(const CodePlug::PagedImage &memory);
+  /** Computes the hash of the layout of the given memory image, ignoring its content. */
+  static QByteArray layout(const CodePlug::PagedImage &memory);
+  /** Computes the CRC32 of the given memory. */
+  static uint32_t crc(const uint8_t *data, size_t n);
+
+  /** Binds the journal to the upload with the given @c hash. Any confirmed units of a previous,
+   * failed upload with the same hash to the same device are loaded. A journal of another upload or
+   * device gets discarded. Units confirmed before are kept. */
+  void open(const QByteArray &hash);
+
+  /** Returns @c true if there are units confirmed by a previous upload. */
+  bool isResumable() const;
+  /** Returns @c true if the unit at the given address was confirmed with the given CRC. */
+  bool isConfirmed(uint32_t address, uint32_t crc) const;
+  /** Removes the unit at the given address from the confirmed ones, e.g., if the content on the
+   * device does not match. */
+  void reject(uint32_t address);
+
+  /** Starts (or resumes) the upload. Rewrites the journal with the remaining confirmed units.
+   * @returns @c false if the journal cannot be written. The upload can proceed anyway, but cannot
+   * be resumed. */
+  bool begin();
+  /** Records the unit at the given address with the given CRC as written and flushes the journal
+   * to disk. Units confirmed before @c begin are written by @c begin. */
+  void confirm(uint32_t address, uint32_t crc);
+  /** Completes the upload and removes the journal. */
+  void finish();
+
+protected:
+  /** The radio name. */
+  QString _radio;
+  /** The device identity. */
+  QString _device;
+  /** The hash of the upload. */
+  QByteArray _hash;
+  /** The journal file. */
+  QFile _file;
+  /** Address to CRC of all confirmed units. */
+  QHash<uint32_t, uint32_t> _confirmed;
+};
+
+#endif // UPLOADJOURNAL_HH
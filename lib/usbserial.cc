@@ -2,9 +2,29 @@
 #include "logger.hh"
 #include <QSerialPortInfo>
 
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <poll.h>
+#include <termios.h>
+#include <sys/ioctl.h>
+#endif
+#ifdef Q_OS_LINUX
+#include <linux/serial.h>
+#endif
+
+USBSerial::Backend USBSerial::_defaultBackend = USBSerial::QtBackend;
+
 USBSerial::USBSerial(unsigned vid, unsigned pid, QObject *parent)
-  : QSerialPort(parent), RadioInterface(), _errorMessage()
+  : QSerialPort(parent), RadioInterface(), _errorMessage(), _backend(_defaultBackend), _fd(-1),
+    _vmin(-1), _serialNumber()
 {
+#ifndef Q_OS_UNIX
+  _backend = QtBackend;
+#endif
+
   //logDebug() << "Try to detect USB serial interface " << Qt::hex << vid << ":" << pid << ".";
   logDebug() << "Try to detect USB serial interface " << vid << ":" << pid << ".";
 
@@ -16,6 +36,12 @@ USBSerial::USBSerial(unsigned vid, unsigned pid, QObject *parent)
     {
       logDebug() << "Found serial port " << vid << ":" << pid << ": "
                  << port.portName() << " '" << port.description() << "'.";
+      _serialNumber = port.serialNumber();
+      if (NativeBackend == _backend) {
+        if (openNative(port.systemLocation()))
+          break;
+        continue;
+      }
       this->setPort(port);
       this->setBaudRate(115200);
       if (! this->open(QIODevice::ReadWrite)) {
@@ -35,6 +61,9 @@ USBSerial::USBSerial(unsigned vid, unsigned pid, QObject *parent)
     return;
   }
 
+  if (NativeBackend == _backend)
+    return;
+
   logDebug() << "Openend serial port " << this->portName() << " with "
              << this->baudRate() << "baud.";
 
@@ -43,26 +72,272 @@ USBSerial::USBSerial(unsigned vid, unsigned pid, QObject *parent)
           this, SLOT(onError(QSerialPort::SerialPortError)));
 }
 
+USBSerial::USBSerial(const QString &device, Backend backend, QObject *parent)
+  : QSerialPort(parent), RadioInterface(), _errorMessage(), _backend(backend), _fd(-1),
+    _vmin(-1), _serialNumber()
+{
+#ifndef Q_OS_UNIX
+  _backend = QtBackend;
+#endif
+
+  // Find the serial number of the device, if it is known to the system
+  foreach (QSerialPortInfo port, QSerialPortInfo::availablePorts()) {
+    if ((device == port.systemLocation()) || (device == port.portName())) {
+      _serialNumber = port.serialNumber();
+      break;
+    }
+  }
+
+  if (NativeBackend == _backend) {
+    openNative(device);
+    return;
+  }
+
+  this->setPortName(device);
+  this->setBaudRate(115200);
+  if (! this->open(QIODevice::ReadWrite)) {
+    _errorMessage = tr("%1: Cannot open serial port '%2': %3")
+        .arg(__func__).arg(device).arg(this->errorString());
+    return;
+  }
+
+  connect(this, SIGNAL(aboutToClose()), this, SLOT(onClose()));
+  connect(this, SIGNAL(errorOccurred(QSerialPort::SerialPortError)),
+          this, SLOT(onError(QSerialPort::SerialPortError)));
+}
+
 USBSerial::~USBSerial() {
   close();
 }
 
+QString
+USBSerial::serialNumber() {
+  return _serialNumber;
+}
+
 bool
 USBSerial::isOpen() const {
+  if (NativeBackend == _backend)
+    return 0 <= _fd;
   return QSerialPort::isOpen();
 }
 
 void
 USBSerial::close() {
+#ifdef Q_OS_UNIX
+  if (NativeBackend == _backend) {
+    if (0 > _fd)
+      return;
+    logDebug() << "Serial port will close now.";
+    ::close(_fd);
+    _fd = -1;
+    return;
+  }
+#endif
   if (isOpen())
     QSerialPort::close();
 }
 
+USBSerial::Backend
+USBSerial::backend() const {
+  return _backend;
+}
+
 const QString &
 USBSerial::errorMessage() const {
   return _errorMessage;
 }
 
+USBSerial::Backend
+USBSerial::defaultBackend() {
+  return _defaultBackend;
+}
+
+void
+USBSerial::setDefaultBackend(Backend backend) {
+  _defaultBackend = backend;
+}
+
+bool
+USBSerial::openNative(const QString &device) {
+#ifdef Q_OS_UNIX
+  _fd = ::open(device.toLocal8Bit().constData(), O_RDWR | O_NOCTTY | O_CLOEXEC);
+  if (0 > _fd) {
+    _errorMessage = tr("%1: Cannot open serial port '%2': %3")
+        .arg(__func__).arg(device).arg(strerror(errno));
+    logDebug() << "Cannot open serial port '" << device << "': " << strerror(errno);
+    return false;
+  }
+
+  // Claim exclusive access like QSerialPort does
+  ioctl(_fd, TIOCEXCL);
+
+  // Raw 8N1 at 115200 baud. Reads return immediately (VMIN=0, VTIME=0) until receiveExact()
+  // requests a specific length.
+  struct termios tio;
+  if (0 != tcgetattr(_fd, &tio)) {
+    _errorMessage = tr("%1: Cannot configure serial port '%2': %3")
+        .arg(__func__).arg(device).arg(strerror(errno));
+    ::close(_fd); _fd = -1;
+    return false;
+  }
+  cfmakeraw(&tio);
+  tio.c_cflag |= (CLOCAL | CREAD);
+  cfsetispeed(&tio, B115200);
+  cfsetospeed(&tio, B115200);
+  tio.c_cc[VMIN] = 0;
+  tio.c_cc[VTIME] = 0;
+  if (0 != tcsetattr(_fd, TCSANOW, &tio)) {
+    _errorMessage = tr("%1: Cannot configure serial port '%2': %3")
+        .arg(__func__).arg(device).arg(strerror(errno));
+    ::close(_fd); _fd = -1;
+    return false;
+  }
+  _vmin = 0;
+  tcflush(_fd, TCIOFLUSH);
+
+#ifdef Q_OS_LINUX
+  // Ask the driver to push received data immediately instead of batching it
+  struct serial_struct serial;
+  bool lowLatency = false;
+  if (0 == ioctl(_fd, TIOCGSERIAL, &serial)) {
+    serial.flags |= ASYNC_LOW_LATENCY;
+    lowLatency = (0 == ioctl(_fd, TIOCSSERIAL, &serial));
+  }
+  if (lowLatency) {
+    logDebug() << "Enabled low-latency mode of serial port '" << device << "'.";
+  } else {
+    logDebug() << "Cannot enable low-latency mode of serial port '" << device << "': "
+               << strerror(errno);
+  }
+#endif
+
+  logDebug() << "Openend serial port " << device << " with 115200baud (native).";
+  return true;
+#else
+  _errorMessage = tr("%1: Native serial backend not available, cannot open '%2'.")
+      .arg(__func__).arg(device);
+  return false;
+#endif
+}
+
+#ifdef Q_OS_UNIX
+/** Sets VMIN of the given device, VTIME is set to 100ms whenever VMIN is non-zero. */
+static bool
+setVMin(int fd, int &current, int vmin) {
+  if (current == vmin)
+    return true;
+  struct termios tio;
+  if (0 != tcgetattr(fd, &tio))
+    return false;
+  tio.c_cc[VMIN] = vmin;
+  tio.c_cc[VTIME] = (vmin ? 1 : 0);
+  if (0 != tcsetattr(fd, TCSANOW, &tio))
+    return false;
+  current = vmin;
+  return true;
+}
+#endif
+
+qint64
+USBSerial::transmit(const char *data, qint64 len) {
+#ifdef Q_OS_UNIX
+  if (NativeBackend == _backend) {
+    qint64 written = 0;
+    while (written < len) {
+      ssize_t n = ::write(_fd, data+written, len-written);
+      if ((0 > n) && (EINTR == errno))
+        continue;
+      if (0 > n) {
+        _errorMessage = tr("%1: Cannot write to serial port: %2").arg(__func__).arg(strerror(errno));
+        return -1;
+      }
+      written += n;
+    }
+    return written;
+  }
+#endif
+  qint64 n = QSerialPort::write(data, len);
+  if (0 > n)
+    _errorMessage = tr("%1: Cannot write to serial port: %2").arg(__func__).arg(errorString());
+  return n;
+}
+
+bool
+USBSerial::waitForData(int msecs) {
+#ifdef Q_OS_UNIX
+  if (NativeBackend == _backend) {
+    struct pollfd pfd = {_fd, POLLIN, 0};
+    int n;
+    while ((0 > (n = poll(&pfd, 1, msecs))) && (EINTR == errno)) {
+      // pass...
+    }
+    return (0 < n) && (pfd.revents & POLLIN);
+  }
+#endif
+  return waitForReadyRead(msecs);
+}
+
+qint64
+USBSerial::receive(char *data, qint64 maxlen) {
+#ifdef Q_OS_UNIX
+  if (NativeBackend == _backend) {
+    if (! setVMin(_fd, _vmin, 0)) {
+      _errorMessage = tr("%1: Cannot configure serial port: %2").arg(__func__).arg(strerror(errno));
+      return -1;
+    }
+    ssize_t n;
+    while ((0 > (n = ::read(_fd, data, maxlen))) && (EINTR == errno)) {
+      // pass...
+    }
+    if (0 > n)
+      _errorMessage = tr("%1: Cannot read from serial port: %2").arg(__func__).arg(strerror(errno));
+    return n;
+  }
+#endif
+  qint64 n = QSerialPort::read(data, maxlen);
+  if (0 > n)
+    _errorMessage = tr("%1: Cannot read from serial port: %2").arg(__func__).arg(errorString());
+  return n;
+}
+
+bool
+USBSerial::receiveExact(char *data, qint64 len, int msecs) {
+  while (0 < len) {
+    if (! waitForData(msecs)) {
+      _errorMessage = tr("%1: No response from device: Timeout.").arg(__func__);
+      return false;
+    }
+
+    qint64 n;
+#ifdef Q_OS_UNIX
+    if (NativeBackend == _backend) {
+      // Let the driver collect the remaining response (VMIN) and return once it is complete or
+      // the device paused for 100ms (VTIME).
+      if (! setVMin(_fd, _vmin, int(qMin(len, qint64(255))))) {
+        _errorMessage = tr("%1: Cannot configure serial port: %2").arg(__func__).arg(strerror(errno));
+        return false;
+      }
+      while ((0 > (n = ::read(_fd, data, len))) && (EINTR == errno)) {
+        // pass...
+      }
+      if (0 > n)
+        _errorMessage = tr("%1: Cannot read from serial port: %2").arg(__func__).arg(strerror(errno));
+    } else {
+      n = receive(data, len);
+    }
+#else
+    n = receive(data, len);
+#endif
+    if (0 > n)
+      return false;
+    data += n;
+    len -= n;
+  }
+
+  return true;
+}
+
 void
 USBSerial::onError(QSerialPort::SerialPortError err) {
   logError() <<"Serial port error: (" << err << ") " << errorString() << ".";
@@ -9,12 +9,23 @@
  *
  * The correct serial port is selected by the given VID and PID to the constructor.
  *
+ * The actual I/O is either performed by @c QSerialPort or, on POSIX systems, directly on the
+ * termios device. The latter avoids the Qt event machinery for each of the many short request
+ * and response exchanges with the radio. See @c setDefaultBackend.
+ *
  * @ingroup rif
  */
 class USBSerial : public QSerialPort, public RadioInterface
 {
   Q_OBJECT
 
+public:
+  /** Possible I/O backends. */
+  enum Backend {
+    QtBackend,    ///< Uses QSerialPort for the I/O.
+    NativeBackend ///< Uses termios and poll() directly (POSIX only).
+  };
+
 protected:
   /** Constructs an opens new serial interface to the devices identified by the given vendor and
    * product IDs.
@@ -22,6 +33,11 @@ protected:
    * @param pid Product ID of device.
    * @param parent Specifies the parent object. */
   explicit USBSerial(unsigned vid, unsigned pid, QObject *parent=nullptr);
+  /** Constructs and opens a serial interface to the given device using the specified backend.
+   * @param device Specifies the path to the serial device.
+   * @param backend Specifies the backend to use.
+   * @param parent Specifies the parent object. */
+  USBSerial(const QString &device, Backend backend, QObject *parent=nullptr);
 
 public:
   /** Destrutor. */
@@ -31,10 +47,35 @@ public:
   bool isOpen() const;
   /** Closes the interface to the device. */
   void close();
+  /** Returns the serial number of the USB device, as reported by the system. */
+  QString serialNumber();
+
+  /** Returns the backend used by this interface. */
+  Backend backend() const;
 
   /** Returns the last error message. */
   const QString &errorMessage() const;
 
+  /** Returns the backend used by newly created interfaces. */
+  static Backend defaultBackend();
+  /** Sets the backend used by newly created interfaces. */
+  static void setDefaultBackend(Backend backend);
+
+protected:
+  /** Sends the given data to the device. Returns the number of bytes written or -1 on error. */
+  qint64 transmit(const char *data, qint64 len);
+  /** Waits at most @c msecs for data to become available. */
+  bool waitForData(int msecs);
+  /** Reads the available data up to @c maxlen bytes from the device. Returns the number of bytes
+   * read or -1 on error. */
+  qint64 receive(char *data, qint64 maxlen);
+  /** Reads exactly @c len bytes from the device. Fails if the device does not respond within
+   * @c msecs.*/
+  bool receiveExact(char *data, qint64 len, int msecs);
+
+  /** Opens the given device using the native backend. */
+  bool openNative(const QString &device);
+
 protected slots:
   /** Callback for serial interface errors. */
   void onError(QSerialPort::SerialPortError error_t);
@@ -44,6 +85,17 @@ protected slots:
 protected:
   /** Holds the last error message. */
   QString _errorMessage;
+  /** The backend of this interface. */
+  Backend _backend;
+  /** File descriptor of the device, if opened by the native backend. */
+  int _fd;
+  /** The current VMIN setting of the native device. */
+  int _vmin;
+  /** The serial number of the USB device, empty if not reported. */
+  QString _serialNumber;
+
+  /** The default backend. */
+  static Backend _defaultBackend;
 };
 
 #endif // USBSERIAL_HH
@@ -7,6 +7,9 @@
 #include <QNetworkReply>
 #include <algorithm>
 #include "logger.hh"
+#include "crc32.hh"
+#include <QDataStream>
+#include <QRegExp>
 #include <cmath>
 
 
@@ -43,18 +46,182 @@ UserDatabase::User::distance(uint id) const {
   return std::abs(a-b);
 }
 
+uint32_t
+UserDatabase::User::hash() const {
+  CRC32 crc;
+  crc.update(QString("%1\t%2\t%3\t%4").arg(call, name, surname, country).toUtf8());
+  return crc.get();
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of UserDatabase::Snapshot
+ * ********************************************************************************************* */
+UserDatabase::Snapshot::Snapshot()
+  : entries(), address(0), image()
+{
+  // pass...
+}
+
+bool
+UserDatabase::Snapshot::isEmpty() const {
+  return entries.isEmpty() && image.isEmpty();
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of UserDatabase::Diff
+ * ********************************************************************************************* */
+bool
+UserDatabase::Diff::isEmpty() const {
+  return added.isEmpty() && removed.isEmpty() && changed.isEmpty();
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of UserDatabase::Index
+ * ********************************************************************************************* */
+UserDatabase::Index::Index()
+  : _calls(), _names(), _ids()
+{
+  // pass...
+}
+
+void
+UserDatabase::Index::build(const QVector<User> &users) {
+  _calls.clear(); _names.clear(); _ids.clear();
+  _calls.reserve(users.size());
+  _names.reserve(2*users.size());
+  _ids.reserve(users.size());
+
+  for (int i=0; i<users.size(); i++) {
+    const User &user = users[i];
+    _calls.append(qMakePair(user.call.toUpper(), i));
+    _ids.append(qMakePair(user.id, i));
+    QStringList tokens = (user.name + " " + user.surname).toUpper().split(" ", QString::SkipEmptyParts);
+    foreach (const QString &token, tokens)
+      _names.append(qMakePair(token, i));
+  }
+
+  std::sort(_calls.begin(), _calls.end());
+  std::sort(_names.begin(), _names.end());
+  std::sort(_ids.begin(), _ids.end());
+}
+
+void
+UserDatabase::Index::remap(const QVector<int> &rows) {
+  for (int i=0; i<_calls.size(); i++)
+    _calls[i].second = rows[_calls[i].second];
+  for (int i=0; i<_names.size(); i++)
+    _names[i].second = rows[_names[i].second];
+  for (int i=0; i<_ids.size(); i++)
+    _ids[i].second = rows[_ids[i].second];
+}
+
+void
+UserDatabase::Index::collect(const QVector<QPair<QString, int>> &keys, const QString &prefix,
+                             int limit, QVector<int> &rows)
+{
+  // Users match several keys (e.g., name and surname), skip rows already collected
+  QSet<int> seen;
+  foreach (int row, rows)
+    seen.insert(row);
+  QVector<QPair<QString, int>>::const_iterator it = std::lower_bound(
+        keys.begin(), keys.end(), qMakePair(prefix, -1));
+  for (; (it != keys.end()) && (rows.size() < limit) && it->first.startsWith(prefix); it++) {
+    if (! seen.contains(it->second)) {
+      seen.insert(it->second);
+      rows.append(it->second);
+    }
+  }
+}
+
+QVector<int>
+UserDatabase::Index::findCall(const QString &prefix, int limit) const {
+  QVector<int> rows;
+  if (! prefix.isEmpty())
+    collect(_calls, prefix.toUpper(), limit, rows);
+  return rows;
+}
+
+QVector<int>
+UserDatabase::Index::findId(const QString &prefix, int limit) const {
+  QVector<int> rows;
+  bool ok;
+  uint value = prefix.toUInt(&ok);
+  // DMR IDs have at most 8 digits and no leading zeros
+  if ((! ok) || prefix.startsWith('0') || (prefix.size() > 8))
+    return rows;
+
+  // IDs with n digits starting with the prefix form the range [p*10^k, (p+1)*10^k), where k is the
+  // number of remaining digits. Search this range for every number of digits.
+  for (int k=0; (k <= (8-prefix.size())) && (rows.size() < limit); k++) {
+    uint scale = 1;
+    for (int i=0; i<k; i++)
+      scale *= 10;
+    QPair<uint, int> first(value*scale, -1);
+    QVector<QPair<uint, int>>::const_iterator it = std::lower_bound(_ids.begin(), _ids.end(), first);
+    for (; (it != _ids.end()) && (it->first < (value+1)*scale) && (rows.size() < limit); it++)
+      rows.append(it->second);
+  }
+  return rows;
+}
+
+QVector<int>
+UserDatabase::Index::findName(const QString &prefix, int limit) const {
+  QVector<int> rows;
+  if (! prefix.isEmpty())
+    collect(_names, prefix.toUpper(), limit, rows);
+  return rows;
+}
+
+QVector<int>
+UserDatabase::Index::find(const QString &prefix, int limit) const {
+  QString text = prefix.trimmed();
+  if (QRegExp("[0-9]+").exactMatch(text))
+    return findId(text, limit);
+
+  QVector<int> rows = findCall(text, limit);
+  if (rows.size() < limit)
+    collect(_names, text.toUpper(), limit, rows);
+  return rows;
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of UserDatabase::Loader
+ * ********************************************************************************************* */
+UserDatabase::Loader::Loader(const QString &filename, bool update, QObject *parent)
+  : QThread(parent), filename(filename), update(update), ok(false), users(), errorMessage()
+{
+  // pass...
+}
+
+void
+UserDatabase::Loader::run() {
+  ok = UserDatabase::parse(filename, users, errorMessage);
+  if (ok)
+    index.build(users);
+}
+
 
 /* ********************************************************************************************* *
  * Implementation of UserDatabase
  * ********************************************************************************************* */
 UserDatabase::UserDatabase(uint updatePeriodDays, QObject *parent)
-  : QAbstractTableModel(parent), _user(), _network()
+  : QAbstractTableModel(parent), _updatePeriod(updatePeriodDays), _loader(nullptr), _user(),
+    _sorted(false), _index(), _network()
 {
   connect(&_network, SIGNAL(finished(QNetworkReply*)),
           this, SLOT(downloadFinished(QNetworkReply*)));
 
-  if ((! load()) || (updatePeriodDays < dbAge()))
-    download();
+  QString path = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+  startLoader(path+"/user.json", true);
+}
+
+UserDatabase::~UserDatabase() {
+  if (_loader)
+    _loader->wait();
 }
 
 qint64
@@ -73,65 +240,287 @@ UserDatabase::user(int idx) const {
   return _user[idx];
 }
 
+const UserDatabase::Index &
+UserDatabase::searchIndex() const {
+  return _index;
+}
+
 bool
 UserDatabase::load(const QString &filename) {
-  QFile file(filename);
-  if (! file.open(QIODevice::ReadOnly)) {
-    QString msg = QString("Cannot open user list '%1': ").arg(filename).arg(file.errorString());
+  QVector<User> users;
+  QString msg;
+  if (! parse(filename, users, msg)) {
     logError() << msg;
     emit error(msg);
     return false;
   }
+
+  Index index;
+  index.build(users);
+  publish(users, index, filename);
+  return true;
+}
+
+bool
+UserDatabase::loadAsync() {
+  QString path = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+  return loadAsync(path+"/user.json");
+}
+
+bool
+UserDatabase::loadAsync(const QString &filename) {
+  return startLoader(filename, false);
+}
+
+bool
+UserDatabase::isLoading() const {
+  return nullptr != _loader;
+}
+
+bool
+UserDatabase::startLoader(const QString &filename, bool update) {
+  if (_loader)
+    return false;
+
+  _loader = new Loader(filename, update, this);
+  connect(_loader, SIGNAL(finished()), this, SLOT(onLoaderFinished()));
+  _loader->start();
+  return true;
+}
+
+void
+UserDatabase::onLoaderFinished() {
+  Loader *loader = _loader;
+  _loader = nullptr;
+
+  if (loader->ok)
+    publish(loader->users, loader->index, loader->filename);
+  else
+    logError() << loader->errorMessage;
+
+  // If the database is missing or outdated, update it. Otherwise signal the error.
+  if (loader->update && ((! loader->ok) || (_updatePeriod < dbAge())))
+    download();
+  else if (! loader->ok)
+    emit error(loader->errorMessage);
+
+  loader->deleteLater();
+}
+
+bool
+UserDatabase::parse(const QString &filename, QVector<User> &users, QString &errorMessage) {
+  QFile file(filename);
+  if (! file.open(QIODevice::ReadOnly)) {
+    errorMessage = QString("Cannot open user list '%1': %2").arg(filename).arg(file.errorString());
+    return false;
+  }
   QByteArray data = file.readAll();
   file.close();
 
   QJsonDocument doc = QJsonDocument::fromJson(data);
   if (! doc.isObject()) {
-    QString msg = "Failed to load user DB: JSON document is not an object!";
-    logError() << msg;
-    emit error(msg);
+    errorMessage = "Failed to load user DB: JSON document is not an object!";
     return false;
   }
   if (! doc.object().contains("users")) {
-    QString msg = "Failed to load user DB: JSON object does not contain 'users' item.";
-    logError() << msg;
-    emit error(msg);
+    errorMessage = "Failed to load user DB: JSON object does not contain 'users' item.";
     return false;
   }
   if (! doc.object()["users"].isArray()) {
-    QString msg = "Failed to load user DB: 'users' item is not an array.";
-    logError() << msg;
-    emit error(msg);
+    errorMessage = "Failed to load user DB: 'users' item is not an array.";
     return false;
   }
 
-  beginResetModel();
-  _user.clear();
-
   QJsonArray array = doc.object()["users"].toArray();
-  _user.reserve(array.size());
+  users.clear();
+  users.reserve(array.size());
   for (int i=0; i<array.size(); i++) {
     User user(array.at(i).toObject());
     if (user.isValid())
-      _user.append(user);
+      users.append(user);
   }
   // Sort repeater w.r.t. their IDs
-  std::stable_sort(_user.begin(), _user.end(), [](const User &a, const User &b){ return a.id < b.id; });
-  // Done.
+  std::stable_sort(users.begin(), users.end(), [](const User &a, const User &b){ return a.id < b.id; });
+
+  return true;
+}
+
+void
+UserDatabase::publish(const QVector<User> &users, const Index &index, const QString &filename) {
+  beginResetModel();
+  _user = users;
+  _sorted = false;
+  _index = index;
   endResetModel();
 
   logDebug() << "Loaded user database with " << _user.size() << " entries from " << filename << ".";
 
   emit loaded();
+}
+
+UserDatabase::Snapshot
+UserDatabase::snapshot(int n) const {
+  Snapshot snapshot;
+  n = std::min(n, _user.size());
+  snapshot.entries.reserve(n);
+  for (int i=0; i<n; i++)
+    snapshot.entries.insert(_user[i].id, _user[i].hash());
+  return snapshot;
+}
+
+UserDatabase::Diff
+UserDatabase::diff(const Snapshot &previous, int n) const {
+  Diff diff;
+  QSet<uint> current;
+  n = std::min(n, _user.size());
+  current.reserve(n);
+  for (int i=0; i<n; i++) {
+    const User &user = _user[i];
+    current.insert(user.id);
+    if (! previous.entries.contains(user.id))
+      diff.added.insert(user.id);
+    else if (previous.entries.value(user.id) != user.hash())
+      diff.changed.insert(user.id);
+  }
+  for (QHash<uint, uint32_t>::const_iterator it=previous.entries.begin(); it!=previous.entries.end(); it++) {
+    if (! current.contains(it.key()))
+      diff.removed.insert(it.key());
+  }
+  return diff;
+}
+
+/** Turns the given name into a part of a file name. */
+static QString
+fileNamePart(const QString &name) {
+  QString part = name.toLower();
+  part.replace(QRegExp("[^a-z0-9]+"), "_");
+  return part;
+}
+
+/** Returns the path of the snapshot file for the specified radio and device. */
+static QString
+snapshotPath(const QString &radio, const QString &device) {
+  QString path = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+  return path + "/callsigndb_" + fileNamePart(radio) + "-" + fileNamePart(device) + ".snapshot";
+}
+
+UserDatabase::Snapshot
+UserDatabase::lastWritten(const QString &radio, const QString &device) const {
+  Snapshot snapshot;
+  if (device.isEmpty())
+    return snapshot;
+  QFile file(snapshotPath(radio, device));
+  if (! file.open(QIODevice::ReadOnly))
+    return snapshot;
+
+  QDataStream stream(&file);
+  quint32 magic, version;
+  stream >> magic >> version;
+  if ((0x43534442 != magic) || (1 != version)) {
+    logWarn() << "Ignore invalid call-sign DB snapshot '" << file.fileName() << "'.";
+    return Snapshot();
+  }
+  stream >> snapshot.entries >> snapshot.address >> snapshot.image;
+  if (QDataStream::Ok != stream.status()) {
+    logWarn() << "Ignore incomplete call-sign DB snapshot '" << file.fileName() << "'.";
+    return Snapshot();
+  }
+
+  logDebug() << "Loaded call-sign DB snapshot of " << snapshot.entries.size()
+             << " entries from " << file.fileName() << ".";
+  return snapshot;
+}
+
+bool
+UserDatabase::setLastWritten(const QString &radio, const QString &device,
+                             const Snapshot &snapshot) const
+{
+  if (device.isEmpty()) {
+    logDebug() << "Do not store call-sign DB snapshot for " << radio
+               << ", device cannot be told apart from others.";
+    return false;
+  }
+
+  QString path = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+  QDir directory;
+  if ((! directory.exists(path)) && (!directory.mkpath(path))) {
+    logError() << "Cannot create path '" << path << "'.";
+    return false;
+  }
+
+  QFile file(snapshotPath(radio, device));
+  if (! file.open(QIODevice::WriteOnly)) {
+    logError() << "Cannot save call-sign DB snapshot at '" << file.fileName() << "': "
+               << file.errorString();
+    return false;
+  }
+
+  QDataStream stream(&file);
+  stream << quint32(0x43534442) << quint32(1)
+         << snapshot.entries << snapshot.address << snapshot.image;
+  file.close();
   return true;
 }
 
+void
+UserDatabase::clearLastWritten(const QString &radio, const QString &device) const {
+  if (! device.isEmpty()) {
+    QFile::remove(snapshotPath(radio, device));
+    return;
+  }
+
+  // Remove snapshots of all devices of the given radio
+  QDir directory(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation));
+  QString pattern = "callsigndb_" + fileNamePart(radio) + "-*.snapshot";
+  foreach (QString name, directory.entryList(QStringList() << pattern, QDir::Files))
+    directory.remove(name);
+}
+
 void
 UserDatabase::sortUsers(uint id) {
-  // Sort repeater w.r.t. distance to ID
-  std::stable_sort(_user.begin(), _user.end(), [id](const User &a, const User &b){
-    return a.distance(id) < b.distance(id);
+  // Sort a permutation w.r.t. distance to ID, such that the search index can be updated
+  QVector<uint> distance(_user.size());
+  QVector<int> order(_user.size());
+  for (int i=0; i<_user.size(); i++) {
+    distance[i] = _user[i].distance(id);
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&distance](int a, int b){
+    return distance[a] < distance[b];
   });
+
+  reorder(order);
+  _sorted = true;
+}
+
+void
+UserDatabase::resetOrder() {
+  if (! _sorted)
+    return;
+
+  QVector<int> order(_user.size());
+  for (int i=0; i<_user.size(); i++)
+    order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [this](int a, int b){
+    return _user[a].id < _user[b].id;
+  });
+
+  reorder(order);
+  _sorted = false;
+}
+
+void
+UserDatabase::reorder(const QVector<int> &order) {
+  beginResetModel();
+  QVector<User> users; users.reserve(_user.size());
+  QVector<int> rows(_user.size());
+  for (int i=0; i<order.size(); i++) {
+    users.append(_user[order[i]]);
+    rows[order[i]] = i;
+  }
+  _user = users;
+  _index.remap(rows);
+  endResetModel();
 }
 
 void
@@ -170,7 +559,7 @@ UserDatabase::downloadFinished(QNetworkReply *reply) {
   file.flush();
   file.close();
 
-  load();
+  loadAsync();
   reply->deleteLater();
 }
 
@@ -234,3 +623,57 @@ UserDatabase::data(const QModelIndex &index, int role) const {
   return QVariant();
 }
 
+
+/* ********************************************************************************************* *
+ * Implementation of UserCompletionModel
+ * ********************************************************************************************* */
+UserCompletionModel::UserCompletionModel(UserDatabase *db, int limit, QObject *parent)
+  : QAbstractListModel(parent), _db(db), _limit(limit), _prefix(), _rows(), _text()
+{
+  connect(_db, SIGNAL(modelReset()), this, SLOT(onDatabaseReset()));
+}
+
+const QString &
+UserCompletionModel::prefix() const {
+  return _prefix;
+}
+
+const UserDatabase::User &
+UserCompletionModel::user(int row) const {
+  return _db->user(_rows[row]);
+}
+
+int
+UserCompletionModel::rowCount(const QModelIndex &parent) const {
+  if (parent.isValid())
+    return 0;
+  return _rows.size();
+}
+
+QVariant
+UserCompletionModel::data(const QModelIndex &index, int role) const {
+  if ((0 > index.row()) || (index.row() >= _rows.size()))
+    return QVariant();
+  if (Qt::DisplayRole == role)
+    return _text[index.row()];
+  if (Qt::EditRole == role)
+    return user(index.row()).call;
+  return QVariant();
+}
+
+void
+UserCompletionModel::setPrefix(const QString &prefix) {
+  beginResetModel();
+  _prefix = prefix;
+  _rows = _db->searchIndex().find(prefix, _limit);
+  // Only the matches get formatted
+  _text.clear();
+  foreach (int row, _rows)
+    _text.append(_db->data(_db->index(row, 0), Qt::DisplayRole).toString());
+  endResetModel();
+}
+
+void
+UserCompletionModel::onDatabaseReset() {
+  setPrefix(_prefix);
+}
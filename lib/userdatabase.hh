@@ -4,11 +4,14 @@
 #include <QObject>
 #include <QVector>
 #include <QHash>
+#include <QSet>
 #include <QJsonObject>
 #include <QNetworkAccessManager>
 #include <QAbstractTableModel>
+#include <QAbstractListModel>
 #include <QSortFilterProxyModel>
 #include <QGeoPositionInfoSource>
+#include <QThread>
 
 /** Auto-updating DMR user database.
  *
@@ -37,6 +40,8 @@ public:
 
     /** Returns the "distance" between this user and the given ID. */
     uint distance(uint id) const;
+    /** Returns a hash over the content (call, name, surname and country) of the entry. */
+    uint32_t hash() const;
 
 		/** The DMR ID of the user. */
 		uint id;
@@ -50,11 +55,116 @@ public:
 		QString country;
 	};
 
+	/** Represents the call-sign DB last written to a radio. That is, the IDs and content hashes of
+	 * all written entries together with the binary form of the encoded DB. */
+	class Snapshot {
+	public:
+		/** Empty constructor. */
+		Snapshot();
+
+		/** Returns @c true if the snapshot is empty. */
+		bool isEmpty() const;
+
+		/** Maps the ID of each entry to the hash of its content. */
+		QHash<uint, uint32_t> entries;
+		/** The address of the binary call-sign DB. */
+		uint32_t address;
+		/** The binary call-sign DB. */
+		QByteArray image;
+	};
+
+	/** Represents the difference between the user database and a snapshot. */
+	class Diff {
+	public:
+		/** Returns @c true if there are no differences. */
+		bool isEmpty() const;
+
+		/** IDs not present in the snapshot. */
+		QSet<uint> added;
+		/** IDs present in the snapshot only. */
+		QSet<uint> removed;
+		/** IDs present in both but with different content. */
+		QSet<uint> changed;
+	};
+
+	/** Search index over the users, answering prefix queries for call-signs, DMR IDs and names in
+	 * O(log n + k), where k is the number of results. The index refers to the users by their row
+	 * within the database. */
+	class Index {
+	public:
+		/** Empty constructor. */
+		Index();
+
+		/** (Re-)Builds the index for the given users. */
+		void build(const QVector<User> &users);
+		/** Updates the rows after the users were reordered, @c rows maps each old row to the new
+		 * one. */
+		void remap(const QVector<int> &rows);
+
+		/** Returns the rows of at most @c limit users whose call-sign starts with @c prefix
+		 * (case-insensitive), ordered by call-sign. */
+		QVector<int> findCall(const QString &prefix, int limit) const;
+		/** Returns the rows of at most @c limit users whose DMR ID starts with the given decimal
+		 * @c prefix. */
+		QVector<int> findId(const QString &prefix, int limit) const;
+		/** Returns the rows of at most @c limit users with a name or surname starting with
+		 * @c prefix (case-insensitive). */
+		QVector<int> findName(const QString &prefix, int limit) const;
+		/** Returns the rows of at most @c limit users matching the given prefix. A numeric prefix is
+		 * matched against the DMR IDs, all others against the call-signs first and the names
+		 * second. */
+		QVector<int> find(const QString &prefix, int limit) const;
+
+	protected:
+		/** Collects the rows of at most @c limit keys starting with @c prefix. */
+		static void collect(const QVector<QPair<QString, int>> &keys, const QString &prefix,
+		                    int limit, QVector<int> &rows);
+
+	protected:
+		/** Upper-case call-signs and rows ordered by call-sign. */
+		QVector<QPair<QString, int>> _calls;
+		/** Upper-case names and surname tokens and rows, ordered by token. */
+		QVector<QPair<QString, int>> _names;
+		/** DMR IDs and rows ordered by ID. */
+		QVector<QPair<uint, int>> _ids;
+	};
+
+protected:
+	/** Parses and sorts the user database in a separate thread. */
+	class Loader: public QThread
+	{
+	public:
+		/** Constructs a loader for the specified file. If @c update is @c true, the database gets
+		 * downloaded if the file cannot be loaded or is outdated. */
+		Loader(const QString &filename, bool update, QObject *parent=nullptr);
+
+	protected:
+		/** Parses the file. */
+		void run();
+
+	public:
+		/** The file to load. */
+		QString filename;
+		/** If @c true, update the database if it cannot be loaded or is outdated. */
+		bool update;
+		/** If @c true, the file was loaded successfully. */
+		bool ok;
+		/** The loaded users sorted by their ID. */
+		QVector<User> users;
+		/** The search index over the loaded users. */
+		Index index;
+		/** The error message, if the file cannot be loaded. */
+		QString errorMessage;
+	};
+
 public:
 	/** Constructs the user-database.
-	 * The constructor will download the current user database if it was not downloaded yet or
-	 * if the downloaded version is older than @c updatePeriodDays days. */
+	 * The constructor loads the downloaded user database in a separate thread (see @c isLoading).
+	 * It will download the current user database if it was not downloaded yet or if the
+	 * downloaded version is older than @c updatePeriodDays days. */
 	explicit UserDatabase(uint updatePeriodDays=30, QObject *parent=nullptr);
+	/** Destructor, waits for a running load to finish. */
+	virtual ~UserDatabase();
 
   /** Returns the number of users. */
   qint64 count() const;
@@ -63,12 +173,46 @@ public:
 	bool load();
 	/** Loads all entries from the downloaded user database at the specified location. */
 	bool load(const QString &filename);
+	/** Starts loading the entries from the downloaded user database in a separate thread.
+	 * The entries get published at once, when the load is complete. Then, the @c loaded signal
+	 * gets emitted. Returns @c false if there is already a load running. */
+	bool loadAsync();
+	/** Starts loading the entries from the downloaded user database at the specified location in a
+	 * separate thread. */
+	bool loadAsync(const QString &filename);
+	/** Returns @c true while the database is loaded in a separate thread. */
+	bool isLoading() const;
 
   /** Sorts users with respect to the distance to the given ID. */
   void sortUsers(uint id);
+  /** Restores the initial order of the users, that is, sorted by their ID. */
+  void resetOrder();
 
 	/** Returns the user with index @c idx. */
   const User &user(int idx) const;
+  /** Returns the search index over all users. */
+  const Index &searchIndex() const;
+
+  /** Returns a snapshot (without binary form) of the first @c n users. */
+  Snapshot snapshot(int n) const;
+  /** Computes the difference between the first @c n users and the given snapshot. */
+  Diff diff(const Snapshot &previous, int n) const;
+
+  /** Returns the snapshot of the call-sign DB last written to the specified device of the given
+   * radio model or an empty snapshot, if there is none. The @c device must identify the
+   * particular device (see @c RadioInterface::identity), if it is empty, there is no snapshot. */
+  Snapshot lastWritten(const QString &radio, const QString &device) const;
+  /** Stores the snapshot of the call-sign DB written to the specified device. Nothing is stored,
+   * if @c device is empty. */
+  bool setLastWritten(const QString &radio, const QString &device, const Snapshot &snapshot) const;
+  /** Removes the snapshot of the call-sign DB written to the specified device. This forces a
+   * complete re-encoding and upload of the call-sign DB. If @c device is empty, the snapshots of
+   * all devices of the given radio model are removed.
+   *
+   * Incremental uploads must call this before writing to the device. The DB on the device is
+   * inconsistent until the upload is complete, so a failed upload must not leave a snapshot
+   * behind that matches neither the old nor the new content. */
+  void clearLastWritten(const QString &radio, const QString &device=QString()) const;
 
 	/** Returns the age of the database in days. */
 	uint dbAge() const;
@@ -93,13 +237,82 @@ public slots:
 private slots:
 	/** Gets called whenever the download is complete. */
 	void downloadFinished(QNetworkReply *reply);
+	/** Gets called whenever a load in a separate thread is complete. */
+	void onLoaderFinished();
 
 private:
+	/** Parses and sorts the user database from the specified file. This function is thread-safe. */
+	static bool parse(const QString &filename, QVector<User> &users, QString &errorMessage);
+	/** Publishes the loaded users and their search index. */
+	void publish(const QVector<User> &users, const Index &index, const QString &filename);
+	/** Starts a loader for the specified file. */
+	bool startLoader(const QString &filename, bool update);
+	/** Reorders the users, such that the i-th user is the one previously at @c order[i]. */
+	void reorder(const QVector<int> &order);
+
+private:
+	/** The update period in days. */
+	uint                  _updatePeriod;
+	/** The running loader or @c nullptr. */
+	Loader               *_loader;
 	/** Holds all users sorted by their ID. */
 	QVector<User>         _user;
+	/** If @c true, the users got reordered by @c sortUsers. */
+	bool                  _sorted;
+	/** The search index over all users. */
+	Index                 _index;
 	/** The network access used for downloading. */
 	QNetworkAccessManager _network;
 };
 
 
+/** A small completion model over the user database.
+ *
+ * Instead of exposing all users to a @c QCompleter, this model holds only the (at most @c limit)
+ * users matching the current prefix, as found by the search index of the database. Hence a
+ * completer using this model should be set to @c QCompleter::UnfilteredPopupCompletion and the
+ * prefix should be updated whenever the completed text gets edited.
+ *
+ * @ingroup util */
+class UserCompletionModel : public QAbstractListModel
+{
+  Q_OBJECT
+
+public:
+  /** Constructs a completion model for the given database, holding at most @c limit matches. */
+  explicit UserCompletionModel(UserDatabase *db, int limit=50, QObject *parent=nullptr);
+
+  /** Returns the current prefix. */
+  const QString &prefix() const;
+  /** Returns the user at the given row. */
+  const UserDatabase::User &user(int row) const;
+
+  /** Implements the QAbstractListModel interface, returns the number of matches. */
+  int rowCount(const QModelIndex &parent=QModelIndex()) const;
+  /** Implements the QAbstractListModel interface, returns the call-sign (edit role) or a
+   * description of the match (display role). */
+  QVariant data(const QModelIndex &index, int role=Qt::DisplayRole) const;
+
+public slots:
+  /** Updates the matches for the given prefix. */
+  void setPrefix(const QString &prefix);
+
+private slots:
+  /** Re-evaluates the current prefix, once the database changed. */
+  void onDatabaseReset();
+
+protected:
+  /** The user database. */
+  UserDatabase *_db;
+  /** The maximum number of matches. */
+  int _limit;
+  /** The current prefix. */
+  QString _prefix;
+  /** The rows of the matching users within the database. */
+  QVector<int> _rows;
+  /** The display text of each match. */
+  QStringList _text;
+};
+
+
 #endif // USERDATABASE_HH
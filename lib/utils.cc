@@ -2,6 +2,13 @@
 #include <QRegExp>
 #include <QVector>
 #include <QHash>
+#include <QtEndian>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QVarLengthArray>
+#include <algorithm>
+#include <limits>
 #include <cmath>
 
 // Maps APRS icon number to code-char
@@ -144,35 +151,52 @@ encode_ascii(uint8_t *data, const QString &text, size_t size, uint16_t fill) {
   }
 }
 
+uint32_t
+decode_bcd8(uint32_t x) {
+  // Combine digit pairs, then digit quadruples and finally both halves
+  x = (x & 0x0f0f0f0fU) + ((x >>  4) & 0x0f0f0f0fU)*10;
+  x = (x & 0x00ff00ffU) + ((x >>  8) & 0x00ff00ffU)*100;
+  x = (x & 0x0000ffffU) + (x >> 16)*10000;
+  return x;
+}
+
+uint32_t
+encode_bcd8(uint32_t num) {
+  num %= 100000000U;
+  // Split into two 4-digit lanes, 32bit apart
+  uint64_t hi = num/10000, x = (hi << 32) | (num - hi*10000);
+  // Divide each lane by 100 (exact for < 43699), giving four 2-digit lanes, 16bit apart
+  uint64_t q = ((x*5243) >> 19) & 0x0000007f0000007fULL;
+  x = (q << 16) | (x - q*100);
+  // Divide each lane by 10 (exact for < 179), giving eight digits, 8bit apart
+  q = ((x*103) >> 10) & 0x000f000f000f000fULL;
+  x = (q << 8) | (x - q*10);
+  // Compact the digits into nibbles
+  x = (x | (x >>  4)) & 0x00ff00ff00ff00ffULL;
+  x = (x | (x >>  8)) & 0x0000ffff0000ffffULL;
+  x = (x | (x >> 16)) & 0x00000000ffffffffULL;
+  return uint32_t(x);
+}
+
 double
 decode_frequency(uint32_t bcd) {
-  double freq =
-      1e2  * ((bcd >> 28) & 0xf) +
-      1e1  * ((bcd >> 24) & 0xf) +
-      1.0  * ((bcd >> 20) & 0xf) +
-      1e-1 * ((bcd >> 16) & 0xf) +
-      1e-2 * ((bcd >> 12) & 0xf) +
-      1e-3 * ((bcd >>  8) & 0xf) +
-      1e-4 * ((bcd >>  4) & 0xf) +
-      1e-5 * ((bcd >>  0) & 0xf);
-  return freq;
+  return hz2mhz(decode_frequency_hz(bcd));
 }
 
 uint32_t
 encode_frequency(double freq) {
-  uint32_t hz = std::round(freq * 1e6);
-  uint32_t a  = (hz / 100000000) % 10;
-  uint32_t b  = (hz /  10000000) % 10;
-  uint32_t c  = (hz /   1000000) % 10;
-  uint32_t d  = (hz /    100000) % 10;
-  uint32_t e  = (hz /     10000) % 10;
-  uint32_t f  = (hz /      1000) % 10;
-  uint32_t g  = (hz /       100) % 10;
-  uint32_t h  = (hz /        10) % 10;
+  return encode_frequency_hz(mhz2hz(freq));
+}
 
-  return (a << 28) + (b << 24) + (c << 20) + (d << 16) + (e << 12) + (f << 8) + (g << 4) + h;
+Frequency
+decode_frequency_hz(uint32_t bcd) {
+  return Frequency(decode_bcd8(bcd))*10;
 }
 
+uint32_t
+encode_frequency_hz(Frequency hz) {
+  return encode_bcd8(uint32_t(hz/10));
+}
 
 uint32_t decode_dmr_id_bin(const uint8_t *id) {
   return ( (id[0]) | (id[1] << 8) | (id[2] << 16) );
@@ -186,39 +210,19 @@ void encode_dmr_id_bin(uint8_t *id, uint32_t no) {
 
 
 uint32_t decode_dmr_id_bcd(const uint8_t *id) {
-  return ((id[0] >> 4) * 10000000
-      + (id[0] & 15) * 1000000
-      + (id[1] >> 4) * 100000
-      + (id[1] & 15) * 10000
-      + (id[2] >> 4) * 1000
-      + (id[2] & 15) * 100
-      + (id[3] >> 4) * 10
-      + (id[3] & 15));
+  return decode_bcd8(qFromBigEndian<quint32>(id));
 }
 
 uint32_t decode_dmr_id_bcd_le(const uint8_t *id) {
-  return ((id[3] >> 4) * 10000000
-      + (id[3] & 15) * 1000000
-      + (id[2] >> 4) * 100000
-      + (id[2] & 15) * 10000
-      + (id[1] >> 4) * 1000
-      + (id[1] & 15) * 100
-      + (id[0] >> 4) * 10
-      + (id[0] & 15));
+  return decode_bcd8(qFromLittleEndian<quint32>(id));
 }
 
 void encode_dmr_id_bcd(uint8_t *id, uint32_t no) {
-  id[0] = ((no / 10000000) << 4)    | ((no / 1000000) % 10);
-  id[1] = ((no / 100000 % 10) << 4) | ((no / 10000) % 10);
-  id[2] = ((no / 1000 % 10) << 4)   | ((no / 100) % 10);
-  id[3] = ((no / 10 % 10) << 4)     | (no % 10);
+  qToBigEndian<quint32>(encode_bcd8(no), id);
 }
 
 void encode_dmr_id_bcd_le(uint8_t *id, uint32_t no) {
-  id[3] = ((no / 10000000) << 4)    | ((no / 1000000) % 10);
-  id[2] = ((no / 100000 % 10) << 4) | ((no / 10000) % 10);
-  id[1] = ((no / 1000 % 10) << 4)   | ((no / 100) % 10);
-  id[0] = ((no / 10 % 10) << 4)     | (no % 10);
+  qToLittleEndian<quint32>(encode_bcd8(no), id);
 }
 
 QVector<char> bin_dtmf_tab = {'0','1','2','3','4','5','6','7','8','9','A','B','C','D','*','#'};
@@ -271,7 +275,7 @@ decode_ctcss_tone_table(uint16_t data) {
   }
 
   // CTCSS
-  return Signaling::fromCTCSSFrequency(100.0*a+10.0*b+1.0*c+0.1*d);
+  return Signaling::fromCTCSSDeciHz(1000*a+100*b+10*c+1*d);
 }
 
 
@@ -287,7 +291,7 @@ encode_ctcss_tone_table(Signaling::Code code)
   if (Signaling::isCTCSS(code)) {
     // CTCSS tone
     tag = 0;
-    unsigned val = Signaling::toCTCSSFrequency(code) * 10.0 + 0.5;
+    unsigned val = Signaling::toCTCSSDeciHz(code);
     a = val / 1000;
     b = (val / 100) % 10;
     c = (val / 10) % 10;
@@ -349,6 +353,57 @@ format_frequency(double MHz) {
   return QString::number(MHz, 'f', 5);
 }
 
+QString
+format_frequency_hz(Frequency hz) {
+  bool negative = (hz < 0);
+  if (negative)
+    hz = -hz;
+  // round to 10Hz
+  hz = (hz+5)/10;
+  return QString("%1%2.%3").arg(negative ? "-" : "").arg(hz/100000).arg(hz%100000, 5, 10, QChar('0'));
+}
+
+bool
+parse_frequency_hz(const QString &text, Frequency &hz) {
+  QString number = text.trimmed();
+  bool negative = false;
+  if (number.startsWith('+') || number.startsWith('-')) {
+    negative = number.startsWith('-');
+    number.remove(0, 1);
+  }
+
+  int dot = number.indexOf('.');
+  QString integer = (0 > dot) ? number : number.left(dot);
+  QString fraction = (0 > dot) ? QString() : number.mid(dot+1);
+  if (integer.isEmpty() && fraction.isEmpty())
+    return false;
+
+  Frequency value = 0;
+  for (int i=0; i<integer.size(); i++) {
+    if (! integer.at(i).isDigit())
+      return false;
+    value = value*10 + integer.at(i).digitValue();
+  }
+  // Fraction down to Hz, round at the 7th digit
+  for (int i=0; i<6; i++) {
+    value *= 10;
+    if (i >= fraction.size())
+      continue;
+    if (! fraction.at(i).isDigit())
+      return false;
+    value += fraction.at(i).digitValue();
+  }
+  for (int i=6; i<fraction.size(); i++) {
+    if (! fraction.at(i).isDigit())
+      return false;
+  }
+  if ((6 < fraction.size()) && (5 <= fraction.at(6).digitValue()))
+    value++;
+
+  hz = negative ? -value : value;
+  return true;
+}
+
 QString
 aprsicon2name(APRSSystem::Icon icon) {
   if ((APRSSystem::APRS_ICON_NO_SYMBOL == icon) || (! aprsIconCodeTable.contains(icon)))
@@ -356,19 +411,96 @@ aprsicon2name(APRSSystem::Icon icon) {
   return QString("\"%1\"").arg(aprsIconNameTable.value(icon));
 }
 
+/// @cond with_internal_docs
+/** An entry of the index of APRS icon names. */
+typedef QPair<QString, APRSSystem::Icon> AprsIconIndexEntry;
+
+/** Returns the index of all APRS icon names, sorted ignoring the case. The index gets built once
+ * and is read-only afterwards. */
+static const QVector<AprsIconIndexEntry> &
+aprsIconIndex() {
+  static const QVector<AprsIconIndexEntry> index = [] () {
+    QVector<AprsIconIndexEntry> entries;
+    QHash<APRSSystem::Icon, QString>::const_iterator item=aprsIconNameTable.constBegin();
+    for (; item != aprsIconNameTable.constEnd(); item++) {
+      if (! item.value().isEmpty())
+        entries.append(AprsIconIndexEntry(item.value(), item.key()));
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const AprsIconIndexEntry &a, const AprsIconIndexEntry &b) {
+      return 0 > QString::compare(a.first, b.first, Qt::CaseInsensitive);
+    });
+    return entries;
+  }();
+  return index;
+}
+
+/** Computes the Levenshtein distance like @c levDist but stops as soon as the distance reaches
+ * @c bound. In this case, a value of at least @c bound is returned. Short strings are compared
+ * without allocation. */
+static int
+levDistBounded(const QString &source, const QString &target, int bound,
+               Qt::CaseSensitivity cs)
+{
+  if (source.size() > target.size())
+    return levDistBounded(target, source, bound, cs);
+
+  const int sourceCount = source.size();
+  const int targetCount = target.size();
+  if ((targetCount-sourceCount) >= bound)
+    return bound;
+  if (0 == sourceCount)
+    return targetCount;
+
+  QVarLengthArray<int, 128> buffer(2*(targetCount+1));
+  int *previousColumn = buffer.data(), *column = buffer.data()+targetCount+1;
+  for (int j=0; j<=targetCount; j++)
+    previousColumn[j] = j;
+
+  for (int i=0; i<sourceCount; i++) {
+    QChar a = (Qt::CaseInsensitive == cs) ? source.at(i).toCaseFolded() : source.at(i);
+    column[0] = i+1;
+    int rowMin = column[0];
+    for (int j=0; j<targetCount; j++) {
+      QChar b = (Qt::CaseInsensitive == cs) ? target.at(j).toCaseFolded() : target.at(j);
+      column[j+1] = std::min({1 + column[j], 1 + previousColumn[j+1],
+                              previousColumn[j] + ((a == b) ? 0 : 1)});
+      rowMin = std::min(rowMin, column[j+1]);
+    }
+    // The distance cannot become smaller than the minimum of the current row
+    if (rowMin >= bound)
+      return bound;
+    std::swap(column, previousColumn);
+  }
+
+  return previousColumn[targetCount];
+}
+/// @endcond
+
 APRSSystem::Icon
 name2aprsicon(const QString &name) {
   if (name.isEmpty())
     return APRSSystem::APRS_ICON_NO_SYMBOL;
 
-  APRSSystem::Icon icon = APRSSystem::APRS_ICON_NO_SYMBOL;
-  int best = levDist(name, "");
+  const QVector<AprsIconIndexEntry> &index = aprsIconIndex();
+
+  // Fast path: exact match ignoring case
+  QVector<AprsIconIndexEntry>::const_iterator item = std::lower_bound(
+        index.constBegin(), index.constEnd(), name,
+        [](const AprsIconIndexEntry &entry, const QString &key) {
+    return 0 > QString::compare(entry.first, key, Qt::CaseInsensitive);
+  });
+  if ((index.constEnd() != item) &&
+      (0 == QString::compare(item->first, name, Qt::CaseInsensitive)))
+    return item->second;
 
-  QHash<APRSSystem::Icon, QString>::const_iterator item=aprsIconNameTable.constBegin();
-  for(; item != aprsIconNameTable.constEnd(); item++) {
-    int dist = levDist(name, item.value());
+  // Otherwise find the closest name. Distances exceeding the best match are not computed.
+  APRSSystem::Icon icon = APRSSystem::APRS_ICON_NO_SYMBOL;
+  int best = name.size();
+  foreach (const AprsIconIndexEntry &entry, index) {
+    int dist = levDistBounded(name, entry.first, best, Qt::CaseInsensitive);
     if (dist < best) {
-      icon = item.key();
+      icon = entry.second;
       best = dist;
     }
   }
@@ -408,45 +540,7 @@ code2aprsicon(char table, char icon) {
 
 int
 levDist(const QString &source, const QString &target, Qt::CaseSensitivity cs) {
-  // Mostly stolen from https://qgis.org/api/2.14/qgsstringutils_8cpp_source.html
-
-  if (0 == QString::compare(source,target, cs)) {
-    return 0;
-  }
-
-  const int sourceCount = source.count();
-  const int targetCount = target.count();
-
-  if (source.isEmpty())
-    return targetCount;
-  if (target.isEmpty())
-    return sourceCount;
-  if (sourceCount > targetCount)
-    return levDist(target, source, cs);
-
-
-  QVector<int> column;
-  column.fill(0, targetCount + 1);
-
-  QVector<int> previousColumn;
-  previousColumn.reserve(targetCount + 1);
-  for (int i = 0; i < targetCount + 1; i++)
-    previousColumn.append(i);
-
-  for (int i = 0; i < sourceCount; i++) {
-    column[0] = i + 1;
-    for (int j = 0; j < targetCount; j++) {
-      column[j + 1] = std::min(
-      {
-              1 + column.at(j),
-              1 + previousColumn.at(1 + j),
-              previousColumn.at(j) + (QString::compare(source.at(i),target.at(j), cs) ? 1 : 0)
-            });
-    }
-    column.swap(previousColumn);
-  }
-
-  return previousColumn.at(targetCount);
+  return levDistBounded(source, target, std::numeric_limits<int>::max(), cs);
 }
 
 uint32_t
@@ -462,3 +556,59 @@ align_addr(uint32_t addr, uint32_t block) {
     return addr;
   return (addr - (addr%block));
 }
+
+
+/** Processes a chunk of a @c parallel_for loop within the thread pool. The chunk is owned by the
+ * @c parallel_for call, as it may also be taken back from the pool and processed by the caller. */
+class ParallelForChunk: public QRunnable
+{
+public:
+  ParallelForChunk(const std::function<void(int)> &func, int start, int end, QSemaphore &done)
+    : QRunnable(), _func(func), _start(start), _end(end), _done(done)
+  {
+    setAutoDelete(false);
+  }
+
+  void run() {
+    for (int i=_start; i<_end; i++)
+      _func(i);
+    _done.release();
+  }
+
+protected:
+  const std::function<void(int)> &_func;
+  int _start, _end;
+  QSemaphore &_done;
+};
+
+void
+parallel_for(int n, const std::function<void(int)> &func, int minChunk) {
+  if (0 >= n)
+    return;
+
+  QThreadPool *pool = QThreadPool::globalInstance();
+  int nchunks = qMin(qMax(1, pool->maxThreadCount()), qMax(1, n/qMax(1, minChunk)));
+  if (1 == nchunks) {
+    for (int i=0; i<n; i++)
+      func(i);
+    return;
+  }
+
+  int chunk = (n+nchunks-1)/nchunks;
+  QSemaphore done(0);
+  QVector<ParallelForChunk *> chunks;
+  for (int c=1; c<nchunks; c++) {
+    chunks.append(new ParallelForChunk(func, qMin(n, c*chunk), qMin(n, (c+1)*chunk), done));
+    pool->start(chunks.back());
+  }
+  for (int i=0; i<chunk; i++)
+    func(i);
+  // Chunks not yet started by the pool are processed here. Otherwise, a call from within a pool
+  // thread may wait for chunks that never start, as all pool threads are waiting too.
+  foreach (ParallelForChunk *c, chunks) {
+    if (pool->tryTake(c))
+      c->run();
+  }
+  done.acquire(chunks.size());
+  qDeleteAll(chunks);
+}
@@ -8,9 +8,11 @@
 
 #include <QString>
 #include <inttypes.h>
+#include <functional>
 
 #include "signaling.hh"
 #include "gpssystem.hh"
+#include "frequency.hh"
 
 /** Decodes the unicode string stored in @c data of size @c size. The @c fill code also defines the
  * end-of-string symbol.
@@ -27,10 +29,21 @@ QString decode_ascii(const uint8_t *data, size_t size, uint16_t fill=0x00);
  * @c fill word as fill and end-of-string word. */
 void encode_ascii(uint8_t *data, const QString &text, size_t size, uint16_t fill=0x00);
 
+/** Unpacks an 8 digit BCD number into its binary representation. This kernel is branch free,
+ * it combines the digits pairwise within the 32bit word. */
+uint32_t decode_bcd8(uint32_t bcd);
+/** Packs the given number (modulo 10^8) as an 8 digit BCD number. This kernel is branch free,
+ * it splits the number into its digits within a 64bit word. */
+uint32_t encode_bcd8(uint32_t num);
+
 /** Decodes an 8 digit BCD encoded frequency (in MHz). */
 double decode_frequency(uint32_t bcd);
 /** Eecodes an 8 digit BCD encoded frequency (in MHz). */
 uint32_t encode_frequency(double freq);
+/** Decodes an 8 digit BCD encoded frequency (in 10Hz) to Hz. */
+Frequency decode_frequency_hz(uint32_t bcd);
+/** Encodes the given frequency in Hz as an 8 digit BCD (in 10Hz). */
+uint32_t encode_frequency_hz(Frequency hz);
 
 /** Decodes binary (24bit) encoded DMR ID. */
 uint32_t decode_dmr_id_bin(const uint8_t *id);
@@ -66,6 +79,11 @@ bool validDTMFNumber(const QString &text);
 
 /** Formats a frequency in MHz passed as double. */
 QString format_frequency(double MHz);
+/** Formats a frequency passed in Hz as MHz, like @c format_frequency. */
+QString format_frequency_hz(Frequency hz);
+/** Parses a frequency (or offset) given in MHz like "439.5625" or "-7.6" exactly into Hz.
+ * Returns @c false if the text is not a valid number. */
+bool parse_frequency_hz(const QString &text, Frequency &hz);
 
 QString aprsicon2name(APRSSystem::Icon icon);
 APRSSystem::Icon name2aprsicon(const QString &name);
@@ -84,4 +102,11 @@ uint32_t align_size(uint32_t size, uint32_t block);
 /** Decreases the address to be aligned with the given block size. */
 uint32_t align_addr(uint32_t addr, uint32_t block);
 
+/** Calls @c func(i) for every @c i in [0, n) using the global thread pool and blocks until all
+ * calls returned. The range is split into chunks of at least @c minChunk items, the first chunk
+ * is processed by the calling thread, as well as all chunks the pool has not started yet. Hence
+ * it may be called from within a pool thread, e.g., nested. As @c func is called from several
+ * threads, it must not create any QObject that outlives the call nor modify shared state. */
+void parallel_for(int n, const std::function<void(int)> &func, int minChunk=64);
+
 #endif // UTILS_HH
@@ -2,8 +2,10 @@
 #include "config.hh"
 #include "logger.hh"
 #include "utils.hh"
+#include "uploadjournal.hh"
 
 #define BSIZE 1024
+#define SECTOR_SIZE 0x10000  // Size of the smallest erasable flash sector
 
 static Radio::Features _uv390_features =
 {
@@ -55,7 +57,8 @@ static Radio::Features _uv390_features =
 
 
 UV390::UV390(QObject *parent)
-  : Radio(parent), _name("TYT MD-UV390"), _dev(nullptr), _codeplugFlags(), _config(nullptr)
+  : Radio(parent), _name("TYT MD-UV390"), _dev(nullptr), _codeplugFlags(), _config(nullptr),
+    _userDB(nullptr)
 {
   // pass...
 }
@@ -101,7 +104,7 @@ UV390::startUpload(Config *config, bool blocking, const CodePlug::Flags &flags)
   if (StatusIdle != _task)
     return false;
 
-  if (! (_config = config))
+  if (! takeSnapshot(config))
     return false;
 
   _task = StatusUpload;
@@ -120,7 +123,8 @@ UV390::startUploadCallsignDB(UserDatabase *db, bool blocking) {
   if (StatusIdle != _task)
     return false;
 
-  _callsigns.encode(db);
+  // The call-sign DB gets encoded within the radio thread, once the device is known
+  _userDB = db;
 
   _task = StatusUploadCallsigns;
   if (blocking) {
@@ -177,16 +181,17 @@ UV390::download() {
     totb += _codeplug.image(0).element(n).data().size()/BSIZE;
   }
 
-  // Then download codeplug
+  // Then download codeplug, using the largest transfers the device supports
+  uint nt = std::max(1U, _dev->transferSize()/BSIZE);
   size_t bcount = 0;
   for (int n=0; n<_codeplug.image(0).numElements(); n++) {
     uint addr = _codeplug.image(0).element(n).address();
     uint size = _codeplug.image(0).element(n).data().size();
     uint b0 = addr/BSIZE, nb = size/BSIZE;
-    for (uint b=0; b<nb; b++, bcount++) {
-      if (! _dev->read(0, (b0+b)*BSIZE, _codeplug.data((b0+b)*BSIZE), BSIZE)) {
+    for (uint b=0, k=std::min(nt, nb); b<nb; b+=k, bcount+=k, k=std::min(nt, nb-b)) {
+      if (cancelRequested() || (! _dev->read(0, (b0+b)*BSIZE, _codeplug.data((b0+b)*BSIZE), k*BSIZE))) {
         _errorMessage = QString("%1 Cannot download codeplug: %2").arg(__func__)
-            .arg(_dev->errorMessage());
+            .arg(transferError(_dev));
         logError() << _errorMessage;
         _task = StatusError;
         _dev->reboot();
@@ -195,7 +200,7 @@ UV390::download() {
         emit downloadError(this);
         return;
       }
-      emit downloadProgress(float(bcount*100)/totb);
+      setProgress(float(bcount*100)/totb, k*BSIZE);
     }
   }
 
@@ -211,6 +216,10 @@ void
 UV390::upload() {
   emit uploadStarted();
 
+  SnapshotGuard snapshot(this, _config);
+  if (snapshot.isNull())
+    return;
+
   _dev = new DFUDevice(0x0483, 0xdf11, this);
   if (!_dev->isOpen()) {
     _errorMessage = QString("Cannot open device at 0483:DF11: %1").arg(_dev->errorMessage());
@@ -236,16 +245,23 @@ UV390::upload() {
   size_t totb = _codeplug.memSize();
 
   size_t bcount = 0;
-  // If codeplug gets updated, download codeplug from device first:
+  // If codeplug gets updated, download codeplug from device first. Blocks completely
+  // overwritten by the encoder are skipped.
   if (_codeplugFlags.updateCodePlug) {
+    QVector<CodePlug::PagedImage::Run> overwritten = _codeplug.overwriteMap(_config);
+    uint skipped = 0;
     for (int n=0; n<_codeplug.image(0).numElements(); n++) {
       uint addr = _codeplug.image(0).element(n).address();
       uint size = _codeplug.image(0).element(n).data().size();
       uint b0 = addr/BSIZE, nb = size/BSIZE;
       for (uint b=0; b<nb; b++, bcount+=BSIZE) {
-        if (! _dev->read(0, (b0+b)*BSIZE, _codeplug.data((b0+b)*BSIZE), BSIZE)) {
+        if (CodePlug::isOverwritten(overwritten, (b0+b)*BSIZE, BSIZE)) {
+          skipped++;
+          continue;
+        }
+        if (cancelRequested() || (! _dev->read(0, (b0+b)*BSIZE, _codeplug.data((b0+b)*BSIZE), BSIZE))) {
           _errorMessage = QString("%1 Cannot upload codeplug: %2").arg(__func__)
-              .arg(_dev->errorMessage());
+              .arg(transferError(_dev));
           logError() << _errorMessage;
           _task = StatusError;
           _dev->reboot();
@@ -254,9 +270,10 @@ UV390::upload() {
           emit downloadError(this);
           return;
         }
-        emit uploadProgress(float(bcount*50)/totb);
+        setProgress(float(bcount*50)/totb, BSIZE);
       }
     }
+    logDebug() << "Skipped reading " << skipped << " blocks overwritten by the encoder.";
   }
 
   // Encode config into codeplug
@@ -269,15 +286,16 @@ UV390::upload() {
 
   logDebug() << "Upload " << _codeplug.image(0).numElements() << " elements.";
   // then, upload modified codeplug
+  uint nt = std::max(1U, _dev->transferSize()/BSIZE);
   bcount = 0;
   for (int n=0; n<_codeplug.image(0).numElements(); n++) {
     uint addr = _codeplug.image(0).element(n).address();
     uint size = _codeplug.image(0).element(n).memSize();
     uint b0 = addr/BSIZE, nb = size/BSIZE;
-    for (size_t b=0; b<nb; b++,bcount+=BSIZE) {
-      if (! _dev->write(0, (b0+b)*BSIZE, _codeplug.data((b0+b)*BSIZE), BSIZE)) {
+    for (uint b=0, k=std::min(nt, nb); b<nb; b+=k, bcount+=k*BSIZE, k=std::min(nt, nb-b)) {
+      if (cancelRequested() || (! _dev->write(0, (b0+b)*BSIZE, _codeplug.data((b0+b)*BSIZE), k*BSIZE))) {
         _errorMessage = QString("%1 Cannot upload codeplug: %2").arg(__func__)
-            .arg(_dev->errorMessage());
+            .arg(transferError(_dev));
         logError() << _errorMessage;
         _task = StatusError;
         _dev->reboot();
@@ -286,7 +304,7 @@ UV390::upload() {
         emit uploadError(this);
         return;
       }
-      emit uploadProgress(50+float(bcount*50)/totb);
+      setProgress(50+float(bcount*50)/totb, k*BSIZE);
     }
   }
 
@@ -311,6 +329,16 @@ UV390::uploadCallsigns() {
     return;
   }
 
+  // Only re-encode entries that differ from the DB last written to this particular device, if it
+  // is still present on the device.
+  QString device = _dev->identity();
+  UserDatabase::Snapshot previous = _userDB->lastWritten(name(), device);
+  if ((! previous.isEmpty()) && (! isOnDevice(_dev, 0, previous.address, previous.image, BSIZE))) {
+    logInfo() << "Call-sign DB on the device differs from the one last written, upload all.";
+    previous = UserDatabase::Snapshot();
+  }
+  _callsigns.encode(_userDB, previous);
+
   logDebug() << "Check alignment.";
   // Check alignment in the codeplug
   if (! _callsigns.isAligned(BSIZE)) {
@@ -324,23 +352,63 @@ UV390::uploadCallsigns() {
     return;
   }
 
-  // then erase memory
-  logDebug() << "Erase memory section for call-sign DB.";
-  _dev->erase(_callsigns.image(0).element(0).address(),
-              _callsigns.image(0).element(0).memSize(),
-              [](uint percent, void *ctx) { emit ((UV390 *)ctx)->uploadProgress(percent/2); }, this);
-
-  logDebug() << "Upload " << _callsigns.image(0).numElements() << " elements.";
-  // Total amount of data to transfer
-  size_t totb = _callsigns.memSize();
-  // Upload callsign DB
+  // Collect all sectors containing modified blocks. Each of these sectors gets erased and
+  // re-written completely.
   uint addr = _callsigns.image(0).element(0).address();
   uint size = _callsigns.image(0).element(0).memSize();
-  uint b0 = addr/BSIZE, nb = size/BSIZE;
-  for (size_t b=0, bcount=0; b<nb; b++,bcount+=BSIZE) {
-    if (! _dev->write(0, (b0+b)*BSIZE, _callsigns.data((b0+b)*BSIZE), BSIZE)) {
-      _errorMessage = QString("%1 Cannot upload codeplug: %2").arg(__func__)
-          .arg(_dev->errorMessage());
+  QVector<uint> sectors;
+  for (uint s=align_addr(addr, SECTOR_SIZE); s<(addr+size); s+=SECTOR_SIZE) {
+    for (uint b=std::max(s, addr); b<std::min(s+SECTOR_SIZE, addr+size); b+=BSIZE) {
+      if (_callsigns.isDirty(b)) {
+        sectors.append(s);
+        break;
+      }
+    }
+  }
+  logDebug() << "Update " << sectors.size() << " of " << align_size(size, SECTOR_SIZE)/SECTOR_SIZE
+             << " sectors of the call-sign DB.";
+
+  // Force a complete upload next time, if this one fails, see UserDatabase::clearLastWritten()
+  _userDB->clearLastWritten(name(), device);
+
+  // Resume a previous, failed upload of the same DB to this device. Sectors confirmed by the
+  // journal are read back and skipped if their content matches.
+  UploadJournal journal(name()+" call-sign DB", _dev->identity());
+  journal.open(UploadJournal::hash(_callsigns.image(0)));
+  if (journal.isResumable()) {
+    QByteArray buffer(SECTOR_SIZE, 0);
+    uint skipped = 0;
+    for (int i=0; i<sectors.size(); i++) {
+      uint s = sectors[i], b0 = std::max(s, addr), b1 = std::min(s+SECTOR_SIZE, addr+size);
+      if (! journal.isConfirmed(s, UploadJournal::crc(_callsigns.data(b0), b1-b0)))
+        continue;
+      bool ok = _dev->read(0, b0, (uint8_t *)buffer.data(), b1-b0);
+      if (ok && (UploadJournal::crc((uint8_t *)buffer.data(), b1-b0)
+                 == UploadJournal::crc(_callsigns.data(b0), b1-b0))) {
+        skipped++;
+        continue;
+      }
+      journal.reject(s);
+    }
+    logInfo() << "Resume upload of call-sign DB, " << skipped << " of " << sectors.size()
+              << " sectors already written.";
+  }
+  journal.begin();
+
+  // Erase and upload modified sectors
+  for (int i=0; i<sectors.size(); i++) {
+    uint s = sectors[i], b0 = std::max(s, addr), b1 = std::min(s+SECTOR_SIZE, addr+size);
+    uint32_t crc = UploadJournal::crc(_callsigns.data(b0), b1-b0);
+    if (journal.isConfirmed(s, crc)) {
+      setProgress(float((i+1)*100)/sectors.size());
+      continue;
+    }
+    // The device splits the sector into the largest transfers it supports
+    bool ok = (! cancelRequested()) && _dev->erase(s, SECTOR_SIZE)
+        && _dev->write(0, b0, _callsigns.data(b0), b1-b0);
+    if (! ok) {
+      _errorMessage = QString("%1 Cannot upload call-sign DB: %2").arg(__func__)
+          .arg(transferError(_dev));
       logError() << _errorMessage;
       _task = StatusError;
       _dev->reboot();
@@ -349,9 +417,14 @@ UV390::uploadCallsigns() {
       emit uploadError(this);
       return;
     }
-    emit uploadProgress(50+float(bcount*50)/totb);
+    journal.confirm(s, crc);
+    setProgress(float((i+1)*100)/sectors.size(), b1-b0);
   }
 
+  // Remember what was written to the device
+  journal.finish();
+  _userDB->setLastWritten(name(), device, _callsigns.snapshot());
+
   _task = StatusIdle;
   _dev->reboot();
   _dev->close();
@@ -1,10 +1,13 @@
 #include "uv390_callsigndb.hh"
 #include "utils.hh"
+#include "logger.hh"
 #include <QtEndian>
 
 #define MAX_CALLSIGNS    0x0001dd55  // Maximum number of callsings in DB
 #define CALLSIGN_START   0x00200000  // Start of callsign database
 #define CALLSIGN_OFFSET  0x00204003  // Start of callsign entries
+#define INDEX_SIZE       0x00004003  // Size of the number of entries and index
+#define BLOCK_SIZE       0x00000400  // Size of the blocks written to the device
 
 
 /* ******************************************************************************************** *
@@ -91,6 +94,11 @@ UV390CallsignDB::callsign_db_t::clear() {
     index[i].clear();
 }
 
+uint
+UV390CallsignDB::callsign_db_t::getN() const {
+  return (uint(n[0])<<16) | (uint(n[1])<<8) | uint(n[2]);
+}
+
 void
 UV390CallsignDB::callsign_db_t::setN(uint N) {
   n[0] = (N>>16)&0xff; n[1] = (N>>8)&0xff; n[2] = (N>>0)&0xff;
@@ -102,7 +110,6 @@ UV390CallsignDB::callsign_db_t::fromUserDB(const UserDatabase *db) {
   clear();
   // Limit users to MAX_CALLSIGNS entries
   uint N = std::min(qint64(MAX_CALLSIGNS), db->count());
-  setN(N);
 
   // If there are no entries -> done.
   if (0 == N)
@@ -115,14 +122,32 @@ UV390CallsignDB::callsign_db_t::fromUserDB(const UserDatabase *db) {
   std::sort(users.begin(), users.end(),
             [](const UserDatabase::User &a, const UserDatabase::User &b) { return a.id < b.id; });
 
+  // Update index
+  encodeIndex(users);
+
+  // Store users
+  for (uint i=0; i<N; i++)
+    this->db[i].fromUser(users[i]);
+}
+
+void
+UV390CallsignDB::callsign_db_t::encodeIndex(const QVector<UserDatabase::User> &users) {
+  memset(n, 0, sizeof(n));
+  for (int i=0; i<4096; i++)
+    index[i].clear();
+  setN(users.size());
+
+  // If there are no entries -> done.
+  if (users.isEmpty())
+    return;
+
   // First index entry
   int  j = 0;
   this->index[j++].set(users[0].id, 1);
   uint cidh = (users[0].id >> 12);
 
-  // Store users and update index
-  for (uint i=0; i<N; i++) {
-    this->db[i].fromUser(users[i]);
+  // Update index
+  for (int i=0; i<users.size(); i++) {
     uint idh = (users[i].id >> 12);
     if (idh != cidh) {
       this->index[j++].set(users[i].id, i+1);
@@ -144,15 +169,90 @@ UV390CallsignDB::UV390CallsignDB(QObject *parent)
 
 void
 UV390CallsignDB::encode(UserDatabase *db) {
+  encode(db, UserDatabase::Snapshot());
+}
+
+void
+UV390CallsignDB::encode(UserDatabase *db, const UserDatabase::Snapshot &previous) {
   // Determine size of call-sign DB in memory
   qint64 n = std::min(db->count(), qint64(MAX_CALLSIGNS));
-  qint64 size = align_size(0x4003 + 120*n, 1024);
+  qint64 size = align_size(INDEX_SIZE + 120*n, BLOCK_SIZE);
+
+  _entries = db->snapshot(n).entries;
+  _dirty.clear();
 
   // allocate & clear memory
   if (0 == image(0).numElements())
     this->image(0).addElement(CALLSIGN_START, size);
+  else
+    this->image(0).element(0).data().resize(size);
   memset(data(CALLSIGN_START), 0xff, size);
+  callsign_db_t *cdb = (callsign_db_t *)data(CALLSIGN_START);
+
+  // Encode complete call-sign DB, if there is no previous one
+  if (previous.isEmpty() || (CALLSIGN_START != previous.address)) {
+    cdb->fromUserDB(db);
+    markDirty(CALLSIGN_START, size);
+    return;
+  }
+
+  // Otherwise, start with the DB last written to the device
+  memcpy(data(CALLSIGN_START), previous.image.constData(), std::min(size, qint64(previous.image.size())));
+  uint prevN = cdb->getN();
+  UserDatabase::Diff diff = db->diff(previous, n);
+  logDebug() << "Update call-sign DB: " << diff.added.size() << " added, "
+             << diff.removed.size() << " removed, " << diff.changed.size() << " changed.";
+
+  // Select n users and sort them in ascending order of their IDs
+  QVector<UserDatabase::User> users;
+  for (qint64 i=0; i<n; i++)
+    users.append(db->user(i));
+  std::sort(users.begin(), users.end(),
+            [](const UserDatabase::User &a, const UserDatabase::User &b) { return a.id < b.id; });
+
+  // Update index, only modified blocks are written
+  QByteArray oldIndex((const char *)cdb, INDEX_SIZE);
+  cdb->encodeIndex(users);
+  for (uint32_t o=0; o<INDEX_SIZE; o+=BLOCK_SIZE) {
+    uint32_t len = std::min(uint32_t(BLOCK_SIZE), INDEX_SIZE-o);
+    if (memcmp(oldIndex.constData()+o, ((const char *)cdb)+o, len))
+      markDirty(CALLSIGN_START+o, len);
+  }
+
+  // Re-encode only those entries that were moved or changed
+  for (qint64 i=0; i<n; i++) {
+    callsign_db_t::callsign_t &entry = cdb->db[i];
+    if (entry.isValid() && (entry.dmrid == users[i].id) && (! diff.changed.contains(users[i].id)))
+      continue;
+    entry.fromUser(users[i]);
+    markDirty(CALLSIGN_START+INDEX_SIZE+120*i, 120);
+  }
+
+  // Clear remaining entries of the previous DB
+  for (qint64 i=n; (i<prevN) && ((INDEX_SIZE+120*(i+1))<=size); i++) {
+    cdb->db[i].clear();
+    markDirty(CALLSIGN_START+INDEX_SIZE+120*i, 120);
+  }
+}
 
-  // Encode call-sign DB
-  ((callsign_db_t *)data(CALLSIGN_START))->fromUserDB(db);
+bool
+UV390CallsignDB::isDirty(uint32_t addr) const {
+  return _dirty.contains(addr/BLOCK_SIZE);
+}
+
+UserDatabase::Snapshot
+UV390CallsignDB::snapshot() const {
+  UserDatabase::Snapshot snapshot;
+  snapshot.entries = _entries;
+  if (image(0).numElements()) {
+    snapshot.address = image(0).element(0).address();
+    snapshot.image = image(0).element(0).data();
+  }
+  return snapshot;
+}
+
+void
+UV390CallsignDB::markDirty(uint32_t addr, uint32_t size) {
+  for (uint32_t b=addr/BLOCK_SIZE; b<=(addr+size-1)/BLOCK_SIZE; b++)
+    _dirty.insert(b);
 }
@@ -75,10 +75,14 @@ public:
 
     /// Clears the complete callsign database.
     void clear();
+    /** Returns the number of entries in the call-sign DB. */
+    uint getN() const;
     /** Stets the number of entries in the call-sign DB. */
     void setN(uint N);
     /// Fills the callsign database from the given user db.
     void fromUserDB(const UserDatabase *db);
+    /// Updates the number of entries and the index for the given users sorted by ID.
+    void encodeIndex(const QVector<UserDatabase::User> &users);
   };
 
 public:
@@ -87,6 +91,25 @@ public:
 
   /** Tries to encode as many entries of the given user-database. */
   void encode(UserDatabase *db);
+  /** Tries to encode as many entries of the given user-database incrementally. That is, only
+   * those entries that differ from the given snapshot of the DB last written to the device get
+   * re-encoded. If the snapshot is empty, the complete DB gets encoded. */
+  void encode(UserDatabase *db, const UserDatabase::Snapshot &previous);
+
+  /** Returns @c true if the block at the given address was modified by the last encoding. */
+  bool isDirty(uint32_t addr) const;
+  /** Returns the snapshot of the encoded DB. */
+  UserDatabase::Snapshot snapshot() const;
+
+protected:
+  /** Marks all blocks within the given address range as modified. */
+  void markDirty(uint32_t addr, uint32_t size);
+
+protected:
+  /** IDs and content hashes of the encoded entries. */
+  QHash<uint, uint32_t> _entries;
+  /** Indices of all modified blocks. */
+  QSet<uint32_t> _dirty;
 };
 
 #endif // UV390CALLSIGNDB_HH
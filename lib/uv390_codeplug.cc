@@ -172,8 +172,24 @@ UV390Codeplug::channel_t::setTXTone(Signaling::Code code)  {
   ctcss_dcs_transmit = encode_ctcss_tone_table(code);
 }
 
+void
+UV390Codeplug::channel_t::parse(CodePlug::ParsedChannel &parsed) const {
+  parsed.name = getName();
+  parsed.rxFrequency = getRXFrequency();
+  parsed.txFrequency = getTXFrequency();
+  parsed.rxTone = getRXTone();
+  parsed.txTone = getTXTone();
+}
+
 Channel *
 UV390Codeplug::channel_t::toChannelObj() const {
+  CodePlug::ParsedChannel parsed;
+  parse(parsed);
+  return toChannelObj(parsed);
+}
+
+Channel *
+UV390Codeplug::channel_t::toChannelObj(const CodePlug::ParsedChannel &parsed) const {
   if (! isValid())
     return nullptr;
 
@@ -198,8 +214,8 @@ UV390Codeplug::channel_t::toChannelObj() const {
     AnalogChannel::Bandwidth bw =
         (BW_12_5_KHZ == bandwidth) ? AnalogChannel::BWNarrow : AnalogChannel::BWWide;
 
-    return new AnalogChannel(getName(), getRXFrequency(), getTXFrequency(), pwr, (tot*15), rx_only,
-                             admit_crit, squelch, getRXTone(), getTXTone(), bw, nullptr);
+    return new AnalogChannel(parsed.name, parsed.rxFrequency, parsed.txFrequency, pwr, (tot*15), rx_only,
+                             admit_crit, squelch, parsed.rxTone, parsed.txTone, bw, nullptr);
   } else if (MODE_DIGITAL == channel_mode) {
     DigitalChannel::Admit admit_crit;
     switch(admit_criteria) {
@@ -212,7 +228,7 @@ UV390Codeplug::channel_t::toChannelObj() const {
     DigitalChannel::TimeSlot slot =
         (1 == time_slot) ? DigitalChannel::TimeSlot1 : DigitalChannel::TimeSlot2;
 
-    return new DigitalChannel(getName(), getRXFrequency(), getTXFrequency(), pwr, (tot*15),
+    return new DigitalChannel(parsed.name, parsed.rxFrequency, parsed.txFrequency, pwr, (tot*15),
                               rx_only, admit_crit, color_code, slot,
                               nullptr, nullptr, nullptr, nullptr, nullptr);
   }
@@ -1283,10 +1299,9 @@ UV390Codeplug::encode(Config *config, const Flags &flags) {
   // Define Contacts
   for (int i=0; i<NCONTACTS; i++) {
     contact_t *cont = (contact_t *)(data(OFFSET_CONTACTS+i*sizeof(contact_t)));
+    cont->clear();
     if (i < config->contacts()->digitalCount())
       cont->fromContactObj(config->contacts()->digitalContact(i), config);
-    else
-      cont->clear();
   }
 
   // Define RX GroupLists
@@ -1341,6 +1356,34 @@ UV390Codeplug::encode(Config *config, const Flags &flags) {
   return true;
 }
 
+bool
+UV390Codeplug::patchIdentity(const Identity &identity) {
+  general_settings_t *genset = (general_settings_t *)(data(OFFSET_SETTINGS));
+  genset->setName(identity.name);
+  genset->setRadioId(identity.id);
+  genset->setIntroLine1(identity.introLine1);
+  genset->setIntroLine2(identity.introLine2);
+  return true;
+}
+
+QVector<CodePlug::PagedImage::Run>
+UV390Codeplug::overwriteMap(const Config *config, uint32_t img) const {
+  QVector<PagedImage::Run> map;
+  if (0 != img)
+    return map;
+
+  uint32_t nchan = std::min(NCHAN, config->channelList()->count());
+  uint32_t nscan = std::min(NSCANL, config->scanlists()->count());
+  map.append({OFFSET_GLISTS, NGLISTS*sizeof(grouplist_t)});
+  map.append({OFFSET_ZONES, NZONES*sizeof(zone_t)});
+  map.append({uint32_t(OFFSET_SCANL+nscan*sizeof(scanlist_t)), uint32_t((NSCANL-nscan)*sizeof(scanlist_t))});
+  map.append({OFFSET_ZONEXT, NZONES*sizeof(zone_ext_t)});
+  map.append({OFFSET_GPS_SYS, NGPSSYSTEMS*sizeof(gpssystem_t)});
+  map.append({uint32_t(OFFSET_CHANNELS+nchan*sizeof(channel_t)), uint32_t((NCHAN-nchan)*sizeof(channel_t))});
+  map.append({OFFSET_CONTACTS, NCONTACTS*sizeof(contact_t)});
+  return map;
+}
+
 bool
 UV390Codeplug::decode(Config *config) {
   // Clear config object
@@ -1359,25 +1402,21 @@ UV390Codeplug::decode(Config *config) {
     return false;
   }
 
-  // Define Contacts
+  // Define Contacts, the contact objects are created once they are accessed
+  CodePlugContactLoader<contact_t> *contact_loader = new CodePlugContactLoader<contact_t>();
   for (int i=0; i<NCONTACTS; i++) {
     contact_t *cont = (contact_t *)(data(OFFSET_CONTACTS+i*sizeof(contact_t)));
     if (! cont) {
       _errorMessage = QString("%1(): Cannot access contact memory at index %2!").arg(__func__).arg(i);
       logError() << _errorMessage;
+      delete contact_loader;
       return false;
     }
     if (! cont->isValid())
       break;
-    if (Contact *obj = cont->toContactObj())
-      config->contacts()->addContact(obj);
-    else {
-      _errorMessage = QString("%1(): Cannot decode codeplug: Invlaid contact at index %2.")
-          .arg(__func__).arg(i);
-      logError() << _errorMessage;
-      return false;
-    }
+    contact_loader->append(cont);
   }
+  config->contacts()->addDeferred(contact_loader->count(), contact_loader);
 
   // Define RX GroupLists
   for (int i=0; i<NGLISTS; i++) {
@@ -1399,7 +1438,8 @@ UV390Codeplug::decode(Config *config) {
     }
   }
 
-  // Define Channels
+  // Index channels
+  QVector<channel_t *> channels;
   for (int i=0; i<NCHAN; i++) {
     channel_t *chan = (channel_t *)(data(OFFSET_CHANNELS+i*sizeof(channel_t)));
     if (! chan) {
@@ -1409,7 +1449,16 @@ UV390Codeplug::decode(Config *config) {
     }
     if (! chan->isValid())
       break;
-    if (Channel *obj = chan->toChannelObj())
+    channels.append(chan);
+  }
+  // Parse channels in parallel
+  QVector<ParsedChannel> parsed_channels(channels.size());
+  parallel_for(channels.size(), [&channels, &parsed_channels](int i) {
+    channels[i]->parse(parsed_channels[i]);
+  });
+  // Define Channels
+  for (int i=0; i<channels.size(); i++) {
+    if (Channel *obj = channels[i]->toChannelObj(parsed_channels[i]))
       config->channelList()->addChannel(obj);
     else {
       _errorMessage = QString("%1(): Cannot decode codeplug: Invlaid channel at index %2.")
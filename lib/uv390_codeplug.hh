@@ -269,8 +269,13 @@ public:
     /** Sets the TX CTCSS tone. */
     void setTXTone(Signaling::Code code);
 
+    /** Decodes name, frequencies and tones of the channel. This method does not create any
+     * QObject, hence it can be called from any thread. */
+    void parse(CodePlug::ParsedChannel &parsed) const;
     /** Constructs a generic @c Channel object from the codeplug channel. */
     Channel *toChannelObj() const;
+    /** Constructs a generic @c Channel object from the codeplug channel and its parsed settings. */
+    Channel *toChannelObj(const CodePlug::ParsedChannel &parsed) const;
     /** Links a previously constructed channel to the rest of the configuration. */
     bool linkChannelObj(Channel *c, Config *conf) const;
     /** Initializes this codeplug channel from the given generic configuration. */
@@ -905,6 +910,12 @@ public:
 	bool decode(Config *config);
   /** Encodes the given generic configuration as a binary codeplug. */
   bool encode(Config *config, const Flags &flags = Flags());
+
+  /** Returns the ranges overwritten by @c encode: All contacts, group lists, zones and GPS systems
+   * as well as the unused channels and scan lists. */
+  QVector<PagedImage::Run> overwriteMap(const Config *config, uint32_t img=0) const;
+  /** Patches the radio name, DMR ID and intro lines within the general settings. */
+  bool patchIdentity(const Identity &identity);
 };
 
 #endif // UV390_CODEPLUG_HH
@@ -34,6 +34,12 @@ AnalogChannelDialog::construct() {
   channelName->setCompleter(completer);
   connect(completer, SIGNAL(activated(const QModelIndex &)),
           this, SLOT(onRepeaterSelected(const QModelIndex &)));
+  // Do not block while the repeater database is loading, just show it
+  if (app->repeater()->isLoading()) {
+    channelName->setPlaceholderText(tr("Loading repeater database..."));
+    connect(app->repeater(), &RepeaterDatabase::loaded,
+            channelName, [this]() { channelName->setPlaceholderText(""); });
+  }
 
   rxFrequency->setValidator(new QDoubleValidator(0,500,5));
   txFrequency->setValidator(new QDoubleValidator(0,500,5));
@@ -5,7 +5,9 @@
 
 #include "logger.hh"
 #include "radio.hh"
+#include "configverifier.hh"
 #include "codeplug.hh"
+#include "configsnapshot.hh"
 #include "config.h"
 #include "settings.hh"
 #include "verifydialog.hh"
@@ -23,7 +25,8 @@
 
 
 Application::Application(int &argc, char *argv[])
-  : QApplication(argc, argv), _config(nullptr), _mainWindow(nullptr), _repeater(nullptr)
+  : QApplication(argc, argv), _config(nullptr), _mainWindow(nullptr), _repeater(nullptr),
+    _verifier(nullptr), _verifierRadio()
 {
   setApplicationName("qdmr");
   setOrganizationName("DM3MAT");
@@ -38,7 +41,11 @@ Application::Application(int &argc, char *argv[])
   _users    = new UserDatabase(30, this);
   _config = new Config(this);
 
-  if (argc>1) {
+  if ((argc>1) && ConfigSnapshot::isSnapshotFile(argv[1])) {
+    QString errorMessage;
+    if (! _config->readSnapshot(argv[1], errorMessage))
+      logError() << errorMessage;
+  } else if (argc>1) {
     QFile file(argv[1]);
     if (! file.open(QIODevice::ReadOnly)) {
 
@@ -292,9 +299,22 @@ Application::loadCodeplug() {
   }
 
   QString filename = QFileDialog::getOpenFileName(nullptr, tr("Open codeplug"), QString(),
-                                                  tr("Codeplug Files (*.conf *.csv *.txt);;All Files (*)"));
+                                                  tr("Codeplug Files (*.conf *.csv *.txt *.dmrb);;All Files (*)"));
   if (filename.isEmpty())
     return;
+
+  logDebug() << "Load codeplug from '" << filename << "'.";
+
+  QString errorMessage;
+  if (ConfigSnapshot::isSnapshotFile(filename)) {
+    if (_config->readSnapshot(filename, errorMessage))
+      _mainWindow->setWindowModified(false);
+    else
+      QMessageBox::critical(nullptr, tr("Cannot read codeplug."),
+                            tr("Cannot read codeplug from file '%1': %2").arg(filename).arg(errorMessage));
+    return;
+  }
+
   QFile file(filename);
   if (!file.open(QIODevice::ReadOnly)) {
     QMessageBox::critical(nullptr, tr("Cannot open file"),
@@ -302,9 +322,6 @@ Application::loadCodeplug() {
     return;
   }
 
-  logDebug() << "Load codeplug from '" << filename << "'.";
-
-  QString errorMessage;
   QTextStream stream(&file);
   if (_config->readCSV(stream, errorMessage))
     _mainWindow->setWindowModified(false);
@@ -320,15 +337,26 @@ Application::saveCodeplug() {
     return;
 
   QString filename = QFileDialog::getSaveFileName(nullptr, tr("Save codeplug"), QString(),
-                                                  tr("Codeplug Files (*.conf *.csv *.txt)"));
+                                                  tr("Codeplug Files (*.conf *.csv *.txt *.dmrb)"));
   if (filename.isEmpty())
     return;
 
   // check for file suffix
   QFileInfo info(filename);
-  if (("conf" != info.suffix()) && ("csv" != info.suffix()) && ("txt" != info.suffix()))
+  if (("conf" != info.suffix()) && ("csv" != info.suffix()) && ("txt" != info.suffix()) &&
+      ("dmrb" != info.suffix()))
     filename = filename + ".conf";
 
+  QString errorMessage;
+  if (ConfigSnapshot::isSnapshotFile(filename)) {
+    if (_config->writeSnapshot(filename, errorMessage))
+      _mainWindow->setWindowModified(false);
+    else
+      QMessageBox::critical(nullptr, tr("Cannot save codeplug"),
+                            tr("Cannot save codeplug to file '%1': %2").arg(filename).arg(errorMessage));
+    return;
+  }
+
   QFile file(filename);
   if (!file.open(QIODevice::WriteOnly)) {
     QMessageBox::critical(nullptr, tr("Cannot open file"),
@@ -336,7 +364,6 @@ Application::saveCodeplug() {
     return;
   }
 
-  QString errorMessage;
   QTextStream stream(&file);
   if (_config->writeCSV(stream, errorMessage))
     _mainWindow->setWindowModified(false);
@@ -369,6 +396,8 @@ Application::detectRadio() {
   Radio *radio = Radio::detect(errorMessage);
   if (radio) {
     QMessageBox::information(nullptr, tr("Radio found"), tr("Found device '%1'.").arg(radio->name()));
+    // Start watching the codeplug for the detected radio
+    verifier(radio);
     radio->deleteLater();
   } else {
     QMessageBox::information(nullptr, tr("No Radio found."),
@@ -395,7 +424,7 @@ Application::verifyCodeplug(Radio *radio, bool showSuccess, bool ignoreWarnings)
 
   bool verified = true;
   QList<VerifyIssue> issues;
-  VerifyIssue::Type maxIssue = myRadio->verifyConfig(_config, issues);
+  VerifyIssue::Type maxIssue = verifier(myRadio)->verify(_config, issues);
   if ( (ignoreWarnings && (maxIssue>VerifyIssue::WARNING)) ||
        ((!ignoreWarnings) && (maxIssue>=VerifyIssue::WARNING)) ) {
     VerifyDialog dialog(issues);
@@ -415,6 +444,41 @@ Application::verifyCodeplug(Radio *radio, bool showSuccess, bool ignoreWarnings)
 }
 
 
+ConfigVerifier *
+Application::verifier(Radio *radio) {
+  if (_verifier && (radio->name() == _verifierRadio))
+    return _verifier;
+
+  if (_verifier) {
+    _verifier->watch(nullptr);
+    _verifier->deleteLater();
+  }
+  _verifierRadio = radio->name();
+  _verifier = new ConfigVerifier(radio->features(), this);
+  connect(_verifier, SIGNAL(issuesChanged()), this, SLOT(onVerifyIssuesChanged()));
+  _verifier->watch(_config);
+  return _verifier;
+}
+
+void
+Application::onVerifyIssuesChanged() {
+  if ((! _mainWindow) || (! _verifier))
+    return;
+
+  int errors = 0, warnings = 0;
+  foreach (const VerifyIssue &issue, _verifier->issues()) {
+    errors += (VerifyIssue::ERROR == issue.type()) ? 1 : 0;
+    warnings += (VerifyIssue::WARNING == issue.type()) ? 1 : 0;
+  }
+  if (errors || warnings)
+    _mainWindow->statusBar()->showMessage(
+          tr("Codeplug for '%1': %2 errors, %3 warnings.")
+          .arg(_verifierRadio).arg(errors).arg(warnings));
+  else
+    _mainWindow->statusBar()->showMessage(tr("Codeplug verified for '%1'.").arg(_verifierRadio));
+}
+
+
 void
 Application::downloadCodeplug() {
   if (! _mainWindow)
@@ -507,14 +571,28 @@ Application::uploadCodeplug() {
   connect(radio, SIGNAL(uploadProgress(int)), progress, SLOT(setValue(int)));
   connect(radio, SIGNAL(uploadError(Radio *)), this, SLOT(onCodeplugUploadError(Radio *)));
   connect(radio, SIGNAL(uploadComplete(Radio *)), this, SLOT(onCodeplugUploaded(Radio *)));
-  radio->startUpload(_config, false, settings.codePlugFlags());
+  // The radio encodes a snapshot of the codeplug, hence editing can continue during the upload
+  setRadioActionsEnabled(false);
+  if (! radio->startUpload(_config, false, settings.codePlugFlags())) {
+    QMessageBox::critical(nullptr, tr("Cannot upload codeplug."),
+                          tr("Cannot upload codeplug: %1").arg(radio->errorMessage()));
+    setRadioActionsEnabled(true);
+    progress->setVisible(false);
+    radio->deleteLater();
+    return;
+  }
 
   _mainWindow->statusBar()->showMessage(tr("Upload ..."));
-  _mainWindow->setEnabled(false);
 }
 
 void
 Application::uploadCallsignDB() {
+  if (_users->isLoading()) {
+    QMessageBox::information(nullptr, tr("Cannot upload call-sign DB."),
+                             tr("The call-sign DB is still loading. Please try again later."));
+    return;
+  }
+
   // Start upload
   QString errorMessage;
 
@@ -568,6 +646,7 @@ Application::onCodeplugUploadError(Radio *radio) {
            "An error occurred during upload: %1").arg(radio->errorMessage()));
   _mainWindow->findChild<QProgressBar *>("progress")->setVisible(false);
   _mainWindow->setEnabled(true);
+  setRadioActionsEnabled(true);
 
   radio->deleteLater();
 }
@@ -578,6 +657,7 @@ Application::onCodeplugUploaded(Radio *radio) {
   _mainWindow->statusBar()->showMessage(tr("Upload complete"));
   _mainWindow->findChild<QProgressBar *>("progress")->setVisible(false);
   _mainWindow->setEnabled(true);
+  setRadioActionsEnabled(true);
 
   radio->deleteLater();
 }
@@ -1233,4 +1313,12 @@ Application::position() const {
 }
 
 
-
+void
+Application::setRadioActionsEnabled(bool enabled) {
+  QStringList actions = {"actionDetectDevice", "actionDownload", "actionUpload",
+                         "actionUploadCallsignDB"};
+  foreach (const QString &name, actions) {
+    if (QAction *action = _mainWindow->findChild<QAction*>(name))
+      action->setEnabled(enabled);
+  }
+}
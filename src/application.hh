@@ -11,6 +11,7 @@ class Radio;
 class RepeaterDatabase;
 class UserDatabase;
 class CodePlug;
+class ConfigVerifier;
 
 
 class Application : public QApplication
@@ -107,6 +108,14 @@ private slots:
   void onHideRoamingNote();
 
   void positionUpdated(const QGeoPositionInfo &info);
+  void onVerifyIssuesChanged();
+
+protected:
+  /** Enables or disables all actions accessing the radio. */
+  void setRadioActionsEnabled(bool enabled);
+  /** Returns the verifier watching the codeplug for the given radio. A new verifier is created
+   * whenever another radio model is connected. */
+  ConfigVerifier *verifier(Radio *radio);
 
 protected:
   Config *_config;
@@ -116,6 +125,10 @@ protected:
   QGeoPositionInfoSource *_source;
   QGeoCoordinate _currentPosition;
   ReleaseNotes _releaseNotes;
+  /** Watches the codeplug for the last radio model verified against. */
+  ConfigVerifier *_verifier;
+  /** The name of the radio model, the verifier verifies against. */
+  QString _verifierRadio;
 };
 
 #endif // APPLICATION_HH
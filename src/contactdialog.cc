@@ -16,20 +16,29 @@
  * Implementation of ContactDialog
  * ********************************************************************************************* */
 ContactDialog::ContactDialog(UserDatabase *users, QWidget *parent)
-  : QDialog(parent), _contact(nullptr), _completer(nullptr)
+  : QDialog(parent), _contact(nullptr), _completions(nullptr), _completer(nullptr)
 {
-  _completer = new QCompleter(users, this);
-  _completer->setCompletionColumn(0);
-  _completer->setCaseSensitivity(Qt::CaseInsensitive);
+  // Complete from the search index of the user DB, only the matches are passed to the completer
+  _completions = new UserCompletionModel(users, 50, this);
+  _completer = new QCompleter(_completions, this);
+  _completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
 
   connect(_completer, SIGNAL(activated(QModelIndex)),
           this, SLOT(onCompleterActivated(QModelIndex)));
 
   construct();
+  connect(contactName, SIGNAL(textEdited(QString)), _completions, SLOT(setPrefix(QString)));
+
+  // Do not block while the user database is loading, just show it
+  if (users->isLoading()) {
+    contactName->setPlaceholderText(tr("Loading call-sign database..."));
+    connect(users, &UserDatabase::loaded,
+            contactName, [this]() { contactName->setPlaceholderText(""); });
+  }
 }
 
 ContactDialog::ContactDialog(UserDatabase *users, Contact *contact, QWidget *parent)
-  : QDialog(parent), _contact(contact), _completer(nullptr)
+  : QDialog(parent), _contact(contact), _completions(nullptr), _completer(nullptr)
 {
   construct();
 }
@@ -102,14 +111,11 @@ void
 ContactDialog::onCompleterActivated(const QModelIndex &idx) {
   if (nullptr == _completer)
     return;
-  UserDatabase *db = qobject_cast<UserDatabase *>(_completer->model());
-  if (nullptr == db)
-    return;
   QAbstractProxyModel *model = qobject_cast<QAbstractProxyModel *>(_completer->completionModel());
   if (nullptr == model)
     return;
   QModelIndex srcidx = model->mapToSource(idx);
-  contactNumber->setText(QString::number(db->user(srcidx.row()).id));
+  contactNumber->setText(QString::number(_completions->user(srcidx.row()).id));
 }
 
 Contact *
@@ -13,6 +13,7 @@
 
 #include "ui_contactdialog.h"
 class UserDatabase;
+class UserCompletionModel;
 
 class ContactDialog: public QDialog, private Ui::ContactDialog
 {
@@ -33,6 +34,7 @@ protected:
 
 protected:
 	Contact *_contact;
+  UserCompletionModel *_completions;
   QCompleter *_completer;
 };
 
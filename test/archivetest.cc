@@ -0,0 +1,85 @@
+#include "archivetest.hh"
+#include "codeplugarchive.hh"
+#include "rd5r_codeplug.hh"
+#include <QTest>
+#include <QDirIterator>
+
+ArchiveTest::ArchiveTest(QObject *parent)
+  : QObject(parent), _config(), _directory()
+{
+  // pass...
+}
+
+void
+ArchiveTest::initTestCase() {
+  QVERIFY(_directory.isValid());
+  QString errMessage;
+  QVERIFY(_config.readCSV("://testconfig.conf", errMessage));
+
+  // Two codeplugs, only differing in name and intro lines
+  RD5RCodeplug codeplug;
+  QVERIFY(codeplug.encode(&_config));
+  QVERIFY(codeplug.write(_directory.filePath("a.dfu")));
+
+  CodePlug::Identity identity(&_config);
+  identity.name = "FLEET1";
+  identity.introLine1 = "GHI";
+  QVERIFY(codeplug.patchIdentity(identity));
+  QVERIFY(codeplug.write(_directory.filePath("b.dfu")));
+
+  CodeplugArchive archive(_directory.filePath("archive"));
+  QVERIFY2(archive.add(_directory.filePath("a.dfu")),
+           archive.errorMessage().toLocal8Bit().constData());
+  QVERIFY2(archive.add(_directory.filePath("b.dfu")),
+           archive.errorMessage().toLocal8Bit().constData());
+}
+
+void
+ArchiveTest::testDeduplication() {
+  CodeplugArchive archive(_directory.filePath("archive"));
+  QList<CodeplugArchive::Entry> entries;
+  QVERIFY(archive.list(entries));
+  QCOMPARE(entries.size(), 2);
+  QCOMPARE(entries.at(0).name, QString("a"));
+  QCOMPARE(entries.at(1).name, QString("b"));
+
+  // Only the two blocks holding the name and intro lines are stored twice
+  uint stored = 0;
+  QDirIterator it(_directory.filePath("archive/blocks"), QDir::Files, QDirIterator::Subdirectories);
+  while (it.hasNext()) {
+    it.next(); stored++;
+  }
+  QVERIFY(stored < (entries.at(0).blocks + entries.at(1).blocks));
+  QVERIFY(stored <= (entries.at(0).blocks + 2));
+}
+
+void
+ArchiveTest::testExtract() {
+  CodeplugArchive archive(_directory.filePath("archive"));
+  QVERIFY2(archive.extract("b", _directory.filePath("c.dfu")),
+           archive.errorMessage().toLocal8Bit().constData());
+
+  QFile original(_directory.filePath("b.dfu")), extracted(_directory.filePath("c.dfu"));
+  QVERIFY(original.open(QIODevice::ReadOnly));
+  QVERIFY(extracted.open(QIODevice::ReadOnly));
+  QCOMPARE(extracted.readAll(), original.readAll());
+}
+
+void
+ArchiveTest::testDiff() {
+  CodeplugArchive archive(_directory.filePath("archive"));
+  QList<CodeplugArchive::Difference> differences;
+  QVERIFY(archive.diff("a", "a", differences));
+  QVERIFY(differences.isEmpty());
+
+  QVERIFY(archive.diff("a", "b", differences));
+  QVERIFY(! differences.isEmpty());
+  foreach (const CodeplugArchive::Difference &diff, differences) {
+    // Radio name within general settings or first intro line
+    bool inName = (diff.address >= 0x000e0) && ((diff.address+diff.size) <= 0x000e8);
+    bool inIntro = (diff.address >= 0x07540) && ((diff.address+diff.size) <= 0x07550);
+    QVERIFY(inName || inIntro);
+  }
+}
+
+QTEST_GUILESS_MAIN(ArchiveTest)
@@ -0,0 +1,28 @@
+#ifndef ARCHIVETEST_HH
+#define ARCHIVETEST_HH
+
+#include "config.hh"
+#include <QObject>
+#include <QTemporaryDir>
+
+
+class ArchiveTest : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit ArchiveTest(QObject *parent = nullptr);
+
+private slots:
+  void initTestCase();
+
+  void testDeduplication();
+  void testExtract();
+  void testDiff();
+
+protected:
+  Config _config;
+  QTemporaryDir _directory;
+};
+
+#endif // ARCHIVETEST_HH
@@ -1,6 +1,37 @@
 #include "configtest.hh"
 #include "config.hh"
+#include "configverifier.hh"
+#include "configsnapshot.hh"
+#include "csvwriter.hh"
+#include "rd5r.hh"
+#include "d878uv.hh"
 #include <QTest>
+#include <QSignalSpy>
+
+
+/** Loads contacts with consecutive numbers and counts the contacts constructed. */
+class CountingLoader: public ContactList::Loader
+{
+public:
+  CountingLoader(int &loaded)
+    : ContactList::Loader(), _loaded(loaded)
+  {
+    // pass...
+  }
+
+  DigitalContact *load(int idx) {
+    _loaded++;
+    return new DigitalContact(DigitalContact::PrivateCall, QString("C%1").arg(idx), 1000+idx);
+  }
+
+  bool number(int idx, uint &number) const {
+    number = 1000+idx;
+    return true;
+  }
+
+protected:
+  int &_loaded;
+};
 
 
 ConfigTest::ConfigTest(QObject *parent) : QObject(parent)
@@ -247,5 +278,253 @@ ConfigTest::testGPSSystems() {
   QCOMPARE(_config.gpsSystems()->gpsSystem(0)->revertChannel(), nullptr);
 }
 
+void
+ConfigTest::testVerifyDuplicateNames() {
+  RD5R radio;
+  ConfigVerifier verifier(radio.features());
+  Config config;
+  DigitalContact *a = new DigitalContact(DigitalContact::PrivateCall, "Test", 1234);
+  DigitalContact *b = new DigitalContact(DigitalContact::PrivateCall, "Test", 1235);
+  config.contacts()->addContact(a);
+  config.contacts()->addContact(b);
+  config.contacts()->addContact(new DigitalContact(DigitalContact::PrivateCall, "Test", 1236));
+
+  // Duplicates are reported once
+  QList<VerifyIssue> issues;
+  verifier.verify(&config, issues);
+  int duplicates = 0;
+  foreach (const VerifyIssue &issue, issues)
+    duplicates += (QString("Duplicate contact name 'Test'.") == issue.message()) ? 1 : 0;
+  QCOMPARE(duplicates, 1);
+
+  // Modified objects get re-verified
+  a->setName("A very long contact name");
+  b->setName("B");
+  config.contacts()->contact(2)->setName("C");
+  issues.clear();
+  verifier.verify(&config, issues);
+  duplicates = 0; int tooLong = 0;
+  foreach (const VerifyIssue &issue, issues) {
+    duplicates += issue.message().startsWith("Duplicate") ? 1 : 0;
+    tooLong += (a == issue.object()) ? 1 : 0;
+  }
+  QCOMPARE(duplicates, 0);
+  QCOMPARE(tooLong, 1);
+}
+
+void
+ConfigTest::testVerifyPriorityChannelRenamed() {
+  RD5R radio;
+  ConfigVerifier verifier(radio.features());
+  Config config;
+  AnalogChannel *prio = new AnalogChannel(
+        "Prio", 145.0, 145.0, Channel::HighPower, 0, false, AnalogChannel::AdmitNone, 1,
+        Signaling::SIGNALING_NONE, Signaling::SIGNALING_NONE, AnalogChannel::BWNarrow, nullptr);
+  config.channelList()->addChannel(prio);
+  ScanList *list = new ScanList("Scan");
+  config.scanlists()->addScanList(list);
+  // Priority channel is not part of the scan list
+  list->setPriorityChannel(prio);
+
+  QList<VerifyIssue> issues;
+  verifier.verify(&config, issues);
+  int matches = 0;
+  foreach (const VerifyIssue &issue, issues)
+    matches += (list == issue.object() && issue.message().contains("'Prio'")) ? 1 : 0;
+  QCOMPARE(matches, 1);
+
+  // Renaming the priority channel must update the cached scan list issue
+  prio->setName("Other");
+  issues.clear();
+  verifier.verify(&config, issues);
+  matches = 0;
+  foreach (const VerifyIssue &issue, issues)
+    matches += (list == issue.object() && issue.message().contains("'Other'")) ? 1 : 0;
+  QCOMPARE(matches, 1);
+}
+
+void
+ConfigTest::testVerifyTXContactRemoved() {
+  // The D878UV requires a TX contact for every digital channel
+  D878UV radio;
+  ConfigVerifier verifier(radio.features());
+  Config config;
+  DigitalContact *contact = new DigitalContact(DigitalContact::GroupCall, "Local", 9);
+  config.contacts()->addContact(contact);
+  DigitalChannel *channel = new DigitalChannel(
+        "CH1", 439.0, 431.4, Channel::LowPower, 0, false, DigitalChannel::AdmitNone, 1,
+        DigitalChannel::TimeSlot1, nullptr, contact, nullptr, nullptr, nullptr);
+  config.channelList()->addChannel(channel);
+
+  QList<VerifyIssue> issues;
+  verifier.verify(&config, issues);
+  int matches = 0;
+  foreach (const VerifyIssue &issue, issues)
+    matches += (channel == issue.object() && issue.message().contains("TX contact")) ? 1 : 0;
+  QCOMPARE(matches, 0);
+
+  // Removing the contact resets the reference and updates the cached channel issues
+  QSignalSpy channelModified(channel, SIGNAL(modified()));
+  QVERIFY(config.contacts()->remContact(contact));
+  QCOMPARE(channelModified.count(), 1);
+  QVERIFY(nullptr == channel->txContact());
+  issues.clear();
+  verifier.verify(&config, issues);
+  matches = 0;
+  foreach (const VerifyIssue &issue, issues)
+    matches += (channel == issue.object() && issue.message().contains("TX contact")) ? 1 : 0;
+  QCOMPARE(matches, 1);
+
+  // So does deleting the contact
+  contact = new DigitalContact(DigitalContact::GroupCall, "Regional", 8);
+  config.contacts()->addContact(contact);
+  channel->setTXContact(contact);
+  issues.clear();
+  verifier.verify(&config, issues);
+  matches = 0;
+  foreach (const VerifyIssue &issue, issues)
+    matches += (channel == issue.object() && issue.message().contains("TX contact")) ? 1 : 0;
+  QCOMPARE(matches, 0);
+  delete contact;
+  issues.clear();
+  verifier.verify(&config, issues);
+  matches = 0;
+  foreach (const VerifyIssue &issue, issues)
+    matches += (channel == issue.object() && issue.message().contains("TX contact")) ? 1 : 0;
+  QCOMPARE(matches, 1);
+}
+
+void
+ConfigTest::testSnapshotRoundTrip() {
+  QString errMessage;
+  QByteArray snapshot;
+  QVERIFY(ConfigSnapshot::write(&_config, snapshot, errMessage));
+
+  Config copy;
+  QVERIFY(ConfigSnapshot::read(&copy, (const uchar *)snapshot.constData(), snapshot.size(), errMessage));
+
+  // Both configs must serialize to the same text, except for the generation time-stamp
+  QString original, restored;
+  QTextStream origStream(&original), copyStream(&restored);
+  QVERIFY(CSVWriter::write(&_config, origStream, errMessage));
+  QVERIFY(CSVWriter::write(&copy, copyStream, errMessage));
+  QStringList origLines = original.split("\n"), copyLines = restored.split("\n");
+  origLines.removeAt(1); copyLines.removeAt(1);
+  QCOMPARE(copyLines, origLines);
+
+  // Truncated snapshots are rejected
+  QVERIFY(! ConfigSnapshot::read(&copy, (const uchar *)snapshot.constData(), snapshot.size()-1, errMessage));
+}
+
+void
+ConfigTest::testSnapshotInvalid() {
+  Config config;
+  config.setName("Source");
+  config.contacts()->addContact(new DigitalContact(DigitalContact::GroupCall, "Local", 9));
+  QString errMessage;
+  QByteArray snapshot;
+  QVERIFY(ConfigSnapshot::write(&config, snapshot, errMessage));
+
+  Config target;
+  target.setName("Target");
+  target.contacts()->addContact(new DigitalContact(DigitalContact::PrivateCall, "A", 1));
+  target.contacts()->addContact(new DigitalContact(DigitalContact::PrivateCall, "B", 2));
+
+  // The call type of the only contact is followed by its number and the empty lists
+  QByteArray invalid = snapshot;
+  invalid[invalid.size()-29] = char(0x07);
+  QVERIFY(! ConfigSnapshot::read(&target, (const uchar *)invalid.constData(), invalid.size(),
+                                 errMessage));
+  QVERIFY2(errMessage.contains("call type"), errMessage.toLocal8Bit().constData());
+  // Invalid and truncated snapshots leave the config untouched
+  QCOMPARE(target.name(), QString("Target"));
+  QCOMPARE(target.contacts()->count(), 2);
+  QVERIFY(! ConfigSnapshot::read(&target, (const uchar *)snapshot.constData(),
+                                 snapshot.size()-1, errMessage));
+  QCOMPARE(target.name(), QString("Target"));
+  QCOMPARE(target.contacts()->count(), 2);
+
+  QVERIFY(ConfigSnapshot::read(&target, (const uchar *)snapshot.constData(), snapshot.size(),
+                               errMessage));
+  QCOMPARE(target.name(), QString("Source"));
+  QCOMPARE(target.contacts()->count(), 1);
+  QCOMPARE(target.contacts()->contact(0)->as<DigitalContact>()->type(), DigitalContact::GroupCall);
+}
+
+void
+ConfigTest::testReferences() {
+  Config config;
+  DigitalContact *a = new DigitalContact(DigitalContact::PrivateCall, "A", 1);
+  DigitalContact *b = new DigitalContact(DigitalContact::PrivateCall, "B", 2);
+  QCOMPARE(config.contacts()->addContact(a), 0);
+  QCOMPARE(config.contacts()->addContact(b), 1);
+  // Adding a contact twice returns its row
+  QCOMPARE(config.contacts()->addContact(a), 0);
+
+  DigitalChannel *ch1 = new DigitalChannel(
+        "CH1", 439.0, 431.4, Channel::LowPower, 0, false, DigitalChannel::AdmitNone, 1,
+        DigitalChannel::TimeSlot1, nullptr, a, nullptr, nullptr, nullptr);
+  DigitalChannel *ch2 = new DigitalChannel(
+        "CH2", 439.1, 431.5, Channel::LowPower, 0, false, DigitalChannel::AdmitNone, 1,
+        DigitalChannel::TimeSlot1, nullptr, a, nullptr, nullptr, nullptr);
+  QCOMPARE(config.channelList()->addChannel(ch1), 0);
+  QCOMPARE(config.channelList()->addChannel(ch2), 1);
+  QCOMPARE(config.channelList()->addChannel(ch1), -1);
+
+  // Rows follow moves
+  QVERIFY(config.contacts()->moveUp(1));
+  QCOMPARE(config.contacts()->indexOf(b), 0);
+  QCOMPARE(config.contacts()->indexOf(a), 1);
+  QVERIFY(config.channelList()->moveDown(0));
+  QCOMPARE(config.channelList()->indexOf(ch2), 0);
+  QCOMPARE(config.channelList()->indexOf(ch1), 1);
+
+  // Deleted objects are removed from their list and references to them get reset
+  delete a;
+  QCOMPARE(config.contacts()->count(), 1);
+  QCOMPARE(config.contacts()->indexOf(b), 0);
+  QVERIFY(nullptr == ch1->txContact());
+  QVERIFY(nullptr == ch2->txContact());
+  delete ch2;
+  QCOMPARE(config.channelList()->count(), 1);
+  QCOMPARE(config.channelList()->indexOf(ch1), 0);
+}
+
+void
+ConfigTest::testCSVErrorPosition() {
+  // Sections are parsed independently, errors must refer to the line within the file
+  QString text = "ID: 1234567\n"
+                 "Name: \"DM3MAT\"\n"
+                 "\n"
+                 "Contact Name Type ID RxTone\n"
+                 "1 \"Local\" Group 9 -\n"
+                 "2 \"Regional\" Group 8 -\n"
+                 "\n"
+                 "Grouplist Name Contacts\n"
+                 "1 \"Local\" 1,2\n"
+                 "2 Regional 2\n";
+  QTextStream stream(&text);
+  Config config;
+  QString errMessage;
+  QVERIFY(! config.readCSV(stream, errMessage));
+  QVERIFY2(errMessage.startsWith("Parse error @ 10,3:"), errMessage.toLocal8Bit().constData());
+}
+
+void
+ConfigTest::testFindDeferredContact() {
+  int loaded = 0;
+  ContactList contacts;
+  contacts.addDeferred(100, new CountingLoader(loaded));
+
+  // Only the contact found gets constructed
+  DigitalContact *contact = contacts.findDigitalContact(1050);
+  QVERIFY(nullptr != contact);
+  QCOMPARE(contact->name(), QString("C50"));
+  QCOMPARE(loaded, 1);
+  QVERIFY(nullptr == contacts.findDigitalContact(2000));
+  QCOMPARE(loaded, 1);
+  QCOMPARE(contacts.findDigitalContact(1050), contact);
+  QCOMPARE(loaded, 1);
+}
 
 QTEST_GUILESS_MAIN(ConfigTest)
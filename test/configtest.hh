@@ -28,6 +28,14 @@ private slots:
   void testZones();
   void testScanLists();
   void testGPSSystems();
+  void testVerifyDuplicateNames();
+  void testVerifyPriorityChannelRenamed();
+  void testVerifyTXContactRemoved();
+  void testSnapshotRoundTrip();
+  void testSnapshotInvalid();
+  void testReferences();
+  void testCSVErrorPosition();
+  void testFindDeferredContact();
 
 protected:
   Config _config;
@@ -0,0 +1,86 @@
+#include "d878uvtest.hh"
+#include "d878uv_codeplug.hh"
+#include "config.hh"
+#include <QTest>
+#include <string.h>
+
+/** Returns @c true if the given ranges overlap. */
+static bool
+overlaps(const CodePlug::PagedImage::Run &a, const CodePlug::PagedImage::Run &b) {
+  return (uint64_t(a.address) < (uint64_t(b.address)+b.size))
+      && (uint64_t(b.address) < (uint64_t(a.address)+a.size));
+}
+
+D878UVTest::D878UVTest(QObject *parent) : QObject(parent)
+{
+  // pass...
+}
+
+void
+D878UVTest::testSectionSpans() {
+  D878UVCodeplug codeplug;
+  // Enable all analog contacts and messages, such that all untouched memory gets allocated
+  memset(codeplug.data(0x02900100), 0x01, 0x80);
+  memset(codeplug.data(0x01640800), 0x00, 0x90);
+  QVERIFY(codeplug.allocateUntouched());
+  // Bitmaps are allocated by clear(), the remaining memory by allocateUntouched()
+  QVector<CodePlug::PagedImage::Run> untouched = codeplug.memory().runs();
+  QVERIFY(untouched.size());
+
+  // The sections encoded in the background must not touch the bitmaps or the untouched memory,
+  // these are read from the device meanwhile
+  for (int s=D878UVCodeplug::RadioIDSection; s<D878UVCodeplug::SettingsSection; s++) {
+    foreach (const CodePlug::PagedImage::Run &span,
+             D878UVCodeplug::sectionSpans(D878UVCodeplug::Section(s))) {
+      foreach (const CodePlug::PagedImage::Run &run, untouched) {
+        QVERIFY2(! overlaps(span, run),
+                 QString("Section %1 span 0x%2 overlaps with memory at 0x%3.").arg(s)
+                 .arg(span.address, 0, 16).arg(run.address, 0, 16).toLocal8Bit().constData());
+      }
+    }
+  }
+
+  // Spans of different sections are disjoint too
+  for (int s=D878UVCodeplug::RadioIDSection; s<=D878UVCodeplug::SettingsSection; s++) {
+    for (int t=s+1; t<=D878UVCodeplug::SettingsSection; t++) {
+      foreach (const CodePlug::PagedImage::Run &a,
+               D878UVCodeplug::sectionSpans(D878UVCodeplug::Section(s))) {
+        foreach (const CodePlug::PagedImage::Run &b,
+                 D878UVCodeplug::sectionSpans(D878UVCodeplug::Section(t)))
+          QVERIFY(! overlaps(a, b));
+      }
+    }
+  }
+}
+
+void
+D878UVTest::testManyContacts() {
+  // Contact banks straddle pages, enough contacts fill several chunks of the arena
+  Config config;
+  config.setId(1234567);
+  config.setName("DM3MAT");
+  for (int i=0; i<1500; i++)
+    config.contacts()->addContact(new DigitalContact(DigitalContact::PrivateCall,
+                                                     QString("Contact%1").arg(i), 2621000+i));
+
+  D878UVCodeplug codeplug;
+  codeplug.setBitmaps(&config);
+  QVERIFY(codeplug.allocateUntouched());
+  QVERIFY(codeplug.allocateForEncoding());
+  QVERIFY(! codeplug.memory().isFragmented());
+  QVERIFY(codeplug.encode(&config));
+
+  // Every bank is contiguous, as records are written through raw pointers
+  for (uint32_t bank=0; bank<(1500/4); bank++) {
+    uint32_t addr = 0x02680000 + bank*0x190;
+    QVERIFY(codeplug.memory().isAllocated(addr, 0x190));
+    QVERIFY((codeplug.data(addr)+0x18f) == codeplug.data(addr+0x18f));
+  }
+
+  Config decoded;
+  QVERIFY(codeplug.decode(&decoded));
+  QCOMPARE(decoded.contacts()->digitalCount(), 1500);
+  QCOMPARE(decoded.contacts()->digitalContact(1499)->number(), uint(2621000+1499));
+}
+
+QTEST_GUILESS_MAIN(D878UVTest)
@@ -0,0 +1,19 @@
+#ifndef D878UVTEST_HH
+#define D878UVTEST_HH
+
+#include <QObject>
+
+
+class D878UVTest : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit D878UVTest(QObject *parent = nullptr);
+
+private slots:
+  void testSectionSpans();
+  void testManyContacts();
+};
+
+#endif // D878UVTEST_HH
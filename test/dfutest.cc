@@ -0,0 +1,50 @@
+#include "dfutest.hh"
+#include "dfu_libusb.hh"
+#include <QTest>
+
+DFUTest::DFUTest(QObject *parent) : QObject(parent)
+{
+  // pass...
+}
+
+void
+DFUTest::testBlockSize() {
+  // Aligned transfers use the complete transfer size
+  QCOMPARE(DFUDevice::blockSize(1024, 0x0000, 0x1000), 1024U);
+  QCOMPARE(DFUDevice::blockSize(2048, 0x0800, 0x0800), 2048U);
+  // Blocks must be aligned to their size in address and length
+  QCOMPARE(DFUDevice::blockSize(1024, 0x0100, 0x0300), 256U);
+  QCOMPARE(DFUDevice::blockSize(1024, 0x0400, 0x0010), 16U);
+  QCOMPARE(DFUDevice::blockSize(1024, 0x0001, 0x0400), 1U);
+  // Transfer sizes that are no power of two
+  QCOMPARE(DFUDevice::blockSize(1000, 0x03e8, 0x07d0), 1000U);
+  QCOMPARE(DFUDevice::blockSize(1000, 0x01f4, 0x03e8), 500U);
+  // Never returns 0
+  QCOMPARE(DFUDevice::blockSize(0, 0x0000, 0x0010), 1U);
+}
+
+void
+DFUTest::testTransferSize() {
+  // Interface association descriptor followed by the DFU functional descriptor (2048b)
+  const unsigned char extra[] = {
+    0x05, 0x24, 0x00, 0x10, 0x01,
+    0x09, 0x21, 0x0b, 0xff, 0x00, 0x00, 0x08, 0x1a, 0x01 };
+  QCOMPARE(DFUDevice::parseTransferSize(extra, sizeof(extra)), 2048U);
+  QCOMPARE(DFUDevice::parseTransferSize(extra+5, sizeof(extra)-5), 2048U);
+
+  // No extra descriptors
+  QCOMPARE(DFUDevice::parseTransferSize(nullptr, 0), 0U);
+  QCOMPARE(DFUDevice::parseTransferSize(extra, 5), 0U);
+  // Truncated functional descriptor
+  QCOMPARE(DFUDevice::parseTransferSize(extra, 10), 0U);
+  // Functional descriptor too short to hold the transfer size
+  const unsigned char shortDesc[] = { 0x05, 0x21, 0x0b, 0xff, 0x00, 0x00, 0x08 };
+  QCOMPARE(DFUDevice::parseTransferSize(shortDesc, sizeof(shortDesc)), 0U);
+  // Invalid zero-length descriptor stops the search
+  const unsigned char invalid[] = {
+    0x00, 0x24, 0x00, 0x10, 0x01,
+    0x09, 0x21, 0x0b, 0xff, 0x00, 0x00, 0x08, 0x1a, 0x01 };
+  QCOMPARE(DFUDevice::parseTransferSize(invalid, sizeof(invalid)), 0U);
+}
+
+QTEST_GUILESS_MAIN(DFUTest)
@@ -0,0 +1,19 @@
+#ifndef DFUTEST_HH
+#define DFUTEST_HH
+
+#include <QObject>
+
+
+class DFUTest : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit DFUTest(QObject *parent = nullptr);
+
+private slots:
+  void testBlockSize();
+  void testTransferSize();
+};
+
+#endif // DFUTEST_HH
@@ -0,0 +1,156 @@
+#include "radiojobtest.hh"
+#include "radiojob.hh"
+#include <QTest>
+#include <QThread>
+#include <QSemaphore>
+#include <QScopedPointer>
+#include <QStringList>
+#include <QMutex>
+
+RadioJobTest::RadioJobTest(QObject *parent)
+  : QObject(parent)
+{
+  // pass...
+}
+
+void
+RadioJobTest::testCall() {
+  QThread *caller = QThread::currentThread(), *callee = nullptr;
+  QScopedPointer<RadioJob> job(RadioJob::call("Call", [&callee](QString &msg) {
+    Q_UNUSED(msg);
+    callee = QThread::currentThread();
+    return true;
+  }));
+  QCOMPARE(job->state(), RadioJob::Pending);
+
+  job->start();
+  // Completes within the thread of the job
+  QCOMPARE(job->state(), RadioJob::Running);
+  QVERIFY(job->wait());
+  QCOMPARE(job->state(), RadioJob::Finished);
+  QCOMPARE(job->progress(), 100);
+  // The function ran within the thread pool
+  QVERIFY(nullptr != callee);
+  QVERIFY(caller != callee);
+}
+
+void
+RadioJobTest::testCallFailed() {
+  QScopedPointer<RadioJob> job(RadioJob::call("Call", [](QString &msg) {
+    msg = "Failed";
+    return false;
+  }));
+  job->start();
+  QVERIFY(! job->wait());
+  QCOMPARE(job->state(), RadioJob::Failed);
+  QCOMPARE(job->errorMessage(), QString("Failed"));
+}
+
+void
+RadioJobTest::testThen() {
+  QStringList calls;
+  QMutex mutex;
+  auto record = [&calls, &mutex](const QString &name) {
+    return RadioJob::call(name, [&calls, &mutex, name](QString &msg) {
+      Q_UNUSED(msg);
+      QMutexLocker lock(&mutex);
+      calls.append(name);
+      return true;
+    });
+  };
+
+  QScopedPointer<RadioJob> first(record("A"));
+  RadioJob *last = first->then(record("B"))->then(record("C"));
+  first->start();
+  QVERIFY(last->wait());
+  QCOMPARE(first->state(), RadioJob::Finished);
+  QCOMPARE(calls, QStringList() << "A" << "B" << "C");
+
+  // Chaining to a finished job starts the next one
+  RadioJob *next = last->then(record("D"));
+  QVERIFY(next->wait());
+  QCOMPARE(calls.last(), QString("D"));
+}
+
+void
+RadioJobTest::testThenFailed() {
+  bool called = false;
+  QScopedPointer<RadioJob> first(RadioJob::call("A", [](QString &msg) {
+    msg = "Failed";
+    return false;
+  }));
+  RadioJob *second = first->then(RadioJob::call("B", [&called](QString &msg) {
+    Q_UNUSED(msg);
+    called = true;
+    return true;
+  }));
+  first->start();
+  QVERIFY(! second->wait());
+  QCOMPARE(first->state(), RadioJob::Failed);
+  QCOMPARE(second->state(), RadioJob::Cancelled);
+  QVERIFY(! called);
+}
+
+void
+RadioJobTest::testCancelPending() {
+  QScopedPointer<RadioJob> first(RadioJob::call("A", [](QString &msg) {
+    Q_UNUSED(msg);
+    return true;
+  }));
+  RadioJob *second = first->then(RadioJob::call("B", [](QString &msg) {
+    Q_UNUSED(msg);
+    return true;
+  }));
+
+  first->cancel();
+  QCOMPARE(first->state(), RadioJob::Cancelled);
+  QCOMPARE(second->state(), RadioJob::Cancelled);
+  // Cancelled jobs cannot be started
+  first->start();
+  QCOMPARE(first->state(), RadioJob::Cancelled);
+}
+
+void
+RadioJobTest::testCancelRunning() {
+  QSemaphore running, release;
+  QScopedPointer<RadioJob> first(RadioJob::call("A", [&running, &release](QString &msg) {
+    Q_UNUSED(msg);
+    running.release();
+    release.acquire();
+    return true;
+  }));
+  RadioJob *second = first->then(RadioJob::call("B", [](QString &msg) {
+    Q_UNUSED(msg);
+    return true;
+  }));
+
+  first->start();
+  running.acquire();
+  // The function cannot be interrupted, the job gets cancelled once it returned
+  first->cancel();
+  QCOMPARE(first->state(), RadioJob::Running);
+  release.release();
+  QVERIFY(! first->wait());
+  QCOMPARE(first->state(), RadioJob::Cancelled);
+  QCOMPARE(second->state(), RadioJob::Cancelled);
+}
+
+void
+RadioJobTest::testTimeout() {
+  QSemaphore release;
+  QScopedPointer<RadioJob> job(RadioJob::call("A", [&release](QString &msg) {
+    Q_UNUSED(msg);
+    release.acquire();
+    return true;
+  }));
+  job->setTimeout(10);
+  job->start();
+  // Let the watchdog fire before the function returns
+  QTest::qWait(50);
+  release.release();
+  QVERIFY(! job->wait());
+  QCOMPARE(job->state(), RadioJob::Failed);
+  QVERIFY(job->errorMessage().contains("timed out"));
+}
+
+QTEST_GUILESS_MAIN(RadioJobTest)
@@ -0,0 +1,23 @@
+#ifndef RADIOJOBTEST_HH
+#define RADIOJOBTEST_HH
+
+#include <QObject>
+
+class RadioJobTest : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit RadioJobTest(QObject *parent = nullptr);
+
+private slots:
+  void testCall();
+  void testCallFailed();
+  void testThen();
+  void testThenFailed();
+  void testCancelPending();
+  void testCancelRunning();
+  void testTimeout();
+};
+
+#endif // RADIOJOBTEST_HH
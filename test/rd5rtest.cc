@@ -488,4 +488,24 @@ RD5RTest::testDecode() {
   QCOMPARE(decoded.gpsSystems()->count(), 0);
 }
 
+void
+RD5RTest::testPatchIdentity() {
+  RD5RCodeplug codeplug;
+  QVERIFY(codeplug.encode(&_config));
+
+  CodePlug::Identity identity;
+  identity.id = 2345678;
+  identity.name = "FLEET1";
+  identity.introLine1 = "GHI";
+  identity.introLine2 = "JKL";
+  QVERIFY(codeplug.patchIdentity(identity));
+
+  QCOMPARE(decode_ascii(codeplug.data(0x000e0+0x00), 8, 0xff), QString("FLEET1"));
+  QCOMPARE(decode_dmr_id_bcd(codeplug.data(0x000e0+0x08)), 2345678U);
+  QCOMPARE(decode_ascii(codeplug.data(0x07540+0x00), 16, 0xff), QString("GHI"));
+  QCOMPARE(decode_ascii(codeplug.data(0x07540+0x10), 16, 0xff), QString("JKL"));
+  // Channels are left untouched
+  QCOMPARE(memcmp(codeplug.data(0x03780), _codeplug.data(0x03780), 0x10+5*0x38), 0);
+}
+
 QTEST_GUILESS_MAIN(RD5RTest)
@@ -29,6 +29,7 @@ private slots:
   void testZones();
   void testScanLists();
   void testDecode();
+  void testPatchIdentity();
 
 protected:
   Config _config;
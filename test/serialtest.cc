@@ -0,0 +1,153 @@
+#include "serialtest.hh"
+#include "usbserial.hh"
+#include <QTest>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <termios.h>
+
+/** Size of a request to the emulated radio. */
+#define REQUEST_SIZE  16
+/** Size of the response, the request repeated twice. */
+#define RESPONSE_SIZE 32
+
+
+/** Exposes the I/O of the serial interface to the test. */
+class PtySerial: public USBSerial
+{
+public:
+  PtySerial(const QString &device, Backend backend)
+    : USBSerial(device, backend)
+  {
+    // pass...
+  }
+
+  bool exchange(const char *request, char *response) {
+    if (REQUEST_SIZE != transmit(request, REQUEST_SIZE))
+      return false;
+    return receiveExact(response, RESPONSE_SIZE, 1000);
+  }
+
+  QString identifier() { return "pty"; }
+  bool write_start(uint32_t, uint32_t) { return false; }
+  bool write(uint32_t, uint32_t, uint8_t *, int) { return false; }
+  bool write_finish() { return false; }
+  bool read_start(uint32_t, uint32_t) { return false; }
+  bool read(uint32_t, uint32_t, uint8_t *, int) { return false; }
+  bool read_finish() { return false; }
+};
+
+
+SerialTest::SerialTest(QObject *parent)
+  : QObject(parent), _master(-1), _device(), _emulator(), _stop(false), _failed(false)
+{
+  // pass...
+}
+
+void
+SerialTest::initTestCase() {
+  _master = posix_openpt(O_RDWR | O_NOCTTY);
+  QVERIFY(0 <= _master);
+  QVERIFY(0 == grantpt(_master));
+  QVERIFY(0 == unlockpt(_master));
+  _device = ptsname(_master);
+
+  struct termios tio;
+  QVERIFY(0 == tcgetattr(_master, &tio));
+  cfmakeraw(&tio);
+  QVERIFY(0 == tcsetattr(_master, TCSANOW, &tio));
+
+  _stop = false;
+  _failed = false;
+  _emulator = std::thread(&SerialTest::emulate, this);
+}
+
+void
+SerialTest::cleanupTestCase() {
+  _stop = true;
+  if (_emulator.joinable())
+    _emulator.join();
+  if (0 <= _master)
+    ::close(_master);
+}
+
+void
+SerialTest::emulate() {
+  char request[REQUEST_SIZE];
+  int len = 0;
+  while (! _stop) {
+    struct pollfd pfd = {_master, POLLIN, 0};
+    if ((0 >= poll(&pfd, 1, 100)) || (! (pfd.revents & POLLIN)))
+      continue;
+    ssize_t n = ::read(_master, request+len, REQUEST_SIZE-len);
+    if (0 >= n)
+      continue;
+    if (REQUEST_SIZE > (len += n))
+      continue;
+    len = 0;
+    // Respond in two chunks like USB-CDC devices do for larger responses
+    if ((! writeAll(request, 8)) || (! writeAll(request+8, REQUEST_SIZE-8))
+        || (! writeAll(request, REQUEST_SIZE))) {
+      _failed = true;
+      return;
+    }
+  }
+}
+
+bool
+SerialTest::writeAll(const char *data, size_t len) {
+  while (len) {
+    ssize_t n = ::write(_master, data, len);
+    if ((0 > n) && (EINTR == errno))
+      continue;
+    if (0 >= n)
+      return false;
+    data += n; len -= size_t(n);
+  }
+  return true;
+}
+
+void
+SerialTest::testExchange_data() {
+  QTest::addColumn<int>("backend");
+  QTest::newRow("qt") << int(USBSerial::QtBackend);
+  QTest::newRow("native") << int(USBSerial::NativeBackend);
+}
+
+void
+SerialTest::testExchange() {
+  QFETCH(int, backend);
+  PtySerial serial(_device, USBSerial::Backend(backend));
+  QVERIFY2(serial.isOpen(), serial.errorMessage().toLocal8Bit().constData());
+
+  char request[REQUEST_SIZE], response[RESPONSE_SIZE];
+  for (int i=0; i<100; i++) {
+    memset(request, i, REQUEST_SIZE);
+    QVERIFY2(serial.exchange(request, response), _failed ? "Emulator failed to respond." : "");
+    QCOMPARE(memcmp(request, response, REQUEST_SIZE), 0);
+    QCOMPARE(memcmp(request, response+REQUEST_SIZE, REQUEST_SIZE), 0);
+  }
+}
+
+void
+SerialTest::benchmarkExchange_data() {
+  testExchange_data();
+}
+
+void
+SerialTest::benchmarkExchange() {
+  QFETCH(int, backend);
+  PtySerial serial(_device, USBSerial::Backend(backend));
+  QVERIFY2(serial.isOpen(), serial.errorMessage().toLocal8Bit().constData());
+
+  char request[REQUEST_SIZE], response[RESPONSE_SIZE];
+  memset(request, 0x55, REQUEST_SIZE);
+  QBENCHMARK {
+    QVERIFY(serial.exchange(request, response));
+  }
+}
+
+QTEST_GUILESS_MAIN(SerialTest)
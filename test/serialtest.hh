@@ -0,0 +1,43 @@
+#ifndef SERIALTEST_HH
+#define SERIALTEST_HH
+
+#include <QObject>
+#include <thread>
+#include <atomic>
+
+class SerialTest : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit SerialTest(QObject *parent = nullptr);
+
+private slots:
+  void initTestCase();
+  void cleanupTestCase();
+
+  void testExchange_data();
+  void testExchange();
+  void benchmarkExchange_data();
+  void benchmarkExchange();
+
+protected:
+  /** Emulates a radio at the master side of the pseudo terminal. */
+  void emulate();
+  /** Writes the complete buffer to the master side. Returns @c false on error. */
+  bool writeAll(const char *data, size_t len);
+
+protected:
+  /** Master side of the pseudo terminal. */
+  int _master;
+  /** Path to the slave side of the pseudo terminal. */
+  QString _device;
+  /** The emulator thread. */
+  std::thread _emulator;
+  /** Stops the emulator. */
+  std::atomic<bool> _stop;
+  /** Gets set if the emulator failed to respond. */
+  std::atomic<bool> _failed;
+};
+
+#endif // SERIALTEST_HH
@@ -0,0 +1,275 @@
+#include "uploadtest.hh"
+#include "uploadjournal.hh"
+#include "uploadcache.hh"
+#include <QTest>
+#include <QStandardPaths>
+#include <string.h>
+
+UploadTest::UploadTest(QObject *parent)
+  : QObject(parent)
+{
+  // pass...
+}
+
+void
+UploadTest::initTestCase() {
+  // Keep journals and caches away from the user's cache directory
+  QStandardPaths::setTestModeEnabled(true);
+}
+
+void
+UploadTest::cleanup() {
+  UploadJournal journal("Test Radio", "DEV1");
+  journal.finish();
+  // Loading removes the cache
+  UploadCache cache("Test Radio", "DEV1");
+  cache.load(QByteArray());
+}
+
+/** Allocates two runs of memory and fills them with a pattern. */
+static void
+fillMemory(CodePlug::PagedImage &memory) {
+  memory.allocate(0x1000, 0x800);
+  memory.allocate(0x2300, 0x200);
+  foreach (const CodePlug::PagedImage::Run &run, memory.runs())
+    for (uint32_t a=run.address; a<(run.address+run.size); a++)
+      *memory.data(a) = uint8_t(a*7);
+}
+
+void
+UploadTest::testJournalResume() {
+  QByteArray hash = QByteArray("image hash");
+
+  // First upload fails after two units
+  {
+    UploadJournal journal("Test Radio", "DEV1");
+    journal.open(hash);
+    QVERIFY(! journal.isResumable());
+    QVERIFY(journal.begin());
+    journal.confirm(0x0100, 0x11111111);
+    journal.confirm(0x0200, 0x22222222);
+  }
+
+  // Retry of the same image to the same device resumes
+  UploadJournal journal("Test Radio", "DEV1");
+  journal.open(hash);
+  QVERIFY(journal.isResumable());
+  QVERIFY(journal.isConfirmed(0x0100, 0x11111111));
+  QVERIFY(journal.isConfirmed(0x0200, 0x22222222));
+  QVERIFY(! journal.isConfirmed(0x0300, 0x33333333));
+  // CRC mismatch, e.g., content changed
+  QVERIFY(! journal.isConfirmed(0x0100, 0x22222222));
+
+  // Rejected units are not confirmed and not written again by begin()
+  journal.reject(0x0100);
+  QVERIFY(! journal.isConfirmed(0x0100, 0x11111111));
+  QVERIFY(journal.begin());
+  journal.confirm(0x0300, 0x33333333);
+  {
+    UploadJournal reread("Test Radio", "DEV1");
+    reread.open(hash);
+    QVERIFY(! reread.isConfirmed(0x0100, 0x11111111));
+    QVERIFY(reread.isConfirmed(0x0200, 0x22222222));
+    QVERIFY(reread.isConfirmed(0x0300, 0x33333333));
+  }
+
+  // Completed uploads leave no journal
+  journal.finish();
+  QVERIFY(! journal.isResumable());
+  {
+    UploadJournal reread("Test Radio", "DEV1");
+    reread.open(hash);
+    QVERIFY(! reread.isResumable());
+  }
+}
+
+void
+UploadTest::testJournalMismatch() {
+  {
+    UploadJournal journal("Test Radio", "DEV1");
+    journal.open("image A");
+    QVERIFY(journal.begin());
+    journal.confirm(0x0100, 0x11111111);
+  }
+
+  // Another image
+  {
+    UploadJournal journal("Test Radio", "DEV1");
+    journal.open("image B");
+    QVERIFY(! journal.isResumable());
+  }
+  // Another device
+  {
+    UploadJournal journal("Test Radio", "DEV2");
+    journal.open("image A");
+    QVERIFY(! journal.isResumable());
+  }
+  // Same upload
+  {
+    UploadJournal journal("Test Radio", "DEV1");
+    journal.open("image A");
+    QVERIFY(journal.isResumable());
+  }
+  // An upload to another device of the same model keeps the journal
+  {
+    UploadJournal journal("Test Radio", "DEV2");
+    journal.open("image A");
+    QVERIFY(journal.begin());
+    journal.confirm(0x0100, 0x11111111);
+  }
+  {
+    UploadJournal journal("Test Radio", "DEV1");
+    journal.open("image A");
+    QVERIFY(journal.isResumable());
+    QVERIFY(journal.isConfirmed(0x0100, 0x11111111));
+  }
+}
+
+void
+UploadTest::testJournalLayout() {
+  CodePlug::PagedImage memory, other;
+  fillMemory(memory);
+  fillMemory(other);
+  QByteArray layout = UploadJournal::layout(memory);
+
+  // The layout ignores the content, the image hash does not
+  *other.data(0x1010) ^= 0xff;
+  QCOMPARE(UploadJournal::layout(other), layout);
+  QVERIFY(UploadJournal::hash(other) != UploadJournal::hash(memory));
+
+  // but not the memory allocated
+  other.allocate(0x4000, 0x100);
+  QVERIFY(UploadJournal::layout(other) != layout);
+}
+
+void
+UploadTest::testCacheUnits() {
+  CodePlug::PagedImage memory;
+  fillMemory(memory);
+
+  // Units do not cross the unit boundaries
+  QVector<CodePlug::PagedImage::Run> units = UploadCache::units(memory, {});
+  QCOMPARE(units.size(), 4);
+  QCOMPARE(units[0].address, 0x1000U); QCOMPARE(units[0].size, 0x400U);
+  QCOMPARE(units[1].address, 0x1400U); QCOMPARE(units[1].size, 0x400U);
+  QCOMPARE(units[2].address, 0x2300U); QCOMPARE(units[2].size, 0x100U);
+  QCOMPARE(units[3].address, 0x2400U); QCOMPARE(units[3].size, 0x100U);
+
+  // Only dirty memory within the spans
+  units = UploadCache::units(memory, {{0x1200, 0x400}, {0x2480, 0x100}});
+  QCOMPARE(units.size(), 3);
+  QCOMPARE(units[0].address, 0x1200U); QCOMPARE(units[0].size, 0x200U);
+  QCOMPARE(units[1].address, 0x1400U); QCOMPARE(units[1].size, 0x200U);
+  QCOMPARE(units[2].address, 0x2480U); QCOMPARE(units[2].size, 0x080U);
+
+  memory.markClean(0x1000, 0x600);
+  units = UploadCache::units(memory, {});
+  QCOMPARE(units.size(), 3);
+  QCOMPARE(units[0].address, 0x1600U); QCOMPARE(units[0].size, 0x200U);
+}
+
+void
+UploadTest::testCacheSkipUnchanged() {
+  QByteArray state("device state"), content("device content");
+
+  // First upload writes everything
+  {
+    CodePlug::PagedImage memory;
+    fillMemory(memory);
+    UploadCache cache("Test Radio", "DEV1");
+    QVERIFY(! cache.load(state));
+    QCOMPARE(cache.skipUnchanged(memory, {}), 0U);
+    QVERIFY(cache.store(state, content));
+  }
+  QVERIFY(UploadCache::exists("Test Radio", "DEV1"));
+  QVERIFY(! UploadCache::exists("Test Radio", "DEV2"));
+
+  // Devices without identity have no cache
+  {
+    CodePlug::PagedImage memory;
+    fillMemory(memory);
+    UploadCache cache("Test Radio", "");
+    QVERIFY(! cache.load(state));
+    cache.skipUnchanged(memory, {});
+    QVERIFY(! cache.store(state, content));
+    QVERIFY(! UploadCache::exists("Test Radio", ""));
+  }
+
+  // One unit changed in the config, the others are skipped without reading the device
+  {
+    CodePlug::PagedImage memory;
+    fillMemory(memory);
+    *memory.data(0x1400) ^= 0xff;
+    UploadCache cache("Test Radio", "DEV1");
+    QVERIFY(cache.load(state));
+    QCOMPARE(cache.skipUnchanged(memory, {{0x1000, 0x800}}), 0x400U);
+    QCOMPARE(cache.skipUnchanged(memory, {}), 0x200U);
+    QVERIFY(! memory.isDirty(0x1000, 0x400));
+    QVERIFY(memory.isDirty(0x1400, 0x400));
+    QVERIFY(! memory.isDirty(0x2300, 0x200));
+    QCOMPARE(cache.verify(memory, content), 0U);
+    QVERIFY(cache.store(state, content));
+  }
+
+  // Bitmaps changed on the device
+  {
+    CodePlug::PagedImage memory;
+    fillMemory(memory);
+    UploadCache cache("Test Radio", "DEV1");
+    QVERIFY(! cache.load("other state"));
+    QCOMPARE(cache.skipUnchanged(memory, {}), 0U);
+    QVERIFY(cache.store(state, content));
+  }
+
+  // Remaining content changed on the device, skipped units are written anyway
+  CodePlug::PagedImage memory;
+  fillMemory(memory);
+  UploadCache cache("Test Radio", "DEV1");
+  QVERIFY(cache.load(state));
+  QCOMPARE(cache.skipUnchanged(memory, {{0x1000, 0x800}}), 0x800U);
+  QCOMPARE(cache.verify(memory, "other content"), 0x800U);
+  QVERIFY(memory.isDirty(0x1000, 0x800));
+  QCOMPARE(cache.skipUnchanged(memory, {}), 0U);
+  QVERIFY(memory.isDirty(0x2300, 0x200));
+
+  // The record is removed once loaded, a failed upload writes everything next time
+  QVERIFY(! UploadCache::exists("Test Radio", "DEV1"));
+}
+
+/** Number of round-trips to transfer @c size bytes in requests of 16 bytes, of which @c window
+ * requests are sent before waiting for their acknowledgements (see @c AnytoneInterface). */
+static uint32_t
+roundTrips(uint32_t size, uint32_t window) {
+  return (size+16*window-1)/(16*window);
+}
+
+void
+UploadTest::testCacheTransferCost() {
+  // Codeplug of 1MiB with one record changed since the last upload
+  CodePlug::PagedImage memory;
+  memory.allocate(0x100000, 0x100000);
+  {
+    UploadCache cache("Test Radio", "DEV1");
+    cache.skipUnchanged(memory, {});
+    QVERIFY(cache.store("state", "content"));
+  }
+  *memory.data(0x100010) ^= 0xff;
+  UploadCache cache("Test Radio", "DEV1");
+  QVERIFY(cache.load("state"));
+  uint32_t skipped = cache.skipUnchanged(memory, {});
+  QCOMPARE(skipped, 0x100000U-UploadCache::UNIT_SIZE);
+
+  // Writing everything, reading back every skipped unit before and skipping it without reading
+  uint32_t written = 0;
+  foreach (const CodePlug::PagedImage::Run &run, memory.runs(true))
+    written += roundTrips(run.size, 8);
+  uint32_t complete = roundTrips(0x100000, 8);
+  uint32_t readBack = roundTrips(skipped, 1) + written;
+  qDebug() << "Round-trips: complete" << complete << ", read back" << readBack
+           << ", skipped" << written;
+  QVERIFY(readBack > complete);
+  QCOMPARE(written, roundTrips(UploadCache::UNIT_SIZE, 8));
+  QVERIFY(written < complete/100);
+}
+
+QTEST_GUILESS_MAIN(UploadTest)
@@ -0,0 +1,25 @@
+#ifndef UPLOADTEST_HH
+#define UPLOADTEST_HH
+
+#include <QObject>
+
+class UploadTest : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit UploadTest(QObject *parent = nullptr);
+
+private slots:
+  void initTestCase();
+  void cleanup();
+
+  void testJournalResume();
+  void testJournalMismatch();
+  void testJournalLayout();
+  void testCacheUnits();
+  void testCacheSkipUnchanged();
+  void testCacheTransferCost();
+};
+
+#endif // UPLOADTEST_HH
@@ -0,0 +1,315 @@
+#include "userdbtest.hh"
+#include "userdatabase.hh"
+#include "uv390_callsigndb.hh"
+#include "d878uv_callsigndb.hh"
+#include "codeplug.hh"
+#include <QTest>
+#include <QStandardPaths>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QFile>
+#include <QDir>
+#include <QtEndian>
+#include <algorithm>
+
+#define FIRST_ID 2621000
+
+UserDBTest::UserDBTest(QObject *parent)
+  : QObject(parent), _dir(), _db(nullptr)
+{
+  // pass...
+}
+
+void
+UserDBTest::initTestCase() {
+  // Keep user DB and snapshots away from the user's data directory
+  QStandardPaths::setTestModeEnabled(true);
+  QString path = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+  QVERIFY(QDir().mkpath(path));
+  // A recent user DB is present, hence nothing gets downloaded
+  QVERIFY(writeUsers(path+"/user.json", 100));
+  _db = new UserDatabase(30, this);
+  QTRY_VERIFY(! _db->isLoading());
+  QCOMPARE(_db->count(), qint64(100));
+}
+
+void
+UserDBTest::cleanupTestCase() {
+  QString path = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+  QFile::remove(path+"/user.json");
+}
+
+void
+UserDBTest::cleanup() {
+  _db->clearLastWritten("Test Radio");
+  QVERIFY(_db->load());
+}
+
+bool
+UserDBTest::writeUsers(const QString &filename, int n, uint changed, uint removed) {
+  QJsonArray users;
+  for (int i=0; i<n; i++) {
+    uint id = FIRST_ID + i;
+    QJsonObject user;
+    user.insert("id", int(removed == id ? FIRST_ID+n : id));
+    user.insert("callsign", QString("DL%1ABC").arg(i));
+    user.insert("fname", (changed == id) ? QString("Changed") : QString("Name%1").arg(i));
+    user.insert("surname", QString("Surname%1").arg(i));
+    user.insert("country", QString("Germany"));
+    users.append(user);
+  }
+  QJsonObject db;
+  db.insert("users", users);
+
+  QFile file(filename);
+  if (! file.open(QIODevice::WriteOnly))
+    return false;
+  file.write(QJsonDocument(db).toJson());
+  file.close();
+  return true;
+}
+
+void
+UserDBTest::testSnapshotDiff() {
+  UserDatabase::Snapshot previous = _db->snapshot(100);
+  QCOMPARE(previous.entries.size(), 100);
+  QVERIFY(_db->diff(previous, 100).isEmpty());
+
+  QVERIFY(writeUsers(_dir.filePath("users.json"), 100, FIRST_ID+5, FIRST_ID+10));
+  QVERIFY(_db->load(_dir.filePath("users.json")));
+  UserDatabase::Diff diff = _db->diff(previous, 100);
+  QCOMPARE(diff.changed.size(), 1);
+  QVERIFY(diff.changed.contains(FIRST_ID+5));
+  QCOMPARE(diff.removed.size(), 1);
+  QVERIFY(diff.removed.contains(FIRST_ID+10));
+  QCOMPARE(diff.added.size(), 1);
+  QVERIFY(diff.added.contains(FIRST_ID+100));
+}
+
+void
+UserDBTest::testLastWritten() {
+  UserDatabase::Snapshot snapshot = _db->snapshot(100);
+  snapshot.address = 0x100000;
+  snapshot.image = QByteArray(1024, 0x55);
+
+  // Snapshots are kept per device
+  QVERIFY(_db->setLastWritten("Test Radio", "DEV1", snapshot));
+  QCOMPARE(_db->lastWritten("Test Radio", "DEV1").entries, snapshot.entries);
+  QCOMPARE(_db->lastWritten("Test Radio", "DEV1").image, snapshot.image);
+  QVERIFY(_db->lastWritten("Test Radio", "DEV2").isEmpty());
+  QVERIFY(_db->lastWritten("Other Radio", "DEV1").isEmpty());
+
+  // Devices without identity get no snapshot
+  QVERIFY(! _db->setLastWritten("Test Radio", "", snapshot));
+  QVERIFY(_db->lastWritten("Test Radio", "").isEmpty());
+
+  // Clear a single device or all devices of a radio
+  QVERIFY(_db->setLastWritten("Test Radio", "DEV2", snapshot));
+  _db->clearLastWritten("Test Radio", "DEV1");
+  QVERIFY(_db->lastWritten("Test Radio", "DEV1").isEmpty());
+  QVERIFY(! _db->lastWritten("Test Radio", "DEV2").isEmpty());
+  _db->clearLastWritten("Test Radio");
+  QVERIFY(_db->lastWritten("Test Radio", "DEV2").isEmpty());
+}
+
+void
+UserDBTest::testIncrementalEncode() {
+  UV390CallsignDB written;
+  written.encode(_db);
+  UserDatabase::Snapshot previous = written.snapshot();
+
+  QVERIFY(writeUsers(_dir.filePath("users.json"), 100, FIRST_ID+5, FIRST_ID+10));
+  QVERIFY(_db->load(_dir.filePath("users.json")));
+
+  // Updating the DB last written must result in the same DB as a complete encoding
+  UV390CallsignDB full, incremental;
+  full.encode(_db);
+  incremental.encode(_db, previous);
+  QCOMPARE(incremental.image(0).element(0).data(), full.image(0).element(0).data());
+
+  // Only the modified blocks get written
+  uint addr = full.image(0).element(0).address();
+  uint size = full.image(0).element(0).memSize();
+  uint dirty = 0, total = 0;
+  for (uint b=addr; b<(addr+size); b+=1024, total++) {
+    QVERIFY(full.isDirty(b));
+    if (incremental.isDirty(b))
+      dirty++;
+  }
+  QVERIFY(0 < dirty);
+  QVERIFY(dirty < total);
+}
+
+void
+UserDBTest::testResetOrder() {
+  _db->sortUsers(FIRST_ID+50);
+  QCOMPARE(_db->user(0).id, uint(FIRST_ID+50));
+  QCOMPARE(_db->searchIndex().findId(QString::number(FIRST_ID+50), 1).value(0, -1), 0);
+
+  // Restores the order and the search index
+  _db->resetOrder();
+  for (int i=0; i<_db->count(); i++)
+    QCOMPARE(_db->user(i).id, uint(FIRST_ID+i));
+  QCOMPARE(_db->searchIndex().findId(QString::number(FIRST_ID+50), 1).value(0, -1), 50);
+}
+
+void
+UserDBTest::testUserIndex() {
+  QVector<UserDatabase::User> users(4);
+  users[0].id = 2621370; users[0].call = "DM3MAT"; users[0].name = "Hannes";
+  users[1].id = 262137;  users[1].call = "DL1ABC"; users[1].name = "Anna"; users[1].surname = "Maria";
+  users[2].id = 3101234; users[2].call = "W1AW";   users[2].name = "Hiram";
+  users[3].id = 26213;   users[3].call = "DM1XY";  users[3].name = "Matthias";
+
+  UserDatabase::Index index;
+  index.build(users);
+
+  // Call-signs, case-insensitive and ordered
+  QCOMPARE(index.findCall("dm", 10), QVector<int>({3, 0}));
+  QCOMPARE(index.findCall("dm", 1), QVector<int>({3}));
+  QCOMPARE(index.findCall("X", 10), QVector<int>());
+  // ID prefixes of different lengths
+  QCOMPARE(index.findId("26213", 10), QVector<int>({3, 1, 0}));
+  QCOMPARE(index.findId("0", 10), QVector<int>());
+  // Names and surnames
+  QCOMPARE(index.findName("ma", 10), QVector<int>({1, 3}));
+  // Combined search, call-signs first
+  QCOMPARE(index.find("h", 10), QVector<int>({0, 2}));
+  QCOMPARE(index.find("3101", 10), QVector<int>({2}));
+
+  // Rows follow a reordering of the users
+  index.remap(QVector<int>({3, 2, 1, 0}));
+  QCOMPARE(index.findCall("dm", 10), QVector<int>({0, 3}));
+}
+
+/** Collects the chunks emitted by the given D878UV call-sign DB encoder. */
+static bool
+collectChunks(D878UVCallsignDB &db, CodePlug::PagedImage &memory,
+              QVector<CodePlug::PagedImage::Run> &chunks)
+{
+  uint32_t addr; QByteArray data; qint64 size = 0;
+  while (db.next(addr, data)) {
+    if ((0 != (data.size()%16)) || memory.isAllocated(addr, data.size()))
+      return false;
+    memory.allocate(addr, data.size());
+    // Chunks may not be contiguous within the image, copy byte-wise
+    for (int i=0; i<data.size(); i++)
+      *memory.data(addr+i) = uint8_t(data.at(i));
+    chunks.append({addr, uint32_t(data.size())});
+    size += data.size();
+  }
+  return size == db.size();
+}
+
+/** Compares the memory at the given address with the given hex string. */
+static bool
+compareHex(const CodePlug::PagedImage &memory, uint32_t addr, const char *hex) {
+  QByteArray expected = QByteArray::fromHex(hex);
+  if (! memory.isAllocated(addr, expected.size()))
+    return false;
+  for (int i=0; i<expected.size(); i++) {
+    if (*memory.data(addr+i) != uint8_t(expected.at(i)))
+      return false;
+  }
+  return true;
+}
+
+void
+UserDBTest::testD878UVEncode() {
+  // Users not in ID order, with an empty surname and fields exceeding their limits
+  QJsonArray users;
+  users.append(QJsonObject({{"id", 2621001}, {"callsign", "DL1ABC"}, {"fname", "Hans"},
+                            {"surname", "Mueller"}, {"country", "Germany"}}));
+  users.append(QJsonObject({{"id", 2621000}, {"callsign", "DL2XYZ"}, {"fname", "Anna"},
+                            {"surname", ""}, {"country", "Austria"}}));
+  users.append(QJsonObject({{"id", 1234567}, {"callsign", "DL3LONGCALL"},
+                            {"fname", "VeryLongFirstName"}, {"surname", "Surname"},
+                            {"country", "Switzerland"}}));
+  QFile file(_dir.filePath("golden.json"));
+  QVERIFY(file.open(QIODevice::WriteOnly));
+  file.write(QJsonDocument(QJsonObject({{"users", users}})).toJson());
+  file.close();
+  QVERIFY(_db->load(file.fileName()));
+
+  D878UVCallsignDB db;
+  db.encode(_db);
+  QCOMPARE(db.count(), 3U);
+  CodePlug::PagedImage memory;
+  QVector<CodePlug::PagedImage::Run> chunks;
+  QVERIFY(collectChunks(db, memory, chunks));
+  QCOMPARE(memory.memSize(), 0x20U + 0x70U + 0x10U);
+
+  // Index ordered by ID
+  QVERIFY(compareHex(memory, 0x04000000,
+                     "0123456700000000026210002b000000"
+                     "02621001440000000000000000000000"));
+  // Records, no trailing space for the empty surname
+  QVERIFY(compareHex(memory, 0x04500000,
+                     "0000566572794c6f6e6746697273744e"
+                     "616d0000444c334c4f4e474300005377"
+                     "69747a65726c616e6400000000416e6e"
+                     "610000444c3258595a00004175737472"
+                     "69610000000048616e73204d75656c6c"
+                     "65720000444c3141424300004765726d"
+                     "616e7900000000000000000000000000"));
+  // Limits
+  QVERIFY(compareHex(memory, 0x044c0000, "03000000650050040000000000000000"));
+}
+
+void
+UserDBTest::testD878UVEncodeBanks() {
+  // Enough users to fill more than two record banks of 0x186a0 bytes
+  const int n = 6000;
+  QVERIFY(writeUsers(_dir.filePath("many.json"), n));
+  QVERIFY(_db->load(_dir.filePath("many.json")));
+
+  D878UVCallsignDB db;
+  db.encode(_db);
+  QCOMPARE(db.count(), uint(n));
+  CodePlug::PagedImage memory;
+  QVector<CodePlug::PagedImage::Run> chunks;
+  QVERIFY(collectChunks(db, memory, chunks));
+
+  // Record chunks stay within their bank, banks start every 0x40000 bytes
+  foreach (const CodePlug::PagedImage::Run &chunk, chunks) {
+    if (0x04500000 > chunk.address)
+      continue;
+    QVERIFY((chunk.address-0x04500000)%0x40000 + chunk.size <= 0x186a0);
+  }
+  QVERIFY(memory.isAllocated(0x04500000, 0x186a0));
+  QVERIFY(! memory.isAllocated(0x045186a0, 0x10));
+  QVERIFY(memory.isAllocated(0x04540000, 0x186a0));
+  QVERIFY(! memory.isAllocated(0x045586a0, 0x10));
+  QVERIFY(memory.isAllocated(0x04580000, 0x10));
+
+  // Follow the index to each record, records may continue in the next bank
+  auto record = [&memory](uint32_t offset, int size) {
+    QByteArray data;
+    for (uint32_t o=offset; o<(offset+size); o++)
+      data.append(char(*memory.data(0x04500000 + (o/0x186a0)*0x40000 + o%0x186a0)));
+    return data;
+  };
+  uint32_t end = 0;
+  for (int i=0; i<n; i++) {
+    const uint8_t *entry = memory.data(0x04000000+8*i);
+    // IDs are 8 digit BCD
+    quint32 bcd = QString::number(FIRST_ID+i).toUInt(nullptr, 16);
+    QCOMPARE(qFromBigEndian<quint32>(entry), bcd);
+    uint32_t offset = qFromLittleEndian<quint32>(entry+4);
+    QByteArray name = QString("Name%1 Surname%1").arg(i).left(16).toLatin1();
+    QByteArray call = QString("DL%1ABC").arg(i).toLatin1();
+    QByteArray expected = QByteArray(2, 0x00) + name + QByteArray(2, 0x00) + call
+        + QByteArray(2, 0x00) + "Germany" + QByteArray(2, 0x00);
+    QCOMPARE(record(offset, expected.size()), expected);
+    end = offset + expected.size();
+  }
+  QVERIFY(end > 2*0x186a0);
+
+  // Limits point behind the last record in the third bank
+  const uint8_t *limits = memory.data(0x044c0000);
+  QCOMPARE(qFromLittleEndian<quint32>(limits), quint32(n));
+  QCOMPARE(qFromLittleEndian<quint32>(limits+4), quint32(0x04580000 + end - 2*0x186a0));
+}
+
+QTEST_GUILESS_MAIN(UserDBTest)
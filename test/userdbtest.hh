@@ -0,0 +1,39 @@
+#ifndef USERDBTEST_HH
+#define USERDBTEST_HH
+
+#include <QObject>
+#include <QTemporaryDir>
+
+class UserDatabase;
+
+class UserDBTest : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit UserDBTest(QObject *parent = nullptr);
+
+private slots:
+  void initTestCase();
+  void cleanupTestCase();
+  void cleanup();
+
+  void testSnapshotDiff();
+  void testLastWritten();
+  void testIncrementalEncode();
+  void testResetOrder();
+  void testUserIndex();
+  void testD878UVEncode();
+  void testD878UVEncodeBanks();
+
+protected:
+  /** Writes a user DB of @c n users to @c filename. The user with ID @c changed gets a different
+   * name, the user with ID @c removed is replaced by a new one. */
+  bool writeUsers(const QString &filename, int n, uint changed=0, uint removed=0);
+
+protected:
+  QTemporaryDir _dir;
+  UserDatabase *_db;
+};
+
+#endif // USERDBTEST_HH
@@ -1,7 +1,39 @@
 #include "utilstest.hh"
 
 #include <QTest>
+#include <QSignalSpy>
 #include "utils.hh"
+#include "codeplug.hh"
+#include "signaling.hh"
+#include "transferprogress.hh"
+#include <QThreadPool>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QAtomicInt>
+#include <numeric>
+
+/** Calls @c parallel_for from within a pool thread. */
+class NestedParallelFor: public QRunnable
+{
+public:
+  NestedParallelFor(QVector<int> &result, QSemaphore &done)
+    : QRunnable(), _result(result), _done(done)
+  {
+    // pass...
+  }
+
+  void run() {
+    QVector<int> &result = _result;
+    parallel_for(result.size(), [&result](int i) {
+      result[i] = i*i;
+    }, 1);
+    _done.release();
+  }
+
+protected:
+  QVector<int> &_result;
+  QSemaphore &_done;
+};
 
 UtilsTest::UtilsTest(QObject *parent) : QObject(parent)
 {
@@ -55,6 +87,43 @@ UtilsTest::testEncodeFrequency() {
   QCOMPARE(decode_frequency(encode_frequency(439.5630)), 439.5630);
 }
 
+void
+UtilsTest::testBCD8() {
+  QCOMPARE(decode_bcd8(0x12345678U), 12345678U);
+  QCOMPARE(encode_bcd8(12345678U), 0x12345678U);
+  QCOMPARE(encode_bcd8(99999999U), 0x99999999U);
+  QCOMPARE(encode_bcd8(0U), 0x00000000U);
+  for (uint32_t i=0; i<100000000U; i+=9973U)
+    QCOMPARE(decode_bcd8(encode_bcd8(i)), i);
+
+  QCOMPARE(decode_frequency_hz(0x43956250U), Frequency(439562500));
+  QCOMPARE(encode_frequency_hz(439562500), 0x43956250U);
+}
+
+void
+UtilsTest::testParseFrequency() {
+  Frequency hz = 0;
+  QVERIFY(parse_frequency_hz("439.5625", hz));
+  QCOMPARE(hz, Frequency(439562500));
+  QVERIFY(parse_frequency_hz("-7.6", hz));
+  QCOMPARE(hz, Frequency(-7600000));
+  QVERIFY(parse_frequency_hz("+5", hz));
+  QCOMPARE(hz, Frequency(5000000));
+  QVERIFY(parse_frequency_hz("145.", hz));
+  QCOMPARE(hz, Frequency(145000000));
+  QVERIFY(parse_frequency_hz("145.0000005", hz));
+  QCOMPARE(hz, Frequency(145000001));
+  QVERIFY(! parse_frequency_hz("abc", hz));
+  QVERIFY(! parse_frequency_hz("", hz));
+}
+
+void
+UtilsTest::testFormatFrequency() {
+  QCOMPARE(format_frequency_hz(439562500), QString("439.56250"));
+  QCOMPARE(format_frequency_hz(-600000), QString("-0.60000"));
+  QCOMPARE(format_frequency_hz(145000000), format_frequency(145.0));
+}
+
 void
 UtilsTest::testDecodeDMRID_bcd() {
   uint8_t bcd[4] = {0x12, 0x34, 0x56, 0x78};
@@ -71,5 +140,200 @@ UtilsTest::testEncodeDMRID_bcd() {
   QCOMPARE(res, QByteArray(bcd, 4));
 }
 
+void
+UtilsTest::testPagedImage() {
+  CodePlug::PagedImage memory;
+  // Allocate two ranges within one page and one spanning several pages
+  QVERIFY(memory.allocate(0x02500000, 0x40, 0xff));
+  QVERIFY(memory.allocate(0x02500080, 0x20));
+  QVERIFY(memory.allocate(0x025003f0, 0x820, 0x11));
+  QVERIFY(memory.isAllocated(0x02500000, 0x40));
+  QVERIFY(! memory.isAllocated(0x02500000, 0x50));
+  QVERIFY(nullptr == memory.data(0x02500040));
+  QCOMPARE(int(memory.data(0x02500000)[0x3f]), 0xff);
+  QCOMPARE(int(memory.data(0x02500080)[0]), 0x00);
+  QCOMPARE(memory.memSize(), uint32_t(0x40+0x20+0x820));
+
+  // Multi-page range is contiguous
+  memory.data(0x025003f0)[0x81f] = 0x22;
+  QCOMPARE(int(memory.data(0x02500c00)[0x0f]), 0x22);
+
+  // Runs in ascending order, split at maxSize
+  QVector<CodePlug::PagedImage::Run> runs = memory.runs();
+  QCOMPARE(runs.size(), 3);
+  QCOMPARE(runs[0].address, uint32_t(0x02500000)); QCOMPARE(runs[0].size, uint32_t(0x40));
+  QCOMPARE(runs[2].address, uint32_t(0x025003f0)); QCOMPARE(runs[2].size, uint32_t(0x820));
+  QCOMPARE(memory.runs(false, 0x400).size(), 5);
+
+  // Dirty tracking
+  memory.markClean(0x02500000, 0x1000);
+  QCOMPARE(memory.runs(true).size(), 0);
+  memory.markDirty(0x02500400, 0x10);
+  QVERIFY(memory.isDirty(0x025003f0, 0x20));
+  QCOMPARE(memory.runs(true).size(), 1);
+
+  // Allocating adjacent pages never moves allocated pages
+  uint8_t *ptr = memory.data(0x025003f0);
+  QVERIFY(memory.allocate(0x02501000, 0x10));
+  QVERIFY(ptr == memory.data(0x025003f0));
+  QCOMPARE(int(ptr[0x81f]), 0x22);
+
+  // Export and import
+  DFUFile::Image image;
+  memory.toImage(image);
+  QCOMPARE(image.numElements(), 4);
+  CodePlug::PagedImage copy;
+  copy.fromImage(image);
+  QCOMPARE(copy.memSize(), memory.memSize());
+  QCOMPARE(int(copy.data(0x02500c00)[0x0f]), 0x22);
+
+  // A range ahead of an allocated page cannot be contiguous, the page stays in place
+  QVERIFY(memory.allocate(0x02600400, 0x10));
+  ptr = memory.data(0x02600400);
+  ptr[0] = 0x33;
+  QVERIFY(memory.allocate(0x02700000, 0x10));
+  QVERIFY(! memory.allocate(0x026003f0, 0x20));
+  QVERIFY(memory.isAllocated(0x026003f0, 0x20));
+  QVERIFY(ptr == memory.data(0x02600400));
+  QCOMPARE(int(ptr[0]), 0x33);
+  QVERIFY(memory.isFragmented());
+
+  // Records within a reserved range are contiguous, even across chunks of the arena
+  memory.clear();
+  QVERIFY(memory.reserve(0x02680000, 0x190*300));
+  QCOMPARE(memory.memSize(), uint32_t(0));
+  for (uint32_t i=0; i<300; i++)
+    QVERIFY(memory.allocate(0x02680000+i*0x190, 0x190));
+  QVERIFY(! memory.isFragmented());
+  QVERIFY((memory.data(0x02680000)+0x190*300-1) == memory.data(0x02680000+0x190*300-1));
+}
+
+void
+UtilsTest::testOverwriteMap() {
+  QVector<CodePlug::PagedImage::Run> map;
+  map.append({0x0100, 0x0100});
+  map.append({0x0200, 0x0080});
+  map.append({0x0400, 0x0400});
+  // Adjacent ranges cover a block
+  QVERIFY(CodePlug::isOverwritten(map, 0x0100, 0x0100));
+  QVERIFY(CodePlug::isOverwritten(map, 0x0180, 0x0100));
+  QVERIFY(CodePlug::isOverwritten(map, 0x0500, 0x0300));
+  // Partially covered blocks must be read
+  QVERIFY(! CodePlug::isOverwritten(map, 0x0000, 0x0200));
+  QVERIFY(! CodePlug::isOverwritten(map, 0x0200, 0x0100));
+  QVERIFY(! CodePlug::isOverwritten(map, 0x0700, 0x0200));
+  QVERIFY(! CodePlug::isOverwritten(QVector<CodePlug::PagedImage::Run>(), 0x0000, 0x0100));
+}
+
+void
+UtilsTest::testSignaling() {
+  QCOMPARE(Signaling::fromCTCSSFrequency(88.5), Signaling::CTCSS_88_5Hz);
+  QCOMPARE(Signaling::fromCTCSSDeciHz(2503), Signaling::CTCSS_250_3Hz);
+  QCOMPARE(Signaling::fromCTCSSDeciHz(625), Signaling::SIGNALING_NONE);
+  QCOMPARE(Signaling::toCTCSSDeciHz(Signaling::CTCSS_67_0Hz), uint16_t(670));
+  QCOMPARE(Signaling::toCTCSSDeciHz(Signaling::DCS_023N), uint16_t(0));
+  QVERIFY(! Signaling::isCTCSSFrequency(0));
+  QCOMPARE(Signaling::fromDCSNumber(754, true), Signaling::DCS_754I);
+  QCOMPARE(Signaling::fromDCSNumber(24, false), Signaling::SIGNALING_NONE);
+  QCOMPARE(Signaling::toDCSNumber(Signaling::DCS_023I), uint16_t(23));
+
+  // Every code survives the tone table round trip
+  for (int c=Signaling::CTCSS_67_0Hz; c<=Signaling::DCS_754I; c++) {
+    Signaling::Code code = Signaling::Code(c);
+    QCOMPARE(decode_ctcss_tone_table(encode_ctcss_tone_table(code)), code);
+  }
+  QCOMPARE(encode_ctcss_tone_table(Signaling::CTCSS_88_5Hz), uint16_t(0x0885));
+}
+
+void
+UtilsTest::testAPRSIconName() {
+  QCOMPARE(name2aprsicon(""), APRSSystem::APRS_ICON_NO_SYMBOL);
+  QCOMPARE(name2aprsicon("Car"), APRSSystem::APRS_ICON_CAR);
+  QCOMPARE(name2aprsicon("jogger"), APRSSystem::APRS_ICON_JOGGER);
+  QCOMPARE(name2aprsicon("Wx Station"), APRSSystem::APRS_ICON_WX_STN);
+  // Closest match
+  QCOMPARE(name2aprsicon("Jeeps"), APRSSystem::APRS_ICON_JEEP);
+  QCOMPARE(name2aprsicon("Digipeter"), APRSSystem::APRS_ICON_DIGI);
+
+  QCOMPARE(levDist("kitten", "sitting"), 3);
+  QCOMPARE(levDist("Car", "car"), 0);
+  QCOMPARE(levDist("Car", "car", Qt::CaseSensitive), 1);
+  QCOMPARE(levDist("", "abc"), 3);
+}
+
+void
+UtilsTest::testTransferProgress() {
+  // Blocking transfer within the consumer thread, gets sampled at most at the given rate
+  TransferProgress progress(20);
+  QSignalSpy spy(&progress, SIGNAL(sampled(TransferProgress::Sample)));
+  progress.start(TransferProgress::Upload);
+  for (int i=0; i<1000; i++)
+    progress.update((i+1)/10, 16);
+  progress.finish();
+  QVERIFY(1 <= spy.count());
+  QVERIFY(spy.count() < 1000);
+
+  TransferProgress::Sample sample = spy.last().at(0).value<TransferProgress::Sample>();
+  QCOMPARE(sample.phase, TransferProgress::Upload);
+  QCOMPARE(sample.percent, 100);
+  QCOMPARE(sample.bytes, qint64(16000));
+  QCOMPARE(sample.remaining, qint64(0));
+
+  // Nothing changed, nothing to sample
+  int count = spy.count();
+  progress.finish();
+  QCOMPARE(spy.count(), count);
+}
+
+void
+UtilsTest::testParallelFor() {
+  // Every index is processed exactly once
+  QVector<QAtomicInt> count(1000);
+  parallel_for(count.size(), [&count](int i) {
+    count[i].ref();
+  }, 1);
+  for (int i=0; i<count.size(); i++)
+    QCOMPARE(count[i].load(), 1);
+
+  // Nothing to do
+  parallel_for(0, [](int) {
+    QFAIL("Unexpected call.");
+  });
+
+  // Nested calls within the callback
+  QVector<int> sums(16);
+  parallel_for(sums.size(), [&sums](int i) {
+    QVector<int> values(100);
+    parallel_for(values.size(), [&values](int j) {
+      values[j] = j;
+    }, 1);
+    sums[i] = std::accumulate(values.begin(), values.end(), 0);
+  }, 1);
+  for (int i=0; i<sums.size(); i++)
+    QCOMPARE(sums[i], 4950);
+}
+
+void
+UtilsTest::testParallelForNested() {
+  // Occupy all pool threads with calls to parallel_for, the chunks they distribute cannot be
+  // started by the pool
+  QThreadPool *pool = QThreadPool::globalInstance();
+  int maxThreads = pool->maxThreadCount();
+  pool->setMaxThreadCount(2);
+
+  QSemaphore done(0);
+  QVector<int> a(1000), b(1000);
+  pool->start(new NestedParallelFor(a, done));
+  pool->start(new NestedParallelFor(b, done));
+  bool finished = done.tryAcquire(2, 10000);
+  pool->setMaxThreadCount(maxThreads);
+  QVERIFY(finished);
+
+  for (int i=0; i<a.size(); i++) {
+    QCOMPARE(a[i], i*i);
+    QCOMPARE(b[i], i*i);
+  }
+}
+
 
 QTEST_GUILESS_MAIN(UtilsTest)
@@ -16,8 +16,18 @@ private slots:
   void testEncodeASCII();
   void testDecodeFrequency();
   void testEncodeFrequency();
+  void testBCD8();
+  void testParseFrequency();
+  void testFormatFrequency();
   void testDecodeDMRID_bcd();
   void testEncodeDMRID_bcd();
+  void testPagedImage();
+  void testOverwriteMap();
+  void testSignaling();
+  void testAPRSIconName();
+  void testTransferProgress();
+  void testParallelFor();
+  void testParallelForNested();
 };
 
 #endif // UTILSTEST_HH